@@ -0,0 +1,75 @@
+#include "frame_replay_app.h"
+#include "le_renderer.h"
+#include "le_backend_vk.h"
+#include "le_log.h"
+
+struct frame_replay_app_o {
+	le_backend_o* backend; // never set up: replay only uses CPU-side parts of the backend
+};
+
+typedef frame_replay_app_o app_o;
+
+static auto logger = LeLog( "frame_replay_app" );
+
+// ----------------------------------------------------------------------
+
+static void app_initialize(){};
+
+// ----------------------------------------------------------------------
+
+static void app_terminate(){};
+
+// ----------------------------------------------------------------------
+
+static frame_replay_app_o* frame_replay_app_create() {
+	auto app = new ( frame_replay_app_o );
+
+	app->backend = le_backend_vk::vk_backend_i.create();
+
+	return app;
+}
+
+// ----------------------------------------------------------------------
+
+static bool frame_replay_app_replay( frame_replay_app_o* self, char const* capture_path, uint32_t num_iterations ) {
+
+	le_frame_replay_stats_t stats{};
+
+	if ( !le_renderer::frame_capture_i.replay( self->backend, capture_path, num_iterations, &stats ) ) {
+		return false;
+	}
+
+	double n = stats.num_iterations ? double( stats.num_iterations ) : 1.0;
+
+	logger.info( "Frame replay: '%s'", capture_path );
+	logger.info( "\t iterations      : %10zu", stats.num_iterations );
+	logger.info( "\t passes          : %10zu", stats.num_passes );
+	logger.info( "\t commands        : %10zu", stats.num_commands );
+	logger.info( "\t command bytes   : %10zu", stats.num_command_bytes );
+	logger.info( "\t plan frame      : %10.4f ms / iteration", stats.plan_frame_ms / n );
+	logger.info( "\t walk commands   : %10.4f ms / iteration", stats.walk_commands_ms / n );
+
+	return true;
+}
+
+// ----------------------------------------------------------------------
+
+static void frame_replay_app_destroy( frame_replay_app_o* self ) {
+	le_backend_vk::vk_backend_i.destroy( self->backend );
+	delete ( self );
+}
+
+// ----------------------------------------------------------------------
+
+LE_MODULE_REGISTER_IMPL( frame_replay_app, api ) {
+
+	auto  frame_replay_app_api_i = static_cast<frame_replay_app_api*>( api );
+	auto& frame_replay_app_i     = frame_replay_app_api_i->frame_replay_app_i;
+
+	frame_replay_app_i.initialize = app_initialize;
+	frame_replay_app_i.terminate  = app_terminate;
+
+	frame_replay_app_i.create  = frame_replay_app_create;
+	frame_replay_app_i.destroy = frame_replay_app_destroy;
+	frame_replay_app_i.replay  = frame_replay_app_replay;
+}
@@ -0,0 +1,60 @@
+#ifndef GUARD_frame_replay_app_H
+#define GUARD_frame_replay_app_H
+#endif
+
+#include "le_core.h"
+
+struct frame_replay_app_o;
+
+// clang-format off
+struct frame_replay_app_api {
+
+	struct frame_replay_app_interface_t {
+		frame_replay_app_o * ( *create           )();
+		void         ( *destroy                  )( frame_replay_app_o *self );
+		bool         ( *replay                   )( frame_replay_app_o *self, char const * capture_path, uint32_t num_iterations );
+		void         ( *initialize               )(); // static methods
+		void         ( *terminate                )(); // static methods
+	};
+
+	frame_replay_app_interface_t frame_replay_app_i;
+};
+// clang-format on
+
+LE_MODULE( frame_replay_app );
+LE_MODULE_LOAD_DEFAULT( frame_replay_app );
+
+#ifdef __cplusplus
+
+namespace frame_replay_app {
+static const auto& api                = frame_replay_app_api_i;
+static const auto& frame_replay_app_i = api -> frame_replay_app_i;
+} // namespace frame_replay_app
+
+class FrameReplayApp : NoCopy, NoMove {
+
+	frame_replay_app_o* self;
+
+  public:
+	FrameReplayApp()
+	    : self( frame_replay_app::frame_replay_app_i.create() ) {
+	}
+
+	bool replay( char const* capture_path, uint32_t num_iterations ) {
+		return frame_replay_app::frame_replay_app_i.replay( self, capture_path, num_iterations );
+	}
+
+	~FrameReplayApp() {
+		frame_replay_app::frame_replay_app_i.destroy( self );
+	}
+
+	static void initialize() {
+		frame_replay_app::frame_replay_app_i.initialize();
+	}
+
+	static void terminate() {
+		frame_replay_app::frame_replay_app_i.terminate();
+	}
+};
+
+#endif
@@ -0,0 +1,37 @@
+#include "frame_replay_app/frame_replay_app.h"
+
+#include <cstdlib>
+
+// ----------------------------------------------------------------------
+// Usage: Island-FrameReplay <path to .le_capture file> [number of iterations]
+//
+// Capture files are written by the renderer if you set the setting
+// `LE_SETTING_RENDERER_CAPTURE_FRAMES` to the number of frames to capture.
+int main( int argc, char const* argv[] ) {
+
+	if ( argc < 2 ) {
+		return 1;
+	}
+
+	char const* capture_path   = argv[ 1 ];
+	uint32_t    num_iterations = argc > 2 ? uint32_t( strtoul( argv[ 2 ], nullptr, 10 ) ) : 100;
+
+	FrameReplayApp::initialize();
+
+	bool result = false;
+
+	{
+		// We instantiate FrameReplayApp in its own scope - so that
+		// it will be destroyed before FrameReplayApp::terminate
+		// is called.
+
+		FrameReplayApp FrameReplayApp{};
+
+		result = FrameReplayApp.replay( capture_path, num_iterations );
+	}
+
+	// Must only be called once last FrameReplayApp is destroyed
+	FrameReplayApp::terminate();
+
+	return result ? 0 : 1;
+}
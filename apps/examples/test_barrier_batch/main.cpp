@@ -0,0 +1,38 @@
+#include "test_barrier_batch_app/test_barrier_batch_app.h"
+
+// ----------------------------------------------------------------------
+
+int main( int argc, char const* argv[] ) {
+
+	TestBarrierBatchApp::initialize();
+
+	uint32_t num_failed_checks = 0;
+
+	{
+		// We instantiate TestBarrierBatchApp in its own scope - so that
+		// it will be destroyed before TestBarrierBatchApp::terminate
+		// is called.
+
+		TestBarrierBatchApp TestBarrierBatchApp{};
+
+		for ( ;; ) {
+
+#ifdef PLUGINS_DYNAMIC
+			le_core_poll_for_module_reloads();
+#endif
+			auto result = TestBarrierBatchApp.update();
+
+			if ( !result ) {
+				break;
+			}
+		}
+
+		num_failed_checks = TestBarrierBatchApp.getNumFailedChecks();
+	}
+
+	// Must only be called once last TestBarrierBatchApp is destroyed
+	TestBarrierBatchApp::terminate();
+
+	// Non-zero exit code tells CI that tests have failed.
+	return num_failed_checks == 0 ? 0 : 1;
+}
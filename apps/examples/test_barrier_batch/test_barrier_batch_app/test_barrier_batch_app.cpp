@@ -0,0 +1,245 @@
+#include "test_barrier_batch_app.h"
+#include "le_log.h"
+#include "private/le_backend_vk/le_barrier_batch.h"
+
+#include <iterator>
+
+// Tests the barrier batch, which turns resource transitions at a pass boundary
+// into the smallest set of barriers. The barrier batch does not depend on
+// Vulkan, so we can test it without a device.
+
+struct test_barrier_batch_app_o {
+	uint32_t num_failed_checks = 0;
+};
+
+typedef test_barrier_batch_app_o app_o;
+
+static auto logger = LeLog( "test_barrier_batch_app" );
+
+// Raw values of the Vulkan flags which we use - the barrier batch only sees raw values.
+
+static constexpr uint64_t STAGE_FRAGMENT_SHADER = 0x00000080; // VK_PIPELINE_STAGE_2_FRAGMENT_SHADER_BIT
+static constexpr uint64_t STAGE_COLOR_OUTPUT    = 0x00000400; // VK_PIPELINE_STAGE_2_COLOR_ATTACHMENT_OUTPUT_BIT
+static constexpr uint64_t STAGE_COMPUTE_SHADER  = 0x00000800; // VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT
+static constexpr uint64_t STAGE_TRANSFER        = 0x00001000; // VK_PIPELINE_STAGE_2_TRANSFER_BIT
+
+static constexpr uint64_t ACCESS_SHADER_READ    = 0x00000020; // VK_ACCESS_2_SHADER_READ_BIT
+static constexpr uint64_t ACCESS_SHADER_WRITE   = 0x00000040; // VK_ACCESS_2_SHADER_WRITE_BIT
+static constexpr uint64_t ACCESS_COLOR_WRITE    = 0x00000100; // VK_ACCESS_2_COLOR_ATTACHMENT_WRITE_BIT
+static constexpr uint64_t ACCESS_TRANSFER_READ  = 0x00000800; // VK_ACCESS_2_TRANSFER_READ_BIT
+static constexpr uint64_t ACCESS_TRANSFER_WRITE = 0x00001000; // VK_ACCESS_2_TRANSFER_WRITE_BIT
+
+static constexpr uint64_t ANY_WRITE_ACCESS = ACCESS_SHADER_WRITE | ACCESS_COLOR_WRITE | ACCESS_TRANSFER_WRITE;
+
+static constexpr uint32_t LAYOUT_COLOR_ATTACHMENT = 2; // VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL
+static constexpr uint32_t LAYOUT_SHADER_READ_ONLY = 5; // VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL
+static constexpr uint32_t LAYOUT_TRANSFER_DST     = 7; // VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL
+
+// ----------------------------------------------------------------------
+
+static void check( app_o* self, bool condition, char const* test_name ) {
+	if ( condition ) {
+		logger.info( "[  OK  ] %s", test_name );
+	} else {
+		logger.error( "[ FAIL ] %s", test_name );
+		self->num_failed_checks++;
+	}
+}
+
+// ----------------------------------------------------------------------
+
+static le_barrier_transition_t make_buffer_transition( uint64_t resource, uint64_t src_stage, uint64_t src_access, uint64_t dst_stage, uint64_t dst_access ) {
+	return { resource, false, { src_stage, src_access, 0 }, { dst_stage, dst_access, 0 } };
+}
+
+// ----------------------------------------------------------------------
+
+static le_barrier_transition_t make_image_transition( uint64_t resource, le_barrier_state_t before, le_barrier_state_t after ) {
+	return { resource, true, before, after };
+}
+
+// ----------------------------------------------------------------------
+// Transitions which don't change state - or which only repeat reads which
+// already happen-before - need no barrier.
+static void test_drop_identical_state( app_o* self ) {
+
+	le_barrier_transition_t transitions[] = {
+	    make_buffer_transition( 1, STAGE_COMPUTE_SHADER, ACCESS_SHADER_WRITE, STAGE_COMPUTE_SHADER, ACCESS_SHADER_WRITE ), // identical, even though it writes
+	    make_buffer_transition( 2, STAGE_FRAGMENT_SHADER, ACCESS_SHADER_READ, STAGE_FRAGMENT_SHADER, ACCESS_SHADER_READ ),  // read-after-read
+	    make_image_transition( 3, { STAGE_FRAGMENT_SHADER, ACCESS_SHADER_READ, LAYOUT_SHADER_READ_ONLY }, { STAGE_FRAGMENT_SHADER, ACCESS_SHADER_READ, LAYOUT_SHADER_READ_ONLY } ),
+	};
+
+	le_barrier_batch_t batch;
+	le_barrier_batch_build( &batch, transitions, std::size( transitions ), ANY_WRITE_ACCESS );
+
+	check( self, batch.empty(), "identical state: no barriers" );
+	check( self, batch.num_dropped == std::size( transitions ), "identical state: all transitions dropped" );
+
+	// A read in a stage which did not already read must still wait for the earlier read.
+	le_barrier_transition_t later_stage = make_buffer_transition( 2, STAGE_FRAGMENT_SHADER, ACCESS_SHADER_READ, STAGE_COMPUTE_SHADER, ACCESS_SHADER_READ );
+	le_barrier_batch_build( &batch, &later_stage, 1, ANY_WRITE_ACCESS );
+
+	check( self, batch.has_memory_barrier && batch.num_dropped == 0, "identical state: read in new stage is not dropped" );
+}
+
+// ----------------------------------------------------------------------
+// Transitions which don't change layout are merged into a single global
+// memory barrier, by combining their masks.
+static void test_merge_same_stage( app_o* self ) {
+
+	le_barrier_transition_t transitions[] = {
+	    make_buffer_transition( 1, STAGE_COMPUTE_SHADER, ACCESS_SHADER_WRITE, STAGE_COMPUTE_SHADER, ACCESS_SHADER_READ ),
+	    make_buffer_transition( 2, STAGE_COMPUTE_SHADER, ACCESS_SHADER_WRITE, STAGE_COMPUTE_SHADER, ACCESS_SHADER_READ ),
+	    make_image_transition( 3, { STAGE_COMPUTE_SHADER, ACCESS_SHADER_WRITE, LAYOUT_SHADER_READ_ONLY }, { STAGE_COMPUTE_SHADER, ACCESS_SHADER_READ, LAYOUT_SHADER_READ_ONLY } ),
+	};
+
+	le_barrier_batch_t batch;
+	le_barrier_batch_build( &batch, transitions, std::size( transitions ), ANY_WRITE_ACCESS );
+
+	auto const& m = batch.memory_barrier;
+
+	check( self, batch.has_memory_barrier, "merge same stage: one memory barrier" );
+	check( self, batch.image_barriers.empty(), "merge same stage: image without layout change needs no image barrier" );
+	check( self, batch.num_dropped == 0, "merge same stage: nothing dropped" );
+	check( self, m.src_stage == STAGE_COMPUTE_SHADER && m.dst_stage == STAGE_COMPUTE_SHADER, "merge same stage: stage masks" );
+	check( self, m.src_access == ACCESS_SHADER_WRITE && m.dst_access == ACCESS_SHADER_READ, "merge same stage: access masks" );
+
+	// Transitions between different stages are combined into the same barrier.
+	le_barrier_transition_t mixed[] = {
+	    make_buffer_transition( 1, STAGE_COMPUTE_SHADER, ACCESS_SHADER_WRITE, STAGE_FRAGMENT_SHADER, ACCESS_SHADER_READ ),
+	    make_buffer_transition( 2, STAGE_TRANSFER, ACCESS_TRANSFER_WRITE, STAGE_COMPUTE_SHADER, ACCESS_SHADER_READ ),
+	};
+
+	le_barrier_batch_build( &batch, mixed, std::size( mixed ), ANY_WRITE_ACCESS );
+
+	check( self, batch.has_memory_barrier && batch.image_barriers.empty(), "merge stages: one memory barrier" );
+	check( self, m.src_stage == ( STAGE_COMPUTE_SHADER | STAGE_TRANSFER ) &&
+	                 m.dst_stage == ( STAGE_FRAGMENT_SHADER | STAGE_COMPUTE_SHADER ),
+	       "merge stages: stage masks are combined" );
+	check( self, m.src_access == ( ACCESS_SHADER_WRITE | ACCESS_TRANSFER_WRITE ), "merge stages: src access masks are combined" );
+}
+
+// ----------------------------------------------------------------------
+// Images which change layout each need an image barrier of their own - the
+// global memory barrier can't change layouts.
+static void test_image_layout_barrier( app_o* self ) {
+
+	le_barrier_transition_t transitions[] = {
+	    make_image_transition( 1, { STAGE_COLOR_OUTPUT, ACCESS_COLOR_WRITE, LAYOUT_COLOR_ATTACHMENT }, { STAGE_FRAGMENT_SHADER, ACCESS_SHADER_READ, LAYOUT_SHADER_READ_ONLY } ),
+	    make_image_transition( 1, { STAGE_COLOR_OUTPUT, ACCESS_COLOR_WRITE, LAYOUT_COLOR_ATTACHMENT }, { STAGE_COMPUTE_SHADER, ACCESS_SHADER_READ, LAYOUT_SHADER_READ_ONLY } ), // same image, same layouts: merged
+	    make_image_transition( 2, { STAGE_FRAGMENT_SHADER, ACCESS_SHADER_READ, LAYOUT_SHADER_READ_ONLY }, { STAGE_TRANSFER, ACCESS_TRANSFER_WRITE, LAYOUT_TRANSFER_DST } ),
+	    make_buffer_transition( 3, STAGE_COMPUTE_SHADER, ACCESS_SHADER_WRITE, STAGE_COMPUTE_SHADER, ACCESS_SHADER_READ ),
+	};
+
+	le_barrier_batch_t batch;
+	le_barrier_batch_build( &batch, transitions, std::size( transitions ), ANY_WRITE_ACCESS );
+
+	check( self, batch.image_barriers.size() == 2, "image layout: one image barrier per image" );
+	check( self, batch.has_memory_barrier && batch.memory_barrier.src_stage == STAGE_COMPUTE_SHADER, "image layout: buffer goes into memory barrier" );
+
+	if ( batch.image_barriers.size() != 2 ) {
+		return;
+	}
+
+	auto const& a = batch.image_barriers[ 0 ];
+	auto const& b = batch.image_barriers[ 1 ];
+
+	check( self, a.resource == 1 && a.old_layout == LAYOUT_COLOR_ATTACHMENT && a.new_layout == LAYOUT_SHADER_READ_ONLY, "image layout: layouts of first image" );
+	check( self, a.masks.dst_stage == ( STAGE_FRAGMENT_SHADER | STAGE_COMPUTE_SHADER ), "image layout: transitions with identical layouts are merged" );
+	check( self, a.masks.src_access == ACCESS_COLOR_WRITE && a.masks.dst_access == ACCESS_SHADER_READ, "image layout: access masks of first image" );
+	check( self, b.resource == 2 && b.old_layout == LAYOUT_SHADER_READ_ONLY && b.new_layout == LAYOUT_TRANSFER_DST, "image layout: layouts of second image" );
+	check( self, ( batch.memory_barrier.dst_stage & STAGE_TRANSFER ) == 0, "image layout: image barriers don't leak into memory barrier" );
+}
+
+// ----------------------------------------------------------------------
+// Write-after-write must make the earlier write available; write-after-read
+// only needs an execution dependency, so src access must be empty - reads
+// never need to be made available.
+static void test_hazard_access_masks( app_o* self ) {
+
+	le_barrier_batch_t batch;
+
+	le_barrier_transition_t waw = make_buffer_transition( 1, STAGE_TRANSFER, ACCESS_TRANSFER_WRITE, STAGE_COMPUTE_SHADER, ACCESS_SHADER_WRITE );
+	le_barrier_batch_build( &batch, &waw, 1, ANY_WRITE_ACCESS );
+
+	check( self, batch.has_memory_barrier, "write-after-write: needs barrier" );
+	check( self, batch.memory_barrier.src_stage == STAGE_TRANSFER && batch.memory_barrier.dst_stage == STAGE_COMPUTE_SHADER, "write-after-write: stage masks" );
+	check( self, batch.memory_barrier.src_access == ACCESS_TRANSFER_WRITE, "write-after-write: earlier write is made available" );
+	check( self, batch.memory_barrier.dst_access == ACCESS_SHADER_WRITE, "write-after-write: dst access is later write" );
+
+	le_barrier_transition_t war = make_buffer_transition( 1, STAGE_FRAGMENT_SHADER, ACCESS_SHADER_READ | ACCESS_TRANSFER_READ, STAGE_TRANSFER, ACCESS_TRANSFER_WRITE );
+	le_barrier_batch_build( &batch, &war, 1, ANY_WRITE_ACCESS );
+
+	check( self, batch.has_memory_barrier, "write-after-read: needs barrier" );
+	check( self, batch.memory_barrier.src_stage == STAGE_FRAGMENT_SHADER && batch.memory_barrier.dst_stage == STAGE_TRANSFER, "write-after-read: execution dependency" );
+	check( self, batch.memory_barrier.src_access == 0, "write-after-read: read access is removed from src access" );
+	check( self, batch.memory_barrier.dst_access == ACCESS_TRANSFER_WRITE, "write-after-read: dst access is later write" );
+
+	// Write-after-write within the same stage: access changes, and the earlier write must be made available.
+	le_barrier_transition_t waw_same = make_buffer_transition( 1, STAGE_COMPUTE_SHADER, ACCESS_SHADER_WRITE, STAGE_COMPUTE_SHADER, ACCESS_SHADER_WRITE | ACCESS_SHADER_READ );
+	le_barrier_batch_build( &batch, &waw_same, 1, ANY_WRITE_ACCESS );
+
+	check( self, batch.has_memory_barrier && batch.memory_barrier.src_access == ACCESS_SHADER_WRITE, "write-after-write: read-write after write is not dropped" );
+}
+
+// ----------------------------------------------------------------------
+
+static void app_initialize(){};
+
+// ----------------------------------------------------------------------
+
+static void app_terminate(){};
+
+// ----------------------------------------------------------------------
+
+static test_barrier_batch_app_o* test_barrier_batch_app_create() {
+	auto app = new ( test_barrier_batch_app_o );
+	return app;
+}
+
+// ----------------------------------------------------------------------
+
+static bool test_barrier_batch_app_update( test_barrier_batch_app_o* self ) {
+
+	test_drop_identical_state( self );
+	test_merge_same_stage( self );
+	test_image_layout_barrier( self );
+	test_hazard_access_masks( self );
+
+	if ( self->num_failed_checks == 0 ) {
+		logger.info( "All tests passed." );
+	} else {
+		logger.error( "%u checks failed.", self->num_failed_checks );
+	}
+
+	return false; // tests run only once
+}
+
+// ----------------------------------------------------------------------
+
+static uint32_t test_barrier_batch_app_get_num_failed_checks( test_barrier_batch_app_o* self ) {
+	return self->num_failed_checks;
+}
+
+// ----------------------------------------------------------------------
+
+static void test_barrier_batch_app_destroy( test_barrier_batch_app_o* self ) {
+	delete ( self );
+}
+
+// ----------------------------------------------------------------------
+
+LE_MODULE_REGISTER_IMPL( test_barrier_batch_app, api ) {
+
+	auto  test_barrier_batch_app_api_i = static_cast<test_barrier_batch_app_api*>( api );
+	auto& test_barrier_batch_app_i     = test_barrier_batch_app_api_i->test_barrier_batch_app_i;
+
+	test_barrier_batch_app_i.initialize = app_initialize;
+	test_barrier_batch_app_i.terminate  = app_terminate;
+
+	test_barrier_batch_app_i.create  = test_barrier_batch_app_create;
+	test_barrier_batch_app_i.destroy = test_barrier_batch_app_destroy;
+	test_barrier_batch_app_i.update  = test_barrier_batch_app_update;
+
+	test_barrier_batch_app_i.get_num_failed_checks = test_barrier_batch_app_get_num_failed_checks;
+}
@@ -0,0 +1,67 @@
+#ifndef GUARD_test_barrier_batch_app_H
+#define GUARD_test_barrier_batch_app_H
+
+#include "le_core.h"
+
+
+struct test_barrier_batch_app_o;
+
+// clang-format off
+struct test_barrier_batch_app_api {
+
+	struct test_barrier_batch_app_interface_t {
+		test_barrier_batch_app_o * ( *create               )();
+		void         ( *destroy                  )( test_barrier_batch_app_o *self );
+		bool         ( *update                   )( test_barrier_batch_app_o *self );
+		uint32_t     ( *get_num_failed_checks    )( test_barrier_batch_app_o *self );
+		void         ( *initialize               )(); // static methods
+		void         ( *terminate                )(); // static methods
+	};
+
+	test_barrier_batch_app_interface_t test_barrier_batch_app_i;
+};
+// clang-format on
+
+LE_MODULE( test_barrier_batch_app );
+LE_MODULE_LOAD_DEFAULT( test_barrier_batch_app );
+
+#ifdef __cplusplus
+
+namespace test_barrier_batch_app {
+static const auto& api            = test_barrier_batch_app_api_i;
+static const auto& test_barrier_batch_app_i = api -> test_barrier_batch_app_i;
+} // namespace test_barrier_batch_app
+
+class TestBarrierBatchApp : NoCopy, NoMove {
+
+	test_barrier_batch_app_o* self;
+
+  public:
+	TestBarrierBatchApp()
+	    : self( test_barrier_batch_app::test_barrier_batch_app_i.create() ) {
+	}
+
+	bool update() {
+		return test_barrier_batch_app::test_barrier_batch_app_i.update( self );
+	}
+
+	uint32_t getNumFailedChecks() {
+		return test_barrier_batch_app::test_barrier_batch_app_i.get_num_failed_checks( self );
+	}
+
+	~TestBarrierBatchApp() {
+		test_barrier_batch_app::test_barrier_batch_app_i.destroy( self );
+	}
+
+	static void initialize() {
+		test_barrier_batch_app::test_barrier_batch_app_i.initialize();
+	}
+
+	static void terminate() {
+		test_barrier_batch_app::test_barrier_batch_app_i.terminate();
+	}
+};
+
+#endif
+
+#endif
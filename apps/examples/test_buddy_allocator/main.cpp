@@ -0,0 +1,38 @@
+#include "test_buddy_allocator_app/test_buddy_allocator_app.h"
+
+// ----------------------------------------------------------------------
+
+int main( int argc, char const* argv[] ) {
+
+	TestBuddyAllocatorApp::initialize();
+
+	uint32_t num_failed_checks = 0;
+
+	{
+		// We instantiate TestBuddyAllocatorApp in its own scope - so that
+		// it will be destroyed before TestBuddyAllocatorApp::terminate
+		// is called.
+
+		TestBuddyAllocatorApp TestBuddyAllocatorApp{};
+
+		for ( ;; ) {
+
+#ifdef PLUGINS_DYNAMIC
+			le_core_poll_for_module_reloads();
+#endif
+			auto result = TestBuddyAllocatorApp.update();
+
+			if ( !result ) {
+				break;
+			}
+		}
+
+		num_failed_checks = TestBuddyAllocatorApp.getNumFailedChecks();
+	}
+
+	// Must only be called once last TestBuddyAllocatorApp is destroyed
+	TestBuddyAllocatorApp::terminate();
+
+	// Non-zero exit code tells CI that tests have failed.
+	return num_failed_checks == 0 ? 0 : 1;
+}
@@ -0,0 +1,261 @@
+#include "test_buddy_allocator_app.h"
+#include "le_log.h"
+#include "private/le_renderer/le_buddy_allocator.h"
+
+#include <random>
+#include <vector>
+
+// Tests the buddy allocator which sub-allocates retained buffers. The
+// allocator only does book-keeping, so we can test it without a device.
+
+struct test_buddy_allocator_app_o {
+	uint32_t num_failed_checks = 0;
+};
+
+typedef test_buddy_allocator_app_o app_o;
+
+static auto logger = LeLog( "test_buddy_allocator_app" );
+
+// ----------------------------------------------------------------------
+
+static void check( app_o* self, bool condition, char const* test_name ) {
+	if ( condition ) {
+		logger.info( "[  OK  ] %s", test_name );
+	} else {
+		logger.error( "[ FAIL ] %s", test_name );
+		self->num_failed_checks++;
+	}
+}
+
+// ----------------------------------------------------------------------
+// Returns total number of free blocks over all orders.
+static size_t count_free_blocks( le_buddy_allocator_t const& a ) {
+	size_t count = 0;
+	for ( auto const& f : a.free_blocks ) {
+		count += f.size();
+	}
+	return count;
+}
+
+// ----------------------------------------------------------------------
+// Allocating the smallest block from a fresh allocator must split the
+// range once per order, and leave one free buddy per order behind.
+static void test_split( app_o* self ) {
+
+	le_buddy_allocator_t a( 10, 4 ); // 1024 bytes, blocks of at least 16 bytes
+
+	uint64_t offset = ~0ull;
+	check( self, a.allocate( 16, &offset ), "split: allocation succeeds" );
+	check( self, offset == 0, "split: first block is placed at offset 0" );
+	check( self, a.get_allocation_size( offset ) == 16, "split: block has smallest size" );
+	check( self, a.used_bytes == 16, "split: used bytes match block size" );
+
+	bool one_buddy_per_order = a.free_blocks.back().empty();
+	for ( uint32_t o = 0; o + 1 < a.free_blocks.size(); o++ ) {
+		one_buddy_per_order &= a.free_blocks[ o ].size() == 1 &&
+		                       *a.free_blocks[ o ].begin() == a.get_block_size( o );
+	}
+	check( self, one_buddy_per_order, "split: upper halves are returned to free lists" );
+
+	// A second allocation of the same size must take the buddy, and not split again.
+	uint64_t second = ~0ull;
+	check( self, a.allocate( 10, &second ) && second == 16, "split: next allocation takes free buddy" );
+	check( self, a.free_blocks[ 0 ].empty(), "split: buddy was removed from free list" );
+}
+
+// ----------------------------------------------------------------------
+// Freeing must reject offsets which were never handed out, or which were
+// already freed.
+static void test_free( app_o* self ) {
+
+	le_buddy_allocator_t a( 10, 4 );
+
+	uint64_t offset = ~0ull;
+	a.allocate( 64, &offset );
+
+	check( self, !a.free( offset + 16 ), "free: unknown offset is rejected" );
+	check( self, a.free( offset ), "free: allocated offset is accepted" );
+	check( self, a.get_allocation_size( offset ) == 0, "free: block is no longer allocated" );
+	check( self, a.used_bytes == 0, "free: used bytes drop to zero" );
+	check( self, !a.free( offset ), "free: double free is rejected" );
+}
+
+// ----------------------------------------------------------------------
+// Once all blocks are freed - in any order - buddies must merge back into
+// a single block which spans the whole range.
+static void test_coalesce( app_o* self ) {
+
+	le_buddy_allocator_t a( 10, 4 );
+
+	uint64_t offsets[ 4 ];
+	for ( auto& o : offsets ) {
+		a.allocate( 256, &o );
+	}
+
+	check( self, count_free_blocks( a ) == 0, "coalesce: range is fully allocated" );
+
+	// Free non-adjacent blocks first: these have no free buddy yet, and must not merge.
+	a.free( offsets[ 0 ] );
+	a.free( offsets[ 2 ] );
+	check( self, a.free_blocks[ a.get_order( 256 ) ].size() == 2, "coalesce: blocks without free buddy don't merge" );
+
+	a.free( offsets[ 1 ] );
+	check( self, a.free_blocks[ a.get_order( 512 ) ].count( 0 ) == 1, "coalesce: buddies merge into parent block" );
+
+	a.free( offsets[ 3 ] );
+	check( self, count_free_blocks( a ) == 1 && a.free_blocks.back().count( 0 ) == 1, "coalesce: range merges back into a single block" );
+
+	uint64_t whole = ~0ull;
+	check( self, a.allocate( 1024, &whole ) && whole == 0, "coalesce: whole range may be allocated again" );
+}
+
+// ----------------------------------------------------------------------
+// Allocation must fail once there is no free block large enough, and
+// succeed again once memory was returned.
+static void test_exhaustion( app_o* self ) {
+
+	le_buddy_allocator_t a( 10, 4 );
+
+	uint64_t offset = ~0ull;
+	check( self, !a.allocate( 2048, &offset ), "exhaustion: request larger than range fails" );
+
+	uint64_t first = ~0ull;
+	a.allocate( 512, &first );
+	uint64_t second = ~0ull;
+	a.allocate( 256, &second );
+
+	// 256 bytes remain free, but not as a single block of 512 bytes.
+	check( self, !a.allocate( 512, &offset ), "exhaustion: fragmented range can't fit larger block" );
+	check( self, a.allocate( 256, &offset ), "exhaustion: remaining block may be allocated" );
+	check( self, !a.allocate( 16, &offset ), "exhaustion: full range rejects smallest block" );
+
+	a.free( first );
+	check( self, a.allocate( 512, &offset ) && offset == first, "exhaustion: freed block may be allocated again" );
+}
+
+// ----------------------------------------------------------------------
+// Every block must be aligned to its own size; allocated blocks must
+// never overlap.
+static void test_alignment( app_o* self ) {
+
+	le_buddy_allocator_t a( 16, 4 ); // 64 KiB, blocks of at least 16 bytes
+
+	std::mt19937 rng( 0x5eed ); // fixed seed, so that failures can be reproduced
+
+	std::vector<std::pair<uint64_t, uint64_t>> live; // offset, size
+
+	bool all_aligned   = true;
+	bool none_overlap  = true;
+	bool sizes_fit     = true;
+	bool used_bytes_ok = true;
+
+	for ( int iteration = 0; iteration != 4000; iteration++ ) {
+
+		if ( live.empty() || rng() % 3 != 0 ) {
+
+			uint64_t num_bytes = 1 + rng() % 2000;
+			uint64_t offset    = 0;
+
+			if ( a.allocate( num_bytes, &offset ) ) {
+
+				uint64_t size = a.get_allocation_size( offset );
+
+				all_aligned &= ( offset % size ) == 0;
+				sizes_fit &= size >= num_bytes && size < 2 * num_bytes + 16;
+
+				for ( auto const& [ o, s ] : live ) {
+					none_overlap &= offset + size <= o || o + s <= offset;
+				}
+
+				live.push_back( { offset, size } );
+			}
+
+		} else {
+			size_t i = rng() % live.size();
+			a.free( live[ i ].first );
+			live[ i ] = live.back();
+			live.pop_back();
+		}
+
+		uint64_t sum = 0;
+		for ( auto const& l : live ) {
+			sum += l.second;
+		}
+		used_bytes_ok &= sum == a.used_bytes;
+	}
+
+	for ( auto const& l : live ) {
+		a.free( l.first );
+	}
+
+	bool fully_coalesced = count_free_blocks( a ) == 1 && a.free_blocks.back().count( 0 ) == 1;
+
+	check( self, all_aligned, "alignment: blocks are aligned to their size" );
+	check( self, sizes_fit, "alignment: block size is smallest power of two which fits" );
+	check( self, none_overlap, "alignment: allocated blocks don't overlap" );
+	check( self, used_bytes_ok, "alignment: used bytes match live allocations" );
+	check( self, fully_coalesced, "alignment: range merges back into a single block" );
+}
+
+// ----------------------------------------------------------------------
+
+static void app_initialize(){};
+
+// ----------------------------------------------------------------------
+
+static void app_terminate(){};
+
+// ----------------------------------------------------------------------
+
+static test_buddy_allocator_app_o* test_buddy_allocator_app_create() {
+	auto app = new ( test_buddy_allocator_app_o );
+	return app;
+}
+
+// ----------------------------------------------------------------------
+
+static bool test_buddy_allocator_app_update( test_buddy_allocator_app_o* self ) {
+
+	test_split( self );
+	test_free( self );
+	test_coalesce( self );
+	test_exhaustion( self );
+	test_alignment( self );
+
+	if ( self->num_failed_checks == 0 ) {
+		logger.info( "All tests passed." );
+	} else {
+		logger.error( "%u checks failed.", self->num_failed_checks );
+	}
+
+	return false; // tests run only once
+}
+
+// ----------------------------------------------------------------------
+
+static uint32_t test_buddy_allocator_app_get_num_failed_checks( test_buddy_allocator_app_o* self ) {
+	return self->num_failed_checks;
+}
+
+// ----------------------------------------------------------------------
+
+static void test_buddy_allocator_app_destroy( test_buddy_allocator_app_o* self ) {
+	delete ( self );
+}
+
+// ----------------------------------------------------------------------
+
+LE_MODULE_REGISTER_IMPL( test_buddy_allocator_app, api ) {
+
+	auto  test_buddy_allocator_app_api_i = static_cast<test_buddy_allocator_app_api*>( api );
+	auto& test_buddy_allocator_app_i     = test_buddy_allocator_app_api_i->test_buddy_allocator_app_i;
+
+	test_buddy_allocator_app_i.initialize = app_initialize;
+	test_buddy_allocator_app_i.terminate  = app_terminate;
+
+	test_buddy_allocator_app_i.create  = test_buddy_allocator_app_create;
+	test_buddy_allocator_app_i.destroy = test_buddy_allocator_app_destroy;
+	test_buddy_allocator_app_i.update  = test_buddy_allocator_app_update;
+
+	test_buddy_allocator_app_i.get_num_failed_checks = test_buddy_allocator_app_get_num_failed_checks;
+}
@@ -0,0 +1,67 @@
+#ifndef GUARD_test_buddy_allocator_app_H
+#define GUARD_test_buddy_allocator_app_H
+
+#include "le_core.h"
+
+
+struct test_buddy_allocator_app_o;
+
+// clang-format off
+struct test_buddy_allocator_app_api {
+
+	struct test_buddy_allocator_app_interface_t {
+		test_buddy_allocator_app_o * ( *create               )();
+		void         ( *destroy                  )( test_buddy_allocator_app_o *self );
+		bool         ( *update                   )( test_buddy_allocator_app_o *self );
+		uint32_t     ( *get_num_failed_checks    )( test_buddy_allocator_app_o *self );
+		void         ( *initialize               )(); // static methods
+		void         ( *terminate                )(); // static methods
+	};
+
+	test_buddy_allocator_app_interface_t test_buddy_allocator_app_i;
+};
+// clang-format on
+
+LE_MODULE( test_buddy_allocator_app );
+LE_MODULE_LOAD_DEFAULT( test_buddy_allocator_app );
+
+#ifdef __cplusplus
+
+namespace test_buddy_allocator_app {
+static const auto& api            = test_buddy_allocator_app_api_i;
+static const auto& test_buddy_allocator_app_i = api -> test_buddy_allocator_app_i;
+} // namespace test_buddy_allocator_app
+
+class TestBuddyAllocatorApp : NoCopy, NoMove {
+
+	test_buddy_allocator_app_o* self;
+
+  public:
+	TestBuddyAllocatorApp()
+	    : self( test_buddy_allocator_app::test_buddy_allocator_app_i.create() ) {
+	}
+
+	bool update() {
+		return test_buddy_allocator_app::test_buddy_allocator_app_i.update( self );
+	}
+
+	uint32_t getNumFailedChecks() {
+		return test_buddy_allocator_app::test_buddy_allocator_app_i.get_num_failed_checks( self );
+	}
+
+	~TestBuddyAllocatorApp() {
+		test_buddy_allocator_app::test_buddy_allocator_app_i.destroy( self );
+	}
+
+	static void initialize() {
+		test_buddy_allocator_app::test_buddy_allocator_app_i.initialize();
+	}
+
+	static void terminate() {
+		test_buddy_allocator_app::test_buddy_allocator_app_i.terminate();
+	}
+};
+
+#endif
+
+#endif
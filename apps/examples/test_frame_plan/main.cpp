@@ -0,0 +1,38 @@
+#include "test_frame_plan_app/test_frame_plan_app.h"
+
+// ----------------------------------------------------------------------
+
+int main( int argc, char const* argv[] ) {
+
+	TestFramePlanApp::initialize();
+
+	uint32_t num_failed_checks = 0;
+
+	{
+		// We instantiate TestFramePlanApp in its own scope - so that
+		// it will be destroyed before TestFramePlanApp::terminate
+		// is called.
+
+		TestFramePlanApp TestFramePlanApp{};
+
+		for ( ;; ) {
+
+#ifdef PLUGINS_DYNAMIC
+			le_core_poll_for_module_reloads();
+#endif
+			auto result = TestFramePlanApp.update();
+
+			if ( !result ) {
+				break;
+			}
+		}
+
+		num_failed_checks = TestFramePlanApp.getNumFailedChecks();
+	}
+
+	// Must only be called once last TestFramePlanApp is destroyed
+	TestFramePlanApp::terminate();
+
+	// Non-zero exit code tells CI that tests have failed.
+	return num_failed_checks == 0 ? 0 : 1;
+}
@@ -0,0 +1,280 @@
+#include "test_frame_plan_app.h"
+#include "le_log.h"
+#include "le_renderer.hpp"
+#include "le_backend_vk.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include "private/le_renderer/le_rendergraph.h" // for access to built passes - needs <string>, <vector>
+#include "private/le_backend_vk/le_backend_frame_plan.h"
+
+// Tests frame planning (explicit barriers, resource lifetimes, and queue
+// submissions) via the backend's dry run, `vk_backend_i.plan_frame`, and
+// benchmarks it. The backend is never set up, so this runs without a device.
+
+struct test_frame_plan_app_o {
+	le_backend_o* backend; // never set up: we only use CPU-side frame planning
+	uint32_t      num_failed_checks = 0;
+};
+
+typedef test_frame_plan_app_o app_o;
+
+static auto logger = LeLog( "test_frame_plan_app" );
+
+static le_image_resource_handle  IMG_COLOR  = LE_IMG_RESOURCE( "test_frame_plan_color" );
+static le_image_resource_handle  IMG_UNUSED = LE_IMG_RESOURCE( "test_frame_plan_unused" );
+static le_buffer_resource_handle BUF_OUTPUT = LE_BUF_RESOURCE( "test_frame_plan_output" );
+
+// ----------------------------------------------------------------------
+
+static void check( app_o* self, bool condition, char const* test_name ) {
+	if ( condition ) {
+		logger.info( "[  OK  ] %s", test_name );
+	} else {
+		logger.error( "[ FAIL ] %s", test_name );
+		self->num_failed_checks++;
+	}
+}
+
+// ----------------------------------------------------------------------
+
+static le_backend_frame_plan_t::Resource const* plan_find_resource( le_backend_frame_plan_t const& plan, le_resource_handle resource ) {
+	auto it = std::find_if( plan.resources.begin(), plan.resources.end(), [ & ]( auto const& r ) { return r.handle == resource; } );
+	return it != plan.resources.end() ? &*it : nullptr;
+}
+
+// ----------------------------------------------------------------------
+// Builds a graph of three passes:
+//
+// + "draw"    : renders into IMG_COLOR
+// + "compute" : reads IMG_COLOR as a storage image, writes BUF_OUTPUT - root pass
+// + "unused"  : renders into IMG_UNUSED - does not contribute to any root pass
+//
+// and plans a frame for it.
+static void test_plan_frame( app_o* self ) {
+
+	le::RenderGraph graph{};
+
+	{
+		le::RenderPass draw( "draw", le::QueueFlagBits::eGraphics );
+		draw.addColorAttachment( IMG_COLOR );
+
+		le::RenderPass compute( "compute", le::QueueFlagBits::eCompute );
+		compute
+		    .useImageResource( IMG_COLOR, le::AccessFlagBits2::eShaderStorageRead )
+		    .useBufferResource( BUF_OUTPUT, le::AccessFlagBits2::eNone, le::AccessFlagBits2::eShaderStorageWrite )
+		    .setIsRoot( true );
+
+		le::RenderPass unused( "unused", le::QueueFlagBits::eGraphics );
+		unused.addColorAttachment( IMG_UNUSED );
+
+		graph
+		    .addRenderPass( draw )
+		    .addRenderPass( compute )
+		    .addRenderPass( unused );
+	}
+
+	le_rendergraph_o* rendergraph = graph;
+
+	le_renderer::api->le_rendergraph_private_i.build( rendergraph, 0 );
+
+	check( self, rendergraph->passes.size() == 2, "rendergraph: non-contributing pass is culled" );
+
+	uint32_t draw_width_before = 0;
+	le_renderer::renderpass_i.get_framebuffer_settings( rendergraph->passes[ 0 ], &draw_width_before, nullptr, nullptr );
+
+	auto plan_frame = [ & ]( le_backend_frame_plan_t* plan ) {
+		return le_backend_vk::vk_backend_i.plan_frame(
+		    self->backend,
+		    rendergraph->passes.data(), rendergraph->passes.size(),
+		    rendergraph->declared_resources_id.data(), rendergraph->declared_resources_info.data(), rendergraph->declared_resources_id.size(),
+		    rendergraph->root_passes_affinity_masks.data(), uint32_t( rendergraph->root_passes_affinity_masks.size() ),
+		    plan );
+	};
+
+	le_backend_frame_plan_t plan;
+
+	check( self, plan_frame( &plan ), "plan_frame: succeeds without a device" );
+
+	if ( plan.passes.size() != 2 ) {
+		check( self, false, "plan_frame: plans two passes" );
+		return;
+	}
+
+	// -- Passes are planned in order, and the caller's passes are left untouched
+
+	check( self, 0 == strcmp( plan.passes[ 0 ].debug_name, "draw" ) && 0 == strcmp( plan.passes[ 1 ].debug_name, "compute" ), "plan_frame: passes are in order of execution" );
+
+	uint32_t draw_width_after = 0;
+	le_renderer::renderpass_i.get_framebuffer_settings( rendergraph->passes[ 0 ], &draw_width_after, nullptr, nullptr );
+
+	check( self, draw_width_before == 0 && draw_width_after == 0, "plan_frame: does not patch the caller's pass extents" );
+	check( self, plan.passes[ 0 ].width != 0 && plan.passes[ 0 ].height != 0, "plan_frame: planned pass has default extents" );
+
+	// -- Draw pass synchronises its attachment implicitly
+
+	check( self, plan.passes[ 0 ].attachments.size() == 1 && plan.passes[ 0 ].attachments[ 0 ].resource == IMG_COLOR, "plan_frame: draw pass has color attachment" );
+	check( self, plan.passes[ 0 ].barriers.empty(), "plan_frame: draw pass needs no explicit barrier" );
+
+	// -- Compute pass must wait for, and transition, the image which draw wrote to
+
+	auto const& barriers          = plan.passes[ 1 ].barriers;
+	auto        image_barrier     = std::find_if( barriers.begin(), barriers.end(), []( auto const& b ) { return b.resource == IMG_COLOR; } );
+	bool        has_image_barrier = image_barrier != barriers.end();
+
+	check( self, has_image_barrier, "plan_frame: compute pass has barrier for image written by draw" );
+	check( self, has_image_barrier && image_barrier->src.layout != image_barrier->dst.layout, "plan_frame: barrier transitions image layout" );
+	check( self, has_image_barrier && image_barrier->src.layout == plan.passes[ 0 ].attachments[ 0 ].final.layout, "plan_frame: barrier starts from attachment final layout" );
+
+	// -- Resource lifetimes
+
+	auto color  = plan_find_resource( plan, IMG_COLOR );
+	auto output = plan_find_resource( plan, BUF_OUTPUT );
+
+	check( self, color && color->first_pass == 0 && color->last_pass == 1, "plan_frame: image lifetime spans draw and compute" );
+	check( self, output && output->first_pass == 1 && output->last_pass == 1, "plan_frame: buffer lifetime is compute only" );
+	check( self, nullptr == plan_find_resource( plan, IMG_UNUSED ), "plan_frame: resources of culled passes are not planned" );
+
+	// -- Both passes contribute to the same root, and therefore to the same submission
+
+	check( self, plan.submissions.size() == 1 && plan.submissions[ 0 ].pass_indices == std::vector<uint32_t>{ 0, 1 }, "plan_frame: one submission with both passes" );
+
+	// -- Planning is repeatable: planning the same passes again gives the same result
+
+	le_backend_frame_plan_t plan_again;
+	plan_frame( &plan_again );
+
+	bool is_same = plan_again.passes.size() == plan.passes.size() &&
+	               plan_again.resources.size() == plan.resources.size() &&
+	               plan_again.submissions.size() == plan.submissions.size();
+
+	for ( size_t i = 0; is_same && i != plan.passes.size(); i++ ) {
+		is_same = plan_again.passes[ i ].width == plan.passes[ i ].width &&
+		          plan_again.passes[ i ].height == plan.passes[ i ].height &&
+		          plan_again.passes[ i ].barriers.size() == plan.passes[ i ].barriers.size();
+	}
+
+	check( self, is_same, "plan_frame: repeated planning gives the same plan" );
+}
+
+// ----------------------------------------------------------------------
+// Benchmarks frame planning for a chain of compute passes, in which each pass
+// reads the buffer which the previous pass wrote - so that each pass needs a
+// barrier. Planning is CPU-only, which is why we can time it in isolation.
+static void benchmark_plan_frame( app_o* self ) {
+
+	constexpr uint32_t NUM_PASSES     = 64;
+	constexpr uint32_t NUM_ITERATIONS = 200;
+
+	std::vector<le_buffer_resource_handle> buffers;
+	buffers.reserve( NUM_PASSES );
+	for ( uint32_t i = 0; i != NUM_PASSES; i++ ) {
+		buffers.push_back( LE_BUF_RESOURCE( ( "test_frame_plan_chain_" + std::to_string( i ) ).c_str() ) );
+	}
+
+	le::RenderGraph graph{};
+
+	for ( uint32_t i = 0; i != NUM_PASSES; i++ ) {
+		le::RenderPass pass( "chain", le::QueueFlagBits::eCompute );
+		if ( i > 0 ) {
+			pass.useBufferResource( buffers[ i - 1 ], le::AccessFlagBits2::eShaderStorageRead );
+		}
+		pass
+		    .useBufferResource( buffers[ i ], le::AccessFlagBits2::eNone, le::AccessFlagBits2::eShaderStorageWrite )
+		    .setIsRoot( i + 1 == NUM_PASSES );
+		graph.addRenderPass( pass );
+	}
+
+	le_rendergraph_o* rendergraph = graph;
+
+	le_renderer::api->le_rendergraph_private_i.build( rendergraph, 0 );
+
+	le_backend_frame_plan_t plan;
+
+	auto t_start = std::chrono::steady_clock::now();
+
+	for ( uint32_t i = 0; i != NUM_ITERATIONS; i++ ) {
+		plan = {};
+		le_backend_vk::vk_backend_i.plan_frame(
+		    self->backend,
+		    rendergraph->passes.data(), rendergraph->passes.size(),
+		    rendergraph->declared_resources_id.data(), rendergraph->declared_resources_info.data(), rendergraph->declared_resources_id.size(),
+		    rendergraph->root_passes_affinity_masks.data(), uint32_t( rendergraph->root_passes_affinity_masks.size() ),
+		    &plan );
+	}
+
+	auto t_end = std::chrono::steady_clock::now();
+
+	check( self, plan.passes.size() == NUM_PASSES, "benchmark: all chained passes are planned" );
+
+	logger.info( "plan_frame: %u passes: %.3fus per frame (average over %u frames)",
+	             NUM_PASSES,
+	             std::chrono::duration<double, std::micro>( t_end - t_start ).count() / NUM_ITERATIONS,
+	             NUM_ITERATIONS );
+}
+
+// ----------------------------------------------------------------------
+
+static void app_initialize(){};
+
+// ----------------------------------------------------------------------
+
+static void app_terminate(){};
+
+// ----------------------------------------------------------------------
+
+static test_frame_plan_app_o* test_frame_plan_app_create() {
+	auto app     = new ( test_frame_plan_app_o );
+	app->backend = le_backend_vk::vk_backend_i.create();
+	return app;
+}
+
+// ----------------------------------------------------------------------
+
+static bool test_frame_plan_app_update( test_frame_plan_app_o* self ) {
+
+	test_plan_frame( self );
+	benchmark_plan_frame( self );
+
+	if ( self->num_failed_checks == 0 ) {
+		logger.info( "All tests passed." );
+	} else {
+		logger.error( "%u checks failed.", self->num_failed_checks );
+	}
+
+	return false; // tests run only once
+}
+
+// ----------------------------------------------------------------------
+
+static uint32_t test_frame_plan_app_get_num_failed_checks( test_frame_plan_app_o* self ) {
+	return self->num_failed_checks;
+}
+
+// ----------------------------------------------------------------------
+
+static void test_frame_plan_app_destroy( test_frame_plan_app_o* self ) {
+	le_backend_vk::vk_backend_i.destroy( self->backend );
+	delete ( self );
+}
+
+// ----------------------------------------------------------------------
+
+LE_MODULE_REGISTER_IMPL( test_frame_plan_app, api ) {
+
+	auto  test_frame_plan_app_api_i = static_cast<test_frame_plan_app_api*>( api );
+	auto& test_frame_plan_app_i     = test_frame_plan_app_api_i->test_frame_plan_app_i;
+
+	test_frame_plan_app_i.initialize = app_initialize;
+	test_frame_plan_app_i.terminate  = app_terminate;
+
+	test_frame_plan_app_i.create  = test_frame_plan_app_create;
+	test_frame_plan_app_i.destroy = test_frame_plan_app_destroy;
+	test_frame_plan_app_i.update  = test_frame_plan_app_update;
+
+	test_frame_plan_app_i.get_num_failed_checks = test_frame_plan_app_get_num_failed_checks;
+}
@@ -0,0 +1,68 @@
+#ifndef GUARD_test_frame_plan_app_H
+#define GUARD_test_frame_plan_app_H
+
+#include "le_core.h"
+
+// depends on le_backend_vk. le_backend_vk must be loaded before this class is used.
+
+struct test_frame_plan_app_o;
+
+// clang-format off
+struct test_frame_plan_app_api {
+
+	struct test_frame_plan_app_interface_t {
+		test_frame_plan_app_o * ( *create               )();
+		void         ( *destroy                  )( test_frame_plan_app_o *self );
+		bool         ( *update                   )( test_frame_plan_app_o *self );
+		uint32_t     ( *get_num_failed_checks    )( test_frame_plan_app_o *self );
+		void         ( *initialize               )(); // static methods
+		void         ( *terminate                )(); // static methods
+	};
+
+	test_frame_plan_app_interface_t test_frame_plan_app_i;
+};
+// clang-format on
+
+LE_MODULE( test_frame_plan_app );
+LE_MODULE_LOAD_DEFAULT( test_frame_plan_app );
+
+#ifdef __cplusplus
+
+namespace test_frame_plan_app {
+static const auto& api            = test_frame_plan_app_api_i;
+static const auto& test_frame_plan_app_i = api -> test_frame_plan_app_i;
+} // namespace test_frame_plan_app
+
+class TestFramePlanApp : NoCopy, NoMove {
+
+	test_frame_plan_app_o* self;
+
+  public:
+	TestFramePlanApp()
+	    : self( test_frame_plan_app::test_frame_plan_app_i.create() ) {
+	}
+
+	bool update() {
+		return test_frame_plan_app::test_frame_plan_app_i.update( self );
+	}
+
+	uint32_t getNumFailedChecks() {
+		return test_frame_plan_app::test_frame_plan_app_i.get_num_failed_checks( self );
+	}
+
+	~TestFramePlanApp() {
+		test_frame_plan_app::test_frame_plan_app_i.destroy( self );
+	}
+
+	static void initialize() {
+		test_frame_plan_app::test_frame_plan_app_i.initialize();
+	}
+
+	static void terminate() {
+		test_frame_plan_app::test_frame_plan_app_i.terminate();
+	}
+};
+
+#endif
+
+#endif
@@ -0,0 +1,38 @@
+#include "test_hash_app/test_hash_app.h"
+
+// ----------------------------------------------------------------------
+
+int main( int argc, char const* argv[] ) {
+
+	TestHashApp::initialize();
+
+	uint32_t num_failed_checks = 0;
+
+	{
+		// We instantiate TestHashApp in its own scope - so that
+		// it will be destroyed before TestHashApp::terminate
+		// is called.
+
+		TestHashApp TestHashApp{};
+
+		for ( ;; ) {
+
+#ifdef PLUGINS_DYNAMIC
+			le_core_poll_for_module_reloads();
+#endif
+			auto result = TestHashApp.update();
+
+			if ( !result ) {
+				break;
+			}
+		}
+
+		num_failed_checks = TestHashApp.getNumFailedChecks();
+	}
+
+	// Must only be called once last TestHashApp is destroyed
+	TestHashApp::terminate();
+
+	// Non-zero exit code tells CI that tests have failed.
+	return num_failed_checks == 0 ? 0 : 1;
+}
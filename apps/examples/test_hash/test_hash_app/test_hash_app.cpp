@@ -0,0 +1,231 @@
+#include "test_hash_app.h"
+#include "le_log.h"
+#include "le_hash_util.h"
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <string>
+#include <vector>
+
+// Tests hash_64_word against the key sets that it actually gets used for
+// (settings names and resource names, as found in this repository), and
+// benchmarks it against hash_64_fnv1a.
+
+struct test_hash_app_o {
+	uint32_t num_failed_checks = 0;
+};
+
+typedef test_hash_app_o app_o;
+
+static auto logger = LeLog( "test_hash_app" );
+
+// Settings names - these are looked up via hash_64_word( name ) in the settings store.
+static constexpr char const* SETTINGS_KEYS[] = {
+    "LE_SETTING_BACKEND_ALIAS_TRANSIENT_RESOURCES",
+    "LE_SETTING_BACKEND_CACHE_DESCRIPTOR_SETS",
+    "LE_SETTING_BACKEND_CACHE_VK_OBJECTS",
+    "LE_SETTING_BACKEND_OBJECT_CACHE_MAX_UNUSED_FRAMES",
+    "LE_SETTING_BACKEND_SHOULD_CHECK_ARGUMENT_STATE",
+    "LE_SETTING_BACKEND_TRANSLATE_PASSES_IN_PARALLEL",
+    "LE_SETTING_ENCODER_DEDUPLICATE_ARGUMENT_DATA",
+    "LE_SETTING_ENCODER_ELIMINATE_REDUNDANT_STATE",
+    "LE_SETTING_ENCODER_MERGE_INSTANCED_DRAWS",
+    "LE_SETTING_ENCODER_SORT_DRAWS",
+    "LE_SETTING_GENERATE_QUEUE_SYNC_DOT_FILES",
+    "LE_SETTING_PIPELINE_CACHE_FILE_PATH",
+    "LE_SETTING_PIPELINE_CACHE_SAVE_INTERVAL_FRAMES",
+    "LE_SETTING_PIPELINE_COMPILE_IN_BACKGROUND",
+    "LE_SETTING_RENDERER_CAPTURE_FRAMES",
+    "LE_SETTING_RENDERGRAPH_GENERATE_DOT_FILES",
+    "LE_SETTING_RENDERGRAPH_PRINT_EXTENDED_DEBUG_MESSAGES",
+    "LE_SETTING_RENDERGRAPH_RECORD_PASSES_IN_PARALLEL",
+    "LE_SETTING_RENDERGRAPH_USE_BUILD_CACHE",
+    "LE_SETTING_RETAINED_BUFFER_PAGE_SIZE",
+    "LE_SETTING_SHADER_CACHE_DIRECTORY",
+    "LE_SETTING_SHOULD_USE_VALIDATION_LAYERS",
+    "LE_SETTING_SHOULD_USE_VIDEO_STATUS_QUERIES",
+};
+
+// Resource and texture names - texture handles are looked up via hash_64_word( name ).
+static constexpr char const* RESOURCE_KEYS[] = {
+    "DEPTH_BUFFER", "DEPTH_BUFFER_0", "DEPTH_BUFFER_1", "ImgEarthClouds", "ImgEarthNormals",
+    "ImguiDefaultFontImage", "WORLD_INDICES", "WORLD_VERTICES", "bloom_blur_h_0", "bloom_blur_h_1",
+    "bloom_blur_h_2", "bloom_blur_h_3", "bloom_blur_h_4", "bloom_blur_v_0", "bloom_blur_v_1",
+    "bloom_blur_v_2", "bloom_blur_v_3", "bloom_blur_v_4", "cube_image", "depth_buffer",
+    "heightmap_image", "imgEarthAlbedo", "imgEarthNight", "index_buffer", "le_rtx_scratch_buffer_handle",
+    "lut_image", "lut_image_texture", "render_target_image_1", "sort_data", "source_image",
+    "src_image_texture", "src_texture_handle_1", "test_image", "tex_unit_0", "uv_buffer",
+    "vertex_buffer",
+};
+
+// Hashes all keys at compile time - we use this to check that compile-time and
+// runtime variants agree.
+template <size_t N>
+consteval std::array<uint64_t, N> hash_keys_const( char const* const ( &keys )[ N ] ) {
+	std::array<uint64_t, N> result{};
+	for ( size_t i = 0; i != N; i++ ) {
+		result[ i ] = hash_64_word_const( keys[ i ] );
+	}
+	return result;
+}
+
+// ----------------------------------------------------------------------
+// Returns number of keys for which compile-time and runtime hashes differ.
+template <size_t N>
+static size_t count_const_mismatches( char const* const ( &keys )[ N ], std::array<uint64_t, N> const& const_hashes ) {
+	size_t num_mismatches = 0;
+	for ( size_t i = 0; i != N; i++ ) {
+		if ( hash_64_word( keys[ i ] ) != const_hashes[ i ] ) {
+			logger.error( "hash_64_word_const differs from hash_64_word for key: '%s'", keys[ i ] );
+			num_mismatches++;
+		}
+	}
+	return num_mismatches;
+}
+
+// ----------------------------------------------------------------------
+// Returns number of hash collisions among `keys` - keys must be unique.
+static size_t count_collisions( std::vector<std::string> const& keys, uint64_t ( *hash_fun )( char const* ) ) {
+	std::vector<uint64_t> hashes;
+	hashes.reserve( keys.size() );
+	for ( auto const& k : keys ) {
+		hashes.push_back( hash_fun( k.c_str() ) );
+	}
+	std::sort( hashes.begin(), hashes.end() );
+	return size_t( hashes.end() - std::unique( hashes.begin(), hashes.end() ) );
+}
+
+// ----------------------------------------------------------------------
+// Returns the largest number of keys that end up in the same bucket if we use
+// the lowest bits of their hash to index a power-of-two sized table.
+static size_t get_worst_bucket_occupancy( std::vector<std::string> const& keys, uint64_t ( *hash_fun )( char const* ), size_t num_buckets ) {
+	std::vector<size_t> buckets( num_buckets, 0 );
+	for ( auto const& k : keys ) {
+		buckets[ hash_fun( k.c_str() ) & ( num_buckets - 1 ) ]++;
+	}
+	return *std::max_element( buckets.begin(), buckets.end() );
+}
+
+// ----------------------------------------------------------------------
+// Returns elapsed time in milliseconds for hashing all `keys` using `hash_fun`.
+static double benchmark_hash( std::vector<std::string> const& keys, uint64_t ( *hash_fun )( char const* ), uint64_t* checksum ) {
+	auto     t_start = std::chrono::steady_clock::now();
+	uint64_t sum     = 0;
+	for ( auto const& k : keys ) {
+		sum += hash_fun( k.c_str() );
+	}
+	auto t_end = std::chrono::steady_clock::now();
+	*checksum  = sum; // so that the loop does not get optimised away
+	return std::chrono::duration<double, std::milli>( t_end - t_start ).count();
+}
+
+static uint64_t hash_fun_word( char const* str ) {
+	return hash_64_word( str );
+}
+
+static uint64_t hash_fun_fnv1a( char const* str ) {
+	return hash_64_fnv1a( str );
+}
+
+// ----------------------------------------------------------------------
+
+static void app_initialize(){};
+
+// ----------------------------------------------------------------------
+
+static void app_terminate(){};
+
+// ----------------------------------------------------------------------
+
+static test_hash_app_o* test_hash_app_create() {
+	auto app = new ( test_hash_app_o );
+	return app;
+}
+
+// ----------------------------------------------------------------------
+
+static bool test_hash_app_update( test_hash_app_o* self ) {
+
+	constexpr static auto settings_hashes = hash_keys_const( SETTINGS_KEYS );
+	constexpr static auto resource_hashes = hash_keys_const( RESOURCE_KEYS );
+
+	if ( count_const_mismatches( SETTINGS_KEYS, settings_hashes ) + count_const_mismatches( RESOURCE_KEYS, resource_hashes ) ) {
+		self->num_failed_checks++;
+	}
+
+	// Collision test over the real key sets - settings and resource names
+	// live in separate tables, but we test them together as this is the
+	// stricter test.
+	std::vector<std::string> real_keys;
+	real_keys.insert( real_keys.end(), std::begin( SETTINGS_KEYS ), std::end( SETTINGS_KEYS ) );
+	real_keys.insert( real_keys.end(), std::begin( RESOURCE_KEYS ), std::end( RESOURCE_KEYS ) );
+
+	if ( size_t num_collisions = count_collisions( real_keys, hash_fun_word ) ) {
+		logger.error( "hash_64_word: %zu collisions over %zu settings and resource names", num_collisions, real_keys.size() );
+		self->num_failed_checks++;
+	}
+
+	// Generate resource-name-style keys for the collision test at scale, and for the benchmark.
+	constexpr size_t         NUM_GENERATED_KEYS = 1 << 20;
+	std::vector<std::string> generated_keys;
+	generated_keys.reserve( NUM_GENERATED_KEYS );
+	for ( size_t i = 0; i != NUM_GENERATED_KEYS; i++ ) {
+		generated_keys.emplace_back( std::string( RESOURCE_KEYS[ i % std::size( RESOURCE_KEYS ) ] ) + "_" + std::to_string( i ) );
+	}
+
+	if ( size_t num_collisions = count_collisions( generated_keys, hash_fun_word ) ) {
+		logger.error( "hash_64_word: %zu collisions over %zu generated resource names", num_collisions, generated_keys.size() );
+		self->num_failed_checks++;
+	}
+
+	logger.info( "worst bucket occupancy (%zu keys, 4096 buckets): hash_64_word: %zu, hash_64_fnv1a: %zu",
+	             generated_keys.size(),
+	             get_worst_bucket_occupancy( generated_keys, hash_fun_word, 4096 ),
+	             get_worst_bucket_occupancy( generated_keys, hash_fun_fnv1a, 4096 ) );
+
+	uint64_t checksum_word  = 0;
+	uint64_t checksum_fnv1a = 0;
+	double   ms_word        = benchmark_hash( generated_keys, hash_fun_word, &checksum_word );
+	double   ms_fnv1a       = benchmark_hash( generated_keys, hash_fun_fnv1a, &checksum_fnv1a );
+
+	logger.info( "hashing %zu keys: hash_64_word: %.3fms, hash_64_fnv1a: %.3fms (checksums: %llx, %llx)",
+	             generated_keys.size(), ms_word, ms_fnv1a, ( unsigned long long )checksum_word, ( unsigned long long )checksum_fnv1a );
+
+	if ( self->num_failed_checks == 0 ) {
+		logger.info( "All tests passed." );
+	} else {
+		logger.error( "%u checks failed.", self->num_failed_checks );
+	}
+
+	return false; // tests run only once
+}
+
+// ----------------------------------------------------------------------
+
+static uint32_t test_hash_app_get_num_failed_checks( test_hash_app_o* self ) {
+	return self->num_failed_checks;
+}
+
+// ----------------------------------------------------------------------
+
+static void test_hash_app_destroy( test_hash_app_o* self ) {
+	delete ( self );
+}
+
+// ----------------------------------------------------------------------
+
+LE_MODULE_REGISTER_IMPL( test_hash_app, api ) {
+
+	auto  test_hash_app_api_i = static_cast<test_hash_app_api*>( api );
+	auto& test_hash_app_i     = test_hash_app_api_i->test_hash_app_i;
+
+	test_hash_app_i.initialize = app_initialize;
+	test_hash_app_i.terminate  = app_terminate;
+
+	test_hash_app_i.create  = test_hash_app_create;
+	test_hash_app_i.destroy = test_hash_app_destroy;
+	test_hash_app_i.update  = test_hash_app_update;
+
+	test_hash_app_i.get_num_failed_checks = test_hash_app_get_num_failed_checks;
+}
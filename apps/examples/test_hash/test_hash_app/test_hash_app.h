@@ -0,0 +1,67 @@
+#ifndef GUARD_test_hash_app_H
+#define GUARD_test_hash_app_H
+
+#include "le_core.h"
+
+
+struct test_hash_app_o;
+
+// clang-format off
+struct test_hash_app_api {
+
+	struct test_hash_app_interface_t {
+		test_hash_app_o * ( *create               )();
+		void         ( *destroy                  )( test_hash_app_o *self );
+		bool         ( *update                   )( test_hash_app_o *self );
+		uint32_t     ( *get_num_failed_checks    )( test_hash_app_o *self );
+		void         ( *initialize               )(); // static methods
+		void         ( *terminate                )(); // static methods
+	};
+
+	test_hash_app_interface_t test_hash_app_i;
+};
+// clang-format on
+
+LE_MODULE( test_hash_app );
+LE_MODULE_LOAD_DEFAULT( test_hash_app );
+
+#ifdef __cplusplus
+
+namespace test_hash_app {
+static const auto& api            = test_hash_app_api_i;
+static const auto& test_hash_app_i = api -> test_hash_app_i;
+} // namespace test_hash_app
+
+class TestHashApp : NoCopy, NoMove {
+
+	test_hash_app_o* self;
+
+  public:
+	TestHashApp()
+	    : self( test_hash_app::test_hash_app_i.create() ) {
+	}
+
+	bool update() {
+		return test_hash_app::test_hash_app_i.update( self );
+	}
+
+	uint32_t getNumFailedChecks() {
+		return test_hash_app::test_hash_app_i.get_num_failed_checks( self );
+	}
+
+	~TestHashApp() {
+		test_hash_app::test_hash_app_i.destroy( self );
+	}
+
+	static void initialize() {
+		test_hash_app::test_hash_app_i.initialize();
+	}
+
+	static void terminate() {
+		test_hash_app::test_hash_app_i.terminate();
+	}
+};
+
+#endif
+
+#endif
@@ -0,0 +1,38 @@
+#include "test_transient_memory_plan_app/test_transient_memory_plan_app.h"
+
+// ----------------------------------------------------------------------
+
+int main( int argc, char const* argv[] ) {
+
+	TestTransientMemoryPlanApp::initialize();
+
+	uint32_t num_failed_checks = 0;
+
+	{
+		// We instantiate TestTransientMemoryPlanApp in its own scope - so that
+		// it will be destroyed before TestTransientMemoryPlanApp::terminate
+		// is called.
+
+		TestTransientMemoryPlanApp TestTransientMemoryPlanApp{};
+
+		for ( ;; ) {
+
+#ifdef PLUGINS_DYNAMIC
+			le_core_poll_for_module_reloads();
+#endif
+			auto result = TestTransientMemoryPlanApp.update();
+
+			if ( !result ) {
+				break;
+			}
+		}
+
+		num_failed_checks = TestTransientMemoryPlanApp.getNumFailedChecks();
+	}
+
+	// Must only be called once last TestTransientMemoryPlanApp is destroyed
+	TestTransientMemoryPlanApp::terminate();
+
+	// Non-zero exit code tells CI that tests have failed.
+	return num_failed_checks == 0 ? 0 : 1;
+}
@@ -0,0 +1,226 @@
+#include "test_transient_memory_plan_app.h"
+#include "le_log.h"
+#include "private/le_backend_vk/le_transient_memory_plan.h"
+
+#include <random>
+
+// Tests the transient memory planner, which decides which transient
+// resources may alias each other's memory. The planner does not depend on
+// Vulkan, so we can test it without a device.
+
+struct test_transient_memory_plan_app_o {
+	uint32_t num_failed_checks = 0;
+};
+
+typedef test_transient_memory_plan_app_o app_o;
+
+static auto logger = LeLog( "test_transient_memory_plan_app" );
+
+static constexpr uint64_t MB = 1024 * 1024;
+
+// ----------------------------------------------------------------------
+
+static void check( app_o* self, bool condition, char const* test_name ) {
+	if ( condition ) {
+		logger.info( "[  OK  ] %s", test_name );
+	} else {
+		logger.error( "[ FAIL ] %s", test_name );
+		self->num_failed_checks++;
+	}
+}
+
+// ----------------------------------------------------------------------
+// Returns lifetime for a resource which may be placed in any memory type.
+static le_transient_resource_lifetime_t make_lifetime( uint32_t first_use, uint32_t last_use, uint64_t size, uint64_t alignment = 1, uint64_t group = 0 ) {
+	return { first_use, last_use, size, alignment, ~0u, group };
+}
+
+// ----------------------------------------------------------------------
+// Ping-pong chain: each pass reads the previous pass' target, and writes its own -
+// only two targets are ever alive at the same time, so two targets' worth of
+// memory must be enough.
+static void test_ping_pong_chain( app_o* self ) {
+
+	std::vector<le_transient_resource_lifetime_t> resources;
+	for ( uint32_t i = 0; i != 12; i++ ) {
+		resources.push_back( make_lifetime( i, i + 1, 8 * MB ) );
+	}
+
+	le_transient_memory_plan_t plan;
+	le_transient_memory_plan_build( &plan, resources.data(), resources.size() );
+
+	check( self, le_transient_memory_plan_is_valid( plan, resources.data(), resources.size() ), "ping-pong chain: plan is valid" );
+	check( self, le_transient_memory_plan_get_total_size( plan ) == 16 * MB, "ping-pong chain: needs memory for two targets" );
+}
+
+// ----------------------------------------------------------------------
+// Resources which are all alive at the same time must not share memory.
+static void test_overlapping_lifetimes( app_o* self ) {
+
+	le_transient_resource_lifetime_t resources[] = {
+	    make_lifetime( 0, 3, 4 * MB ),
+	    make_lifetime( 1, 2, 2 * MB ),
+	    make_lifetime( 2, 5, 1 * MB ),
+	};
+
+	le_transient_memory_plan_t plan;
+	le_transient_memory_plan_build( &plan, resources, std::size( resources ) );
+
+	check( self, le_transient_memory_plan_is_valid( plan, resources, std::size( resources ) ), "overlapping lifetimes: plan is valid" );
+	check( self, le_transient_memory_plan_get_total_size( plan ) == 7 * MB, "overlapping lifetimes: no memory is shared" );
+}
+
+// ----------------------------------------------------------------------
+// Resources from different groups (queue submissions), or with incompatible
+// memory types must never alias, even if their lifetimes are disjoint.
+static void test_groups_and_memory_types( app_o* self ) {
+
+	le_transient_resource_lifetime_t resources[] = {
+	    make_lifetime( 0, 0, 1 * MB, 1, 0 ),
+	    make_lifetime( 1, 1, 1 * MB, 1, 1 ), // different group
+	    { 2, 2, 1 * MB, 1, 0x1, 0 },         // memory type incompatible with next resource
+	    { 3, 3, 1 * MB, 1, 0x2, 0 },
+	};
+
+	le_transient_memory_plan_t plan;
+	le_transient_memory_plan_build( &plan, resources, std::size( resources ) );
+
+	check( self, le_transient_memory_plan_is_valid( plan, resources, std::size( resources ) ), "groups and memory types: plan is valid" );
+	check( self, plan.placements[ 0 ].block != plan.placements[ 1 ].block, "groups and memory types: groups don't share blocks" );
+	check( self, plan.placements[ 2 ].block != plan.placements[ 3 ].block, "groups and memory types: incompatible memory types don't share blocks" );
+}
+
+// ----------------------------------------------------------------------
+// A resource which gets placed next to another resource must be placed at
+// an offset which respects its alignment.
+static void test_alignment( app_o* self ) {
+
+	le_transient_resource_lifetime_t resources[] = {
+	    make_lifetime( 0, 0, 1000 ),
+	    make_lifetime( 1, 2, 300 ),
+	    make_lifetime( 2, 2, 300, 256 ),
+	};
+
+	le_transient_memory_plan_t plan;
+	le_transient_memory_plan_build( &plan, resources, std::size( resources ) );
+
+	check( self, le_transient_memory_plan_is_valid( plan, resources, std::size( resources ) ), "alignment: plan is valid" );
+	check( self, plan.blocks.size() == 1, "alignment: all resources share one block" );
+	check( self, plan.placements[ 2 ].offset == 512, "alignment: offset is rounded up to alignment" );
+}
+
+// ----------------------------------------------------------------------
+// A plan built for one frame must be rejected for a frame in which lifetimes
+// changed so that aliased resources would be alive at the same time.
+static void test_plan_invalidation( app_o* self ) {
+
+	std::vector<le_transient_resource_lifetime_t> resources = {
+	    make_lifetime( 0, 1, 8 * MB ),
+	    make_lifetime( 2, 3, 8 * MB ),
+	};
+
+	le_transient_memory_plan_t plan;
+	le_transient_memory_plan_build( &plan, resources.data(), resources.size() );
+
+	check( self, plan.blocks.size() == 1 && plan.placements[ 0 ].offset == plan.placements[ 1 ].offset, "invalidation: disjoint resources alias" );
+
+	resources[ 0 ].last_use = 2; // lifetimes now overlap
+	check( self, !le_transient_memory_plan_is_valid( plan, resources.data(), resources.size() ), "invalidation: plan is rejected once lifetimes overlap" );
+
+	resources.push_back( make_lifetime( 0, 0, 1 * MB ) );
+	check( self, !le_transient_memory_plan_is_valid( plan, resources.data(), resources.size() ), "invalidation: plan is rejected if number of resources changes" );
+}
+
+// ----------------------------------------------------------------------
+// Any plan which we build must be valid for the resources it was built for.
+static void test_random_plans_are_valid( app_o* self ) {
+
+	std::mt19937 rng( 0x5eed ); // fixed seed, so that failures can be reproduced
+
+	bool all_valid = true;
+
+	for ( int iteration = 0; iteration != 1000; iteration++ ) {
+
+		std::vector<le_transient_resource_lifetime_t> resources( 1 + rng() % 32 );
+
+		for ( auto& r : resources ) {
+			r.first_use        = uint32_t( rng() % 16 );
+			r.last_use         = uint32_t( r.first_use + rng() % 4 );
+			r.size             = 1 + rng() % 4096;
+			r.alignment        = uint64_t( 1 ) << ( rng() % 9 );
+			r.memory_type_bits = uint32_t( 1 + rng() % 3 );
+			r.group            = rng() % 2;
+		}
+
+		le_transient_memory_plan_t plan;
+		le_transient_memory_plan_build( &plan, resources.data(), resources.size() );
+
+		all_valid &= le_transient_memory_plan_is_valid( plan, resources.data(), resources.size() );
+	}
+
+	check( self, all_valid, "random plans are valid" );
+}
+
+// ----------------------------------------------------------------------
+
+static void app_initialize(){};
+
+// ----------------------------------------------------------------------
+
+static void app_terminate(){};
+
+// ----------------------------------------------------------------------
+
+static test_transient_memory_plan_app_o* test_transient_memory_plan_app_create() {
+	auto app = new ( test_transient_memory_plan_app_o );
+	return app;
+}
+
+// ----------------------------------------------------------------------
+
+static bool test_transient_memory_plan_app_update( test_transient_memory_plan_app_o* self ) {
+
+	test_ping_pong_chain( self );
+	test_overlapping_lifetimes( self );
+	test_groups_and_memory_types( self );
+	test_alignment( self );
+	test_plan_invalidation( self );
+	test_random_plans_are_valid( self );
+
+	if ( self->num_failed_checks == 0 ) {
+		logger.info( "All tests passed." );
+	} else {
+		logger.error( "%u checks failed.", self->num_failed_checks );
+	}
+
+	return false; // tests run only once
+}
+
+// ----------------------------------------------------------------------
+
+static uint32_t test_transient_memory_plan_app_get_num_failed_checks( test_transient_memory_plan_app_o* self ) {
+	return self->num_failed_checks;
+}
+
+// ----------------------------------------------------------------------
+
+static void test_transient_memory_plan_app_destroy( test_transient_memory_plan_app_o* self ) {
+	delete ( self );
+}
+
+// ----------------------------------------------------------------------
+
+LE_MODULE_REGISTER_IMPL( test_transient_memory_plan_app, api ) {
+
+	auto  test_transient_memory_plan_app_api_i = static_cast<test_transient_memory_plan_app_api*>( api );
+	auto& test_transient_memory_plan_app_i     = test_transient_memory_plan_app_api_i->test_transient_memory_plan_app_i;
+
+	test_transient_memory_plan_app_i.initialize = app_initialize;
+	test_transient_memory_plan_app_i.terminate  = app_terminate;
+
+	test_transient_memory_plan_app_i.create  = test_transient_memory_plan_app_create;
+	test_transient_memory_plan_app_i.destroy = test_transient_memory_plan_app_destroy;
+	test_transient_memory_plan_app_i.update  = test_transient_memory_plan_app_update;
+
+	test_transient_memory_plan_app_i.get_num_failed_checks = test_transient_memory_plan_app_get_num_failed_checks;
+}
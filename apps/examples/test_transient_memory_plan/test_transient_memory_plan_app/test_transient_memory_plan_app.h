@@ -0,0 +1,67 @@
+#ifndef GUARD_test_transient_memory_plan_app_H
+#define GUARD_test_transient_memory_plan_app_H
+
+#include "le_core.h"
+
+
+struct test_transient_memory_plan_app_o;
+
+// clang-format off
+struct test_transient_memory_plan_app_api {
+
+	struct test_transient_memory_plan_app_interface_t {
+		test_transient_memory_plan_app_o * ( *create               )();
+		void         ( *destroy                  )( test_transient_memory_plan_app_o *self );
+		bool         ( *update                   )( test_transient_memory_plan_app_o *self );
+		uint32_t     ( *get_num_failed_checks    )( test_transient_memory_plan_app_o *self );
+		void         ( *initialize               )(); // static methods
+		void         ( *terminate                )(); // static methods
+	};
+
+	test_transient_memory_plan_app_interface_t test_transient_memory_plan_app_i;
+};
+// clang-format on
+
+LE_MODULE( test_transient_memory_plan_app );
+LE_MODULE_LOAD_DEFAULT( test_transient_memory_plan_app );
+
+#ifdef __cplusplus
+
+namespace test_transient_memory_plan_app {
+static const auto& api            = test_transient_memory_plan_app_api_i;
+static const auto& test_transient_memory_plan_app_i = api -> test_transient_memory_plan_app_i;
+} // namespace test_transient_memory_plan_app
+
+class TestTransientMemoryPlanApp : NoCopy, NoMove {
+
+	test_transient_memory_plan_app_o* self;
+
+  public:
+	TestTransientMemoryPlanApp()
+	    : self( test_transient_memory_plan_app::test_transient_memory_plan_app_i.create() ) {
+	}
+
+	bool update() {
+		return test_transient_memory_plan_app::test_transient_memory_plan_app_i.update( self );
+	}
+
+	uint32_t getNumFailedChecks() {
+		return test_transient_memory_plan_app::test_transient_memory_plan_app_i.get_num_failed_checks( self );
+	}
+
+	~TestTransientMemoryPlanApp() {
+		test_transient_memory_plan_app::test_transient_memory_plan_app_i.destroy( self );
+	}
+
+	static void initialize() {
+		test_transient_memory_plan_app::test_transient_memory_plan_app_i.initialize();
+	}
+
+	static void terminate() {
+		test_transient_memory_plan_app::test_transient_memory_plan_app_i.terminate();
+	}
+};
+
+#endif
+
+#endif
@@ -180,6 +180,7 @@ struct BackendRenderPass {
 	uint32_t                height;
 	le::SampleCountFlagBits sampleCount;    // We store this with renderpass, as sampleCount must be same for all color/depth attachments
 	uint64_t                renderpassHash; ///< spooky hash of elements that could influence renderpass compatibility
+	uint64_t                renderpassKey;  ///< spooky hash of all elements of renderpass create info - used to look up cached renderpass
 
 	std::vector<le_resource_handle> resources; // resources used with this renderpass
 
@@ -2,6 +2,9 @@
 #include "le_backend_vk.h"
 #include "le_log.h"
 #include "private/le_backend_vk/le_command_stream_t.h"
+#include "private/le_backend_vk/le_transient_memory_plan.h"
+#include "private/le_backend_vk/le_barrier_batch.h"
+#include "private/le_backend_vk/le_backend_frame_plan.h"
 #include "util/vk_mem_alloc/vk_mem_alloc.h" // for allocation
 #include "le_backend_types_internal.h"      // includes vulkan.hpp
 #include "le_swapchain_vk.h"
@@ -11,6 +14,7 @@
 #include "3rdparty/src/spooky/SpookyV2.h" // for hashing renderpass gestalt
 
 #include "le_tracy.h"
+#include "le_jobs.h"
 
 #include <bitset>
 #include <cassert>
@@ -26,6 +30,7 @@
 #include <set>
 #include <atomic>
 #include <mutex>
+#include <shared_mutex>
 #include <memory>
 #include <cstring> // for memcpy
 #include <array>
@@ -538,12 +543,14 @@ struct BackendFrameData {
 	};
 
 	struct PerQueueSubmissionData {
-		uint32_t              queue_idx;               // backend device queue index
-		VkQueueFlags          queue_flags;             // queue flags for this submission
-		std::vector<uint32_t> pass_indices;            // which passes from the current frame to add to this submission, count tells us about number of command buffers that need to be alloated
-		CommandPool*          command_pool;            // non-owning. which command pool from the list of available command pools
-		std::string           debug_root_passes_names; // name of root passes
-	};                                                 //
+		le::RootPassesField          key;                     // submission key - passes with matching affinity belong to this submission
+		uint32_t                     queue_idx;               // backend device queue index
+		VkQueueFlags                 queue_flags;             // queue flags for this submission
+		std::vector<uint32_t>        pass_indices;            // which passes from the current frame to add to this submission, count tells us about number of command buffers that need to be alloated
+		CommandPool*                 command_pool;            // non-owning. which command pool from the list of available command pools - if each pass has a pool of its own, this is the last pool
+		std::vector<VkCommandBuffer> command_buffers;         // one per pass, in order of pass_indices, which is the order of submission
+		std::string                  debug_root_passes_names; // name of root passes
+	};                                                        //
 	std::vector<PerQueueSubmissionData> queue_submission_data;
 	std::vector<CommandPool*>           available_command_pools; // Owning. reset on frame recycle, delete all objects on BackendFrameData::destroy
 
@@ -575,6 +582,8 @@ struct BackendFrameData {
 	/// \brief vk resources retained and destroyed with BackendFrameData.
 	/// These resources (such as samplers, imageviews, framebuffers) are transient,
 	/// and lifetime of these resources is tied to the frame fence.
+	/// Note that samplers, imageviews, framebuffers and renderpasses only end up here
+	/// if the backend's object cache has been disabled.
 	std::forward_list<AbstractPhysicalResource> ownedResources;
 
 	/// \brief if user provides explicit resource info, we collect this here, so that we can make sure
@@ -599,6 +608,8 @@ struct BackendFrameData {
 	ResourceMap_T availableResources; // resources this frame may use - each entry represents an association between a le_resource_handle and a vk resource
 	ResourceMap_T binnedResources;    // resources to delete when this frame comes round to clear()
 
+	std::vector<VmaAllocation> binnedMemory; // memory to free when this frame comes round to clear() - used for memory which backs aliased transient resources
+
 	/*
 
 	  Each Frame has one allocation pool from which all allocations for scratch buffers are drawn.
@@ -617,11 +628,70 @@ struct BackendFrameData {
 
 	le_staging_allocator_o* stagingAllocator; // owning: allocator for large objects to GPU memory
 
-	std::vector<le_command_stream_t*> command_streams; // owning; these must be destroyed when frame gets destroyed.
+	std::vector<le_command_stream_t*> command_streams;                // owning; these must be destroyed when frame gets destroyed.
+	size_t                            num_command_streams_in_use = 0; // number of command streams handed out for current frame, reset on frame clear
+	std::vector<le_command_stream_t*> scratch_command_streams;        // owning; one per pass, where encoders hold back commands while recording sorted draws
 
 	bool must_create_queues_dot_graph = false;
 };
 
+// Memory which is shared by aliased transient resources - see le_transient_memory_plan.h
+//
+// Aliased resources are stored in allocated_resources as any other resource, but they don't own
+// their memory (their allocation is nullptr) - memory is owned by `blocks` instead.
+struct TransientMemoryState {
+	std::vector<le_resource_handle>               resources;    // aliased resources, sorted, in the same order as lifetimes
+	std::vector<ResourceCreateInfo>               create_infos; // per resource: info which was used to create resource
+	std::vector<le_transient_resource_lifetime_t> lifetimes;    // per resource: lifetime and memory requirements at the time the plan was built
+	le_transient_memory_plan_t                    plan;         //
+	std::vector<VmaAllocation>                    blocks;       // owning: one allocation per block in plan
+};
+
+// Vulkan objects which are derived from frame data, and which would otherwise have to be
+// re-created every frame: renderpasses, framebuffers, image views, and samplers.
+//
+// Objects are keyed by a hash over the contents of their create info. An object gets
+// destroyed once it has not been used for a number of frames - but never before the last
+// frame which used it has been cleared.
+//
+// Image handles may be recycled once an image has been destroyed - we therefore mix
+// `image_generation` into the keys of objects which refer to images, and increment
+// `image_generation` whenever the backend creates an image. Objects which refer to a
+// previous generation will not be found anymore, and get destroyed once they age out.
+struct VkObjectCache {
+	struct Entry {
+		AbstractPhysicalResource object;
+		std::vector<VkImageView> owned_image_views;   // framebuffers only: attachment image views, destroyed together with framebuffer
+		uint64_t                 last_used_frame = 0; // frame number of most recent frame which used this object
+	};
+	std::unordered_map<uint64_t, Entry> entries;              // key: hash over create info
+	std::mutex                          mtx;                  // protects entries
+	std::atomic<uint64_t>               image_generation = 0; // incremented whenever backend creates an image
+};
+
+// Descriptor sets which may be re-used within and across frames - see `updateArguments`.
+//
+// Sets are keyed by a hash over their set layout and the complete list of descriptor writes,
+// and allocated from persistent pools. A set gets freed once it has not been used for a number
+// of frames - but never before the last frame which used it has been cleared.
+//
+// A cached set refers to buffers, images, image views, samplers, and acceleration structures
+// via their handles. Since handles may be recycled once an object has been destroyed, we mix
+// `resource_generation` into every key, and increment `resource_generation` whenever the backend
+// creates a buffer or image, or destroys an image view or sampler. Sets which refer to a previous
+// generation will not be found anymore, and get freed once they age out.
+struct DescriptorSetCache {
+	struct Entry {
+		VkDescriptorSet       set             = nullptr;
+		VkDescriptorPool      pool            = nullptr; // pool from which set was allocated
+		std::atomic<uint64_t> last_used_frame = 0;       // frame number of most recent frame which used this set
+	};
+	std::unordered_map<uint64_t, Entry> entries;                 // key: hash over set layout and descriptor writes
+	std::vector<VkDescriptorPool>       pools;                   // owning: pools are created with VK_DESCRIPTOR_POOL_CREATE_FREE_DESCRIPTOR_SET_BIT
+	std::shared_mutex                   mtx;                     // protects entries, pools; must be held exclusively to allocate, update, or free sets
+	std::atomic<uint64_t>               resource_generation = 0; // mixed into keys, so that we never re-use a set which might refer to a recycled handle
+};
+
 /// \brief backend data object
 struct le_backend_o {
 
@@ -672,6 +742,11 @@ struct le_backend_o {
 	std::mutex                                                  allocated_resources_mutex; /// mutex protecting allocated_resources
 
   public:
+	TransientMemoryState transient_memory; // protected by allocated_resources_mutex: lock via get_allocated_resources() before access
+
+	VkObjectCache      object_cache;         // renderpasses, framebuffers, image views, and samplers which are re-used across frames
+	DescriptorSetCache descriptor_set_cache; // descriptor sets which are re-used within and across frames
+
 	auto get_allocated_resources() {
 		// By returning a lock with the reference to allocated resources we enforce that
 		// the mutex be locked for the duration that the reference is in-scope.
@@ -766,6 +841,140 @@ static VkBufferUsageFlags defaults_get_buffer_usage_scratch() {
 
 // ----------------------------------------------------------------------
 
+// If `pipeline_manager` is given, render passes get destroyed via the pipeline manager,
+// which defers destroying a render pass while pipelines are compiled against it.
+static void physical_resource_destroy( VkDevice device, le_pipeline_manager_o* pipeline_manager, AbstractPhysicalResource const& r ) {
+	static auto logger = LeLog( LOGGER_LABEL );
+
+	switch ( r.type ) {
+	case AbstractPhysicalResource::eBuffer:
+		vkDestroyBuffer( device, r.asBuffer, nullptr );
+		break;
+	case AbstractPhysicalResource::eFramebuffer:
+		vkDestroyFramebuffer( device, r.asFramebuffer, nullptr );
+		break;
+	case AbstractPhysicalResource::eImage:
+		vkDestroyImage( device, r.asImage, nullptr );
+		break;
+	case AbstractPhysicalResource::eImageView:
+		vkDestroyImageView( device, r.asImageView, nullptr );
+		break;
+	case AbstractPhysicalResource::eRenderPass:
+		if ( pipeline_manager ) {
+			le_backend_vk::le_pipeline_manager_i.destroy_render_pass( pipeline_manager, r.asRenderPass );
+		} else {
+			vkDestroyRenderPass( device, r.asRenderPass, nullptr );
+		}
+		break;
+	case AbstractPhysicalResource::eSampler:
+		vkDestroySampler( device, r.asSampler, nullptr );
+		break;
+
+	case AbstractPhysicalResource::eUndefined:
+		logger.warn( "%s: abstract physical resource has unknown type (%p) and cannot be deleted. leaking...", __PRETTY_FUNCTION__, r.type );
+		break;
+	}
+}
+
+// ----------------------------------------------------------------------
+
+static void object_cache_entry_destroy( VkDevice device, le_pipeline_manager_o* pipeline_manager, VkObjectCache::Entry const& entry ) {
+	// Destroy object before any image views which it owns, as the object refers to these views.
+	physical_resource_destroy( device, pipeline_manager, entry.object );
+	for ( auto const& v : entry.owned_image_views ) {
+		vkDestroyImageView( device, v, nullptr );
+	}
+}
+
+// ----------------------------------------------------------------------
+// Returns object stored under `key` in cache - if there is no such object, calls
+// `create( VkObjectCache::Entry& )` to create the object, and stores it with the cache.
+//
+// If `cache` is nullptr, caching is disabled: we always create a new object, and hand
+// it to the frame, which destroys it once the frame gets cleared.
+template <typename CreateFun>
+static AbstractPhysicalResource object_cache_get_or_create( VkObjectCache* cache, BackendFrameData& frame, uint64_t key, CreateFun const& create ) {
+
+	if ( nullptr == cache ) {
+		VkObjectCache::Entry entry;
+		create( entry );
+		for ( auto const& v : entry.owned_image_views ) {
+			AbstractPhysicalResource iv;
+			iv.type        = AbstractPhysicalResource::eImageView;
+			iv.asImageView = v;
+			frame.ownedResources.emplace_front( std::move( iv ) );
+		}
+		frame.ownedResources.emplace_front( entry.object );
+		return entry.object;
+	}
+
+	// --------| invariant: caching is enabled
+
+	std::scoped_lock lock( cache->mtx );
+
+	auto it = cache->entries.find( key );
+
+	if ( it == cache->entries.end() ) {
+		VkObjectCache::Entry entry;
+		create( entry );
+		it = cache->entries.emplace( key, std::move( entry ) ).first;
+	}
+
+	it->second.last_used_frame = std::max( it->second.last_used_frame, frame.frameNumber );
+
+	return it->second.object;
+}
+
+// ----------------------------------------------------------------------
+// Destroys any cached objects which have not been used for at least `max_unused_frames` frames.
+// Returns the number of objects which were destroyed.
+//
+// `completed_frame_number` must be the number of a frame which has crossed its fence,
+// and all frames before it must have crossed their fences, too.
+static size_t object_cache_evict( VkObjectCache& cache, VkDevice device, le_pipeline_manager_o* pipeline_manager, uint64_t completed_frame_number, uint64_t max_unused_frames ) {
+	ZoneScoped;
+	std::scoped_lock lock( cache.mtx );
+
+	size_t num_evicted = 0;
+
+	for ( auto it = cache.entries.begin(); it != cache.entries.end(); ) {
+		auto const& entry = it->second;
+		if ( entry.last_used_frame <= completed_frame_number &&
+		     completed_frame_number - entry.last_used_frame >= max_unused_frames ) {
+			object_cache_entry_destroy( device, pipeline_manager, entry );
+			it = cache.entries.erase( it );
+			num_evicted++;
+		} else {
+			it++;
+		}
+	}
+
+	return num_evicted;
+}
+
+// ----------------------------------------------------------------------
+// Frees any cached descriptor sets which have not been used for at least `max_unused_frames` frames.
+//
+// `completed_frame_number` must be the number of a frame which has crossed its fence,
+// and all frames before it must have crossed their fences, too.
+static void descriptor_set_cache_evict( DescriptorSetCache& cache, VkDevice device, uint64_t completed_frame_number, uint64_t max_unused_frames ) {
+	ZoneScoped;
+	std::unique_lock lock( cache.mtx );
+
+	for ( auto it = cache.entries.begin(); it != cache.entries.end(); ) {
+		uint64_t const last_used_frame = it->second.last_used_frame.load( std::memory_order_relaxed );
+		if ( last_used_frame <= completed_frame_number &&
+		     completed_frame_number - last_used_frame >= max_unused_frames ) {
+			vkFreeDescriptorSets( device, it->second.pool, 1, &it->second.set );
+			it = cache.entries.erase( it );
+		} else {
+			it++;
+		}
+	}
+}
+
+// ----------------------------------------------------------------------
+
 static le_backend_o* backend_create() {
 	auto self = new le_backend_o;
 	return self;
@@ -782,6 +991,13 @@ static void backend_destroy( le_backend_o* self ) {
 		self->pipelineCache = nullptr;
 	}
 
+	if ( nullptr == self->device ) {
+		// Backend was never set up - this is the case if the backend was only
+		// used for CPU-side work, such as frame planning, or frame replay.
+		delete self;
+		return;
+	}
+
 	VkDevice   device   = self->device->getVkDevice(); // may be nullptr if device was not created
 	VkInstance instance = le_backend_vk::vk_instance_i.get_vk_instance( self->instance );
 
@@ -796,6 +1012,25 @@ static void backend_destroy( le_backend_o* self ) {
 
 	vkDeviceWaitIdle( self->device.get()->getVkDevice() );
 
+	{
+		// Destroy any cached vk objects - no frames are in flight anymore.
+		std::scoped_lock lock( self->object_cache.mtx );
+		for ( auto const& e : self->object_cache.entries ) {
+			object_cache_entry_destroy( device, nullptr, e.second ); // pipeline manager has already been destroyed
+		}
+		self->object_cache.entries.clear();
+	}
+
+	{
+		// Destroy descriptor set cache pools - this implicitly frees all cached descriptor sets.
+		std::unique_lock lock( self->descriptor_set_cache.mtx );
+		for ( auto& p : self->descriptor_set_cache.pools ) {
+			vkDestroyDescriptorPool( device, p, nullptr );
+		}
+		self->descriptor_set_cache.pools.clear();
+		self->descriptor_set_cache.entries.clear();
+	}
+
 	// if we created a conversion sampler, we must destroy it here.
 	if ( self->vk_sampler_ycbcr_conversion ) {
 		vkDestroySamplerYcbcrConversion( device, self->vk_sampler_ycbcr_conversion, nullptr );
@@ -876,6 +1111,11 @@ static void backend_destroy( le_backend_o* self ) {
 				vmaFreeMemory( self->mAllocator, a.second.allocation );
 			}
 			frameData.binnedResources.clear();
+
+			for ( auto& a : frameData.binnedMemory ) {
+				vmaFreeMemory( self->mAllocator, a );
+			}
+			frameData.binnedMemory.clear();
 		}
 
 		{ // Clear command streams
@@ -883,6 +1123,11 @@ static void backend_destroy( le_backend_o* self ) {
 				delete ( cs );
 			}
 			frameData.command_streams.clear();
+
+			for ( auto& cs : frameData.scratch_command_streams ) {
+				delete ( cs );
+			}
+			frameData.scratch_command_streams.clear();
 		}
 	}
 
@@ -920,6 +1165,12 @@ static void backend_destroy( le_backend_o* self ) {
 		}
 
 		allocated_resources.clear();
+
+		// Free memory which was shared by aliased transient resources
+		for ( auto& a : self->transient_memory.blocks ) {
+			vmaFreeMemory( self->mAllocator, a );
+		}
+		self->transient_memory = {};
 	}
 	if ( self->mAllocator ) {
 		vmaDestroyAllocator( self->mAllocator );
@@ -1010,6 +1261,9 @@ static le_swapchain_handle backend_add_swapchain( le_backend_o* self, le_swapcha
 
 	assert( swapchain );
 
+	self->object_cache.image_generation++; // new swapchain images might have recycled image handles
+	self->descriptor_set_cache.resource_generation++;
+
 	uint64_t swapchain_index = ++self->swapchains_next_handle; // note pre-increment: this is so that index 0 means invalid swapchain
 
 	char swapchain_name[ 64 ];
@@ -1963,10 +2217,6 @@ static void frame_track_resource_state(
 		// Iterate over all image attachments
 		le_renderpass_add_attachments( *pass, currentPass, frame, currentPass.sampleCount );
 
-		// Note that we "steal" the encoder from the renderer pass -
-		// it becomes now our (the backend's) job to destroy it.
-		currentPass.encoder = renderpass_i.steal_encoder( *pass );
-
 		frame.passes.emplace_back( std::move( currentPass ) );
 	} // end for all passes
 
@@ -2168,30 +2418,11 @@ static bool backend_clear_frame( le_backend_o* self, size_t frameIndex ) {
 	{ // clear resources owned exclusively by this frame
 
 		for ( auto& r : frame.ownedResources ) {
-			switch ( r.type ) {
-			case AbstractPhysicalResource::eBuffer:
-				vkDestroyBuffer( device, r.asBuffer, nullptr );
-				break;
-			case AbstractPhysicalResource::eFramebuffer:
-				vkDestroyFramebuffer( device, r.asFramebuffer, nullptr );
-				break;
-			case AbstractPhysicalResource::eImage:
-				vkDestroyImage( device, r.asImage, nullptr );
-				break;
-			case AbstractPhysicalResource::eImageView:
-				vkDestroyImageView( device, r.asImageView, nullptr );
-				break;
-			case AbstractPhysicalResource::eRenderPass:
-				vkDestroyRenderPass( device, r.asRenderPass, nullptr );
-				break;
-			case AbstractPhysicalResource::eSampler:
-				vkDestroySampler( device, r.asSampler, nullptr );
-				break;
-
-			case AbstractPhysicalResource::eUndefined:
-				logger.warn( "%s: abstract physical resource has unknown type (%p) and cannot be deleted. leaking...", __PRETTY_FUNCTION__, r.type );
-				break;
+			if ( r.type == AbstractPhysicalResource::eImageView || r.type == AbstractPhysicalResource::eSampler ) {
+				// cached descriptor sets might refer to this handle, and it might get recycled.
+				self->descriptor_set_cache.resource_generation++;
 			}
+			physical_resource_destroy( device, self->pipelineCache, r );
 		}
 		frame.ownedResources.clear();
 	}
@@ -2223,6 +2454,26 @@ static bool backend_clear_frame( le_backend_o* self, size_t frameIndex ) {
 	for ( auto cs : frame.command_streams ) {
 		cs->reset();
 	}
+	for ( auto cs : frame.scratch_command_streams ) {
+		cs->reset();
+	}
+	frame.num_command_streams_in_use = 0;
+
+	{
+		// -- destroy cached vk objects which have not been used for a while.
+		//
+		// All frames up to and including the frame which we just cleared have crossed
+		// their fence, which means that objects last used by any of these frames are
+		// safe to destroy.
+		LE_SETTING( uint32_t, LE_SETTING_BACKEND_OBJECT_CACHE_MAX_UNUSED_FRAMES, 16 );
+
+		if ( object_cache_evict( self->object_cache, device, self->pipelineCache, frame.frameNumber, *LE_SETTING_BACKEND_OBJECT_CACHE_MAX_UNUSED_FRAMES ) ) {
+			// We might have destroyed image views or samplers - cached descriptor sets might refer to their handles.
+			self->descriptor_set_cache.resource_generation++;
+		}
+
+		descriptor_set_cache_evict( self->descriptor_set_cache, device, frame.frameNumber, *LE_SETTING_BACKEND_OBJECT_CACHE_MAX_UNUSED_FRAMES );
+	}
 
 	frame.frameNumber = self->mFramesCount++; // note post-increment
 
@@ -2250,7 +2501,7 @@ static constexpr auto ANY_WRITE_VK_ACCESS_2_FLAGS =
 // ----------------------------------------------------------------------
 // Executes on the DISPATCH FRAME
 //
-static void backend_create_renderpasses( BackendFrameData& frame, VkDevice& device ) {
+static void backend_create_renderpasses( BackendFrameData& frame, VkDevice& device, VkObjectCache* object_cache ) {
 	ZoneScoped;
 	static auto logger = LeLog( LOGGER_LABEL );
 
@@ -2577,21 +2828,63 @@ static void backend_create_renderpasses( BackendFrameData& frame, VkDevice& devi
 			    .pCorrelatedViewMasks    = 0,
 			};
 
-			// Create vulkan renderpass object
+			// -- Build hash over everything that goes into the renderpass
+			//
+			// We start with the hash for the compatible renderpass, and add everything
+			// which was left out because it does not affect compatibility: load- and
+			// store ops, layouts, resolve attachments, and external dependencies.
+			{
+				uint64_t rp_key = pass.renderpassHash;
+
+				static_assert(
+				    offsetof( VkAttachmentDescription2, finalLayout ) + sizeof( VkAttachmentDescription2::finalLayout ) -
+				            offsetof( VkAttachmentDescription2, loadOp ) ==
+				        4 * sizeof( VkAttachmentLoadOp ) + 2 * sizeof( VkImageLayout ),
+				    "AttachmentDescription struct must be tightly packed for efficient hashing" );
+
+				for ( const auto& a : attachments ) {
+					rp_key = SpookyHash::Hash64(
+					    &a.loadOp, offsetof( VkAttachmentDescription2, finalLayout ) + sizeof( VkAttachmentDescription2::finalLayout ) - offsetof( VkAttachmentDescription2, loadOp ),
+					    rp_key );
+				}
+
+				for ( auto const* refs : { &colorAttachmentReferences, &resolveAttachmentReferences } ) {
+					for ( auto const& r : *refs ) {
+						rp_key = SpookyHash::Hash64( &r.attachment, sizeof( r.attachment ), rp_key );
+						rp_key = SpookyHash::Hash64( &r.layout, sizeof( r.layout ), rp_key );
+					}
+				}
+
+				if ( dsAttachmentReference ) {
+					rp_key = SpookyHash::Hash64( &dsAttachmentReference->layout, sizeof( dsAttachmentReference->layout ), rp_key );
+				}
+
+				for ( auto const& b : memoryBarriers ) {
+					rp_key = SpookyHash::Hash64( &b.srcStageMask, sizeof( b.srcStageMask ), rp_key );
+					rp_key = SpookyHash::Hash64( &b.srcAccessMask, sizeof( b.srcAccessMask ), rp_key );
+					rp_key = SpookyHash::Hash64( &b.dstStageMask, sizeof( b.dstStageMask ), rp_key );
+					rp_key = SpookyHash::Hash64( &b.dstAccessMask, sizeof( b.dstAccessMask ), rp_key );
+				}
+
+				pass.renderpassKey = rp_key;
+			}
+
+			// Fetch vulkan renderpass object from cache, or create it if needed.
+			//
+			// If the object cache is disabled, the renderpass gets added to the list of
+			// owned and life-time tracked resources, so that it can be recycled when not needed anymore.
 
-			vkCreateRenderPass2( device, &renderpassCreateInfo, nullptr, &pass.renderPass );
+			pass.renderPass = object_cache_get_or_create(
+			                      object_cache, frame, pass.renderpassKey,
+			                      [ & ]( VkObjectCache::Entry& entry ) {
+				                      entry.object.type = AbstractPhysicalResource::eRenderPass;
+				                      vkCreateRenderPass2( device, &renderpassCreateInfo, nullptr, &entry.object.asRenderPass );
+			                      } )
+			                      .asRenderPass;
 
 			delete dsAttachmentReference; // noo-op if nullptr; we clean up here in case we allocated a
 			                              // depth stencil attachment reference above.
 			                              // Once createRenderPass has consumed the data, we can safely delete.
-
-			AbstractPhysicalResource rp;
-			rp.type         = AbstractPhysicalResource::eRenderPass;
-			rp.asRenderPass = pass.renderPass;
-
-			// Add vulkan renderpass object to list of owned and life-time tracked resources, so that
-			// it can be recycled when not needed anymore.
-			frame.ownedResources.emplace_front( std::move( rp ) );
 		}
 	} // end for each pass
 }
@@ -2665,10 +2958,16 @@ VkImageAspectFlags get_aspect_flags_from_format( le::Format const& format ) {
 // Executes on the DISPATCH FRAME
 //
 // input: Pass
-// output: framebuffer, append newly created imageViews to retained resources list.
-static void backend_create_frame_buffers( BackendFrameData& frame, VkDevice& device ) {
+// output: framebuffer - fetched from object cache if possible; owns image views for its attachments.
+static void backend_create_frame_buffers( BackendFrameData& frame, VkDevice& device, VkObjectCache* object_cache ) {
 
 	ZoneScoped;
+
+	// Framebuffers refer to images via image views - we must mix image generation
+	// into the key, so that we don't accidentally re-use a framebuffer which refers
+	// to an image that has since been destroyed, and whose handle has been recycled.
+	uint64_t const image_generation = object_cache ? object_cache->image_generation.load() : 0;
+
 	for ( auto& pass : frame.passes ) {
 
 		if ( pass.type != le::QueueFlagBits::eGraphics ) {
@@ -2679,8 +2978,13 @@ static void backend_create_frame_buffers( BackendFrameData& frame, VkDevice& dev
 		                           pass.numResolveAttachments +
 		                           pass.numDepthStencilAttachments;
 
-		std::vector<VkImageView> framebufferAttachments;
-		framebufferAttachments.reserve( attachmentCount );
+		std::vector<VkImageViewCreateInfo> imageViewCreateInfos;
+		imageViewCreateInfos.reserve( attachmentCount );
+
+		uint64_t fb_key = pass.renderpassKey;
+		fb_key          = SpookyHash::Hash64( &image_generation, sizeof( image_generation ), fb_key );
+		fb_key          = SpookyHash::Hash64( &pass.width, sizeof( pass.width ), fb_key );
+		fb_key          = SpookyHash::Hash64( &pass.height, sizeof( pass.height ), fb_key );
 
 		auto const attachment_end = pass.attachments + attachmentCount;
 		for ( AttachmentInfo const* attachment = pass.attachments; attachment != attachment_end; attachment++ ) {
@@ -2706,61 +3010,52 @@ static void backend_create_frame_buffers( BackendFrameData& frame, VkDevice& dev
 			    .subresourceRange = subresourceRange,
 			};
 
-			VkImageView imageView = nullptr;
-			{
-				auto result = vkCreateImageView( device, &imageViewCreateInfo, nullptr, &imageView );
-				assert( result == VK_SUCCESS );
-			}
-
-			framebufferAttachments.push_back( imageView );
-
-			{
-				// Retain imageviews in owned resources - they will be released
-				// once not needed anymore.
-
-				AbstractPhysicalResource iv;
-				iv.type        = AbstractPhysicalResource::eImageView;
-				iv.asImageView = imageView;
+			fb_key = SpookyHash::Hash64( &imageViewCreateInfo.image, sizeof( imageViewCreateInfo.image ), fb_key );
+			fb_key = SpookyHash::Hash64( &imageViewCreateInfo.format, sizeof( imageViewCreateInfo.format ), fb_key );
+			fb_key = SpookyHash::Hash64( &subresourceRange.aspectMask, sizeof( subresourceRange.aspectMask ), fb_key );
 
-				frame.ownedResources.emplace_front( std::move( iv ) );
-			}
+			imageViewCreateInfos.emplace_back( imageViewCreateInfo );
 		}
 
-		VkFramebufferCreateInfo framebufferCreateInfo{
-		    .sType           = VK_STRUCTURE_TYPE_FRAMEBUFFER_CREATE_INFO,
-		    .pNext           = nullptr, // optional
-		    .flags           = 0,       // optional
-		    .renderPass      = pass.renderPass,
-		    .attachmentCount = attachmentCount, // optional
-		    .pAttachments    = framebufferAttachments.data(),
-		    .width           = pass.width,
-		    .height          = pass.height,
-		    .layers          = 1,
-		};
-
-		auto result = vkCreateFramebuffer( device, &framebufferCreateInfo, nullptr, &pass.framebuffer );
-		assert( result == VK_SUCCESS && "Framebuffer must be valid" );
-		{
-			// Retain framebuffer
-
-			AbstractPhysicalResource fb;
-			fb.type          = AbstractPhysicalResource::eFramebuffer;
-			fb.asFramebuffer = pass.framebuffer;
-
-			frame.ownedResources.emplace_front( std::move( fb ) );
-		}
+		// Fetch framebuffer from cache, or create it if needed. Image views for framebuffer
+		// attachments are owned by the framebuffer, and get destroyed together with it.
+
+		pass.framebuffer = object_cache_get_or_create(
+		                       object_cache, frame, fb_key,
+		                       [ & ]( VkObjectCache::Entry& entry ) {
+			                       entry.owned_image_views.reserve( attachmentCount );
+
+			                       for ( auto const& imageViewCreateInfo : imageViewCreateInfos ) {
+				                       VkImageView imageView = nullptr;
+				                       auto        result    = vkCreateImageView( device, &imageViewCreateInfo, nullptr, &imageView );
+				                       assert( result == VK_SUCCESS );
+				                       entry.owned_image_views.push_back( imageView );
+			                       }
+
+			                       VkFramebufferCreateInfo framebufferCreateInfo{
+			                           .sType           = VK_STRUCTURE_TYPE_FRAMEBUFFER_CREATE_INFO,
+			                           .pNext           = nullptr, // optional
+			                           .flags           = 0,       // optional
+			                           .renderPass      = pass.renderPass,
+			                           .attachmentCount = attachmentCount, // optional
+			                           .pAttachments    = entry.owned_image_views.data(),
+			                           .width           = pass.width,
+			                           .height          = pass.height,
+			                           .layers          = 1,
+			                       };
+
+			                       entry.object.type = AbstractPhysicalResource::eFramebuffer;
+			                       auto result       = vkCreateFramebuffer( device, &framebufferCreateInfo, nullptr, &entry.object.asFramebuffer );
+			                       assert( result == VK_SUCCESS && "Framebuffer must be valid" );
+		                       } )
+		                       .asFramebuffer;
 	}
 }
 
 // ----------------------------------------------------------------------
-// Executes on the DISPATCH FRAME
+// Creates a descriptor pool with room for a generous number of descriptors of each type.
 //
-static void backend_create_descriptor_pools( BackendFrameData& frame, VkDevice& device, size_t numRenderPasses ) {
-	ZoneScoped;
-	// Make sure that there is one descriptorpool for every renderpass.
-	// descriptor pools which were created previously will be re-used,
-	// if we're suddenly rendering more frames, we will add additional
-	// descriptorPools.
+static VkDescriptorPool create_descriptor_pool( VkDevice device, VkDescriptorPoolCreateFlags flags ) {
 
 	// At this point it would be nice to have an idea for each renderpass
 	// on how many descriptors to expect, but we cannot know that realistically
@@ -2787,34 +3082,49 @@ static void backend_create_descriptor_pools( BackendFrameData& frame, VkDevice&
 
 	constexpr size_t DESCRIPTOR_TYPE_COUNT = sizeof( DESCRIPTOR_TYPES ) / sizeof( VkDescriptorType );
 
-	for ( ; frame.descriptorPools.size() < numRenderPasses; ) {
+	std::vector<VkDescriptorPoolSize> descriptorPoolSizes;
 
-		std::vector<VkDescriptorPoolSize> descriptorPoolSizes;
+	descriptorPoolSizes.reserve( DESCRIPTOR_TYPE_COUNT );
 
-		descriptorPoolSizes.reserve( DESCRIPTOR_TYPE_COUNT );
+	for ( auto i : DESCRIPTOR_TYPES ) {
+		descriptorPoolSizes.push_back( {
+		    .type            = i,
+		    .descriptorCount = 1000,
+		} ); // 1000 descriptors of each type
+	}
 
-		for ( auto i : DESCRIPTOR_TYPES ) {
-			descriptorPoolSizes.push_back( {
-			    .type            = i,
-			    .descriptorCount = 1000,
-			} ); // 1000 descriptors of each type
-		}
+	VkDescriptorPoolCreateInfo descriptorPoolCreateInfo{
+	    .sType         = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO,
+	    .pNext         = nullptr, // optional
+	    .flags         = flags,   // optional
+	    .maxSets       = 2000,
+	    .poolSizeCount = uint32_t( descriptorPoolSizes.size() ),
+	    .pPoolSizes    = descriptorPoolSizes.data(),
+	};
 
-		VkDescriptorPoolCreateInfo descriptorPoolCreateInfo{
-		    .sType         = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO,
-		    .pNext         = nullptr, // optional
-		    .flags         = 0,       // optional
-		    .maxSets       = 2000,
-		    .poolSizeCount = uint32_t( descriptorPoolSizes.size() ),
-		    .pPoolSizes    = descriptorPoolSizes.data(),
-		};
+	VkDescriptorPool descriptorPool = nullptr;
 
-		VkDescriptorPool descriptorPool = nullptr;
+	auto result = vkCreateDescriptorPool( device, &descriptorPoolCreateInfo, nullptr, &descriptorPool );
+	assert( result == VK_SUCCESS );
 
-		auto result = vkCreateDescriptorPool( device, &descriptorPoolCreateInfo, nullptr, &descriptorPool );
-		assert( result == VK_SUCCESS );
+	return descriptorPool;
+}
+
+// ----------------------------------------------------------------------
+// Executes on the DISPATCH FRAME
+//
+static void backend_create_descriptor_pools( BackendFrameData& frame, VkDevice& device, size_t numRenderPasses ) {
+	ZoneScoped;
+	// Make sure that there is one descriptorpool for every renderpass.
+	// descriptor pools which were created previously will be re-used,
+	// if we're suddenly rendering more frames, we will add additional
+	// descriptorPools.
+	//
+	// Note that frame-local descriptor pools are only used if the
+	// descriptor set cache has been disabled.
 
-		frame.descriptorPools.emplace_back( std::move( descriptorPool ) );
+	for ( ; frame.descriptorPools.size() < numRenderPasses; ) {
+		frame.descriptorPools.emplace_back( create_descriptor_pool( device, 0 ) );
 	}
 }
 
@@ -2858,6 +3168,9 @@ static int32_t backend_allocate_image(
 	        pAllocation,
 	        pAllocationInfo );
 
+	self->object_cache.image_generation++; // image handle might have been recycled
+	self->descriptor_set_cache.resource_generation++;
+
 	return result;
 }
 
@@ -2889,6 +3202,8 @@ static int32_t backend_allocate_buffer(
 	        pAllocation,
 	        pAllocationInfo );
 
+	self->descriptor_set_cache.resource_generation++; // buffer handle might have been recycled
+
 	return result;
 }
 // ----------------------------------------------------------------------
@@ -3370,6 +3685,11 @@ inline void frame_release_binned_resources( BackendFrameData& frame, VmaAllocato
 		}
 	}
 	frame.binnedResources.clear();
+
+	for ( auto& a : frame.binnedMemory ) {
+		vmaFreeMemory( allocator, a );
+	}
+	frame.binnedMemory.clear();
 }
 
 // ----------------------------------------------------------------------
@@ -3677,6 +3997,9 @@ static void printResourceInfo( le_resource_handle const& handle, ResourceCreateI
 
 // ----------------------------------------------------------------------
 
+static constexpr uint32_t DEFAULT_RENDERPASS_WIDTH  = 1024;
+static constexpr uint32_t DEFAULT_RENDERPASS_HEIGHT = 1024;
+
 static void patch_renderpass_extents(
     le_renderpass_o** passes,
     size_t            numRenderPasses,
@@ -3799,95 +4122,430 @@ static void frame_resources_set_debug_names( le_backend_vk_instance_o* instance,
 }
 
 // ----------------------------------------------------------------------
-// Executes on the DISPATCH FRAME
-// towards the start of backend_acquire_physical_resources
-//
-// Allocates all physical Vulkan memory resources (Images/Buffers) referenced to by the frame.
-//
-// - If a resource is already available to the backend, the previously allocated resource is
-//   copied into the frame.
-// - If a resource has not yet been seen, it is freshly allocated, then made available to
-//   the frame. It is also copied to the backend, so that the following frames may access it.
-// - If a resource is requested with properties differing from a resource with the same handle
-//   available from the backend, the previous resource is placed in the frame bin for recycling,
-//   and a new resource is allocated and copied to the frame. This resource in the backend is
-//   replaced by the new version, too. (Effectively, the frame has taken ownership of the old
-//   version and keeps it until it disposes of it).
-// - If there are resources in the recycling bin of a frame, these will get freed. Freeing
-//   happens as a first step, so that resources are only freed once the frame has "come around"
-//   and earlier frames which may have still used the old version of the resource have no claim
-//   on the old version of the resource anymore.
+// Returns true if resource contents need not survive from one frame to the next,
+// in which case the resource may share its memory with other transient resources.
+static bool resource_is_transient( le_resource_handle const& resource ) {
+
+	static_assert( le_img_resource_usage_flags_t::eIsTransient == ( 1u << 1 ), "must match flag used in LE_IMG_RESOURCE_TRANSIENT" );
+	static_assert( le_buf_resource_usage_flags_t::eIsTransient == ( 1u << 2 ), "must match flag used in LE_BUF_RESOURCE_TRANSIENT" );
+
+	// Multisample versions of an image inherit their flags from the image they were derived from.
+	le_resource_handle_data_t const* data =
+	    resource->data->reference_handle
+	        ? resource->data->reference_handle->data
+	        : resource->data;
+
+	switch ( resource->data->type ) {
+	case LeResourceType::eImage:
+		return data->flags & le_img_resource_usage_flags_t::eIsTransient;
+	case LeResourceType::eBuffer:
+		return data->flags & le_buf_resource_usage_flags_t::eIsTransient;
+	default:
+		return false;
+	}
+}
+
+// ----------------------------------------------------------------------
+// Calculates lifetimes for transient resources: for each resource, the index of the first,
+// and the last pass which uses it, and a group, so that resources may only alias other
+// resources which are used on the same queue submission.
 //
-// We are currently not checking for "orphaned" resources (resources which are available in the
-// backend, but not used by the frame) - these could possibly be recycled, too.
+// Only sets first_use, last_use, and group for each element in `lifetimes`.
+static void frame_calculate_transient_resource_lifetimes(
+    le_renderpass_o**                              passes,
+    size_t                                         numRenderPasses,
+    std::vector<le_resource_handle> const&         resources,
+    std::vector<le_transient_resource_lifetime_t>& lifetimes ) {
 
-static void backend_allocate_resources( le_backend_o* self, BackendFrameData& frame, le_renderpass_o** passes, size_t numRenderPasses ) {
 	ZoneScoped;
-	/*
-	- Frame is only ever allowed to reference frame-local resources.
-	- "Acquire" therefore means we create local copies of backend-wide resource handles.
-	*/
-
-	static auto logger = LeLog( LOGGER_LABEL );
+	using namespace le_renderer;
 
-	static le_resource_handle LE_RTX_SCRATCH_BUFFER_HANDLE = LE_BUF_RESOURCE( "le_rtx_scratch_buffer_handle" ); // opaque handle for rtx scratch buffer
+	struct Lifetime {
+		uint32_t            first_use;
+		uint32_t            last_use;
+		le::RootPassesField affinity;
+	};
 
-	// -- first it is our holy duty to drop any binned resources which
-	// were condemned the last time this frame was active.
-	// It's possible that this was more than two frames ago,
-	// depending on how many swapchain images there are.
-	//
-	frame_release_binned_resources( frame, self->mAllocator );
+	std::unordered_map<le_resource_handle, Lifetime> lifetime_per_resource;
 
-	// Iterate over all resource declarations in all passes so that we can collect all resources,
-	// and their usage information. Later, we will consolidate their usages so that resources can
-	// be re-used across passes.
-	//
-	// Note that we accumulate all resource infos first, and do consolidation
-	// in a separate step. That way, we can first make sure all flags are combined,
-	// before we make sure to we find a valid image format which matches all uses...
-	//
+	for ( uint32_t i = 0; i != numRenderPasses; i++ ) {
 
-	std::unordered_map<le_resource_handle, le_resource_info_t> active_resources;
+		le::QueueFlagBits   pass_type{};
+		le::RootPassesField pass_affinity{};
+		renderpass_i.get_queue_sumbission_info( passes[ i ], &pass_type, &pass_affinity );
 
-	collect_resource_infos_per_resource(
-	    passes, numRenderPasses,
-	    frame.declared_resources,
-	    active_resources );
+		le_resource_handle const* pResources       = nullptr;
+		le::AccessFlags2 const*   pResourcesAccess = nullptr;
+		size_t                    resources_count  = 0;
+		renderpass_i.get_used_resources( passes[ i ], &pResources, &pResourcesAccess, &resources_count );
 
-	if ( LE_PRINT_DEBUG_MESSAGES ) {
-		for ( auto const& r : active_resources ) {
-			logger.info( "resource [ %-30s ] : [ %-50s ]", r.first->data->debug_name,
-			             r.second.type == LeResourceType::eImage
-			                 ? to_string_vk_image_usage_flags( r.second.image.usage ).c_str()
-			                 : to_string_vk_buffer_usage_flags( r.second.buffer.usage ).c_str() );
+		for ( size_t j = 0; j != resources_count; j++ ) {
+			auto [ it, was_inserted ] = lifetime_per_resource.try_emplace( pResources[ j ], Lifetime{ i, i, pass_affinity } );
+			if ( !was_inserted ) {
+				it->second.last_use = i;
+				it->second.affinity |= pass_affinity;
+			}
 		}
 	}
 
-	// For each image resource which has versions of additional sample counts
-	// we create additional resource_ids (by patching in the sample count), and add matching
-	// resource info, so that multisample versions of image resources can be allocated dynamically.
-	insert_msaa_versions( active_resources );
+	lifetimes.resize( resources.size() );
 
-	// Check if all resources declared in this frame are already available in backend.
-	// If a resource is not available yet, this resource must be allocated.
+	for ( size_t i = 0; i != resources.size(); i++ ) {
 
-	{
+		// Multisample versions of an image are used whenever the image they were derived from is used.
+		le_resource_handle const key =
+		    resources[ i ]->data->reference_handle
+		        ? resources[ i ]->data->reference_handle
+		        : resources[ i ];
 
-		auto [ backendResources, backend_resources_lock ] = self->get_allocated_resources();
+		Lifetime lifetime{ 0, uint32_t( numRenderPasses ), 0 }; // if we can't find a resource, we must assume that it is alive for the whole frame
 
-		for ( auto const& ar : active_resources ) {
+		auto it = lifetime_per_resource.find( key );
+		if ( it != lifetime_per_resource.end() ) {
+			lifetime = it->second;
+		}
 
-			le_resource_handle const& resource     = ar.first;
-			le_resource_info_t const& resourceInfo = ar.second; ///< consolidated resource info for this resource over all passes
+		// Images and buffers must not alias each other, so that we don't have to
+		// take into account bufferImageGranularity.
+		uint64_t const is_image = ( resources[ i ]->data->type == LeResourceType::eImage ) ? 1 : 0;
 
-			// See if a resource with this id is already available to the frame
-			// This may be the case with a swapchain image resource for example,
-			// as it is allocated and managed from within the swapchain, not here.
-			//
-			if ( frame.availableResources.find( resource ) != frame.availableResources.end() ) {
-				// Resource is already available to and present in the frame.
-				continue;
+		lifetimes[ i ].first_use = lifetime.first_use;
+		lifetimes[ i ].last_use  = lifetime.last_use;
+		lifetimes[ i ].group     = SpookyHash::Hash64( &lifetime.affinity, sizeof( lifetime.affinity ), is_image );
+	}
+}
+
+// ----------------------------------------------------------------------
+// Moves all aliased transient resources, and the memory which backs them, into
+// the frame's recycling bin, so that they get freed once this frame comes round again.
+static void backend_bin_transient_memory( le_backend_o* self, BackendFrameData& frame, std::unordered_map<le_resource_handle, AllocatedResourceVk>& backendResources ) {
+
+	TransientMemoryState& transient = self->transient_memory;
+
+	for ( auto const& r : transient.resources ) {
+		auto it = backendResources.find( r );
+		if ( it != backendResources.end() ) {
+			frame.binnedResources.insert_or_assign( r, it->second );
+			backendResources.erase( it );
+		}
+	}
+
+	frame.binnedMemory.insert( frame.binnedMemory.end(), transient.blocks.begin(), transient.blocks.end() );
+
+	transient = {};
+}
+
+// ----------------------------------------------------------------------
+// Allocates transient resources so that resources which are never used at the same time
+// within a frame share the same memory.
+//
+// We re-use the previous frame's allocations if the previous plan is still valid given
+// the current frame's resource lifetimes. Otherwise, we bin all transient resources
+// and build a new plan.
+//
+// Adds all transient resources to frame.availableResources - so that they get skipped
+// when allocating regular resources.
+static void backend_allocate_transient_resources(
+    le_backend_o*                                               self,
+    BackendFrameData&                                           frame,
+    le_renderpass_o**                                           passes,
+    size_t                                                      numRenderPasses,
+    std::unordered_map<le_resource_handle, le_resource_info_t>& active_resources,
+    std::unordered_map<le_resource_handle, AllocatedResourceVk>& backendResources ) {
+
+	ZoneScoped;
+	static auto logger = LeLog( LOGGER_LABEL );
+
+	LE_SETTING( bool, LE_SETTING_BACKEND_ALIAS_TRANSIENT_RESOURCES, true );
+
+	TransientMemoryState& transient = self->transient_memory;
+
+	if ( false == *LE_SETTING_BACKEND_ALIAS_TRANSIENT_RESOURCES ) {
+		if ( !transient.resources.empty() ) {
+			// We must not keep aliased resources around, as they would otherwise
+			// get re-used as if they were regular resources.
+			backend_bin_transient_memory( self, frame, backendResources );
+		}
+		return;
+	}
+
+	// Collect transient resources, and their create infos.
+
+	std::vector<std::pair<le_resource_handle, ResourceCreateInfo>> requested;
+
+	for ( auto const& [ resource, resourceInfo ] : active_resources ) {
+
+		if ( !resource_is_transient( resource ) ||
+		     frame.availableResources.find( resource ) != frame.availableResources.end() ) {
+			continue;
+		}
+
+		auto createInfo = ResourceCreateInfo::from_le_resource_info( resourceInfo );
+
+		if ( createInfo.isImage() ) {
+
+			patchImageUsageForMipLevels( &createInfo );
+
+			if ( createInfo.imageInfo.format == VK_FORMAT_UNDEFINED ) {
+				inferImageFormat( self, static_cast<le_image_resource_handle>( resource ), resourceInfo.image.usage, &createInfo );
+			}
+
+			if ( 0 == createInfo.imageInfo.extent.width * createInfo.imageInfo.extent.height * createInfo.imageInfo.extent.depth ) {
+				// Invalid extents: we leave it to regular allocation to report the error.
+				continue;
+			}
+		}
+
+		requested.emplace_back( resource, createInfo );
+	}
+
+	if ( requested.empty() ) {
+		// We keep the current plan, as transient resources may be used again in following frames.
+		return;
+	}
+
+	std::sort( requested.begin(), requested.end(), []( auto const& lhs, auto const& rhs ) {
+		return lhs.first < rhs.first;
+	} );
+
+	std::vector<le_resource_handle> resources;
+	resources.reserve( requested.size() );
+	for ( auto const& r : requested ) {
+		resources.push_back( r.first );
+	}
+
+	std::vector<le_transient_resource_lifetime_t> lifetimes;
+	frame_calculate_transient_resource_lifetimes( passes, numRenderPasses, resources, lifetimes );
+
+	// Check whether we can re-use the current plan
+
+	bool can_reuse_plan = ( resources == transient.resources );
+
+	for ( size_t i = 0; can_reuse_plan && i != resources.size(); i++ ) {
+		can_reuse_plan = ( transient.create_infos[ i ] >= requested[ i ].second );
+		// Memory requirements don't change as long as the resource doesn't change.
+		lifetimes[ i ].size             = transient.lifetimes[ i ].size;
+		lifetimes[ i ].alignment        = transient.lifetimes[ i ].alignment;
+		lifetimes[ i ].memory_type_bits = transient.lifetimes[ i ].memory_type_bits;
+	}
+
+	if ( can_reuse_plan ) {
+		can_reuse_plan = le_transient_memory_plan_is_valid( transient.plan, lifetimes.data(), lifetimes.size() );
+	}
+
+	if ( can_reuse_plan ) {
+		for ( auto const& r : resources ) {
+			frame.availableResources.emplace( r, backendResources.at( r ) );
+		}
+		transient.lifetimes = lifetimes;
+		return;
+	}
+
+	// --------| invariant: we must build a new plan
+
+	backend_bin_transient_memory( self, frame, backendResources );
+
+	VkDevice device = self->device->getVkDevice();
+
+	std::vector<AllocatedResourceVk> allocated( requested.size() );
+
+	// Create resources without binding any memory, so that we can query their memory requirements.
+
+	for ( size_t i = 0; i != requested.size(); i++ ) {
+
+		auto& res = allocated[ i ];
+		res.info  = requested[ i ].second;
+
+		VkMemoryRequirements memReqs{};
+
+		if ( res.info.isImage() ) {
+			VkResult result = vkCreateImage( device, &res.info.imageInfo, nullptr, &res.as.image );
+			assert( result == VK_SUCCESS );
+			vkGetImageMemoryRequirements( device, res.as.image, &memReqs );
+			self->object_cache.image_generation++; // image handle might have been recycled
+		} else {
+			VkResult result = vkCreateBuffer( device, &res.info.bufferInfo, nullptr, &res.as.buffer );
+			assert( result == VK_SUCCESS );
+			vkGetBufferMemoryRequirements( device, res.as.buffer, &memReqs );
+		}
+
+		self->descriptor_set_cache.resource_generation++; // resource handle might have been recycled
+
+		lifetimes[ i ].size             = memReqs.size;
+		lifetimes[ i ].alignment        = memReqs.alignment;
+		lifetimes[ i ].memory_type_bits = memReqs.memoryTypeBits;
+	}
+
+	le_transient_memory_plan_build( &transient.plan, lifetimes.data(), lifetimes.size() );
+
+	// Allocate one block of memory per block in the plan.
+
+	std::vector<VmaAllocationInfo> blockInfos( transient.plan.blocks.size() );
+	transient.blocks.resize( transient.plan.blocks.size() );
+
+	for ( size_t b = 0; b != transient.plan.blocks.size(); b++ ) {
+
+		VkMemoryRequirements memReqs{
+		    .size           = transient.plan.blocks[ b ].size,
+		    .alignment      = 1,
+		    .memoryTypeBits = transient.plan.blocks[ b ].memory_type_bits,
+		};
+
+		// Block must satisfy the alignment requirements of all its residents.
+		for ( size_t i = 0; i != lifetimes.size(); i++ ) {
+			if ( transient.plan.placements[ i ].block == b ) {
+				memReqs.alignment = std::max( memReqs.alignment, lifetimes[ i ].alignment );
+			}
+		}
+
+		VmaAllocationCreateInfo allocationCreateInfo{};
+		allocationCreateInfo.usage          = VMA_MEMORY_USAGE_GPU_ONLY;
+		allocationCreateInfo.preferredFlags = VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT;
+
+		VkResult result = vmaAllocateMemory( self->mAllocator, &memReqs, &allocationCreateInfo, &transient.blocks[ b ], &blockInfos[ b ] );
+		assert( result == VK_SUCCESS );
+	}
+
+	// Bind resources to their place in memory, and make them available to backend and frame.
+
+	for ( size_t i = 0; i != requested.size(); i++ ) {
+
+		auto&       res       = allocated[ i ];
+		auto const& placement = transient.plan.placements[ i ];
+
+		if ( res.info.isImage() ) {
+			VkResult result = vmaBindImageMemory2( self->mAllocator, transient.blocks[ placement.block ], placement.offset, res.as.image, nullptr );
+			assert( result == VK_SUCCESS );
+		} else {
+			VkResult result = vmaBindBufferMemory2( self->mAllocator, transient.blocks[ placement.block ], placement.offset, res.as.buffer, nullptr );
+			assert( result == VK_SUCCESS );
+		}
+
+		res.allocation     = nullptr; // resource does not own its memory - memory is owned by transient.blocks
+		res.allocationInfo = blockInfos[ placement.block ];
+		res.allocationInfo.offset += placement.offset;
+		res.allocationInfo.size = lifetimes[ i ].size;
+
+		if ( LE_PRINT_DEBUG_MESSAGES || true ) {
+			printResourceInfo( resources[ i ], res.info, "ALLOC (ALIASED)" );
+		}
+
+		frame.availableResources.insert_or_assign( resources[ i ], res );
+		backendResources.insert_or_assign( resources[ i ], res );
+	}
+
+	transient.resources    = std::move( resources );
+	transient.lifetimes    = std::move( lifetimes );
+	transient.create_infos.clear();
+	for ( auto const& r : requested ) {
+		transient.create_infos.push_back( r.second );
+	}
+
+	{
+		uint64_t size_without_aliasing = 0;
+		for ( auto const& l : transient.lifetimes ) {
+			size_without_aliasing += l.size;
+		}
+		logger.info( "Aliased %d transient resources into %d blocks: %llu bytes (%llu bytes without aliasing)",
+		             transient.resources.size(), transient.blocks.size(),
+		             le_transient_memory_plan_get_total_size( transient.plan ), size_without_aliasing );
+	}
+}
+
+// ----------------------------------------------------------------------
+// Executes on the DISPATCH FRAME
+// towards the start of backend_acquire_physical_resources
+//
+// Allocates all physical Vulkan memory resources (Images/Buffers) referenced to by the frame.
+//
+// - If a resource is already available to the backend, the previously allocated resource is
+//   copied into the frame.
+// - If a resource has not yet been seen, it is freshly allocated, then made available to
+//   the frame. It is also copied to the backend, so that the following frames may access it.
+// - If a resource is requested with properties differing from a resource with the same handle
+//   available from the backend, the previous resource is placed in the frame bin for recycling,
+//   and a new resource is allocated and copied to the frame. This resource in the backend is
+//   replaced by the new version, too. (Effectively, the frame has taken ownership of the old
+//   version and keeps it until it disposes of it).
+// - If there are resources in the recycling bin of a frame, these will get freed. Freeing
+//   happens as a first step, so that resources are only freed once the frame has "come around"
+//   and earlier frames which may have still used the old version of the resource have no claim
+//   on the old version of the resource anymore.
+//
+// We are currently not checking for "orphaned" resources (resources which are available in the
+// backend, but not used by the frame) - these could possibly be recycled, too.
+
+static void backend_allocate_resources( le_backend_o* self, BackendFrameData& frame, le_renderpass_o** passes, size_t numRenderPasses ) {
+	ZoneScoped;
+	/*
+	- Frame is only ever allowed to reference frame-local resources.
+	- "Acquire" therefore means we create local copies of backend-wide resource handles.
+	*/
+
+	static auto logger = LeLog( LOGGER_LABEL );
+
+	static le_resource_handle LE_RTX_SCRATCH_BUFFER_HANDLE = LE_BUF_RESOURCE( "le_rtx_scratch_buffer_handle" ); // opaque handle for rtx scratch buffer
+
+	// -- first it is our holy duty to drop any binned resources which
+	// were condemned the last time this frame was active.
+	// It's possible that this was more than two frames ago,
+	// depending on how many swapchain images there are.
+	//
+	frame_release_binned_resources( frame, self->mAllocator );
+
+	// Iterate over all resource declarations in all passes so that we can collect all resources,
+	// and their usage information. Later, we will consolidate their usages so that resources can
+	// be re-used across passes.
+	//
+	// Note that we accumulate all resource infos first, and do consolidation
+	// in a separate step. That way, we can first make sure all flags are combined,
+	// before we make sure to we find a valid image format which matches all uses...
+	//
+
+	std::unordered_map<le_resource_handle, le_resource_info_t> active_resources;
+
+	collect_resource_infos_per_resource(
+	    passes, numRenderPasses,
+	    frame.declared_resources,
+	    active_resources );
+
+	if ( LE_PRINT_DEBUG_MESSAGES ) {
+		for ( auto const& r : active_resources ) {
+			logger.info( "resource [ %-30s ] : [ %-50s ]", r.first->data->debug_name,
+			             r.second.type == LeResourceType::eImage
+			                 ? to_string_vk_image_usage_flags( r.second.image.usage ).c_str()
+			                 : to_string_vk_buffer_usage_flags( r.second.buffer.usage ).c_str() );
+		}
+	}
+
+	// For each image resource which has versions of additional sample counts
+	// we create additional resource_ids (by patching in the sample count), and add matching
+	// resource info, so that multisample versions of image resources can be allocated dynamically.
+	insert_msaa_versions( active_resources );
+
+	// Check if all resources declared in this frame are already available in backend.
+	// If a resource is not available yet, this resource must be allocated.
+
+	{
+
+		auto [ backendResources, backend_resources_lock ] = self->get_allocated_resources();
+
+		// Transient resources may share memory, we allocate these first -
+		// any transient resources allocated here will be skipped in the following loop.
+		backend_allocate_transient_resources( self, frame, passes, numRenderPasses, active_resources, backendResources );
+
+		for ( auto const& ar : active_resources ) {
+
+			le_resource_handle const& resource     = ar.first;
+			le_resource_info_t const& resourceInfo = ar.second; ///< consolidated resource info for this resource over all passes
+
+			// See if a resource with this id is already available to the frame
+			// This may be the case with a swapchain image resource for example,
+			// as it is allocated and managed from within the swapchain, not here.
+			//
+			if ( frame.availableResources.find( resource ) != frame.availableResources.end() ) {
+				// Resource is already available to and present in the frame.
+				continue;
 			}
 
 			// ---------| invariant: resource with this id is not yet available to frame.
@@ -3915,6 +4573,11 @@ static void backend_allocate_resources( le_backend_o* self, BackendFrameData& fr
 
 				auto allocatedResource = allocate_resource_vk( self->mAllocator, resourceCreateInfo, self->device->getVkDevice() );
 
+				if ( allocatedResource.info.isImage() ) {
+					self->object_cache.image_generation++; // image handle might have been recycled
+				}
+				self->descriptor_set_cache.resource_generation++; // resource handle might have been recycled
+
 				if ( LE_PRINT_DEBUG_MESSAGES || true ) {
 					printResourceInfo( resource, allocatedResource.info, "ALLOC" );
 				}
@@ -3961,6 +4624,11 @@ static void backend_allocate_resources( le_backend_o* self, BackendFrameData& fr
 
 					auto allocatedResource = allocate_resource_vk( self->mAllocator, resourceCreateInfo );
 
+					if ( allocatedResource.info.isImage() ) {
+						self->object_cache.image_generation++; // image handle might have been recycled
+					}
+					self->descriptor_set_cache.resource_generation++; // resource handle might have been recycled
+
 					if ( LE_PRINT_DEBUG_MESSAGES || true ) {
 						printResourceInfo( resource, allocatedResource.info, "RE-ALLOC" );
 					}
@@ -4024,6 +4692,8 @@ static void backend_allocate_resources( le_backend_o* self, BackendFrameData& fr
 			auto               allocated_resource = allocate_resource_vk( self->mAllocator, resourceCreateInfo, self->device->getVkDevice() );
 			frame.availableResources.insert_or_assign( resource_id, allocated_resource );
 
+			self->descriptor_set_cache.resource_generation++; // buffer handle might have been recycled
+
 			// We immediately bin the buffer resource, so that its lifetime is tied to the current frame.
 			frame.binnedResources.insert_or_assign( resource_id, allocated_resource );
 		}
@@ -4073,17 +4743,39 @@ static void backend_allocate_resources( le_backend_o* self, BackendFrameData& fr
 	}
 }
 
+// ----------------------------------------------------------------------
+// Hash over image view create info, used as a key to look up cached image views.
+//
+// We only record whether pNext is set, as pNext is only ever used to chain the
+// backend's default ycbcr conversion info.
+static uint64_t image_view_create_info_hash( VkImageViewCreateInfo const& info, uint64_t image_generation ) {
+	uint64_t const has_next = ( info.pNext != nullptr );
+
+	uint64_t hash = SpookyHash::Hash64( &image_generation, sizeof( image_generation ), AbstractPhysicalResource::eImageView );
+	hash          = SpookyHash::Hash64( &has_next, sizeof( has_next ), hash );
+	hash          = SpookyHash::Hash64( &info.flags, sizeof( info.flags ), hash );
+	hash          = SpookyHash::Hash64( &info.image, sizeof( info.image ), hash );
+	hash          = SpookyHash::Hash64( &info.viewType, sizeof( info.viewType ), hash );
+	hash          = SpookyHash::Hash64( &info.format, sizeof( info.format ), hash );
+	hash          = SpookyHash::Hash64( &info.components, sizeof( info.components ), hash );
+	hash          = SpookyHash::Hash64( &info.subresourceRange, sizeof( info.subresourceRange ), hash );
+	return hash;
+}
+
 // ----------------------------------------------------------------------
 // Executes on the DISPATCH FRAME
 //
-// Allocates ImageViews, Samplers and Textures requested by individual passes
-// these are tied to the lifetime of the frame, and will be re-created
-static void frame_allocate_transient_resources( BackendFrameData& frame, VkDevice const& device, le_renderpass_o** passes, size_t numRenderPasses, VkSamplerYcbcrConversionInfo* ycbcr_conversion_info = nullptr ) {
+// Allocates ImageViews, Samplers and Textures requested by individual passes.
+// These are fetched from the object cache, if given, and created only if not found;
+// without object cache, these are tied to the lifetime of the frame, and will be re-created
+static void frame_allocate_transient_resources( BackendFrameData& frame, VkDevice const& device, le_renderpass_o** passes, size_t numRenderPasses, VkObjectCache* object_cache, VkSamplerYcbcrConversionInfo* ycbcr_conversion_info = nullptr ) {
 	ZoneScoped;
 	using namespace le_renderer;
 	static auto       logger = LeLog( LOGGER_LABEL );
 	le::QueueFlagBits pass_type{};
 
+	uint64_t const image_generation = object_cache ? object_cache->image_generation.load() : 0;
+
 	// Only for compute passes: Create imageviews for all available
 	// resources which are of type image and which have usage
 	// sampled or storage.
@@ -4152,18 +4844,18 @@ static void frame_allocate_transient_resources( BackendFrameData& frame, VkDevic
 				    .subresourceRange = subresourceRange,
 				};
 
-				VkImageView imageView = nullptr;
-				vkCreateImageView( device, &imageViewCreateInfo, nullptr, &imageView );
+				VkImageView imageView =
+				    object_cache_get_or_create(
+				        object_cache, frame, image_view_create_info_hash( imageViewCreateInfo, image_generation ),
+				        [ & ]( VkObjectCache::Entry& entry ) {
+					        entry.object.type = AbstractPhysicalResource::eImageView;
+					        vkCreateImageView( device, &imageViewCreateInfo, nullptr, &entry.object.asImageView );
+				        } )
+				        .asImageView;
 
 				// Store image view object with frame, indexed by image resource id,
 				// so that it can be found quickly if need be.
 				frame.imageViews[ r ] = imageView;
-
-				AbstractPhysicalResource imgView{};
-				imgView.type        = AbstractPhysicalResource::Type::eImageView;
-				imgView.asImageView = imageView;
-
-				frame.ownedResources.emplace_front( std::move( imgView ) );
 			}
 		}
 	}
@@ -4234,16 +4926,18 @@ static void frame_allocate_transient_resources( BackendFrameData& frame, VkDevic
 						imageViewCreateInfo.pNext = ycbcr_conversion_info;
 					}
 
-					vkCreateImageView( device, &imageViewCreateInfo, nullptr, &tex.imageView );
-
-					// Store vk object references with frame-owned resources, so that
-					// the vk objects can be destroyed when frame crosses the fence.
-
-					AbstractPhysicalResource res;
-					res.asImageView = tex.imageView;
-					res.type        = AbstractPhysicalResource::Type::eImageView;
-
-					frame.ownedResources.emplace_front( std::move( res ) );
+					// Fetch image view from object cache, or create it if needed - if the cache is
+					// disabled, the image view is stored with frame-owned resources, so that it can
+					// be destroyed when frame crosses the fence.
+
+					tex.imageView =
+					    object_cache_get_or_create(
+					        object_cache, frame, image_view_create_info_hash( imageViewCreateInfo, image_generation ),
+					        [ & ]( VkObjectCache::Entry& entry ) {
+						        entry.object.type = AbstractPhysicalResource::eImageView;
+						        vkCreateImageView( device, &imageViewCreateInfo, nullptr, &entry.object.asImageView );
+					        } )
+					        .asImageView;
 				}
 
 				{
@@ -4272,15 +4966,30 @@ static void frame_allocate_transient_resources( BackendFrameData& frame, VkDevic
 						    .borderColor             = VkBorderColor( texInfo.sampler.borderColor ),
 						    .unnormalizedCoordinates = texInfo.sampler.unnormalizedCoordinates,
 						};
-						vkCreateSampler( device, &samplerCreateInfo, nullptr, &tex.sampler );
-						// Now store vk object references with frame-owned resources, so that
-						// the vk objects can be destroyed when frame crosses the fence.
-
-						AbstractPhysicalResource res;
 
-						res.asSampler = tex.sampler;
-						res.type      = AbstractPhysicalResource::Type::eSampler;
-						frame.ownedResources.emplace_front( std::move( res ) );
+						// Samplers don't refer to any images, which means that we don't
+						// need to mix image generation into their key.
+
+						static_assert(
+						    offsetof( VkSamplerCreateInfo, unnormalizedCoordinates ) + sizeof( VkSamplerCreateInfo::unnormalizedCoordinates ) -
+						            offsetof( VkSamplerCreateInfo, flags ) ==
+						        17 * sizeof( uint32_t ),
+						    "SamplerCreateInfo struct must be tightly packed for efficient hashing" );
+
+						uint64_t const sampler_key =
+						    SpookyHash::Hash64(
+						        &samplerCreateInfo.flags,
+						        offsetof( VkSamplerCreateInfo, unnormalizedCoordinates ) + sizeof( VkSamplerCreateInfo::unnormalizedCoordinates ) - offsetof( VkSamplerCreateInfo, flags ),
+						        AbstractPhysicalResource::eSampler );
+
+						tex.sampler =
+						    object_cache_get_or_create(
+						        object_cache, frame, sampler_key,
+						        [ & ]( VkObjectCache::Entry& entry ) {
+							        entry.object.type = AbstractPhysicalResource::eSampler;
+							        vkCreateSampler( device, &samplerCreateInfo, nullptr, &entry.object.asSampler );
+						        } )
+						        .asSampler;
 					}
 				}
 
@@ -4301,6 +5010,23 @@ static void frame_allocate_transient_resources( BackendFrameData& frame, VkDevic
 // where we associate virtual with physical resources, allocate physical
 // resources as needed, and keep track of sync state of physical resources.
 //
+static void frame_declare_resources( BackendFrameData&         frame,
+                                     le_resource_handle const* declared_resources,
+                                     le_resource_info_t const* declared_resources_infos,
+                                     size_t                    declared_resources_count ) {
+
+	for ( size_t i = 0; i != declared_resources_count; i++, declared_resources++, declared_resources_infos++ ) {
+
+		auto const& [ it, was_inserted ] = frame.declared_resources.emplace( *declared_resources, *declared_resources_infos );
+		if ( was_inserted == false ) {
+			// we must consolidate - find the superset for two resource infos
+			consolidate_resource_info_into( it->second, *declared_resources_infos ); // we must consolidate
+		}
+	}
+}
+
+// ----------------------------------------------------------------------
+
 static bool backend_acquire_physical_resources( le_backend_o*             self,
                                                 size_t                    frameIndex,
                                                 le_renderpass_o**         passes,
@@ -4337,14 +5063,7 @@ static bool backend_acquire_physical_resources( le_backend_o*             self,
 	// actually used in the frame.
 	//
 
-	for ( size_t i = 0; i != declared_resources_count; i++, declared_resources++, declared_resources_infos++ ) {
-
-		auto const& [ it, was_inserted ] = frame.declared_resources.emplace( *declared_resources, *declared_resources_infos );
-		if ( was_inserted == false ) {
-			// we must consolidate - find the superset for two resource infos
-			consolidate_resource_info_into( it->second, *declared_resources_infos ); // we must consolidate
-		}
-	}
+	frame_declare_resources( frame, declared_resources, declared_resources_infos, declared_resources_count );
 
 	{
 
@@ -4355,9 +5074,6 @@ static bool backend_acquire_physical_resources( le_backend_o*             self,
 		// we must follow this from the back, so that if nothing is defined, the extent of the swapchain
 		// is applied to all renderpasses that don't have an explicitly defined extent.
 
-		static constexpr uint32_t DEFAULT_RENDERPASS_WIDTH  = 1024;
-		static constexpr uint32_t DEFAULT_RENDERPASS_HEIGHT = 1024;
-
 		patch_renderpass_extents(
 		    passes,
 		    numRenderPasses,
@@ -4377,6 +5093,22 @@ static bool backend_acquire_physical_resources( le_backend_o*             self,
 			frame.syncChainTable.insert( { res.first, { res.second.state } } );
 		}
 
+		{
+			// Aliased transient resources don't keep their contents: they start each frame in undefined layout.
+			// Since they share memory with other resources, their first use must wait for any preceding commands.
+			auto [ backend_resources, lock ] = self->get_allocated_resources(); // protects transient_memory
+
+			for ( auto const& r : self->transient_memory.resources ) {
+				auto it = frame.syncChainTable.find( r );
+				if ( it != frame.syncChainTable.end() ) {
+					auto& initialState          = it->second.front();
+					initialState.stage          = VK_PIPELINE_STAGE_2_ALL_COMMANDS_BIT;
+					initialState.visible_access = VK_ACCESS_2_MEMORY_WRITE_BIT;
+					initialState.layout         = VK_IMAGE_LAYOUT_UNDEFINED;
+				}
+			}
+		}
+
 		// -- build sync chain for each resource, create explicit sync barrier requests for resources
 		// which cannot be implicitly synced.
 		std::vector<le_image_resource_handle> tmp_swapchain_resources{};
@@ -4388,6 +5120,16 @@ static bool backend_acquire_physical_resources( le_backend_o*             self,
 
 		frame_track_resource_state( frame, passes, numRenderPasses, tmp_swapchain_resources );
 
+		{
+			// Note that we "steal" the encoder from each renderer pass -
+			// it becomes now our (the backend's) job to destroy it.
+			using namespace le_renderer;
+			auto backend_pass = frame.passes.end() - numRenderPasses;
+			for ( auto pass = passes; pass != passes + numRenderPasses; pass++, backend_pass++ ) {
+				backend_pass->encoder = renderpass_i.steal_encoder( *pass );
+			}
+		}
+
 		// At this point we know the state for each resource at the end of the sync chain.
 		// this state will be the initial state for the resource
 
@@ -4434,11 +5176,16 @@ static bool backend_acquire_physical_resources( le_backend_o*             self,
 		}
 	}
 
+	// Renderpasses, framebuffers, image views and samplers are re-used across frames via
+	// the object cache, unless caching has been disabled.
+	LE_SETTING( bool, LE_SETTING_BACKEND_CACHE_VK_OBJECTS, true );
+	VkObjectCache* object_cache = *LE_SETTING_BACKEND_CACHE_VK_OBJECTS ? &self->object_cache : nullptr;
+
 	// -- allocate any transient vk objects such as image samplers, and image views
-	frame_allocate_transient_resources( frame, device, passes, numRenderPasses, &self->vk_sampler_ycbcr_conversion_info );
+	frame_allocate_transient_resources( frame, device, passes, numRenderPasses, object_cache, &self->vk_sampler_ycbcr_conversion_info );
 
 	// create renderpasses - use sync chain to apply implicit syncing for image attachment resources
-	backend_create_renderpasses( frame, device );
+	backend_create_renderpasses( frame, device, object_cache );
 
 	// -- make sure that there is a descriptorpool for every renderpass
 	backend_create_descriptor_pools( frame, device, numRenderPasses );
@@ -4446,7 +5193,7 @@ static bool backend_acquire_physical_resources( le_backend_o*             self,
 	// patch and retain physical resources in bulk here, so that
 	// each pass may be processed independently
 
-	backend_create_frame_buffers( frame, device );
+	backend_create_frame_buffers( frame, device, object_cache );
 
 	return true;
 };
@@ -4458,28 +5205,71 @@ static le_allocator_o** backend_get_transient_allocators( le_backend_o* self, si
 
 // ----------------------------------------------------------------------
 
-static le_command_stream_t** backend_get_frame_command_streams( le_backend_o* self, size_t frameIndex, size_t num_command_streams ) {
+static le_command_stream_t** backend_get_frame_command_streams( le_backend_o* self, size_t frameIndex, size_t num_command_streams, uint64_t const* pass_ids ) {
 
 	// Check if the command stream pool has enough free command stream elements in the pool for us
 	// If no, we must add some additional command streams
 
-	auto& cmd_streams = self->mFrames[ frameIndex ].command_streams;
+	auto& frame       = self->mFrames[ frameIndex ];
+	auto& cmd_streams = frame.command_streams;
 
 	// We should maybe find a nicer way to do this...
 	while ( cmd_streams.size() < num_command_streams ) {
 		cmd_streams.insert( cmd_streams.end(), new le_command_stream_t() );
 	}
 
+	frame.num_command_streams_in_use = num_command_streams;
+
+	if ( pass_ids ) {
+		// Let each command stream know which pass it will record, so that
+		// it may reserve as much memory as this pass used previously.
+		for ( size_t i = 0; i != num_command_streams; i++ ) {
+			cmd_streams[ i ]->begin( pass_ids[ i ] );
+		}
+	}
+
 	return cmd_streams.data();
 };
 
 // ----------------------------------------------------------------------
-static le_allocator_o** backend_create_transient_allocators( le_backend_o* self, size_t frameIndex, size_t numAllocators ) {
+// Scratch command streams are pooled with the frame, just like the main command
+// streams, so that encoders don't need to allocate a stream each time they record
+// sorted draws. A scratch stream allocates no memory until it is first written to.
+static le_command_stream_t** backend_get_frame_scratch_command_streams( le_backend_o* self, size_t frameIndex, size_t num_command_streams ) {
 
-	using namespace le_backend_vk;
+	auto& cmd_streams = self->mFrames[ frameIndex ].scratch_command_streams;
 
-	auto&                           frame                         = self->mFrames[ frameIndex ];
-	static const VkBufferUsageFlags LE_BUFFER_USAGE_FLAGS_SCRATCH = defaults_get_buffer_usage_scratch();
+	while ( cmd_streams.size() < num_command_streams ) {
+		cmd_streams.insert( cmd_streams.end(), new le_command_stream_t() );
+	}
+
+	return cmd_streams.data();
+}
+
+// ----------------------------------------------------------------------
+
+static void backend_get_frame_command_stream_stats( le_backend_o* self, size_t frameIndex, le_command_stream_stats_t* stats ) {
+
+	auto const& frame = self->mFrames[ frameIndex ];
+
+	*stats             = {};
+	stats->num_streams = frame.num_command_streams_in_use;
+
+	for ( size_t i = 0; i != frame.num_command_streams_in_use; i++ ) {
+		auto const& cs = frame.command_streams[ i ];
+		stats->num_commands += cs->cmd_count;
+		stats->num_bytes += cs->size;
+		stats->num_bytes_reserved += cs->capacity;
+	}
+}
+
+// ----------------------------------------------------------------------
+static le_allocator_o** backend_create_transient_allocators( le_backend_o* self, size_t frameIndex, size_t numAllocators ) {
+
+	using namespace le_backend_vk;
+
+	auto&                           frame                         = self->mFrames[ frameIndex ];
+	static const VkBufferUsageFlags LE_BUFFER_USAGE_FLAGS_SCRATCH = defaults_get_buffer_usage_scratch();
 
 	for ( size_t i = frame.allocators.size(); i != numAllocators; ++i ) {
 
@@ -4512,6 +5302,8 @@ static le_allocator_o** backend_create_transient_allocators( le_backend_o* self,
 
 		assert( result == VK_SUCCESS ); // todo: deal with failed allocation
 
+		self->descriptor_set_cache.resource_generation++; // buffer handle might have been recycled
+
 		// Create a new allocator - note that we assume an alignment of 256 bytes
 		le_allocator_o* allocator = le_allocator_linear_i.create( &allocationInfo, 256 );
 
@@ -4545,8 +5337,192 @@ static bool is_equal( le_pipeline_and_layout_info_t const& lhs, le_pipeline_and_
 	       lhs.layout_info.active_vk_shader_stages == rhs.layout_info.active_vk_shader_stages;
 }
 
+// ----------------------------------------------------------------------
+// Writes descriptors for set `setId` of argument state into `descriptorSet`.
+static void descriptor_set_write( VkDevice device, VkDescriptorSet descriptorSet, ArgumentState const& argumentState, size_t setId ) {
+	if ( /* DISABLES CODE */ ( false ) ) {
+		// I wish that this would work - but it appears that accelerator decriptors cannot be updated using templates.
+		vkUpdateDescriptorSetWithTemplate( device, descriptorSet, argumentState.updateTemplates[ setId ], argumentState.setData[ setId ].data() );
+
+	} else {
+
+		std::vector<VkWriteDescriptorSet> write_descriptor_sets;
+
+		// We deliberately allocate write descriptor set acceleration structure objects on the heap,
+		// so that the pointer to the object will not change if and when the vector grows.
+		//
+		// This means that we can hand out copies of pointers from this vector without fear from
+		// within the current scope, but also that we must clean up the contents of the vector
+		// manually before leaving the current scope or else we will leak these objects.
+		std::vector<VkWriteDescriptorSetAccelerationStructureKHR*> write_acceleration_structures;
+
+		write_descriptor_sets.reserve( argumentState.setData[ setId ].size() );
+
+		for ( auto& a : argumentState.setData[ setId ] ) {
+			VkWriteDescriptorSet w{
+			    .sType            = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET,
+			    .pNext            = nullptr, // optional
+			    .dstSet           = descriptorSet,
+			    .dstBinding       = a.bindingNumber,
+			    .dstArrayElement  = a.arrayIndex,
+			    .descriptorCount  = 1,
+			    .descriptorType   = VkDescriptorType( a.type ),
+			    .pImageInfo       = 0,
+			    .pBufferInfo      = 0,
+			    .pTexelBufferView = 0,
+			};
+			;
+
+			switch ( a.type ) {
+			case le::DescriptorType::eSampler:
+			case le::DescriptorType::eCombinedImageSampler:
+			case le::DescriptorType::eSampledImage:
+			case le::DescriptorType::eStorageImage:
+			case le::DescriptorType::eInputAttachment:
+				w.pImageInfo = reinterpret_cast<VkDescriptorImageInfo const*>( &a.imageInfo );
+				break;
+			case le::DescriptorType::eUniformTexelBuffer:
+			case le::DescriptorType::eStorageTexelBuffer:
+				w.pTexelBufferView = reinterpret_cast<VkBufferView const*>( &a.texelBufferInfo );
+				break;
+			case le::DescriptorType::eUniformBuffer:
+			case le::DescriptorType::eStorageBuffer:
+			case le::DescriptorType::eUniformBufferDynamic:
+			case le::DescriptorType::eStorageBufferDynamic:
+				w.pBufferInfo = reinterpret_cast<VkDescriptorBufferInfo const*>( &a.bufferInfo );
+				break;
+			case le::DescriptorType::eInlineUniformBlockExt:
+				assert( false && "inline uniform blocks are not yet supported" );
+				break;
+			case le::DescriptorType::eAccelerationStructureNv:
+				assert( false && "NV acceleration structures are not supported anymore. Use KHR acceleration structures." );
+				break;
+			case le::DescriptorType::eAccelerationStructureKhr: {
+				// FIXME: use an arena for that - we don't want to allocate on the free store
+				auto wd = new VkWriteDescriptorSetAccelerationStructureKHR{
+				    .sType                      = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET_ACCELERATION_STRUCTURE_KHR,
+				    .pNext                      = nullptr, // optional
+				    .accelerationStructureCount = 1,
+				    .pAccelerationStructures    = &reinterpret_cast<VkAccelerationStructureKHR const&>( a.accelerationStructureInfo.accelerationStructure ),
+				};
+				w.pNext = wd;
+				write_acceleration_structures.push_back( wd );
+
+			} break;
+			default:
+				assert( false && "Unhandled descriptor Type" );
+			}
+
+			write_descriptor_sets.emplace_back( w );
+		}
+		vkUpdateDescriptorSets( device, uint32_t( write_descriptor_sets.size() ), write_descriptor_sets.data(), 0, nullptr );
+
+		// We must manually delete any WriteDescriptorSetAccelerationStructureKHR objects
+		for ( auto& w : write_acceleration_structures ) {
+			delete ( w );
+		}
+	}
+}
+
+// ----------------------------------------------------------------------
+// Returns a descriptor set which holds descriptors for set `setId` of argument state.
+//
+// If the cache holds a set with identical layout and identical descriptors, we return
+// the cached set - otherwise we allocate a new set from the cache's persistent pools,
+// write descriptors, and store the new set with the cache.
+static VkDescriptorSet descriptor_set_cache_get_or_create( DescriptorSetCache& cache, VkDevice device, ArgumentState const& argumentState, size_t setId, uint64_t frame_number ) {
+
+	uint64_t const resource_generation = cache.resource_generation.load();
+
+	uint64_t key = SpookyHash::Hash64( &resource_generation, sizeof( resource_generation ), 0 );
+	key          = SpookyHash::Hash64( &argumentState.layouts[ setId ], sizeof( VkDescriptorSetLayout ), key );
+
+	for ( auto const& d : argumentState.setData[ setId ] ) {
+		// Hash the same fields which are compared in DescriptorData::operator==
+		key = SpookyHash::Hash64( &d.type, sizeof( d.type ), key );
+		key = SpookyHash::Hash64( &d.bindingNumber, sizeof( d.bindingNumber ), key );
+		key = SpookyHash::Hash64( &d.arrayIndex, sizeof( d.arrayIndex ), key );
+		key = SpookyHash::Hash64( d.data, sizeof( d.data ), key );
+	}
+
+	{
+		std::shared_lock lock( cache.mtx );
+
+		auto it = cache.entries.find( key );
+
+		if ( it != cache.entries.end() ) {
+			it->second.last_used_frame.store( std::max( it->second.last_used_frame.load( std::memory_order_relaxed ), frame_number ), std::memory_order_relaxed );
+			return it->second.set;
+		}
+	}
+
+	// --------| invariant: set was not found - we must allocate and write a new set
+
+	std::unique_lock lock( cache.mtx );
+
+	// Another thread might have created our set since we last looked.
+
+	if ( auto it = cache.entries.find( key ); it != cache.entries.end() ) {
+		it->second.last_used_frame.store( std::max( it->second.last_used_frame.load( std::memory_order_relaxed ), frame_number ), std::memory_order_relaxed );
+		return it->second.set;
+	}
+
+	VkDescriptorSet  descriptorSet = nullptr;
+	VkDescriptorPool pool          = nullptr;
+
+	// Try to allocate from the most recently created pool first - older pools will
+	// only have room if sets have been freed from them.
+	for ( auto p = cache.pools.rbegin(); p != cache.pools.rend() && descriptorSet == nullptr; p++ ) {
+
+		VkDescriptorSetAllocateInfo allocateInfo{
+		    .sType              = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO,
+		    .pNext              = nullptr, // optional
+		    .descriptorPool     = *p,
+		    .descriptorSetCount = 1,
+		    .pSetLayouts        = &argumentState.layouts[ setId ],
+		};
+
+		if ( VK_SUCCESS == vkAllocateDescriptorSets( device, &allocateInfo, &descriptorSet ) ) {
+			pool = *p;
+		} else {
+			descriptorSet = nullptr;
+		}
+	}
+
+	if ( descriptorSet == nullptr ) {
+
+		// All pools are exhausted (or there are no pools yet) - we must add a new pool.
+
+		pool = cache.pools.emplace_back( create_descriptor_pool( device, VK_DESCRIPTOR_POOL_CREATE_FREE_DESCRIPTOR_SET_BIT ) );
+
+		VkDescriptorSetAllocateInfo allocateInfo{
+		    .sType              = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO,
+		    .pNext              = nullptr, // optional
+		    .descriptorPool     = pool,
+		    .descriptorSetCount = 1,
+		    .pSetLayouts        = &argumentState.layouts[ setId ],
+		};
+
+		auto result = vkAllocateDescriptorSets( device, &allocateInfo, &descriptorSet );
+		assert( result == VK_SUCCESS && "failed to allocate descriptor set" );
+	}
+
+	// We must write the set while we still hold the lock, so that no other thread
+	// may bind the set before it has been written.
+	descriptor_set_write( device, descriptorSet, argumentState, setId );
+
+	auto& entry = cache.entries[ key ];
+	entry.set   = descriptorSet;
+	entry.pool  = pool;
+	entry.last_used_frame.store( frame_number, std::memory_order_relaxed );
+
+	return descriptorSet;
+}
+
 static bool updateArguments( const VkDevice&                    device,
                              const VkDescriptorPool&            descriptorPool_,
+                             DescriptorSetCache*                descriptorSetCache, // optional: if set, descriptor sets are fetched from cache
+                             uint64_t                           frame_number,
                              const ArgumentState&               argumentState,
                              std::array<DescriptorSetState, 8>& previousSetData,
                              VkDescriptorSet*                   descriptorSets ) {
@@ -4672,102 +5648,28 @@ static bool updateArguments( const VkDevice&                    device,
 			     previousSetData[ setId ].setData != argumentState.setData[ setId ] ||
 			     previousSetData[ setId ].setLayout != argumentState.layouts[ setId ] ) {
 
-				VkDescriptorSetAllocateInfo allocateInfo{
-				    .sType              = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO,
-				    .pNext              = nullptr, // optional
-				    .descriptorPool     = descriptorPool_,
-				    .descriptorSetCount = 1,
-				    .pSetLayouts        = &argumentState.layouts[ setId ],
-				};
-
-				// -- allocate descriptorSets based on current layout
-				// and place them in the correct position
-
-				auto result = vkAllocateDescriptorSets( device, &allocateInfo, &descriptorSets[ setId ] );
-
-				assert( result == VK_SUCCESS && "failed to allocate descriptor set" );
-
-				if ( /* DISABLES CODE */ ( false ) ) {
-					// I wish that this would work - but it appears that accelerator decriptors cannot be updated using templates.
-					vkUpdateDescriptorSetWithTemplate( device, descriptorSets[ setId ], argumentState.updateTemplates[ setId ], argumentState.setData[ setId ].data() );
-
+				if ( descriptorSetCache ) {
+					// Re-use an identical descriptor set if possible - this saves us from
+					// allocating and updating a new set.
+					descriptorSets[ setId ] = descriptor_set_cache_get_or_create( *descriptorSetCache, device, argumentState, setId, frame_number );
 				} else {
 
-					std::vector<VkWriteDescriptorSet> write_descriptor_sets;
+					VkDescriptorSetAllocateInfo allocateInfo{
+					    .sType              = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO,
+					    .pNext              = nullptr, // optional
+					    .descriptorPool     = descriptorPool_,
+					    .descriptorSetCount = 1,
+					    .pSetLayouts        = &argumentState.layouts[ setId ],
+					};
 
-					// We deliberately allocate write descriptor set acceleration structure objects on the heap,
-					// so that the pointer to the object will not change if and when the vector grows.
-					//
-					// This means that we can hand out copies of pointers from this vector without fear from
-					// within the current scope, but also that we must clean up the contents of the vector
-					// manually before leaving the current scope or else we will leak these objects.
-					std::vector<VkWriteDescriptorSetAccelerationStructureKHR*> write_acceleration_structures;
-
-					write_descriptor_sets.reserve( argumentState.setData[ setId ].size() );
-
-					for ( auto& a : argumentState.setData[ setId ] ) {
-						VkWriteDescriptorSet w{
-						    .sType            = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET,
-						    .pNext            = nullptr, // optional
-						    .dstSet           = descriptorSets[ setId ],
-						    .dstBinding       = a.bindingNumber,
-						    .dstArrayElement  = a.arrayIndex,
-						    .descriptorCount  = 1,
-						    .descriptorType   = VkDescriptorType( a.type ),
-						    .pImageInfo       = 0,
-						    .pBufferInfo      = 0,
-						    .pTexelBufferView = 0,
-						};
-						;
-
-						switch ( a.type ) {
-						case le::DescriptorType::eSampler:
-						case le::DescriptorType::eCombinedImageSampler:
-						case le::DescriptorType::eSampledImage:
-						case le::DescriptorType::eStorageImage:
-						case le::DescriptorType::eInputAttachment:
-							w.pImageInfo = reinterpret_cast<VkDescriptorImageInfo const*>( &a.imageInfo );
-							break;
-						case le::DescriptorType::eUniformTexelBuffer:
-						case le::DescriptorType::eStorageTexelBuffer:
-							w.pTexelBufferView = reinterpret_cast<VkBufferView const*>( &a.texelBufferInfo );
-							break;
-						case le::DescriptorType::eUniformBuffer:
-						case le::DescriptorType::eStorageBuffer:
-						case le::DescriptorType::eUniformBufferDynamic:
-						case le::DescriptorType::eStorageBufferDynamic:
-							w.pBufferInfo = reinterpret_cast<VkDescriptorBufferInfo const*>( &a.bufferInfo );
-							break;
-						case le::DescriptorType::eInlineUniformBlockExt:
-							assert( false && "inline uniform blocks are not yet supported" );
-							break;
-						case le::DescriptorType::eAccelerationStructureNv:
-							assert( false && "NV acceleration structures are not supported anymore. Use KHR acceleration structures." );
-							break;
-						case le::DescriptorType::eAccelerationStructureKhr: {
-							// FIXME: use an arena for that - we don't want to allocate on the free store
-							auto wd = new VkWriteDescriptorSetAccelerationStructureKHR{
-							    .sType                      = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET_ACCELERATION_STRUCTURE_KHR,
-							    .pNext                      = nullptr, // optional
-							    .accelerationStructureCount = 1,
-							    .pAccelerationStructures    = &reinterpret_cast<VkAccelerationStructureKHR const&>( a.accelerationStructureInfo.accelerationStructure ),
-							};
-							w.pNext = wd;
-							write_acceleration_structures.push_back( wd );
+					// -- allocate descriptorSets based on current layout
+					// and place them in the correct position
 
-						} break;
-						default:
-							assert( false && "Unhandled descriptor Type" );
-						}
+					auto result = vkAllocateDescriptorSets( device, &allocateInfo, &descriptorSets[ setId ] );
 
-						write_descriptor_sets.emplace_back( w );
-					}
-					vkUpdateDescriptorSets( device, uint32_t( write_descriptor_sets.size() ), write_descriptor_sets.data(), 0, nullptr );
+					assert( result == VK_SUCCESS && "failed to allocate descriptor set" );
 
-					// We must manually delete any WriteDescriptorSetAccelerationStructureKHR objects
-					for ( auto& w : write_acceleration_structures ) {
-						delete ( w );
-					}
+					descriptor_set_write( device, descriptorSets[ setId ], argumentState, setId );
 				}
 				previousSetData[ setId ].setData   = argumentState.setData[ setId ];
 				previousSetData[ setId ].setLayout = argumentState.layouts[ setId ];
@@ -4990,6 +5892,8 @@ static void backend_acquire_swapchain_resources( le_backend_o* self, size_t fram
 			// try to acquire again by creating a new swapchain from the old one
 
 			le_swapchain_o* new_swapchain = swapchain_i.create_from_old_swapchain( local_swapchain_state.swapchain_data.get_swapchain() );
+			self->object_cache.image_generation++; // new swapchain images might have recycled image handles
+			self->descriptor_set_cache.resource_generation++;
 			local_swapchain_state.swapchain_data.replace_swapchain( new_swapchain );
 
 			VkSemaphoreCreateInfo const create_info = {
@@ -5120,1877 +6024,2051 @@ inline DescriptorData* find_descriptor_with_binding_number_and_array_idx(
 }
 
 // ----------------------------------------------------------------------
-// Decode commandStream for each pass (may happen in parallel)
-// translate into vk specific commands.
-static void backend_process_frame( le_backend_o* self, size_t frameIndex ) {
-
+// -- Collect command buffers for each queue submission by testing against queue submission key.
+//    if a pass's affinity matches the submission key, it belongs to that particular queue submission.
+// -- And collect pass indices per queue submission
+//
+// Note that this only depends on frame.passes, and frame.queue_submission_keys,
+// and does not touch the device.
+static void frame_build_queue_submission_data( BackendFrameData& frame, bool needs_to_collect_root_pass_names ) {
 	ZoneScoped;
-	static auto logger = LeLog( LOGGER_LABEL );
 
-	if ( LE_PRINT_DEBUG_MESSAGES ) {
-		logger.debug( "** Process Frame #%8d **", frameIndex );
+	size_t num_invocation_keys = frame.queue_submission_keys.size();
+
+	for ( size_t i = 0; i != num_invocation_keys; i++ ) {
+
+		auto const& key = frame.queue_submission_keys[ i ];
+
+		BackendFrameData::PerQueueSubmissionData submission_data{};
+		submission_data.key = key;
+
+		for ( size_t pi = 0; pi != frame.passes.size(); pi++ ) {
+
+			auto const& pass = frame.passes[ pi ];
+
+			if ( key & pass.root_passes_affinity ) {
+				submission_data.queue_flags |= VkQueueFlags( pass.type ); // Accumulate queue flags over submission - queue capabilities must be superset
+				submission_data.pass_indices.push_back( uint32_t( pi ) );
+			}
+		}
+
+		if ( needs_to_collect_root_pass_names ) {
+			for ( size_t j = 0; j != frame.debug_root_passes_names.size(); j++ ) {
+				if ( key & ( uint64_t( 1 ) << j ) ) {
+					if ( !submission_data.debug_root_passes_names.empty() ) {
+						submission_data.debug_root_passes_names.append( " | " );
+					}
+					submission_data.debug_root_passes_names.append( frame.debug_root_passes_names[ j ] );
+				}
+			}
+		}
+
+		if ( !submission_data.pass_indices.empty() ) {
+			frame.queue_submission_data.push_back( submission_data );
+		}
+	}
+
+	assert( num_invocation_keys == frame.queue_submission_data.size() && "must have one submission data element per invocaton key" );
+}
+
+// ----------------------------------------------------------------------
+// Returns true if explicit sync op `op` requires a barrier - in which case
+// `stateInitial` and `stateFinal` are set to the states before, and after
+// the barrier.
+static bool frame_explicit_sync_op_needs_barrier( BackendFrameData const& frame, ExplicitSyncOp const& op, ResourceState const** stateInitial, ResourceState const** stateFinal ) {
+
+	if ( op.active == false ) {
+		return false;
 	}
 
+	// ---------| invariant: barrier is active.
+
+	auto const& syncChain = frame.syncChainTable.at( op.resource );
+
+	*stateInitial = &syncChain[ op.sync_chain_offset_initial ];
+	*stateFinal   = &syncChain[ op.sync_chain_offset_final ];
+
+	return **stateInitial != **stateFinal;
+}
+
+// ----------------------------------------------------------------------
+// Translates the command stream of pass at `passIndex` into Vulkan commands, which
+// get recorded into `cmd`.
+//
+// Each pass owns its command stream and its descriptor pool, which means that
+// passes may be translated concurrently, as long as no two passes record into
+// command buffers which were allocated from the same command pool.
+static void backend_translate_pass( le_backend_o* self, BackendFrameData& frame, uint32_t passIndex, uint32_t queue_idx, VkCommandBuffer cmd ) {
+
+	ZoneScoped;
+	static auto logger = LeLog( LOGGER_LABEL );
+
 	using namespace le_renderer;   // for encoder
 	using namespace le_backend_vk; // for device
 
-	auto& frame = self->mFrames[ frameIndex ];
-
 	// Only insert debug labels iff validation layers are active - otherwise we will get errors.
 	// Debug labels are useful for RenderDoc, for example.
 	bool const SHOULD_INSERT_DEBUG_LABELS = self->instance->is_using_validation_layers;
 
 	VkDevice device = self->device->getVkDevice();
 
-	static_assert( sizeof( VkViewport ) == sizeof( le::Viewport ), "Viewport data size must be same in vk and le" );
-	static_assert( sizeof( VkRect2D ) == sizeof( le::Rect2D ), "Rect2D data size must be same in vk and le" );
-
 	static auto maxVertexInputBindings = vk_device_i.get_vk_physical_device_properties( *self->device )->limits.maxVertexInputBindings;
 
-	bool needs_to_collect_root_pass_names = frame.must_create_queues_dot_graph; // only collect root pass names when these are needed, for example in order to create dot graphs or debug printouts
+	auto& pass           = frame.passes[ passIndex ];
+	auto& descriptorPool = frame.descriptorPools[ passIndex ];
 
-	{
+	// Descriptor sets are re-used within and across frames via the descriptor set
+	// cache - unless caching is disabled, in which case we allocate sets from the
+	// frame-local descriptor pool for this pass.
+	LE_SETTING( bool, LE_SETTING_BACKEND_CACHE_DESCRIPTOR_SETS, true );
+	DescriptorSetCache* descriptorSetCache = *LE_SETTING_BACKEND_CACHE_DESCRIPTOR_SETS ? &self->descriptor_set_cache : nullptr;
 
-		// -- Collect command buffers for each queue submission by testing against queue submission key.
-		//    if a pass's affinity matches the submission key, it belongs to that particular queue submission.
-		// -- And collect pass indices per queue submission
+	std::array<VkClearValue, 16> clearValues{};
 
-		size_t num_invocation_keys = frame.queue_submission_keys.size();
+	// create frame buffer, based on swapchain and renderpass
 
-		for ( size_t i = 0; i != num_invocation_keys; i++ ) {
+	{
+		VkCommandBufferBeginInfo info = {
+		    .sType            = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO,
+		    .pNext            = nullptr,                                     // optional
+		    .flags            = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT, // optional
+		    .pInheritanceInfo = 0,                                           // optional
+		};
 
-			auto const& key = frame.queue_submission_keys[ i ];
+		vkBeginCommandBuffer( cmd, &info );
+	}
 
-			BackendFrameData::PerQueueSubmissionData submission_data{};
+	if ( SHOULD_INSERT_DEBUG_LABELS ) {
+		VkDebugUtilsLabelEXT labelInfo{
+		    .sType      = VK_STRUCTURE_TYPE_DEBUG_UTILS_LABEL_EXT,
+		    .pNext      = nullptr, // optional
+		    .pLabelName = pass.debugName,
+		    .color      = {},
+		};
 
-			for ( size_t pi = 0; pi != frame.passes.size(); pi++ ) {
+		static constexpr auto LE_COLOUR_LIGHTBLUE    = hex_rgba_to_float_colour( 0x61BBEFFF );
+		static constexpr auto LE_COLOUR_GREENY_BLUE  = hex_rgba_to_float_colour( 0x4EC9B0FF );
+		static constexpr auto LE_COLOUR_BRICK_ORANGE = hex_rgba_to_float_colour( 0xCE4B0EFF );
+		static constexpr auto LE_COLOUR_PALE_PEACH   = hex_rgba_to_float_colour( 0xFFDBA3FF );
 
-				auto const& pass = frame.passes[ pi ];
+		switch ( pass.type ) {
+		case le::QueueFlagBits::eCompute:
+			memcpy( labelInfo.color, LE_COLOUR_LIGHTBLUE.data(), sizeof( float ) * 4 );
+			break;
+		case le::QueueFlagBits::eGraphics:
+			memcpy( labelInfo.color, LE_COLOUR_GREENY_BLUE.data(), sizeof( float ) * 4 );
+			break;
+		case le::QueueFlagBits::eTransfer:
+			memcpy( labelInfo.color, LE_COLOUR_BRICK_ORANGE.data(), sizeof( float ) * 4 );
+			break;
+		default:
+			break;
+		}
 
-				if ( key & pass.root_passes_affinity ) {
-					submission_data.queue_flags |= VkQueueFlags( pass.type ); // Accumulate queue flags over submission - queue capabilities must be superset
-					submission_data.pass_indices.push_back( uint32_t( pi ) );
-				}
-			}
+		vkCmdBeginDebugUtilsLabelEXT( cmd, &labelInfo );
+	}
 
-			if ( needs_to_collect_root_pass_names ) {
-				for ( size_t j = 0; j != frame.debug_root_passes_names.size(); j++ ) {
-					if ( key & ( uint64_t( 1 ) << j ) ) {
-						if ( !submission_data.debug_root_passes_names.empty() ) {
-							submission_data.debug_root_passes_names.append( " | " );
-						}
-						submission_data.debug_root_passes_names.append( frame.debug_root_passes_names[ j ] );
-					}
-				}
-			}
+	{
 
-			if ( !submission_data.pass_indices.empty() ) {
-				frame.queue_submission_data.push_back( submission_data );
-			}
+		if ( LE_PRINT_DEBUG_MESSAGES ) {
+			logger.info( "*** Frame %d *** Queue %d *** Renderpass '%s'", frame.frameNumber, queue_idx, pass.debugName );
 		}
 
-		assert( num_invocation_keys == frame.queue_submission_data.size() && "must have one submission data element per invocaton key" );
+		// -- Issue sync barriers for all resources which require explicit sync.
+		//
+		// We must to this here, as the spec requires barriers to happen
+		// before renderpass begin.
+		//
+		// We collect transitions for all explicit sync ops of this pass, and
+		// issue them as a single batch - see le_barrier_batch.h
+		//
+		std::vector<le_barrier_transition_t> transitions;
+		transitions.reserve( pass.explicit_sync_ops.size() );
 
-		// -- Control that resources may only be used by the same queue family per-frame.
-		// we adjust for this by making the queue requirements a superset of all resource queue usages,
-		// and accumulating all queue usages per-resource first.
+		for ( auto const& op : pass.explicit_sync_ops ) {
+			// fill in sync op
 
-		if ( self->must_track_resources_queue_family_ownership ) {
-			// We only must do this if we have multiple queue families active
-			// as this can get pretty expensive if there are many resources flying around.
+			ResourceState const* pStateInitial = nullptr;
+			ResourceState const* pStateFinal   = nullptr;
 
-			// We do this to prevent a situation where a resource is claimed by two or more queue families
-			// Ideally, this
+			if ( frame_explicit_sync_op_needs_barrier( frame, op, &pStateInitial, &pStateFinal ) ) {
+				// we must issue an image barrier
 
-			// for each resource, accumulate all queue type flags that it gets used with over all submissions
+				auto const& stateInitial = *pStateInitial;
+				auto const& stateFinal   = *pStateFinal;
 
-			std::unordered_map<le_resource_handle, VkQueueFlags> resource_queue_flags;
+				if ( LE_PRINT_DEBUG_MESSAGES ) {
 
-			for ( auto const& qs : frame.queue_submission_data ) {
-				for ( auto const& pi : qs.pass_indices ) {
-					for ( auto const& r : frame.passes[ pi ].resources ) {
-						resource_queue_flags[ r ] |= qs.queue_flags;
-					}
-				}
-			}
+					// --------| invariant: barrier is active.
 
-			// now accumulate submission's queue flags based on the queue flags that all its resources have
+					// print out sync chain for sampled image
+					logger.info( "\t Explicit Barrier for: %s (s: %d)", op.resource->data->debug_name, 1 << op.resource->data->num_samples );
+					logger.info( "\t % 3s : % 30s : % 30s : % 10s", "#", "visible_access", "write_stage", "layout" );
 
-			for ( auto& qs : frame.queue_submission_data ) {
-				for ( auto const& pi : qs.pass_indices ) {
-					VkQueueFlags flags = qs.queue_flags;
-					for ( auto const& r : frame.passes[ pi ].resources ) {
-						flags |= resource_queue_flags.at( r );
+					auto const& syncChain = frame.syncChainTable.at( op.resource );
+
+					for ( size_t i = op.sync_chain_offset_initial; i <= op.sync_chain_offset_final; i++ ) {
+						auto const& s = syncChain[ i ];
+						logger.info( "\t % 3d : % 30s : % 30s : % 10s", i,
+						             to_string_vk_access_flags2( s.visible_access ).c_str(),
+						             to_string_vk_pipeline_stage_flags2( s.stage ).c_str(),
+						             to_str_vk_image_layout( s.layout ) );
 					}
-					qs.queue_flags = flags;
 				}
-			}
-		}
 
-		{
-			/// Assign queues to each submission:
-			///
-			/// we must have a unique mapping from queue_flags to queue family.
-			///
-			/// from this, we can then go through all queues of the queue family
-			/// and pick the queue with the least submissions.
-			///
-			std::vector<uint32_t> num_submissions_per_queue( num_invocation_keys, 0 );
-			for ( size_t i = 0; i != num_invocation_keys; i++ ) {
+				auto dstImage = frame_data_get_image_from_le_resource_id( &frame, static_cast<le_image_resource_handle>( op.resource ) );
 
-				auto const& queues = self->queues;
-				auto const& flags  = frame.queue_submission_data[ i ].queue_flags;
+				transitions.push_back( {
+				    .resource = reinterpret_cast<uint64_t>( dstImage ),
+				    .is_image = true,
+				    .before   = { uint64_t( stateInitial.stage ), uint64_t( stateInitial.visible_access ), uint32_t( stateInitial.layout ) },
+				    .after    = { uint64_t( stateFinal.stage ), uint64_t( stateFinal.visible_access ), uint32_t( stateFinal.layout ) },
+				} );
+			}
+		} // end for all explicit sync ops.
 
-				int      matching_queue          = -1;
-				uint32_t lowest_submission_count = uint32_t( ~0 );
+		if ( !transitions.empty() ) {
 
-				uint32_t matching_queue_family_index = backend_find_queue_family_index_from_requirements( self, flags );
+			le_barrier_batch_t batch;
+			le_barrier_batch_build( &batch, transitions.data(), transitions.size(), ANY_WRITE_VK_ACCESS_2_FLAGS );
 
-				// try to find an exact match with the lowest submissions to it
-				for ( uint32_t j = 0; j != queues.size(); j++ ) {
-					if ( queues[ j ]->queue_family_index == matching_queue_family_index ) {
-						// all flags are contained in q.queue_flags
-						if ( num_submissions_per_queue[ j ] < lowest_submission_count ) {
-							matching_queue          = j;
-							lowest_submission_count = num_submissions_per_queue[ j ];
-						}
-					}
-				}
+			if ( LE_PRINT_DEBUG_MESSAGES ) {
+				logger.info( "\t Barrier batch: %zu transitions -> %zu image barriers, %d memory barriers, %zu dropped",
+				             transitions.size(), batch.image_barriers.size(), batch.has_memory_barrier ? 1 : 0, batch.num_dropped );
+			}
 
-				if ( matching_queue == -1 ) {
-					le::Log( LOGGER_LABEL ).error( "Could not find matching queue with capability: %s\n"
-					                               "This could be caused by one or more queue families claiming ownership of the same resource.",
-					                               to_string_vk_queue_flags( flags ).c_str() );
-				}
+			// happens-before: if no stage was specified, we must wait for top of pipe.
+			auto get_src_stage = []( uint64_t stage ) -> VkPipelineStageFlags2 {
+				return stage == 0 ? VK_PIPELINE_STAGE_2_TOP_OF_PIPE_BIT : VkPipelineStageFlags2( stage );
+			};
 
-				assert( matching_queue != -1 && "must have found matching queue" );
+			VkMemoryBarrier2 memoryBarrier{
+			    .sType         = VK_STRUCTURE_TYPE_MEMORY_BARRIER_2,
+			    .pNext         = nullptr,
+			    .srcStageMask  = get_src_stage( batch.memory_barrier.src_stage ),
+			    .srcAccessMask = batch.memory_barrier.src_access,
+			    .dstStageMask  = batch.memory_barrier.dst_stage,
+			    .dstAccessMask = batch.memory_barrier.dst_access,
+			};
 
-				num_submissions_per_queue[ matching_queue ]++;
+			std::vector<VkImageMemoryBarrier2> imageBarriers;
+			imageBarriers.reserve( batch.image_barriers.size() );
+
+			for ( auto const& b : batch.image_barriers ) {
+				imageBarriers.push_back( {
+				    .sType               = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER_2,
+				    .pNext               = nullptr,
+				    .srcStageMask        = get_src_stage( b.masks.src_stage ), // happens-before
+				    .srcAccessMask       = b.masks.src_access,                 // make available memory update from operation (in case it was a write operation, otherwise don't wait)
+				    .dstStageMask        = b.masks.dst_stage,                  // happens-after
+				    .dstAccessMask       = b.masks.dst_access,                 // make visible
+				    .oldLayout           = VkImageLayout( b.old_layout ),
+				    .newLayout           = VkImageLayout( b.new_layout ),
+				    .srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+				    .dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+				    .image               = reinterpret_cast<VkImage>( b.resource ),
+				    .subresourceRange    = LE_IMAGE_SUBRESOURCE_RANGE_ALL_MIPLEVELS,
+				} );
+			}
 
-				frame.queue_submission_data[ i ].queue_idx = matching_queue;
+			if ( !batch.empty() ) {
+
+				VkDependencyInfo dependencyInfo = {
+				    .sType                    = VK_STRUCTURE_TYPE_DEPENDENCY_INFO,
+				    .pNext                    = nullptr,                            // optional
+				    .dependencyFlags          = 0,                                  // optional
+				    .memoryBarrierCount       = batch.has_memory_barrier ? 1u : 0u, // optional
+				    .pMemoryBarriers          = &memoryBarrier,
+				    .bufferMemoryBarrierCount = 0, // optional
+				    .pBufferMemoryBarriers    = 0,
+				    .imageMemoryBarrierCount  = uint32_t( imageBarriers.size() ), // optional
+				    .pImageMemoryBarriers     = imageBarriers.data(),
+				};
+
+				vkCmdPipelineBarrier2( cmd, &dependencyInfo );
 			}
 		}
+	}
 
-		// for each submission data, allocate pool from the correct queue
+	// Draw passes must begin by opening a Renderpass context.
+	if ( pass.type == le::QueueFlagBits::eGraphics && pass.renderPass ) {
 
-		for ( auto& data : frame.queue_submission_data ) {
-			// this submission has passes
-			// find available command pool which has the correct queue family.
+		for ( uint32_t i = 0; i != ( pass.numColorAttachments + pass.numDepthStencilAttachments ); ++i ) {
+			clearValues[ i ] = reinterpret_cast<VkClearValue&>( pass.attachments[ i ].clearValue );
+		}
 
-			data.command_pool = backend_frame_data_produce_command_pool( frame, self->queues[ data.queue_idx ]->queue_family_index, self->device->getVkDevice() );
-			{
-				VkCommandBufferAllocateInfo info = {
-				    .sType              = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO,
-				    .pNext              = nullptr, // optional
-				    .commandPool        = data.command_pool->pool,
-				    .level              = VK_COMMAND_BUFFER_LEVEL_PRIMARY,
-				    .commandBufferCount = uint32_t( data.pass_indices.size() ),
-				};
-
-				data.command_pool->buffers.resize( info.commandBufferCount );
-				vkAllocateCommandBuffers( device, &info, data.command_pool->buffers.data() );
-			}
-		}
+		VkRenderPassBeginInfo renderPassBeginInfo{
+		    .sType       = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO,
+		    .pNext       = nullptr, // optional
+		    .renderPass  = pass.renderPass,
+		    .framebuffer = pass.framebuffer,
+		    .renderArea  = {
+		         .offset = { 0, 0 },
+		         .extent = { pass.width, pass.height },
+                    },
+		    .clearValueCount = uint32_t( pass.numColorAttachments + pass.numDepthStencilAttachments ), // optional
+		    .pClearValues    = clearValues.data(),
+		};
 
-		if ( LE_PRINT_DEBUG_MESSAGES ) {
-			logger.info( "Listing queue batches and their queue affinity:" );
-			int i = 0;
-			for ( auto const& qf : frame.queue_submission_data ) {
-				logger.info( "#%i, [%-50s]", i, to_string_vk_queue_flags( qf.queue_flags ).c_str() );
-				i++;
-			}
-			logger.info( "" );
-		}
+		vkCmdBeginRenderPass( cmd, &renderPassBeginInfo, VK_SUBPASS_CONTENTS_INLINE );
 	}
 
-	for ( auto const& submission : frame.queue_submission_data ) {
-		std::array<VkClearValue, 16> clearValues{};
-		// split graph into separate submissions by filtering by submission key
-		// accumulate pass types to find out the needed queue flags for the
-		//
-		// create vectors of pass indices per submission
-		// then assign each submission based on best-match to queues
-		// submit submissions to queues in-order.
+	// -- Translate intermediary command stream data to api-native instructions
 
-		// TODO: (parallel for)
-		// note that access to any caches when creating pipelines and layouts and descriptorsets must be
-		// mutex-controlled when processing happens concurrently.
-		uint32_t buffer_index = 0;
-		for ( auto const& passIndex : submission.pass_indices ) {
+	le_command_stream_t* commandStream = nullptr;
+	size_t               dataSize      = 0;
+	size_t               numCommands   = 0;
+	size_t               commandIndex  = 0;
+	uint32_t             subpassIndex  = 0;
 
-			auto& pass           = frame.passes[ passIndex ];
-			auto& cmd            = submission.command_pool->buffers[ buffer_index++ ]; // note that we post-increment, so that next iteration will get next command buffer.
-			auto& descriptorPool = frame.descriptorPools[ passIndex ];
+	VkPipelineLayout currentPipelineLayout                          = nullptr;
+	VkDescriptorSet  descriptorSets[ LE_MAX_BOUND_DESCRIPTOR_SETS ] = {}; // currently bound descriptorSets (allocated from pool, therefore we must not worry about freeing, and may re-use freely)
 
-			// create frame buffer, based on swapchain and renderpass
+	// We store currently bound descriptors so that we only allocate new DescriptorSets
+	// if the descriptors really change. With dynamic descriptors, it is very likely
+	// that we don't need to allocate new descriptors, as the same descriptors are used
+	// for different accessors, only with different dynamic binding offsets.
+	//
+	//
+	std::array<DescriptorSetState, 8> previousSetState; // currently bound descriptorSetLayout+Data for each set
+	ArgumentState                     argumentState{};  //
+	RtxState                          rtx_state{};      // used to keep track of shader binding tables bound with rtx pipelines.
 
-			{
-				VkCommandBufferBeginInfo info = {
-				    .sType            = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO,
-				    .pNext            = nullptr,                                     // optional
-				    .flags            = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT, // optional
-				    .pInheritanceInfo = 0,                                           // optional
-				};
+	static le_buffer_resource_handle LE_RTX_SCRATCH_BUFFER_HANDLE = LE_BUF_RESOURCE( "le_rtx_scratch_buffer_handle" ); // opaque handle for rtx scratch buffer
 
-				vkBeginCommandBuffer( cmd, &info );
-			}
+	if ( pass.encoder ) {
+		encoder_i.get_encoded_data( pass.encoder, &commandStream, &dataSize, &numCommands );
+	} else {
+		// This is legit behaviour for draw passes which are used only to clear attachments,
+		// in which case they don't need to include any draw commands.
+	}
 
-			if ( SHOULD_INSERT_DEBUG_LABELS ) {
-				VkDebugUtilsLabelEXT labelInfo{
-				    .sType      = VK_STRUCTURE_TYPE_DEBUG_UTILS_LABEL_EXT,
-				    .pNext      = nullptr, // optional
-				    .pLabelName = pass.debugName,
-				    .color      = {},
-				};
+	if ( commandStream != nullptr && numCommands > 0 ) {
 
-				static constexpr auto LE_COLOUR_LIGHTBLUE    = hex_rgba_to_float_colour( 0x61BBEFFF );
-				static constexpr auto LE_COLOUR_GREENY_BLUE  = hex_rgba_to_float_colour( 0x4EC9B0FF );
-				static constexpr auto LE_COLOUR_BRICK_ORANGE = hex_rgba_to_float_colour( 0xCE4B0EFF );
-				static constexpr auto LE_COLOUR_PALE_PEACH   = hex_rgba_to_float_colour( 0xFFDBA3FF );
+		le_pipeline_manager_o* pipelineManager = encoder_i.get_pipeline_manager( pass.encoder );
+		assert( pipelineManager );
 
-				switch ( pass.type ) {
-				case le::QueueFlagBits::eCompute:
-					memcpy( labelInfo.color, LE_COLOUR_LIGHTBLUE.data(), sizeof( float ) * 4 );
-					break;
-				case le::QueueFlagBits::eGraphics:
-					memcpy( labelInfo.color, LE_COLOUR_GREENY_BLUE.data(), sizeof( float ) * 4 );
-					break;
-				case le::QueueFlagBits::eTransfer:
-					memcpy( labelInfo.color, LE_COLOUR_BRICK_ORANGE.data(), sizeof( float ) * 4 );
-					break;
-				default:
-					break;
-				}
+		std::vector<VkBuffer>         vertexInputBindings( maxVertexInputBindings, nullptr );
+		le_command_stream_t::Block*   dataBlock = nullptr;                               // block which holds current command
+		void*                         dataIt    = commandStream->begin_read( &dataBlock ); // current command
+		le_pipeline_and_layout_info_t currentPipeline{};
 
-				vkCmdBeginDebugUtilsLabelEXT( cmd, &labelInfo );
-			}
+		while ( commandIndex != numCommands ) {
 
-			{
+			auto header = static_cast<le::CommandHeader*>( dataIt );
 
-				if ( LE_PRINT_DEBUG_MESSAGES ) {
-					logger.info( "*** Frame %d *** Queue %d *** Renderpass '%s'", frame.frameNumber, submission.queue_idx, pass.debugName );
-				}
+			if ( /* DISABLES CODE */ ( false ) ) {
+				// Print the command stream to stdout.
+				debug_print_command( dataIt );
+			}
 
-				// -- Issue sync barriers for all resources which require explicit sync.
-				//
-				// We must to this here, as the spec requires barriers to happen
-				// before renderpass begin.
-				//
-				for ( auto const& op : pass.explicit_sync_ops ) {
-					// fill in sync op
+			switch ( header->info.type ) {
 
-					if ( op.active == false ) {
-						continue;
-					}
+			case le::CommandType::eBindGraphicsPipeline: {
+				auto* le_cmd = static_cast<le::CommandBindGraphicsPipeline*>( dataIt );
 
-					// ---------| invariant: barrier is active.
+				if ( pass.type == le::QueueFlagBits::eGraphics ) {
+					// at this point, a valid renderpass must be bound
 
-					auto const& syncChain = frame.syncChainTable[ op.resource ];
+					using namespace le_backend_vk;
+					// -- potentially compile and create pipeline here, based on current pass and subpass
+					auto requestedPipeline = le_pipeline_manager_i.produce_graphics_pipeline( pipelineManager, le_cmd->info.gpsoHandle, pass, subpassIndex );
 
-					auto const& stateInitial = syncChain[ op.sync_chain_offset_initial ];
-					auto const& stateFinal   = syncChain[ op.sync_chain_offset_final ];
+					if ( /* DISABLES CODE */ ( false ) ) {
 
-					if ( stateInitial != stateFinal ) {
-						// we must issue an image barrier
+						// Print pipeline debug info when a new pipeline gets bound.
 
-						if ( LE_PRINT_DEBUG_MESSAGES ) {
+						logger.info( "Requested pipeline: %x ", le_cmd->info.gpsoHandle );
+						debug_print_le_pipeline_layout_info( &requestedPipeline.layout_info );
+					}
 
-							// --------| invariant: barrier is active.
+					if ( !is_equal( currentPipeline, requestedPipeline ) ) {
+						// update current pipeline
+						currentPipeline = requestedPipeline;
+						// -- grab current pipeline layout from cache
+						currentPipelineLayout = le_pipeline_manager_i.get_pipeline_layout( pipelineManager, currentPipeline.layout_info.pipeline_layout_key );
+						// -- update pipelineData - that's the data values for all descriptors which are currently bound
 
-							// print out sync chain for sampled image
-							logger.info( "\t Explicit Barrier for: %s (s: %d)", op.resource->data->debug_name, 1 << op.resource->data->num_samples );
-							logger.info( "\t % 3s : % 30s : % 30s : % 10s", "#", "visible_access", "write_stage", "layout" );
+						argumentState.setCount = uint32_t( currentPipeline.layout_info.set_layout_count );
+						argumentState.binding_infos.clear();
 
-							auto const& syncChain = frame.syncChainTable.at( op.resource );
+						// -- reset dynamic offset count
+						argumentState.dynamicOffsetCount = 0;
 
-							for ( size_t i = op.sync_chain_offset_initial; i <= op.sync_chain_offset_final; i++ ) {
-								auto const& s = syncChain[ i ];
-								logger.info( "\t % 3d : % 30s : % 30s : % 10s", i,
-								             to_string_vk_access_flags2( s.visible_access ).c_str(),
-								             to_string_vk_pipeline_stage_flags2( s.stage ).c_str(),
-								             to_str_vk_image_layout( s.layout ) );
-							}
-						}
+						// let's create descriptorData vector based on current bindings-
+						for ( size_t setId = 0; setId != argumentState.setCount; ++setId ) {
 
-						auto dstImage = frame_data_get_image_from_le_resource_id( &frame, static_cast<le_image_resource_handle>( op.resource ) );
+							// look up set layout info via set layout key
+							auto const& set_layout_key = currentPipeline.layout_info.set_layout_keys[ setId ];
 
-						VkImageMemoryBarrier2 imageLayoutTransfer{
-						    .sType               = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER_2,
-						    .pNext               = nullptr,
-						    .srcStageMask        = uint64_t( stateInitial.stage ) == 0 ? VK_PIPELINE_STAGE_2_TOP_OF_PIPE_BIT : stateInitial.stage, // happens-before
-						    .srcAccessMask       = ( stateInitial.visible_access & ANY_WRITE_VK_ACCESS_2_FLAGS ),                                  // make available memory update from operation (in case it was a write operation, otherwise don't wait)
-						    .dstStageMask        = stateFinal.stage,                                                                               // happens-after
-						    .dstAccessMask       = stateFinal.visible_access,                                                                      // make visible
-						    .oldLayout           = stateInitial.layout,
-						    .newLayout           = stateFinal.layout,
-						    .srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
-						    .dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
-						    .image               = dstImage,
-						    .subresourceRange    = LE_IMAGE_SUBRESOURCE_RANGE_ALL_MIPLEVELS,
-						};
+							auto const setLayoutInfo = le_pipeline_manager_i.get_descriptor_set_layout( pipelineManager, set_layout_key );
 
-						VkDependencyInfo dependencyInfo = {
-						    .sType                    = VK_STRUCTURE_TYPE_DEPENDENCY_INFO,
-						    .pNext                    = nullptr, // optional
-						    .dependencyFlags          = 0,       // optional
-						    .memoryBarrierCount       = 0,       // optional
-						    .pMemoryBarriers          = 0,
-						    .bufferMemoryBarrierCount = 0, // optional
-						    .pBufferMemoryBarriers    = 0,
-						    .imageMemoryBarrierCount  = 1, // optional
-						    .pImageMemoryBarriers     = &imageLayoutTransfer,
-						};
+							auto& setData = argumentState.setData[ setId ];
 
-						vkCmdPipelineBarrier2( cmd, &dependencyInfo );
-					}
-				} // end for all explicit sync ops.
-			}
+							argumentState.layouts[ setId ]         = setLayoutInfo->vk_descriptor_set_layout;
+							argumentState.updateTemplates[ setId ] = setLayoutInfo->vk_descriptor_update_template;
 
-			// Draw passes must begin by opening a Renderpass context.
-			if ( pass.type == le::QueueFlagBits::eGraphics && pass.renderPass ) {
+							setData.clear();
+							setData.reserve( setLayoutInfo->binding_info.size() );
 
-				for ( uint32_t i = 0; i != ( pass.numColorAttachments + pass.numDepthStencilAttachments ); ++i ) {
-					clearValues[ i ] = reinterpret_cast<VkClearValue&>( pass.attachments[ i ].clearValue );
-				}
+							for ( auto b : setLayoutInfo->binding_info ) {
 
-				VkRenderPassBeginInfo renderPassBeginInfo{
-				    .sType       = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO,
-				    .pNext       = nullptr, // optional
-				    .renderPass  = pass.renderPass,
-				    .framebuffer = pass.framebuffer,
-				    .renderArea  = {
-				         .offset = { 0, 0 },
-				         .extent = { pass.width, pass.height },
-                    },
-				    .clearValueCount = uint32_t( pass.numColorAttachments + pass.numDepthStencilAttachments ), // optional
-				    .pClearValues    = clearValues.data(),
-				};
-
-				vkCmdBeginRenderPass( cmd, &renderPassBeginInfo, VK_SUBPASS_CONTENTS_INLINE );
-			}
-
-			// -- Translate intermediary command stream data to api-native instructions
+								if ( b.count == 0 ) {
+									// If this is a placeholder binding, we continue early -
+									// this means that this binding will not be added to argumentState.
+									continue;
+								}
 
-			void*    commandStream = nullptr;
-			size_t   dataSize      = 0;
-			size_t   numCommands   = 0;
-			size_t   commandIndex  = 0;
-			uint32_t subpassIndex  = 0;
+								// ----------| invariant: b.count > 0
 
-			VkPipelineLayout currentPipelineLayout                          = nullptr;
-			VkDescriptorSet  descriptorSets[ LE_MAX_BOUND_DESCRIPTOR_SETS ] = {}; // currently bound descriptorSets (allocated from pool, therefore we must not worry about freeing, and may re-use freely)
+								// add an entry for each array element with this binding to setData
+								for ( size_t arrayIndex = 0; arrayIndex != b.count; arrayIndex++ ) {
+									DescriptorData descriptorData{};
 
-			// We store currently bound descriptors so that we only allocate new DescriptorSets
-			// if the descriptors really change. With dynamic descriptors, it is very likely
-			// that we don't need to allocate new descriptors, as the same descriptors are used
-			// for different accessors, only with different dynamic binding offsets.
-			//
-			//
-			std::array<DescriptorSetState, 8> previousSetState; // currently bound descriptorSetLayout+Data for each set
-			ArgumentState                     argumentState{};  //
-			RtxState                          rtx_state{};      // used to keep track of shader binding tables bound with rtx pipelines.
+									descriptorData.type          = b.type;
+									descriptorData.bindingNumber = uint32_t( b.binding );
+									descriptorData.arrayIndex    = uint32_t( arrayIndex );
 
-			static le_buffer_resource_handle LE_RTX_SCRATCH_BUFFER_HANDLE = LE_BUF_RESOURCE( "le_rtx_scratch_buffer_handle" ); // opaque handle for rtx scratch buffer
+									if ( b.type == le::DescriptorType::eStorageBuffer ||
+									     b.type == le::DescriptorType::eUniformBuffer ||
+									     b.type == le::DescriptorType::eStorageBufferDynamic ||
+									     b.type == le::DescriptorType::eUniformBufferDynamic ) {
 
-			if ( pass.encoder ) {
-				encoder_i.get_encoded_data( pass.encoder, &commandStream, &dataSize, &numCommands );
-			} else {
-				// This is legit behaviour for draw passes which are used only to clear attachments,
-				// in which case they don't need to include any draw commands.
-			}
+										descriptorData.bufferInfo.range = b.range;
+									}
 
-			if ( commandStream != nullptr && numCommands > 0 ) {
+									setData.emplace_back( descriptorData );
+								}
 
-				le_pipeline_manager_o* pipelineManager = encoder_i.get_pipeline_manager( pass.encoder );
-				assert( pipelineManager );
+								if ( b.type == le::DescriptorType::eStorageBufferDynamic ||
+								     b.type == le::DescriptorType::eUniformBufferDynamic ) {
+									assert( b.count != 0 ); // count cannot be 0
 
-				std::vector<VkBuffer>         vertexInputBindings( maxVertexInputBindings, nullptr );
-				void*                         dataIt = commandStream;
-				le_pipeline_and_layout_info_t currentPipeline{};
+									// store dynamic offset index for this element
+									b.dynamic_offset_idx = argumentState.dynamicOffsetCount;
 
-				while ( commandIndex != numCommands ) {
+									// increase dynamic offset count by number of elements in this binding
+									argumentState.dynamicOffsetCount += b.count;
+								}
 
-					auto header = static_cast<le::CommandHeader*>( dataIt );
+								// add this binding to list of current bindings
+								argumentState.binding_infos.push_back( b );
+							}
+						}
 
-					if ( /* DISABLES CODE */ ( false ) ) {
-						// Print the command stream to stdout.
-						debug_print_command( dataIt );
+						if ( currentPipeline.pipeline ) {
+							vkCmdBindPipeline( cmd, VK_PIPELINE_BIND_POINT_GRAPHICS, currentPipeline.pipeline );
+						} else {
+							// Pipeline is being compiled in the background: we skip any draws until it is ready.
+						}
+					} else {
+						// Re-using previously bound pipeline. We may keep argumentState state as it is.
 					}
 
-					switch ( header->info.type ) {
+					// -- Reset dynamic offsets in argumentState:
+					// we do this regardless of whether pipeline was already bound,
+					// because binding a pipeline should always reset parameters associated
+					// with the pipeline.
 
-					case le::CommandType::eBindGraphicsPipeline: {
-						auto* le_cmd = static_cast<le::CommandBindGraphicsPipeline*>( dataIt );
+					memset( argumentState.dynamicOffsets.data(), 0, sizeof( uint32_t ) * argumentState.dynamicOffsetCount );
 
-						if ( pass.type == le::QueueFlagBits::eGraphics ) {
-							// at this point, a valid renderpass must be bound
+				} else {
+					// -- TODO: warn that graphics pipelines may only be bound within
+					// draw passes.
+				}
+			} break;
 
-							using namespace le_backend_vk;
-							// -- potentially compile and create pipeline here, based on current pass and subpass
-							auto requestedPipeline = le_pipeline_manager_i.produce_graphics_pipeline( pipelineManager, le_cmd->info.gpsoHandle, pass, subpassIndex );
+			case le::CommandType::eBindComputePipeline: {
+				auto* le_cmd = static_cast<le::CommandBindComputePipeline*>( dataIt );
+				if ( pass.type == le::QueueFlagBits::eCompute ) {
+					// at this point, a valid renderpass must be bound
 
-							if ( /* DISABLES CODE */ ( false ) ) {
+					using namespace le_backend_vk;
+					// -- potentially compile and create pipeline here, based on current pass and subpass
+					currentPipeline = le_pipeline_manager_i.produce_compute_pipeline( pipelineManager, le_cmd->info.cpsoHandle );
 
-								// Print pipeline debug info when a new pipeline gets bound.
+					// -- grab current pipeline layout from cache
+					currentPipelineLayout = le_pipeline_manager_i.get_pipeline_layout( pipelineManager, currentPipeline.layout_info.pipeline_layout_key );
 
-								logger.info( "Requested pipeline: %x ", le_cmd->info.gpsoHandle );
-								debug_print_le_pipeline_layout_info( &requestedPipeline.layout_info );
-							}
+					{
+						// -- update pipelineData - that's the data values for all descriptors which are currently bound
 
-							if ( !is_equal( currentPipeline, requestedPipeline ) ) {
-								// update current pipeline
-								currentPipeline = requestedPipeline;
-								// -- grab current pipeline layout from cache
-								currentPipelineLayout = le_pipeline_manager_i.get_pipeline_layout( pipelineManager, currentPipeline.layout_info.pipeline_layout_key );
-								// -- update pipelineData - that's the data values for all descriptors which are currently bound
+						argumentState.setCount = uint32_t( currentPipeline.layout_info.set_layout_count );
+						argumentState.binding_infos.clear();
 
-								argumentState.setCount = uint32_t( currentPipeline.layout_info.set_layout_count );
-								argumentState.binding_infos.clear();
+						// -- reset dynamic offset count
+						argumentState.dynamicOffsetCount = 0;
 
-								// -- reset dynamic offset count
-								argumentState.dynamicOffsetCount = 0;
+						// let's create descriptorData vector based on current bindings-
+						for ( size_t setId = 0; setId != argumentState.setCount; ++setId ) {
 
-								// let's create descriptorData vector based on current bindings-
-								for ( size_t setId = 0; setId != argumentState.setCount; ++setId ) {
+							// look up set layout info via set layout key
+							auto const& set_layout_key = currentPipeline.layout_info.set_layout_keys[ setId ];
 
-									// look up set layout info via set layout key
-									auto const& set_layout_key = currentPipeline.layout_info.set_layout_keys[ setId ];
+							auto const setLayoutInfo = le_pipeline_manager_i.get_descriptor_set_layout( pipelineManager, set_layout_key );
 
-									auto const setLayoutInfo = le_pipeline_manager_i.get_descriptor_set_layout( pipelineManager, set_layout_key );
+							auto& setData = argumentState.setData[ setId ];
 
-									auto& setData = argumentState.setData[ setId ];
+							argumentState.layouts[ setId ]         = setLayoutInfo->vk_descriptor_set_layout;
+							argumentState.updateTemplates[ setId ] = setLayoutInfo->vk_descriptor_update_template;
 
-									argumentState.layouts[ setId ]         = setLayoutInfo->vk_descriptor_set_layout;
-									argumentState.updateTemplates[ setId ] = setLayoutInfo->vk_descriptor_update_template;
+							setData.clear();
+							setData.reserve( setLayoutInfo->binding_info.size() );
 
-									setData.clear();
-									setData.reserve( setLayoutInfo->binding_info.size() );
+							for ( auto b : setLayoutInfo->binding_info ) {
 
-									for ( auto b : setLayoutInfo->binding_info ) {
+								// add an entry for each array element with this binding to setData
+								for ( size_t arrayIndex = 0; arrayIndex != b.count; arrayIndex++ ) {
+									DescriptorData descriptorData{};
 
-										if ( b.count == 0 ) {
-											// If this is a placeholder binding, we continue early -
-											// this means that this binding will not be added to argumentState.
-											continue;
-										}
+									descriptorData.type          = b.type;
+									descriptorData.bindingNumber = uint32_t( b.binding );
+									descriptorData.arrayIndex    = uint32_t( arrayIndex );
 
-										// ----------| invariant: b.count > 0
+									descriptorData.bufferInfo.range = b.range;
 
-										// add an entry for each array element with this binding to setData
-										for ( size_t arrayIndex = 0; arrayIndex != b.count; arrayIndex++ ) {
-											DescriptorData descriptorData{};
+									setData.emplace_back( std::move( descriptorData ) );
+								}
 
-											descriptorData.type          = b.type;
-											descriptorData.bindingNumber = uint32_t( b.binding );
-											descriptorData.arrayIndex    = uint32_t( arrayIndex );
+								if ( b.type == le::DescriptorType::eStorageBufferDynamic ||
+								     b.type == le::DescriptorType::eUniformBufferDynamic ) {
+									assert( b.count != 0 ); // count cannot be 0
 
-											if ( b.type == le::DescriptorType::eStorageBuffer ||
-											     b.type == le::DescriptorType::eUniformBuffer ||
-											     b.type == le::DescriptorType::eStorageBufferDynamic ||
-											     b.type == le::DescriptorType::eUniformBufferDynamic ) {
+									// store dynamic offset index for this element
+									b.dynamic_offset_idx = argumentState.dynamicOffsetCount;
 
-												descriptorData.bufferInfo.range = b.range;
-											}
+									// increase dynamic offset count by number of elements in this binding
+									argumentState.dynamicOffsetCount += b.count;
+								}
 
-											setData.emplace_back( descriptorData );
-										}
+								// add this binding to list of current bindings
+								argumentState.binding_infos.emplace_back( std::move( b ) );
+							}
+						}
 
-										if ( b.type == le::DescriptorType::eStorageBufferDynamic ||
-										     b.type == le::DescriptorType::eUniformBufferDynamic ) {
-											assert( b.count != 0 ); // count cannot be 0
+						// -- reset dynamic offsets
+						memset( argumentState.dynamicOffsets.data(), 0, sizeof( uint32_t ) * argumentState.dynamicOffsetCount );
 
-											// store dynamic offset index for this element
-											b.dynamic_offset_idx = argumentState.dynamicOffsetCount;
+						// we write directly into descriptorsetstate when we update descriptors.
+						// when we bind a pipeline, we update the descriptorsetstate based
+						// on what the pipeline requires.
+					}
+					if ( currentPipeline.pipeline ) {
+						vkCmdBindPipeline( cmd, VK_PIPELINE_BIND_POINT_COMPUTE, currentPipeline.pipeline );
+					} else {
+						// Pipeline is being compiled in the background: we skip any dispatches until it is ready.
+					}
 
-											// increase dynamic offset count by number of elements in this binding
-											argumentState.dynamicOffsetCount += b.count;
-										}
+				} else {
+					// -- TODO: warn that compute pipelines may only be bound within
+					// compute passes.
+				}
 
-										// add this binding to list of current bindings
-										argumentState.binding_infos.push_back( b );
-									}
-								}
+			} break;
 
-								vkCmdBindPipeline( cmd, VK_PIPELINE_BIND_POINT_GRAPHICS, currentPipeline.pipeline );
-							} else {
-								// Re-using previously bound pipeline. We may keep argumentState state as it is.
-							}
+			case le::CommandType::eBindRtxPipeline: {
+				auto* le_cmd = static_cast<le::CommandBindRtxPipeline*>( dataIt );
+				if ( pass.type == le::QueueFlagBits::eCompute ) {
+					// at this point, a valid renderpass must be bound
 
-							// -- Reset dynamic offsets in argumentState:
-							// we do this regardless of whether pipeline was already bound,
-							// because binding a pipeline should always reset parameters associated
-							// with the pipeline.
+					using namespace le_backend_vk;
 
-							memset( argumentState.dynamicOffsets.data(), 0, sizeof( uint32_t ) * argumentState.dynamicOffsetCount );
+					// -- fetch pipeline from pipeline cache, also fetch shader group data, so that
+					// we can verify that the current pipeline state matches the pipeline state which
+					// was used to create the pipeline. The pipeline state may change if pipeline gets recompiled.
 
-						} else {
-							// -- TODO: warn that graphics pipelines may only be bound within
-							// draw passes.
-						}
-					} break;
+					{
+						currentPipeline.pipeline                        = static_cast<VkPipeline>( le_cmd->info.pipeline_native_handle );
+						currentPipeline.layout_info.pipeline_layout_key = le_cmd->info.pipeline_layout_key;
 
-					case le::CommandType::eBindComputePipeline: {
-						auto* le_cmd = static_cast<le::CommandBindComputePipeline*>( dataIt );
-						if ( pass.type == le::QueueFlagBits::eCompute ) {
-							// at this point, a valid renderpass must be bound
+						memcpy( currentPipeline.layout_info.set_layout_keys, le_cmd->info.descriptor_set_layout_keys, sizeof( currentPipeline.layout_info.set_layout_keys ) );
 
-							using namespace le_backend_vk;
-							// -- potentially compile and create pipeline here, based on current pass and subpass
-							currentPipeline = le_pipeline_manager_i.produce_compute_pipeline( pipelineManager, le_cmd->info.cpsoHandle );
+						currentPipeline.layout_info.set_layout_count = le_cmd->info.descriptor_set_layout_count;
+					}
 
-							// -- grab current pipeline layout from cache
-							currentPipelineLayout = le_pipeline_manager_i.get_pipeline_layout( pipelineManager, currentPipeline.layout_info.pipeline_layout_key );
+					// -- grab current pipeline layout from cache
+					currentPipelineLayout = le_pipeline_manager_i.get_pipeline_layout( pipelineManager, currentPipeline.layout_info.pipeline_layout_key );
 
-							{
-								// -- update pipelineData - that's the data values for all descriptors which are currently bound
+					{
+						// -- update pipelineData - that's the data values for all descriptors which are currently bound
 
-								argumentState.setCount = uint32_t( currentPipeline.layout_info.set_layout_count );
-								argumentState.binding_infos.clear();
+						argumentState.setCount = uint32_t( currentPipeline.layout_info.set_layout_count );
+						argumentState.binding_infos.clear();
 
-								// -- reset dynamic offset count
-								argumentState.dynamicOffsetCount = 0;
+						// -- reset dynamic offset count
+						argumentState.dynamicOffsetCount = 0;
 
-								// let's create descriptorData vector based on current bindings-
-								for ( size_t setId = 0; setId != argumentState.setCount; ++setId ) {
+						// let's create descriptorData vector based on current bindings-
+						for ( size_t setId = 0; setId != argumentState.setCount; ++setId ) {
 
-									// look up set layout info via set layout key
-									auto const& set_layout_key = currentPipeline.layout_info.set_layout_keys[ setId ];
+							// look up set layout info via set layout key
+							auto const& set_layout_key = currentPipeline.layout_info.set_layout_keys[ setId ];
 
-									auto const setLayoutInfo = le_pipeline_manager_i.get_descriptor_set_layout( pipelineManager, set_layout_key );
+							auto const setLayoutInfo = le_pipeline_manager_i.get_descriptor_set_layout( pipelineManager, set_layout_key );
 
-									auto& setData = argumentState.setData[ setId ];
+							auto& setData = argumentState.setData[ setId ];
 
-									argumentState.layouts[ setId ]         = setLayoutInfo->vk_descriptor_set_layout;
-									argumentState.updateTemplates[ setId ] = setLayoutInfo->vk_descriptor_update_template;
+							argumentState.layouts[ setId ]         = setLayoutInfo->vk_descriptor_set_layout;
+							argumentState.updateTemplates[ setId ] = setLayoutInfo->vk_descriptor_update_template;
 
-									setData.clear();
-									setData.reserve( setLayoutInfo->binding_info.size() );
+							setData.clear();
+							setData.reserve( setLayoutInfo->binding_info.size() );
 
-									for ( auto b : setLayoutInfo->binding_info ) {
+							for ( auto b : setLayoutInfo->binding_info ) {
 
-										// add an entry for each array element with this binding to setData
-										for ( size_t arrayIndex = 0; arrayIndex != b.count; arrayIndex++ ) {
-											DescriptorData descriptorData{};
+								// add an entry for each array element with this binding to setData
+								for ( size_t arrayIndex = 0; arrayIndex != b.count; arrayIndex++ ) {
+									DescriptorData descriptorData{};
 
-											descriptorData.type          = b.type;
-											descriptorData.bindingNumber = uint32_t( b.binding );
-											descriptorData.arrayIndex    = uint32_t( arrayIndex );
+									descriptorData.type          = le::DescriptorType( b.type );
+									descriptorData.bindingNumber = uint32_t( b.binding );
+									descriptorData.arrayIndex    = uint32_t( arrayIndex );
 
-											descriptorData.bufferInfo.range = b.range;
+									if ( b.type == le::DescriptorType::eStorageBuffer ||
+									     b.type == le::DescriptorType::eUniformBuffer ||
+									     b.type == le::DescriptorType::eStorageBufferDynamic ||
+									     b.type == le::DescriptorType::eUniformBufferDynamic ) {
 
-											setData.emplace_back( std::move( descriptorData ) );
-										}
+										descriptorData.bufferInfo.range = b.range;
+									}
 
-										if ( b.type == le::DescriptorType::eStorageBufferDynamic ||
-										     b.type == le::DescriptorType::eUniformBufferDynamic ) {
-											assert( b.count != 0 ); // count cannot be 0
+									setData.emplace_back( std::move( descriptorData ) );
+								}
 
-											// store dynamic offset index for this element
-											b.dynamic_offset_idx = argumentState.dynamicOffsetCount;
+								if ( b.type == le::DescriptorType::eStorageBufferDynamic ||
+								     b.type == le::DescriptorType::eUniformBufferDynamic ) {
+									assert( b.count != 0 ); // count cannot be 0
 
-											// increase dynamic offset count by number of elements in this binding
-											argumentState.dynamicOffsetCount += b.count;
-										}
+									// store dynamic offset index for this element
+									b.dynamic_offset_idx = argumentState.dynamicOffsetCount;
 
-										// add this binding to list of current bindings
-										argumentState.binding_infos.emplace_back( std::move( b ) );
-									}
+									// increase dynamic offset count by number of elements in this binding
+									argumentState.dynamicOffsetCount += b.count;
 								}
 
-								// -- reset dynamic offsets
-								memset( argumentState.dynamicOffsets.data(), 0, sizeof( uint32_t ) * argumentState.dynamicOffsetCount );
-
-								// we write directly into descriptorsetstate when we update descriptors.
-								// when we bind a pipeline, we update the descriptorsetstate based
-								// on what the pipeline requires.
+								// add this binding to list of current bindings
+								argumentState.binding_infos.emplace_back( std::move( b ) );
 							}
-							vkCmdBindPipeline( cmd, VK_PIPELINE_BIND_POINT_COMPUTE, currentPipeline.pipeline );
-
-						} else {
-							// -- TODO: warn that compute pipelines may only be bound within
-							// compute passes.
 						}
 
-					} break;
-
-					case le::CommandType::eBindRtxPipeline: {
-						auto* le_cmd = static_cast<le::CommandBindRtxPipeline*>( dataIt );
-						if ( pass.type == le::QueueFlagBits::eCompute ) {
-							// at this point, a valid renderpass must be bound
+						// -- reset dynamic offsets
+						memset( argumentState.dynamicOffsets.data(), 0, sizeof( uint32_t ) * argumentState.dynamicOffsetCount );
+					}
 
-							using namespace le_backend_vk;
+					vkCmdBindPipeline( cmd, VK_PIPELINE_BIND_POINT_RAY_TRACING_KHR, currentPipeline.pipeline );
+					// -- "bind" shader binding table state
 
-							// -- fetch pipeline from pipeline cache, also fetch shader group data, so that
-							// we can verify that the current pipeline state matches the pipeline state which
-							// was used to create the pipeline. The pipeline state may change if pipeline gets recompiled.
+					{
+						rtx_state.sbt_buffer = le_cmd->info.sbt_buffer;
 
-							{
-								currentPipeline.pipeline                        = static_cast<VkPipeline>( le_cmd->info.pipeline_native_handle );
-								currentPipeline.layout_info.pipeline_layout_key = le_cmd->info.pipeline_layout_key;
+						VkBuffer vk_buffer = frame_data_get_buffer_from_le_resource_id( &frame, le_cmd->info.sbt_buffer );
 
-								memcpy( currentPipeline.layout_info.set_layout_keys, le_cmd->info.descriptor_set_layout_keys, sizeof( currentPipeline.layout_info.set_layout_keys ) );
+						VkBufferDeviceAddressInfo info = {
+						    .sType  = VK_STRUCTURE_TYPE_BUFFER_DEVICE_ADDRESS_INFO,
+						    .pNext  = nullptr, // optional
+						    .buffer = vk_buffer,
+						};
+						uint64_t offset               = vkGetBufferDeviceAddress( device, &info );
+						rtx_state.ray_gen_sbt_offset  = offset + le_cmd->info.ray_gen_sbt_offset;
+						rtx_state.ray_gen_sbt_size    = le_cmd->info.ray_gen_sbt_size;
+						rtx_state.miss_sbt_offset     = offset + le_cmd->info.miss_sbt_offset;
+						rtx_state.miss_sbt_stride     = le_cmd->info.miss_sbt_stride;
+						rtx_state.miss_sbt_size       = le_cmd->info.miss_sbt_size;
+						rtx_state.hit_sbt_offset      = offset + le_cmd->info.hit_sbt_offset;
+						rtx_state.hit_sbt_stride      = le_cmd->info.hit_sbt_stride;
+						rtx_state.hit_sbt_size        = le_cmd->info.hit_sbt_size;
+						rtx_state.callable_sbt_offset = offset + le_cmd->info.callable_sbt_offset;
+						rtx_state.callable_sbt_stride = le_cmd->info.callable_sbt_stride;
+						rtx_state.callable_sbt_size   = le_cmd->info.callable_sbt_size;
+						rtx_state.is_set              = true;
+					}
 
-								currentPipeline.layout_info.set_layout_count = le_cmd->info.descriptor_set_layout_count;
-							}
+				} else {
+					// -- TODO: warn that rtx pipelines may only be bound within
+					// compute passes.
+				}
 
-							// -- grab current pipeline layout from cache
-							currentPipelineLayout = le_pipeline_manager_i.get_pipeline_layout( pipelineManager, currentPipeline.layout_info.pipeline_layout_key );
+			} break;
+			case le::CommandType::eTraceRays: {
+				auto* le_cmd = static_cast<le::CommandTraceRays*>( dataIt );
 
-							{
-								// -- update pipelineData - that's the data values for all descriptors which are currently bound
+				// -- update descriptorsets via template if tainted
+				bool argumentsOk = updateArguments( device, descriptorPool, descriptorSetCache, frame.frameNumber, argumentState, previousSetState, descriptorSets );
 
-								argumentState.setCount = uint32_t( currentPipeline.layout_info.set_layout_count );
-								argumentState.binding_infos.clear();
+				if ( false == argumentsOk ) {
+					break;
+				}
 
-								// -- reset dynamic offset count
-								argumentState.dynamicOffsetCount = 0;
+				// --------| invariant: arguments were updated successfully
 
-								// let's create descriptorData vector based on current bindings-
-								for ( size_t setId = 0; setId != argumentState.setCount; ++setId ) {
+				if ( argumentState.setCount > 0 ) {
 
-									// look up set layout info via set layout key
-									auto const& set_layout_key = currentPipeline.layout_info.set_layout_keys[ setId ];
+					vkCmdBindDescriptorSets(
+					    cmd,
+					    VK_PIPELINE_BIND_POINT_RAY_TRACING_KHR,
+					    currentPipelineLayout,
+					    0,
+					    argumentState.setCount,
+					    descriptorSets,
+					    argumentState.dynamicOffsetCount,
+					    argumentState.dynamicOffsets.data() );
+				}
 
-									auto const setLayoutInfo = le_pipeline_manager_i.get_descriptor_set_layout( pipelineManager, set_layout_key );
+				assert( rtx_state.is_set && "sbt state must have been set before calling traceRays" );
+
+				// VkBuffer sbt_vk_buffer = frame_data_get_buffer_from_le_resource_id( frame, rtx_state.sbt_buffer );
+
+				//					std::cout << "sbt buffer: " << std::hex << sbt_vk_buffer << std::endl
+				//					          << std::flush;
+				//					std::cout << "sbt buffer raygen offset: " << std::dec << rtx_state.ray_gen_sbt_offset << std::endl
+				//					          << std::flush;
+
+				// buffer, offset, stride, size
+				VkStridedDeviceAddressRegionKHR sbt_ray_gen{ rtx_state.ray_gen_sbt_offset, rtx_state.ray_gen_sbt_size, rtx_state.ray_gen_sbt_size };
+				VkStridedDeviceAddressRegionKHR sbt_miss{ rtx_state.miss_sbt_offset, rtx_state.miss_sbt_stride, rtx_state.miss_sbt_size };
+				VkStridedDeviceAddressRegionKHR sbt_hit{ rtx_state.hit_sbt_offset, rtx_state.hit_sbt_stride, rtx_state.hit_sbt_size };
+				VkStridedDeviceAddressRegionKHR sbt_callable{ rtx_state.callable_sbt_offset, rtx_state.callable_sbt_stride, rtx_state.callable_sbt_size };
+
+				vkCmdTraceRaysKHR(
+				    cmd,
+				    &sbt_ray_gen,
+				    &sbt_miss,
+				    &sbt_hit,
+				    &sbt_callable,
+				    le_cmd->info.width,
+				    le_cmd->info.height,
+				    le_cmd->info.depth //
+				);
+
+			} break;
+			case le::CommandType::eDispatch: {
+				auto* le_cmd = static_cast<le::CommandDispatch*>( dataIt );
+
+				if ( nullptr == currentPipeline.pipeline ) {
+					break; // no pipeline bound - or pipeline is still being compiled in the background
+				}
 
-									auto& setData = argumentState.setData[ setId ];
+				// -- update descriptorsets via template if tainted
+				bool argumentsOk = updateArguments( device, descriptorPool, descriptorSetCache, frame.frameNumber, argumentState, previousSetState, descriptorSets );
 
-									argumentState.layouts[ setId ]         = setLayoutInfo->vk_descriptor_set_layout;
-									argumentState.updateTemplates[ setId ] = setLayoutInfo->vk_descriptor_update_template;
+				if ( false == argumentsOk ) {
+					break;
+				}
 
-									setData.clear();
-									setData.reserve( setLayoutInfo->binding_info.size() );
+				// --------| invariant: arguments were updated successfully
 
-									for ( auto b : setLayoutInfo->binding_info ) {
+				if ( argumentState.setCount > 0 ) {
 
-										// add an entry for each array element with this binding to setData
-										for ( size_t arrayIndex = 0; arrayIndex != b.count; arrayIndex++ ) {
-											DescriptorData descriptorData{};
+					vkCmdBindDescriptorSets( cmd,
+					                         VK_PIPELINE_BIND_POINT_COMPUTE,
+					                         currentPipelineLayout,
+					                         0,
+					                         argumentState.setCount,
+					                         descriptorSets,
+					                         argumentState.dynamicOffsetCount,
+					                         argumentState.dynamicOffsets.data() );
+				}
 
-											descriptorData.type          = le::DescriptorType( b.type );
-											descriptorData.bindingNumber = uint32_t( b.binding );
-											descriptorData.arrayIndex    = uint32_t( arrayIndex );
+				vkCmdDispatch( cmd, le_cmd->info.groupCountX, le_cmd->info.groupCountY, le_cmd->info.groupCountZ );
+
+			} break;
+			case le::CommandType::eBufferMemoryBarrier: {
+				auto*                  le_cmd = static_cast<le::CommandBufferMemoryBarrier*>( dataIt );
+				VkBufferMemoryBarrier2 bufferMemoryBarrier{
+				    .sType               = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER_2,
+				    .pNext               = nullptr,
+				    .srcStageMask        = static_cast<VkPipelineStageFlags2>( le_cmd->info.srcStageMask ), // happens-before
+				    .srcAccessMask       = 0,                                                               // FIXME: no memory is made available from src stage ?!
+				    .dstStageMask        = static_cast<VkPipelineStageFlags2>( le_cmd->info.dstStageMask ), // before continuing with dst stage
+				    .dstAccessMask       = static_cast<VkAccessFlagBits2>( le_cmd->info.dstAccessMask ),    // and making memory visible to dst stage
+				    .srcQueueFamilyIndex = 0,
+				    .dstQueueFamilyIndex = 0,
+				    .buffer              = frame_data_get_buffer_from_le_resource_id( &frame, le_cmd->info.buffer ),
+				    .offset              = le_cmd->info.offset,
+				    .size                = le_cmd->info.range,
+				};
 
-											if ( b.type == le::DescriptorType::eStorageBuffer ||
-											     b.type == le::DescriptorType::eUniformBuffer ||
-											     b.type == le::DescriptorType::eStorageBufferDynamic ||
-											     b.type == le::DescriptorType::eUniformBufferDynamic ) {
+				VkDependencyInfo dependency_info{
+				    .sType                    = VK_STRUCTURE_TYPE_DEPENDENCY_INFO,
+				    .pNext                    = nullptr, // optional
+				    .dependencyFlags          = 0,       // optional
+				    .memoryBarrierCount       = 0,       // optional
+				    .pMemoryBarriers          = 0,
+				    .bufferMemoryBarrierCount = 1, // optional
+				    .pBufferMemoryBarriers    = &bufferMemoryBarrier,
+				    .imageMemoryBarrierCount  = 0, // optional
+				    .pImageMemoryBarriers     = 0,
+				};
 
-												descriptorData.bufferInfo.range = b.range;
-											}
+				vkCmdPipelineBarrier2( cmd, &dependency_info );
 
-											setData.emplace_back( std::move( descriptorData ) );
-										}
+			} break;
+			case le::CommandType::eDraw: {
+				auto* le_cmd = static_cast<le::CommandDraw*>( dataIt );
 
-										if ( b.type == le::DescriptorType::eStorageBufferDynamic ||
-										     b.type == le::DescriptorType::eUniformBufferDynamic ) {
-											assert( b.count != 0 ); // count cannot be 0
+				if ( nullptr == currentPipeline.pipeline ) {
+					break; // no pipeline bound - or pipeline is still being compiled in the background
+				}
 
-											// store dynamic offset index for this element
-											b.dynamic_offset_idx = argumentState.dynamicOffsetCount;
+				// -- update descriptorsets via template if tainted
+				bool argumentsOk = updateArguments( device, descriptorPool, descriptorSetCache, frame.frameNumber, argumentState, previousSetState, descriptorSets );
 
-											// increase dynamic offset count by number of elements in this binding
-											argumentState.dynamicOffsetCount += b.count;
-										}
+				if ( false == argumentsOk ) {
+					break;
+				}
 
-										// add this binding to list of current bindings
-										argumentState.binding_infos.emplace_back( std::move( b ) );
-									}
-								}
+				// --------| invariant: arguments were updated successfully
 
-								// -- reset dynamic offsets
-								memset( argumentState.dynamicOffsets.data(), 0, sizeof( uint32_t ) * argumentState.dynamicOffsetCount );
-							}
+				if ( argumentState.setCount > 0 ) {
 
-							vkCmdBindPipeline( cmd, VK_PIPELINE_BIND_POINT_RAY_TRACING_KHR, currentPipeline.pipeline );
-							// -- "bind" shader binding table state
-
-							{
-								rtx_state.sbt_buffer = le_cmd->info.sbt_buffer;
-
-								VkBuffer vk_buffer = frame_data_get_buffer_from_le_resource_id( &frame, le_cmd->info.sbt_buffer );
-
-								VkBufferDeviceAddressInfo info = {
-								    .sType  = VK_STRUCTURE_TYPE_BUFFER_DEVICE_ADDRESS_INFO,
-								    .pNext  = nullptr, // optional
-								    .buffer = vk_buffer,
-								};
-								uint64_t offset               = vkGetBufferDeviceAddress( device, &info );
-								rtx_state.ray_gen_sbt_offset  = offset + le_cmd->info.ray_gen_sbt_offset;
-								rtx_state.ray_gen_sbt_size    = le_cmd->info.ray_gen_sbt_size;
-								rtx_state.miss_sbt_offset     = offset + le_cmd->info.miss_sbt_offset;
-								rtx_state.miss_sbt_stride     = le_cmd->info.miss_sbt_stride;
-								rtx_state.miss_sbt_size       = le_cmd->info.miss_sbt_size;
-								rtx_state.hit_sbt_offset      = offset + le_cmd->info.hit_sbt_offset;
-								rtx_state.hit_sbt_stride      = le_cmd->info.hit_sbt_stride;
-								rtx_state.hit_sbt_size        = le_cmd->info.hit_sbt_size;
-								rtx_state.callable_sbt_offset = offset + le_cmd->info.callable_sbt_offset;
-								rtx_state.callable_sbt_stride = le_cmd->info.callable_sbt_stride;
-								rtx_state.callable_sbt_size   = le_cmd->info.callable_sbt_size;
-								rtx_state.is_set              = true;
-							}
+					vkCmdBindDescriptorSets(
+					    cmd,
+					    VK_PIPELINE_BIND_POINT_GRAPHICS,
+					    currentPipelineLayout,
+					    0,
+					    argumentState.setCount,
+					    descriptorSets,
+					    argumentState.dynamicOffsetCount,
+					    argumentState.dynamicOffsets.data() );
+				}
 
-						} else {
-							// -- TODO: warn that rtx pipelines may only be bound within
-							// compute passes.
-						}
+				vkCmdDraw( cmd, le_cmd->info.vertexCount, le_cmd->info.instanceCount, le_cmd->info.firstVertex, le_cmd->info.firstInstance );
+			} break;
 
-					} break;
-					case le::CommandType::eTraceRays: {
-						auto* le_cmd = static_cast<le::CommandTraceRays*>( dataIt );
+			case le::CommandType::eDrawIndexed: {
+				auto* le_cmd = static_cast<le::CommandDrawIndexed*>( dataIt );
 
-						// -- update descriptorsets via template if tainted
-						bool argumentsOk = updateArguments( device, descriptorPool, argumentState, previousSetState, descriptorSets );
+				if ( nullptr == currentPipeline.pipeline ) {
+					break; // no pipeline bound - or pipeline is still being compiled in the background
+				}
 
-						if ( false == argumentsOk ) {
-							break;
-						}
+				// -- update descriptorsets via template if tainted
+				bool argumentsOk = updateArguments( device, descriptorPool, descriptorSetCache, frame.frameNumber, argumentState, previousSetState, descriptorSets );
 
-						// --------| invariant: arguments were updated successfully
+				if ( false == argumentsOk ) {
+					break;
+				}
 
-						if ( argumentState.setCount > 0 ) {
+				// --------| invariant: arguments were updated successfully
 
-							vkCmdBindDescriptorSets(
-							    cmd,
-							    VK_PIPELINE_BIND_POINT_RAY_TRACING_KHR,
-							    currentPipelineLayout,
-							    0,
-							    argumentState.setCount,
-							    descriptorSets,
-							    argumentState.dynamicOffsetCount,
-							    argumentState.dynamicOffsets.data() );
-						}
+				if ( argumentState.setCount > 0 ) {
 
-						assert( rtx_state.is_set && "sbt state must have been set before calling traceRays" );
+					vkCmdBindDescriptorSets(
+					    cmd,
+					    VK_PIPELINE_BIND_POINT_GRAPHICS,
+					    currentPipelineLayout,
+					    0,
+					    argumentState.setCount,
+					    descriptorSets,
+					    argumentState.dynamicOffsetCount,
+					    argumentState.dynamicOffsets.data() );
+				}
 
-						// VkBuffer sbt_vk_buffer = frame_data_get_buffer_from_le_resource_id( frame, rtx_state.sbt_buffer );
+				vkCmdDrawIndexed(
+				    cmd,
+				    le_cmd->info.indexCount,
+				    le_cmd->info.instanceCount,
+				    le_cmd->info.firstIndex,
+				    le_cmd->info.vertexOffset,
+				    le_cmd->info.firstInstance );
+			} break;
+			case le::CommandType::eDrawMeshTasks: {
+				auto* le_cmd = static_cast<le::CommandDrawMeshTasks*>( dataIt );
+
+				if ( nullptr == currentPipeline.pipeline ) {
+					break; // no pipeline bound - or pipeline is still being compiled in the background
+				}
 
-						//					std::cout << "sbt buffer: " << std::hex << sbt_vk_buffer << std::endl
-						//					          << std::flush;
-						//					std::cout << "sbt buffer raygen offset: " << std::dec << rtx_state.ray_gen_sbt_offset << std::endl
-						//					          << std::flush;
+				// -- update descriptorsets via template if tainted
+				bool argumentsOk = updateArguments( device, descriptorPool, descriptorSetCache, frame.frameNumber, argumentState, previousSetState, descriptorSets );
 
-						// buffer, offset, stride, size
-						VkStridedDeviceAddressRegionKHR sbt_ray_gen{ rtx_state.ray_gen_sbt_offset, rtx_state.ray_gen_sbt_size, rtx_state.ray_gen_sbt_size };
-						VkStridedDeviceAddressRegionKHR sbt_miss{ rtx_state.miss_sbt_offset, rtx_state.miss_sbt_stride, rtx_state.miss_sbt_size };
-						VkStridedDeviceAddressRegionKHR sbt_hit{ rtx_state.hit_sbt_offset, rtx_state.hit_sbt_stride, rtx_state.hit_sbt_size };
-						VkStridedDeviceAddressRegionKHR sbt_callable{ rtx_state.callable_sbt_offset, rtx_state.callable_sbt_stride, rtx_state.callable_sbt_size };
+				if ( false == argumentsOk ) {
+					break;
+				}
 
-						vkCmdTraceRaysKHR(
-						    cmd,
-						    &sbt_ray_gen,
-						    &sbt_miss,
-						    &sbt_hit,
-						    &sbt_callable,
-						    le_cmd->info.width,
-						    le_cmd->info.height,
-						    le_cmd->info.depth //
-						);
-
-					} break;
-					case le::CommandType::eDispatch: {
-						auto* le_cmd = static_cast<le::CommandDispatch*>( dataIt );
-
-						// -- update descriptorsets via template if tainted
-						bool argumentsOk = updateArguments( device, descriptorPool, argumentState, previousSetState, descriptorSets );
-
-						if ( false == argumentsOk ) {
-							break;
-						}
+				// --------| invariant: arguments were updated successfully
 
-						// --------| invariant: arguments were updated successfully
+				if ( argumentState.setCount > 0 ) {
 
-						if ( argumentState.setCount > 0 ) {
+					vkCmdBindDescriptorSets( cmd,
+					                         VK_PIPELINE_BIND_POINT_GRAPHICS,
+					                         currentPipelineLayout,
+					                         0,
+					                         argumentState.setCount,
+					                         descriptorSets,
+					                         argumentState.dynamicOffsetCount,
+					                         argumentState.dynamicOffsets.data() );
+				}
 
-							vkCmdBindDescriptorSets( cmd,
-							                         VK_PIPELINE_BIND_POINT_COMPUTE,
-							                         currentPipelineLayout,
-							                         0,
-							                         argumentState.setCount,
-							                         descriptorSets,
-							                         argumentState.dynamicOffsetCount,
-							                         argumentState.dynamicOffsets.data() );
-						}
+				vkCmdDrawMeshTasksEXT( cmd, le_cmd->info.x_count, le_cmd->info.y_count, le_cmd->info.z_count );
+			} break;
 
-						vkCmdDispatch( cmd, le_cmd->info.groupCountX, le_cmd->info.groupCountY, le_cmd->info.groupCountZ );
-
-					} break;
-					case le::CommandType::eBufferMemoryBarrier: {
-						auto*                  le_cmd = static_cast<le::CommandBufferMemoryBarrier*>( dataIt );
-						VkBufferMemoryBarrier2 bufferMemoryBarrier{
-						    .sType               = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER_2,
-						    .pNext               = nullptr,
-						    .srcStageMask        = static_cast<VkPipelineStageFlags2>( le_cmd->info.srcStageMask ), // happens-before
-						    .srcAccessMask       = 0,                                                               // FIXME: no memory is made available from src stage ?!
-						    .dstStageMask        = static_cast<VkPipelineStageFlags2>( le_cmd->info.dstStageMask ), // before continuing with dst stage
-						    .dstAccessMask       = static_cast<VkAccessFlagBits2>( le_cmd->info.dstAccessMask ),    // and making memory visible to dst stage
-						    .srcQueueFamilyIndex = 0,
-						    .dstQueueFamilyIndex = 0,
-						    .buffer              = frame_data_get_buffer_from_le_resource_id( &frame, le_cmd->info.buffer ),
-						    .offset              = le_cmd->info.offset,
-						    .size                = le_cmd->info.range,
-						};
+			case le::CommandType::eDrawMeshTasksNV: {
+				auto* le_cmd = static_cast<le::CommandDrawMeshTasksNV*>( dataIt );
 
-						VkDependencyInfo dependency_info{
-						    .sType                    = VK_STRUCTURE_TYPE_DEPENDENCY_INFO,
-						    .pNext                    = nullptr, // optional
-						    .dependencyFlags          = 0,       // optional
-						    .memoryBarrierCount       = 0,       // optional
-						    .pMemoryBarriers          = 0,
-						    .bufferMemoryBarrierCount = 1, // optional
-						    .pBufferMemoryBarriers    = &bufferMemoryBarrier,
-						    .imageMemoryBarrierCount  = 0, // optional
-						    .pImageMemoryBarriers     = 0,
-						};
+				if ( nullptr == currentPipeline.pipeline ) {
+					break; // no pipeline bound - or pipeline is still being compiled in the background
+				}
 
-						vkCmdPipelineBarrier2( cmd, &dependency_info );
+				// -- update descriptorsets via template if tainted
+				bool argumentsOk = updateArguments( device, descriptorPool, descriptorSetCache, frame.frameNumber, argumentState, previousSetState, descriptorSets );
 
-					} break;
-					case le::CommandType::eDraw: {
-						auto* le_cmd = static_cast<le::CommandDraw*>( dataIt );
+				if ( false == argumentsOk ) {
+					break;
+				}
 
-						// -- update descriptorsets via template if tainted
-						bool argumentsOk = updateArguments( device, descriptorPool, argumentState, previousSetState, descriptorSets );
+				// --------| invariant: arguments were updated successfully
 
-						if ( false == argumentsOk ) {
-							break;
-						}
+				if ( argumentState.setCount > 0 ) {
 
-						// --------| invariant: arguments were updated successfully
+					vkCmdBindDescriptorSets( cmd,
+					                         VK_PIPELINE_BIND_POINT_GRAPHICS,
+					                         currentPipelineLayout,
+					                         0,
+					                         argumentState.setCount,
+					                         descriptorSets,
+					                         argumentState.dynamicOffsetCount,
+					                         argumentState.dynamicOffsets.data() );
+				}
 
-						if ( argumentState.setCount > 0 ) {
+				vkCmdDrawMeshTasksNV( cmd, le_cmd->info.taskCount, le_cmd->info.firstTask );
+			} break;
 
-							vkCmdBindDescriptorSets(
-							    cmd,
-							    VK_PIPELINE_BIND_POINT_GRAPHICS,
-							    currentPipelineLayout,
-							    0,
-							    argumentState.setCount,
-							    descriptorSets,
-							    argumentState.dynamicOffsetCount,
-							    argumentState.dynamicOffsets.data() );
-						}
+			case le::CommandType::eSetLineWidth: {
+				auto* le_cmd = static_cast<le::CommandSetLineWidth*>( dataIt );
+				vkCmdSetLineWidth( cmd, le_cmd->info.width );
+			} break;
 
-						vkCmdDraw( cmd, le_cmd->info.vertexCount, le_cmd->info.instanceCount, le_cmd->info.firstVertex, le_cmd->info.firstInstance );
-					} break;
+			case le::CommandType::eSetViewport: {
+				auto* le_cmd = static_cast<le::CommandSetViewport*>( dataIt );
+				// Since data for viewports *is stored inline*, we increment the typed pointer
+				// of le_cmd by 1 to reach the next slot in the stream, where the data is stored.
+				vkCmdSetViewport( cmd, le_cmd->info.firstViewport, le_cmd->info.viewportCount, reinterpret_cast<VkViewport*>( le_cmd + 1 ) );
+			} break;
 
-					case le::CommandType::eDrawIndexed: {
-						auto* le_cmd = static_cast<le::CommandDrawIndexed*>( dataIt );
+			case le::CommandType::eSetScissor: {
+				auto* le_cmd = static_cast<le::CommandSetScissor*>( dataIt );
+				// Since data for scissors *is stored inline*, we increment the typed pointer
+				// of le_cmd by 1 to reach the next slot in the stream, where the data is stored.
+				vkCmdSetScissor( cmd, le_cmd->info.firstScissor, le_cmd->info.scissorCount, reinterpret_cast<VkRect2D*>( le_cmd + 1 ) );
+			} break;
 
-						// -- update descriptorsets via template if tainted
-						bool argumentsOk = updateArguments( device, descriptorPool, argumentState, previousSetState, descriptorSets );
+			case le::CommandType::eSetPushConstantData: {
+				if ( currentPipelineLayout ) {
 
-						if ( false == argumentsOk ) {
-							break;
+#ifndef NDEBUG
+					// Only do extra check when compiling for Debug:
+					//
+					// If current pipeline has not push constants enabled, then exit early, and print an error message.
+					if ( ( currentPipeline.layout_info.push_constants_enabled & 0x1 ) == false ) {
+						// We only want to print this message once.
+						if ( LE_DEBUG_TRUE_ONCE_IF_CHANGED( uint64_t( currentPipeline.pipeline ) ) ) {
+							LeLog( LOGGER_LABEL ).warn( "Push Constants used, but none available for this particular Pipeline: %p\n"
+							                            "\t>> Perhaps Push Constants have been optimised out in shader code as their members are not used by the shader(s)?",
+							                            currentPipeline.pipeline );
 						}
+						break; // early-out, prevents rest of command to be interpreted
+					}
+#endif
+					auto*              le_cmd               = static_cast<le::CommandSetPushConstantData*>( dataIt );
+					VkShaderStageFlags active_shader_stages = VkShaderStageFlags( currentPipeline.layout_info.active_vk_shader_stages );
+					vkCmdPushConstants( cmd, currentPipelineLayout, active_shader_stages, 0, uint32_t( le_cmd->info.num_bytes ), ( le_cmd + 1 ) ); // Note that we fetch inline data at (le_cmd + 1)
+				}
+				break;
+			}
 
-						// --------| invariant: arguments were updated successfully
+			case le::CommandType::eBindArgumentBuffer: {
+				// we need to store the data for the dynamic binding which was set as an argument to the ubo
+				// this alters our internal state
+				auto* le_cmd = static_cast<le::CommandBindArgumentBuffer*>( dataIt );
 
-						if ( argumentState.setCount > 0 ) {
+				uint64_t argument_name_id = le_cmd->info.argument_name_id;
 
-							vkCmdBindDescriptorSets(
-							    cmd,
-							    VK_PIPELINE_BIND_POINT_GRAPHICS,
-							    currentPipelineLayout,
-							    0,
-							    argumentState.setCount,
-							    descriptorSets,
-							    argumentState.dynamicOffsetCount,
-							    argumentState.dynamicOffsets.data() );
-						}
+				// find binding info with name referenced in command
 
-						vkCmdDrawIndexed(
-						    cmd,
-						    le_cmd->info.indexCount,
-						    le_cmd->info.instanceCount,
-						    le_cmd->info.firstIndex,
-						    le_cmd->info.vertexOffset,
-						    le_cmd->info.firstInstance );
-					} break;
-					case le::CommandType::eDrawMeshTasks: {
-						auto* le_cmd = static_cast<le::CommandDrawMeshTasks*>( dataIt );
-
-						// -- update descriptorsets via template if tainted
-						bool argumentsOk = updateArguments( device, descriptorPool, argumentState, previousSetState, descriptorSets );
-
-						if ( false == argumentsOk ) {
-							break;
-						}
+				auto b = argumentState.binding_infos.begin();
 
-						// --------| invariant: arguments were updated successfully
+				for ( ; b != argumentState.binding_infos.end(); b++ ) {
+					if ( b->name_hash == argument_name_id ) {
+						break;
+					}
+				}
 
-						if ( argumentState.setCount > 0 ) {
+				if ( b == argumentState.binding_infos.end() ) {
+					static uint64_t wrong_argument = argument_name_id;
+					[]( uint64_t argument ) {
+						static uint64_t argument_id_local = 0;
+						if ( argument_id_local == wrong_argument )
+							return;
+						logger.warn( "Process_frame: \x1b[38;5;209mInvalid argument name: '%s'\x1b[0m id: %x", le_get_argument_name_from_hash( argument ), argument );
+						argument_id_local = argument;
+					}( argument_name_id );
+					break;
+				}
 
-							vkCmdBindDescriptorSets( cmd,
-							                         VK_PIPELINE_BIND_POINT_GRAPHICS,
-							                         currentPipelineLayout,
-							                         0,
-							                         argumentState.setCount,
-							                         descriptorSets,
-							                         argumentState.dynamicOffsetCount,
-							                         argumentState.dynamicOffsets.data() );
-						}
+				// ---------| invariant: we found an argument name that matches
 
-						vkCmdDrawMeshTasksEXT( cmd, le_cmd->info.x_count, le_cmd->info.y_count, le_cmd->info.z_count );
-					} break;
+				DescriptorData* descriptor_data =
+				    find_descriptor_with_binding_number_and_array_idx(
+				        argumentState.setData[ b->setIndex ], b->binding );
 
-					case le::CommandType::eDrawMeshTasksNV: {
-						auto* le_cmd = static_cast<le::CommandDrawMeshTasksNV*>( dataIt );
+				if ( descriptor_data ) {
 
-						// -- update descriptorsets via template if tainted
-						bool argumentsOk = updateArguments( device, descriptorPool, argumentState, previousSetState, descriptorSets );
+					// Matching binding found
 
-						if ( false == argumentsOk ) {
-							break;
-						}
+					DescriptorData::BufferInfo& buffer_info = descriptor_data->bufferInfo;
 
-						// --------| invariant: arguments were updated successfully
+					buffer_info.buffer = frame_data_get_buffer_from_le_resource_id( &frame, le_cmd->info.buffer_id );
+					buffer_info.range  = le_cmd->info.range;
 
-						if ( argumentState.setCount > 0 ) {
+					if ( buffer_info.range == 0 ) {
 
-							vkCmdBindDescriptorSets( cmd,
-							                         VK_PIPELINE_BIND_POINT_GRAPHICS,
-							                         currentPipelineLayout,
-							                         0,
-							                         argumentState.setCount,
-							                         descriptorSets,
-							                         argumentState.dynamicOffsetCount,
-							                         argumentState.dynamicOffsets.data() );
-						}
+						// If no range was specified, we must default to VK_WHOLE_SIZE,
+						// as a range setting of 0 is not allowed in Vulkan.
 
-						vkCmdDrawMeshTasksNV( cmd, le_cmd->info.taskCount, le_cmd->info.firstTask );
-					} break;
+						buffer_info.range = VK_WHOLE_SIZE;
+					}
 
-					case le::CommandType::eSetLineWidth: {
-						auto* le_cmd = static_cast<le::CommandSetLineWidth*>( dataIt );
-						vkCmdSetLineWidth( cmd, le_cmd->info.width );
-					} break;
+					// If binding is in fact a dynamic binding, set the corresponding dynamic offset
+					// and set the buffer offset to 0.
+					if ( b->type == le::DescriptorType::eStorageBufferDynamic ||
+					     b->type == le::DescriptorType::eUniformBufferDynamic ) {
+						auto dynamicOffset                            = b->dynamic_offset_idx;
+						buffer_info.offset                            = 0;
+						argumentState.dynamicOffsets[ dynamicOffset ] = uint32_t( le_cmd->info.offset );
+					} else {
+						buffer_info.offset = le_cmd->info.offset;
+					}
+				}
 
-					case le::CommandType::eSetViewport: {
-						auto* le_cmd = static_cast<le::CommandSetViewport*>( dataIt );
-						// Since data for viewports *is stored inline*, we increment the typed pointer
-						// of le_cmd by 1 to reach the next slot in the stream, where the data is stored.
-						vkCmdSetViewport( cmd, le_cmd->info.firstViewport, le_cmd->info.viewportCount, reinterpret_cast<VkViewport*>( le_cmd + 1 ) );
-					} break;
+			} break;
 
-					case le::CommandType::eSetScissor: {
-						auto* le_cmd = static_cast<le::CommandSetScissor*>( dataIt );
-						// Since data for scissors *is stored inline*, we increment the typed pointer
-						// of le_cmd by 1 to reach the next slot in the stream, where the data is stored.
-						vkCmdSetScissor( cmd, le_cmd->info.firstScissor, le_cmd->info.scissorCount, reinterpret_cast<VkRect2D*>( le_cmd + 1 ) );
-					} break;
+			case le::CommandType::eSetArgumentTexture: {
+				auto*    le_cmd           = static_cast<le::CommandSetArgumentTexture*>( dataIt );
+				uint64_t argument_name_id = le_cmd->info.argument_name_id;
 
-					case le::CommandType::eSetPushConstantData: {
-						if ( currentPipelineLayout ) {
+				// Find binding info with name referenced in command
+				auto b = argumentState.binding_infos.begin();
 
-#ifndef NDEBUG
-							// Only do extra check when compiling for Debug:
-							//
-							// If current pipeline has not push constants enabled, then exit early, and print an error message.
-							if ( ( currentPipeline.layout_info.push_constants_enabled & 0x1 ) == false ) {
-								// We only want to print this message once.
-								if ( LE_DEBUG_TRUE_ONCE_IF_CHANGED( uint64_t( currentPipeline.pipeline ) ) ) {
-									LeLog( LOGGER_LABEL ).warn( "Push Constants used, but none available for this particular Pipeline: %p\n"
-									                            "\t>> Perhaps Push Constants have been optimised out in shader code as their members are not used by the shader(s)?",
-									                            currentPipeline.pipeline );
-								}
-								break; // early-out, prevents rest of command to be interpreted
-							}
-#endif
-							auto*              le_cmd               = static_cast<le::CommandSetPushConstantData*>( dataIt );
-							VkShaderStageFlags active_shader_stages = VkShaderStageFlags( currentPipeline.layout_info.active_vk_shader_stages );
-							vkCmdPushConstants( cmd, currentPipelineLayout, active_shader_stages, 0, uint32_t( le_cmd->info.num_bytes ), ( le_cmd + 1 ) ); // Note that we fetch inline data at (le_cmd + 1)
-						}
+				for ( ; b != argumentState.binding_infos.end(); b++ ) {
+					if ( b->name_hash == argument_name_id ) {
 						break;
 					}
+				}
 
-					case le::CommandType::eBindArgumentBuffer: {
-						// we need to store the data for the dynamic binding which was set as an argument to the ubo
-						// this alters our internal state
-						auto* le_cmd = static_cast<le::CommandBindArgumentBuffer*>( dataIt );
+				if ( b == argumentState.binding_infos.end() ) {
+					logger.warn( "Invalid texture argument name id: %x", argument_name_id );
+					break;
+				}
 
-						uint64_t argument_name_id = le_cmd->info.argument_name_id;
+				// ---------| invariant: we found an argument name that matches
 
-						// find binding info with name referenced in command
+				auto arrayIndex = uint32_t( le_cmd->info.array_index );
 
-						auto b = argumentState.binding_infos.begin();
+				// Descriptors are stored as flat arrays; we cannot assume that binding number matches
+				// index of descriptor in set, because some types of uniforms may be arrays, and these
+				// arrays will be stored flat in the vector of per-set descriptors.
+				//
+				// Imagine these were bindings for a set: a b c0 c1 c2 c3 c4 d
+				// a(0), b(1), would have their own binding number, but c0(2), c1(2), c2(2), c3(2), c4(2)
+				// would share a single binding number, 2, until d(3), which would have binding number 3.
+				//
+				// To find the correct descriptor, we must therefore iterate over descriptors in-set
+				// until we find one that matches the correct array index.
+				//
 
-						for ( ; b != argumentState.binding_infos.end(); b++ ) {
-							if ( b->name_hash == argument_name_id ) {
-								break;
-							}
-						}
+				auto bindingData =
+				    find_descriptor_with_binding_number_and_array_idx(
+				        argumentState.setData[ b->setIndex ], b->binding, arrayIndex );
 
-						if ( b == argumentState.binding_infos.end() ) {
-							static uint64_t wrong_argument = argument_name_id;
-							[]( uint64_t argument ) {
-								static uint64_t argument_id_local = 0;
-								if ( argument_id_local == wrong_argument )
-									return;
-								logger.warn( "Process_frame: \x1b[38;5;209mInvalid argument name: '%s'\x1b[0m id: %x", le_get_argument_name_from_hash( argument ), argument );
-								argument_id_local = argument;
-							}( argument_name_id );
-							break;
-						}
+				if ( bindingData ) {
+					// fetch texture information based on texture id from command
 
-						// ---------| invariant: we found an argument name that matches
+					auto foundTex = frame.textures_per_pass[ passIndex ].find( le_cmd->info.texture_id );
+					if ( foundTex == frame.textures_per_pass[ passIndex ].end() ) {
+						using namespace le_renderer;
+						logger.error( "Could not find requested texture: '%s', ignoring texture binding command",
+						              renderer_i.texture_handle_get_name( le_cmd->info.texture_id ) );
+						break;
+					}
 
-						DescriptorData* descriptor_data =
-						    find_descriptor_with_binding_number_and_array_idx(
-						        argumentState.setData[ b->setIndex ], b->binding );
+					// ----------| invariant: texture has been found
 
-						if ( descriptor_data ) {
+					bindingData->imageInfo.imageLayout = le::ImageLayout::eShaderReadOnlyOptimal;
+					bindingData->imageInfo.sampler     = foundTex->second.sampler;
+					bindingData->imageInfo.imageView   = foundTex->second.imageView;
+					bindingData->type                  = le::DescriptorType::eCombinedImageSampler;
+				} else {
+					logger.error( "Could not find binding at set: %d, binding: %d, array index: %d.", b->setIndex, b->binding, arrayIndex );
+					assert( bindingData && "could not find specified binding." );
+				}
+			} break;
 
-							// Matching binding found
+			case le::CommandType::eSetArgumentImage: {
+				auto*    le_cmd           = static_cast<le::CommandSetArgumentImage*>( dataIt );
+				uint64_t argument_name_id = le_cmd->info.argument_name_id;
 
-							DescriptorData::BufferInfo& buffer_info = descriptor_data->bufferInfo;
+				// Find binding info with name referenced in command
+				auto b = argumentState.binding_infos.begin();
 
-							buffer_info.buffer = frame_data_get_buffer_from_le_resource_id( &frame, le_cmd->info.buffer_id );
-							buffer_info.range  = le_cmd->info.range;
+				for ( ; b != argumentState.binding_infos.end(); b++ ) {
+					if ( b->name_hash == argument_name_id ) {
+						break;
+					}
+				}
 
-							if ( buffer_info.range == 0 ) {
+				if ( b == argumentState.binding_infos.end() ) {
+					logger.warn( "Warning: Invalid image argument name id: %x", argument_name_id );
+					break;
+				}
+				auto arrayIndex = uint32_t( le_cmd->info.array_index );
 
-								// If no range was specified, we must default to VK_WHOLE_SIZE,
-								// as a range setting of 0 is not allowed in Vulkan.
+				// ---------| invariant: we found an argument name that matches
 
-								buffer_info.range = VK_WHOLE_SIZE;
-							}
+				auto bindingData =
+				    find_descriptor_with_binding_number_and_array_idx(
+				        argumentState.setData[ b->setIndex ], b->binding, arrayIndex );
 
-							// If binding is in fact a dynamic binding, set the corresponding dynamic offset
-							// and set the buffer offset to 0.
-							if ( b->type == le::DescriptorType::eStorageBufferDynamic ||
-							     b->type == le::DescriptorType::eUniformBufferDynamic ) {
-								auto dynamicOffset                            = b->dynamic_offset_idx;
-								buffer_info.offset                            = 0;
-								argumentState.dynamicOffsets[ dynamicOffset ] = uint32_t( le_cmd->info.offset );
-							} else {
-								buffer_info.offset = le_cmd->info.offset;
-							}
-						}
+				// fetch image view information based on image_id from command
+				if ( bindingData ) {
 
-					} break;
+					auto foundImgView = frame.imageViews.find( le_cmd->info.image_id );
+					if ( foundImgView == frame.imageViews.end() ) {
+						logger.error( "Could not find image view for image: '%s', ignoring image binding command.",
+						              le_cmd->info.image_id->data->debug_name );
+						break;
+					}
 
-					case le::CommandType::eSetArgumentTexture: {
-						auto*    le_cmd           = static_cast<le::CommandSetArgumentTexture*>( dataIt );
-						uint64_t argument_name_id = le_cmd->info.argument_name_id;
+					// ----------| invariant: image view has been found
 
-						// Find binding info with name referenced in command
-						auto b = argumentState.binding_infos.begin();
+					// FIXME: (sync) image layout at this point *must* be general, if we wanted to write to this image.
+					bindingData->imageInfo.imageLayout = le::ImageLayout::eGeneral;
+					bindingData->imageInfo.imageView   = foundImgView->second;
 
-						for ( ; b != argumentState.binding_infos.end(); b++ ) {
-							if ( b->name_hash == argument_name_id ) {
-								break;
-							}
-						}
+					bindingData->type       = le::DescriptorType::eStorageImage;
+					bindingData->arrayIndex = uint32_t( le_cmd->info.array_index );
+				} else {
+					logger.error( "Could not find binding at set: %d, binding: %d.", b->setIndex, b->binding );
+					assert( bindingData && "Could not find specified binding" );
+				}
 
-						if ( b == argumentState.binding_infos.end() ) {
-							logger.warn( "Invalid texture argument name id: %x", argument_name_id );
-							break;
-						}
+			} break;
+			case le::CommandType::eSetArgumentTlas: {
+				auto*    le_cmd           = static_cast<le::CommandSetArgumentTlas*>( dataIt );
+				uint64_t argument_name_id = le_cmd->info.argument_name_id;
 
-						// ---------| invariant: we found an argument name that matches
-
-						auto arrayIndex = uint32_t( le_cmd->info.array_index );
-
-						// Descriptors are stored as flat arrays; we cannot assume that binding number matches
-						// index of descriptor in set, because some types of uniforms may be arrays, and these
-						// arrays will be stored flat in the vector of per-set descriptors.
-						//
-						// Imagine these were bindings for a set: a b c0 c1 c2 c3 c4 d
-						// a(0), b(1), would have their own binding number, but c0(2), c1(2), c2(2), c3(2), c4(2)
-						// would share a single binding number, 2, until d(3), which would have binding number 3.
-						//
-						// To find the correct descriptor, we must therefore iterate over descriptors in-set
-						// until we find one that matches the correct array index.
-						//
-
-						auto bindingData =
-						    find_descriptor_with_binding_number_and_array_idx(
-						        argumentState.setData[ b->setIndex ], b->binding, arrayIndex );
-
-						if ( bindingData ) {
-							// fetch texture information based on texture id from command
-
-							auto foundTex = frame.textures_per_pass[ passIndex ].find( le_cmd->info.texture_id );
-							if ( foundTex == frame.textures_per_pass[ passIndex ].end() ) {
-								using namespace le_renderer;
-								logger.error( "Could not find requested texture: '%s', ignoring texture binding command",
-								              renderer_i.texture_handle_get_name( le_cmd->info.texture_id ) );
-								break;
-							}
+				// Find binding info with name referenced in command
+				auto b = argumentState.binding_infos.begin();
 
-							// ----------| invariant: texture has been found
+				for ( ; b != argumentState.binding_infos.end(); b++ ) {
+					if ( b->name_hash == argument_name_id ) {
+						break;
+					}
+				}
 
-							bindingData->imageInfo.imageLayout = le::ImageLayout::eShaderReadOnlyOptimal;
-							bindingData->imageInfo.sampler     = foundTex->second.sampler;
-							bindingData->imageInfo.imageView   = foundTex->second.imageView;
-							bindingData->type                  = le::DescriptorType::eCombinedImageSampler;
-						} else {
-							logger.error( "Could not find binding at set: %d, binding: %d, array index: %d.", b->setIndex, b->binding, arrayIndex );
-							assert( bindingData && "could not find specified binding." );
-						}
-					} break;
+				if ( b == argumentState.binding_infos.end() ) {
+					logger.warn( "Invalid tlas argument name id: %x", argument_name_id );
+					break;
+				}
 
-					case le::CommandType::eSetArgumentImage: {
-						auto*    le_cmd           = static_cast<le::CommandSetArgumentImage*>( dataIt );
-						uint64_t argument_name_id = le_cmd->info.argument_name_id;
+				// ---------| invariant: we found an argument name that matches
 
-						// Find binding info with name referenced in command
-						auto b = argumentState.binding_infos.begin();
+				auto bindingData =
+				    find_descriptor_with_binding_number_and_array_idx(
+				        argumentState.setData[ b->setIndex ], b->binding );
 
-						for ( ; b != argumentState.binding_infos.end(); b++ ) {
-							if ( b->name_hash == argument_name_id ) {
-								break;
-							}
-						}
+				if ( bindingData ) {
+					auto found_resource = frame.availableResources.find( le_cmd->info.tlas_id );
+					if ( found_resource == frame.availableResources.end() ) {
+						logger.error( "Could not find acceleration structure: '%s'. Ignoring top level acceleration structure binding command.", le_cmd->info.tlas_id->data->debug_name );
+						break;
+					}
 
-						if ( b == argumentState.binding_infos.end() ) {
-							logger.warn( "Warning: Invalid image argument name id: %x", argument_name_id );
-							break;
-						}
-						auto arrayIndex = uint32_t( le_cmd->info.array_index );
+					// ----------| invariant: acceleration structure has been found
 
-						// ---------| invariant: we found an argument name that matches
+					bindingData->accelerationStructureInfo.accelerationStructure = found_resource->second.as.tlas;
+					bindingData->type                                            = le::DescriptorType::eAccelerationStructureKhr;
+					bindingData->arrayIndex                                      = uint32_t( le_cmd->info.array_index );
+				} else {
+					logger.error( "Could not find binding at set: %d, binding: %d.", b->setIndex, b->binding );
+				}
 
-						auto bindingData =
-						    find_descriptor_with_binding_number_and_array_idx(
-						        argumentState.setData[ b->setIndex ], b->binding, arrayIndex );
+			} break;
+			case le::CommandType::eBindIndexBuffer: {
+				auto* le_cmd = static_cast<le::CommandBindIndexBuffer*>( dataIt );
+				auto  buffer = frame_data_get_buffer_from_le_resource_id( &frame, le_cmd->info.buffer );
+				vkCmdBindIndexBuffer( cmd, buffer, le_cmd->info.offset, static_cast<VkIndexType>( le_cmd->info.indexType ) );
+			} break;
 
-						// fetch image view information based on image_id from command
-						if ( bindingData ) {
+			case le::CommandType::eBindVertexBuffers: {
+				auto* le_cmd = static_cast<le::CommandBindVertexBuffers*>( dataIt );
 
-							auto foundImgView = frame.imageViews.find( le_cmd->info.image_id );
-							if ( foundImgView == frame.imageViews.end() ) {
-								logger.error( "Could not find image view for image: '%s', ignoring image binding command.",
-								              le_cmd->info.image_id->data->debug_name );
-								break;
-							}
+				uint32_t firstBinding = le_cmd->info.firstBinding;
+				uint32_t numBuffers   = le_cmd->info.bindingCount;
 
-							// ----------| invariant: image view has been found
+				assert( numBuffers && "must at least have one buffer to bind." );
 
-							// FIXME: (sync) image layout at this point *must* be general, if we wanted to write to this image.
-							bindingData->imageInfo.imageLayout = le::ImageLayout::eGeneral;
-							bindingData->imageInfo.imageView   = foundImgView->second;
+				// Bind vertex buffers by looking up le resources and matching them with their corresponding
+				// vk resources.
 
-							bindingData->type       = le::DescriptorType::eStorageImage;
-							bindingData->arrayIndex = uint32_t( le_cmd->info.array_index );
-						} else {
-							logger.error( "Could not find binding at set: %d, binding: %d.", b->setIndex, b->binding );
-							assert( bindingData && "Could not find specified binding" );
-						}
+				// First, we must relocate pointers into the command stream - we know that this command
+				// is immediately followed by its payload on the command stream.
 
-					} break;
-					case le::CommandType::eSetArgumentTlas: {
-						auto*    le_cmd           = static_cast<le::CommandSetArgumentTlas*>( dataIt );
-						uint64_t argument_name_id = le_cmd->info.argument_name_id;
+				// The payload is two tightly packed arrays
+				// - le_buf_handle[bindingCount]
+				// - uint64_t[bindingCount]
 
-						// Find binding info with name referenced in command
-						auto b = argumentState.binding_infos.begin();
+				le_buffer_resource_handle* p_buffers = ( le_buffer_resource_handle* )( le_cmd + 1 );
+				uint64_t*                  p_offsets = ( uint64_t* )( p_buffers + le_cmd->info.bindingCount );
 
-						for ( ; b != argumentState.binding_infos.end(); b++ ) {
-							if ( b->name_hash == argument_name_id ) {
-								break;
-							}
-						}
+				le_buffer_resource_handle le_buffer = *p_buffers;
 
-						if ( b == argumentState.binding_infos.end() ) {
-							logger.warn( "Invalid tlas argument name id: %x", argument_name_id );
-							break;
-						}
+				VkBuffer vk_buffer                  = frame_data_get_buffer_from_le_resource_id( &frame, le_buffer );
+				vertexInputBindings[ firstBinding ] = vk_buffer;
 
-						// ---------| invariant: we found an argument name that matches
+				for ( uint32_t b = 1; b != numBuffers; ++b ) {
+					// We optimise for the likely case that the same resource is given a number of times:
+					// we cache the last lookup of a vk_resource, and if the same le_resource is requested again,
+					// we can use the cached value instead of having to do a lookup.
+					le_buffer_resource_handle next_buffer = p_buffers[ b ];
+					if ( next_buffer != le_buffer ) {
+						le_buffer = next_buffer;
+						vk_buffer = frame_data_get_buffer_from_le_resource_id( &frame, le_buffer );
+					}
+					vertexInputBindings[ b + firstBinding ] = vk_buffer;
+				}
 
-						auto bindingData =
-						    find_descriptor_with_binding_number_and_array_idx(
-						        argumentState.setData[ b->setIndex ], b->binding );
+				vkCmdBindVertexBuffers( cmd, le_cmd->info.firstBinding, le_cmd->info.bindingCount, &vertexInputBindings[ firstBinding ], p_offsets );
+			} break;
 
-						if ( bindingData ) {
-							auto found_resource = frame.availableResources.find( le_cmd->info.tlas_id );
-							if ( found_resource == frame.availableResources.end() ) {
-								logger.error( "Could not find acceleration structure: '%s'. Ignoring top level acceleration structure binding command.", le_cmd->info.tlas_id->data->debug_name );
-								break;
-							}
+			case le::CommandType::eWriteToBuffer: {
 
-							// ----------| invariant: acceleration structure has been found
+				// Enqueue copy buffer command
+				// TODO: we must sync this before the next read.
+				auto* le_cmd = static_cast<le::CommandWriteToBuffer*>( dataIt );
 
-							bindingData->accelerationStructureInfo.accelerationStructure = found_resource->second.as.tlas;
-							bindingData->type                                            = le::DescriptorType::eAccelerationStructureKhr;
-							bindingData->arrayIndex                                      = uint32_t( le_cmd->info.array_index );
-						} else {
-							logger.error( "Could not find binding at set: %d, binding: %d.", b->setIndex, b->binding );
-						}
+				VkBufferCopy region{
+				    .srcOffset = le_cmd->info.src_offset,
+				    .dstOffset = le_cmd->info.dst_offset,
+				    .size      = le_cmd->info.numBytes,
+				};
+
+				auto srcBuffer = frame_data_get_buffer_from_le_resource_id( &frame, le_cmd->info.src_buffer_id );
+				auto dstBuffer = frame_data_get_buffer_from_le_resource_id( &frame, le_cmd->info.dst_buffer_id );
+
+				vkCmdCopyBuffer( cmd, srcBuffer, dstBuffer, 1, &region );
+
+				break;
+			}
 
-					} break;
-					case le::CommandType::eBindIndexBuffer: {
-						auto* le_cmd = static_cast<le::CommandBindIndexBuffer*>( dataIt );
-						auto  buffer = frame_data_get_buffer_from_le_resource_id( &frame, le_cmd->info.buffer );
-						vkCmdBindIndexBuffer( cmd, buffer, le_cmd->info.offset, static_cast<VkIndexType>( le_cmd->info.indexType ) );
-					} break;
+			case le::CommandType::eWriteToImage: {
 
-					case le::CommandType::eBindVertexBuffers: {
-						auto* le_cmd = static_cast<le::CommandBindVertexBuffers*>( dataIt );
+				auto* le_cmd = static_cast<le::CommandWriteToImage*>( dataIt );
 
-						uint32_t firstBinding = le_cmd->info.firstBinding;
-						uint32_t numBuffers   = le_cmd->info.bindingCount;
+				auto srcBuffer = frame_data_get_buffer_from_le_resource_id( &frame, le_cmd->info.src_buffer_id );
+				auto dstImage  = frame_data_get_image_from_le_resource_id( &frame, le_cmd->info.dst_image_id );
 
-						assert( numBuffers && "must at least have one buffer to bind." );
+				// We define a range that covers all miplevels. this is useful as it allows us to transform
+				// Image layouts in bulk, covering the full mip chain.
+				VkImageSubresourceRange rangeAllRemainingMiplevels{
+				    .aspectMask     = VK_IMAGE_ASPECT_COLOR_BIT,
+					.baseMipLevel   = std::min( le_cmd->info.num_miplevels, le_cmd->info.dst_miplevel + 1 ), // TODO: we must make sure that baseMipLevel never is greater than the total number of mip levels available for this image.
+					.levelCount     = VK_REMAINING_MIP_LEVELS,                                               // we want all miplevels to be in transferDstOptimal.
+					.baseArrayLayer = le_cmd->info.dst_array_layer,
+				    .layerCount     = VK_REMAINING_ARRAY_LAYERS, // we want the range to encompass all layers
+				};
 
-						// Bind vertex buffers by looking up le resources and matching them with their corresponding
-						// vk resources.
+				{
 
-						// First, we must relocate pointers into the command stream - we know that this command
-						// is immediately followed by its payload on the command stream.
+					// Note: this barrier prepares the buffer resource for transfer read
+					VkBufferMemoryBarrier2 bufferTransferBarrier{
+					    .sType               = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER_2,
+					    .pNext               = nullptr,                          // optional
+					    .srcStageMask        = VK_PIPELINE_STAGE_2_HOST_BIT,     // any host operation
+					    .srcAccessMask       = VK_ACCESS_2_HOST_WRITE_BIT,       // make HostWrite memory available (flush host-write)
+					    .dstStageMask        = VK_PIPELINE_STAGE_2_TRANSFER_BIT, // must complete before transfer operation
+					    .dstAccessMask       = VK_ACCESS_2_TRANSFER_READ_BIT,    // and it must be visible for transferRead - so that we might read
+					    .srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+					    .dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+					    .buffer              = srcBuffer,
+					    .offset              = 0, // we assume a fresh buffer was allocated, so offset must be 0
+					    .size                = le_cmd->info.numBytes,
+					};
 
-						// The payload is two tightly packed arrays
-						// - le_buf_handle[bindingCount]
-						// - uint64_t[bindingCount]
+					// Note: The Renderpass will have prepared this resource to be written to
+					// so that it will be in LAYOUT_TRANSFER_DST_OPTIMAL at this point
+
+					VkDependencyInfo dependency_info{
+					    .sType                    = VK_STRUCTURE_TYPE_DEPENDENCY_INFO,
+					    .pNext                    = nullptr,
+					    .dependencyFlags          = 0,
+					    .memoryBarrierCount       = 0,
+					    .pMemoryBarriers          = 0,
+					    .bufferMemoryBarrierCount = 1,
+					    .pBufferMemoryBarriers    = &bufferTransferBarrier,
+						.imageMemoryBarrierCount  = 0,
+						.pImageMemoryBarriers     = nullptr,
+					};
 
-						le_buffer_resource_handle* p_buffers = ( le_buffer_resource_handle* )( le_cmd + 1 );
-						uint64_t*                  p_offsets = ( uint64_t* )( p_buffers + le_cmd->info.bindingCount );
+					vkCmdPipelineBarrier2( cmd, &dependency_info );
+				}
 
-						le_buffer_resource_handle le_buffer = *p_buffers;
+				{
+					// Copy data for first mip level from buffer to image.
+					//
+					// Then use the first mip level as a source for subsequent mip levels.
+					// When copying from a lower mip level to a higher mip level, we must make
+					// sure to add barriers, as these blit operations are transfers.
+					//
 
-						VkBuffer vk_buffer                  = frame_data_get_buffer_from_le_resource_id( &frame, le_buffer );
-						vertexInputBindings[ firstBinding ] = vk_buffer;
+					VkImageSubresourceLayers imageSubresourceLayers{
+					    .aspectMask     = VK_IMAGE_ASPECT_COLOR_BIT,
+					    .mipLevel       = 0,
+					    .baseArrayLayer = le_cmd->info.dst_array_layer,
+					    .layerCount     = 1,
+					};
 
-						for ( uint32_t b = 1; b != numBuffers; ++b ) {
-							// We optimise for the likely case that the same resource is given a number of times:
-							// we cache the last lookup of a vk_resource, and if the same le_resource is requested again,
-							// we can use the cached value instead of having to do a lookup.
-							le_buffer_resource_handle next_buffer = p_buffers[ b ];
-							if ( next_buffer != le_buffer ) {
-								le_buffer = next_buffer;
-								vk_buffer = frame_data_get_buffer_from_le_resource_id( &frame, le_buffer );
-							}
-							vertexInputBindings[ b + firstBinding ] = vk_buffer;
-						}
+					VkBufferImageCopy region{
+					    .bufferOffset      = 0,                                   // buffer offset is 0, since staging buffer is a fresh, specially allocated buffer
+					    .bufferRowLength   = 0,                                   // 0 means tightly packed
+					    .bufferImageHeight = 0,                                   // 0 means tightly packed
+					    .imageSubresource  = std::move( imageSubresourceLayers ), // stored inline
+					    .imageOffset =
+					        { .x = le_cmd->info.offset_x,
+					          .y = le_cmd->info.offset_y,
+					          .z = le_cmd->info.offset_z },
+					    .imageExtent =
+					        { .width  = le_cmd->info.image_w,
+					          .height = le_cmd->info.image_h,
+					          .depth  = le_cmd->info.image_d } };
+					;
+
+					vkCmdCopyBufferToImage( cmd, srcBuffer, dstImage, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 1, &region );
+				}
 
-						vkCmdBindVertexBuffers( cmd, le_cmd->info.firstBinding, le_cmd->info.bindingCount, &vertexInputBindings[ firstBinding ], p_offsets );
-					} break;
+				if ( le_cmd->info.num_miplevels > 1 ) {
 
-					case le::CommandType::eWriteToBuffer: {
+					// We generate additional miplevels by issueing scaled blits from one image subresource to the
+					// next higher mip level subresource.
 
-						// Enqueue copy buffer command
-						// TODO: we must sync this before the next read.
-						auto* le_cmd = static_cast<le::CommandWriteToBuffer*>( dataIt );
+					// For this to work, we must first make sure that the image subresource we just wrote to
+					// is ready to be read back. We do this by issueing a read-after-write barrier, and with
+					// the same barrier we also transition the source subresource image to transfer_src_optimal
+					// layout (which is a requirement for blitting operations)
+					//
+					// The target image subresource is already in layout transfer_dst_optimal, as this is the
+					// layout we applied to the whole mip chain when
 
-						VkBufferCopy region{
-						    .srcOffset = le_cmd->info.src_offset,
-						    .dstOffset = le_cmd->info.dst_offset,
-						    .size      = le_cmd->info.numBytes,
+					const uint32_t base_miplevel = le_cmd->info.dst_miplevel;
+					{
+						VkImageMemoryBarrier2 prepareBlit{
+						    .sType               = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER_2,
+						    .pNext               = nullptr,                              //
+						    .srcStageMask        = VK_PIPELINE_STAGE_2_TRANSFER_BIT,     //
+						    .srcAccessMask       = VK_ACCESS_2_TRANSFER_WRITE_BIT,       // make transfer write memory available (flush) to layout transition
+						    .dstStageMask        = VK_PIPELINE_STAGE_2_TRANSFER_BIT,     //
+						    .dstAccessMask       = VK_ACCESS_2_TRANSFER_READ_BIT,        // make cache (after layout transition) visible to transferRead op
+						    .oldLayout           = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, // layout transition from transfer dst optimal,
+						    .newLayout           = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, // to shader readonly optimal - note: implicitly makes memory available
+						    .srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+						    .dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+						    .image               = dstImage,
+						    .subresourceRange    = { VK_IMAGE_ASPECT_COLOR_BIT, base_miplevel, 1, 0, 1 },
 						};
 
-						auto srcBuffer = frame_data_get_buffer_from_le_resource_id( &frame, le_cmd->info.src_buffer_id );
-						auto dstBuffer = frame_data_get_buffer_from_le_resource_id( &frame, le_cmd->info.dst_buffer_id );
-
-						vkCmdCopyBuffer( cmd, srcBuffer, dstBuffer, 1, &region );
+						VkDependencyInfo dependency_info{
+						    .sType                    = VK_STRUCTURE_TYPE_DEPENDENCY_INFO,
+						    .pNext                    = nullptr,
+						    .dependencyFlags          = 0,
+						    .memoryBarrierCount       = 0,
+						    .pMemoryBarriers          = 0,
+						    .bufferMemoryBarrierCount = 0,
+						    .pBufferMemoryBarriers    = 0,
+						    .imageMemoryBarrierCount  = 1,
+						    .pImageMemoryBarriers     = &prepareBlit,
+						};
 
-						break;
+						vkCmdPipelineBarrier2( cmd, &dependency_info );
 					}
+					// Now blit from the srcMipLevel to dstMipLevel
 
-					case le::CommandType::eWriteToImage: {
+					int32_t srcImgWidth  = int32_t( le_cmd->info.image_w );
+					int32_t srcImgHeight = int32_t( le_cmd->info.image_h );
 
-						auto* le_cmd = static_cast<le::CommandWriteToImage*>( dataIt );
+					for ( uint32_t dstMipLevel = le_cmd->info.dst_miplevel + 1; dstMipLevel < le_cmd->info.num_miplevels; dstMipLevel++ ) {
 
-						auto srcBuffer = frame_data_get_buffer_from_le_resource_id( &frame, le_cmd->info.src_buffer_id );
-						auto dstImage  = frame_data_get_image_from_le_resource_id( &frame, le_cmd->info.dst_image_id );
+						// Blit from lower mip level into next higher mip level
+						auto srcMipLevel = dstMipLevel - 1;
 
-						// We define a range that covers all miplevels. this is useful as it allows us to transform
-						// Image layouts in bulk, covering the full mip chain.
-						VkImageSubresourceRange rangeAllRemainingMiplevels{
-						    .aspectMask     = VK_IMAGE_ASPECT_COLOR_BIT,
-							.baseMipLevel   = std::min( le_cmd->info.num_miplevels, le_cmd->info.dst_miplevel + 1 ), // TODO: we must make sure that baseMipLevel never is greater than the total number of mip levels available for this image.
-							.levelCount     = VK_REMAINING_MIP_LEVELS,                                               // we want all miplevels to be in transferDstOptimal.
-							.baseArrayLayer = le_cmd->info.dst_array_layer,
-						    .layerCount     = VK_REMAINING_ARRAY_LAYERS, // we want the range to encompass all layers
+						// Calculate width and height for next image in mip chain as half the corresponding source
+						// image dimension, unless dimension is smaller or equal to 2, in which case clamp to 1.
+						auto dstImgWidth  = srcImgWidth > 2 ? srcImgWidth >> 1 : 1;
+						auto dstImgHeight = srcImgHeight > 2 ? srcImgHeight >> 1 : 1;
+
+						VkOffset3D  offsetZero = { .x = 0, .y = 0, .z = 0 };
+						VkOffset3D  offsetSrc  = { .x = srcImgWidth, .y = srcImgHeight, .z = 1 };
+						VkOffset3D  offsetDst  = { .x = dstImgWidth, .y = dstImgHeight, .z = 1 };
+						VkImageBlit region{
+						    .srcSubresource = { VK_IMAGE_ASPECT_COLOR_BIT, srcMipLevel, 0, 1 },
+						    .srcOffsets     = { offsetZero, offsetSrc },
+						    .dstSubresource = { VK_IMAGE_ASPECT_COLOR_BIT, dstMipLevel, 0, 1 },
+						    .dstOffsets     = { offsetZero, offsetDst },
 						};
 
-						{
+						vkCmdBlitImage(
+						    cmd,
+						    dstImage, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
+						    dstImage, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+						    1, &region, VK_FILTER_LINEAR );
+
+						// Now we barrier Read after Write, and transition our freshly blitted subresource to transferSrc,
+						// so that the next iteration may read from it.
 
-							// Note: this barrier prepares the buffer resource for transfer read
-							VkBufferMemoryBarrier2 bufferTransferBarrier{
-							    .sType               = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER_2,
-							    .pNext               = nullptr,                          // optional
-							    .srcStageMask        = VK_PIPELINE_STAGE_2_HOST_BIT,     // any host operation
-							    .srcAccessMask       = VK_ACCESS_2_HOST_WRITE_BIT,       // make HostWrite memory available (flush host-write)
-							    .dstStageMask        = VK_PIPELINE_STAGE_2_TRANSFER_BIT, // must complete before transfer operation
-							    .dstAccessMask       = VK_ACCESS_2_TRANSFER_READ_BIT,    // and it must be visible for transferRead - so that we might read
+						{
+							VkImageMemoryBarrier2 finishBlit{
+							    .sType               = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER_2,
+							    .pNext               = nullptr,                              // optional
+							    .srcStageMask        = VK_PIPELINE_STAGE_2_TRANSFER_BIT,     // wait on transfer op
+							    .srcAccessMask       = VK_ACCESS_2_TRANSFER_WRITE_BIT,       // flush transfer writes so that memory becomes available to layout transition
+							    .dstStageMask        = VK_PIPELINE_STAGE_2_TRANSFER_BIT,     // before next transfer op
+							    .dstAccessMask       = VK_ACCESS_2_TRANSFER_READ_BIT,        // make transitioned image visible to subsequent transfer read ops
+							    .oldLayout           = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, // transition from transfer dst optimal
+							    .newLayout           = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, // to shader readonly optimal
 							    .srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
 							    .dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
-							    .buffer              = srcBuffer,
-							    .offset              = 0, // we assume a fresh buffer was allocated, so offset must be 0
-							    .size                = le_cmd->info.numBytes,
+							    .image               = dstImage,
+							    .subresourceRange    = {
+							           .aspectMask     = VK_IMAGE_ASPECT_COLOR_BIT,
+							           .baseMipLevel   = dstMipLevel,
+							           .levelCount     = 1,
+							           .baseArrayLayer = 0,
+							           .layerCount     = 1,
+                                        },
 							};
 
-							// Note: The Renderpass will have prepared this resource to be written to
-							// so that it will be in LAYOUT_TRANSFER_DST_OPTIMAL at this point
-
 							VkDependencyInfo dependency_info{
 							    .sType                    = VK_STRUCTURE_TYPE_DEPENDENCY_INFO,
 							    .pNext                    = nullptr,
 							    .dependencyFlags          = 0,
 							    .memoryBarrierCount       = 0,
 							    .pMemoryBarriers          = 0,
-							    .bufferMemoryBarrierCount = 1,
-							    .pBufferMemoryBarriers    = &bufferTransferBarrier,
-								.imageMemoryBarrierCount  = 0,
-								.pImageMemoryBarriers     = nullptr,
+							    .bufferMemoryBarrierCount = 0,
+							    .pBufferMemoryBarriers    = 0,
+							    .imageMemoryBarrierCount  = 1,
+							    .pImageMemoryBarriers     = &finishBlit,
 							};
 
 							vkCmdPipelineBarrier2( cmd, &dependency_info );
 						}
 
+						// Store this miplevel image's dimensions for next iteration
+						srcImgHeight = dstImgHeight;
+						srcImgWidth  = dstImgWidth;
+					}
+
+				} // end if mipLevelCount > 1
+
+				// Transition image from transfer src optimal to shader read only optimal layout
+
+				if ( le_cmd->info.num_miplevels > 1 ) {
+
+					const uint32_t base_miplevel = le_cmd->info.dst_miplevel;
+					{
+						VkImageMemoryBarrier2 revert_prepare_blit{
+							.sType               = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER_2,
+							.pNext               = nullptr,                              //
+							.srcStageMask        = VK_PIPELINE_STAGE_2_TRANSFER_BIT,     //
+							.srcAccessMask       = VK_ACCESS_2_NONE,                     // make transfer write memory available (flush) to layout transition
+							.dstStageMask        = VK_PIPELINE_STAGE_2_TRANSFER_BIT,     //
+							.dstAccessMask       = VK_ACCESS_2_TRANSFER_WRITE_BIT,       // make cache (after layout transition) visible to transferRead op
+							.oldLayout           = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, // layout transition from transfer dst optimal,
+							.newLayout           = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, // to shader readonly optimal - note: implicitly makes memory available
+							.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+							.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+							.image               = dstImage,
+							.subresourceRange    = { VK_IMAGE_ASPECT_COLOR_BIT, base_miplevel, 1, 0, 1 },
+						};
+
+						VkDependencyInfo dependency_info{
+							.sType                    = VK_STRUCTURE_TYPE_DEPENDENCY_INFO,
+							.pNext                    = nullptr,
+							.dependencyFlags          = 0,
+							.memoryBarrierCount       = 0,
+							.pMemoryBarriers          = 0,
+							.bufferMemoryBarrierCount = 0,
+							.pBufferMemoryBarriers    = 0,
+							.imageMemoryBarrierCount  = 1,
+							.pImageMemoryBarriers     = &revert_prepare_blit,
+						};
+
+						vkCmdPipelineBarrier2( cmd, &dependency_info );
+					}
+					{
+						VkImageMemoryBarrier2 imageLayoutToShaderReadOptimal{
+							.sType               = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER_2,
+							.pNext               = nullptr,
+							.srcStageMask        = 0,
+							.srcAccessMask       = 0,
+							.dstStageMask        = 0,
+							.dstAccessMask       = 0,
+							.oldLayout           = VK_IMAGE_LAYOUT_UNDEFINED,
+							.newLayout           = VK_IMAGE_LAYOUT_UNDEFINED,
+							.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+							.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+							.image               = dstImage,
+							.subresourceRange    = rangeAllRemainingMiplevels,
+						};
+
+						// If there were additional miplevels, the miplevel generation logic ensures that all subresources
+						// are left in transfer_src layout.
+
+						imageLayoutToShaderReadOptimal.srcStageMask  = VK_PIPELINE_STAGE_2_TRANSFER_BIT;     // anything in transfer must happen-before
+						imageLayoutToShaderReadOptimal.dstStageMask  = VK_PIPELINE_STAGE_2_TRANSFER_BIT;     // anything that fragment shader does
+						imageLayoutToShaderReadOptimal.srcAccessMask = VK_ACCESS_2_NONE;                     // no memory needs to be made available - nothing to flush, as previous barriers ensure flush
+						imageLayoutToShaderReadOptimal.dstAccessMask = VK_ACCESS_2_TRANSFER_WRITE_BIT;       // make layout transitioned image visible to shader read in FragmentShader stage
+						imageLayoutToShaderReadOptimal.oldLayout     = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL; // transition from transfer src optimal
+						imageLayoutToShaderReadOptimal.newLayout     = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL; // ...to shader readonly optimal -and make transitioned image available;
+
+						VkDependencyInfo dependency_info{
+							.sType                    = VK_STRUCTURE_TYPE_DEPENDENCY_INFO,
+							.pNext                    = nullptr,
+							.dependencyFlags          = 0,
+							.memoryBarrierCount       = 0,
+							.pMemoryBarriers          = 0,
+							.bufferMemoryBarrierCount = 0,
+							.pBufferMemoryBarriers    = 0,
+							.imageMemoryBarrierCount  = 1,
+							.pImageMemoryBarriers     = &imageLayoutToShaderReadOptimal,
+						};
+
+						vkCmdPipelineBarrier2( cmd, &dependency_info ); // images: prepare for shader read
+					}
+				}
+
+				break;
+			}
+			case le::CommandType::eBuildRtxBlas: {
+				auto* le_cmd = static_cast<le::CommandBuildRtxBlas*>( dataIt );
+
+				size_t     num_blas_handles  = le_cmd->info.blas_handles_count;
+				auto const blas_handle_begin = reinterpret_cast<le_resource_handle*>( le_cmd + 1 );
+
+				auto const blas_end = blas_handle_begin + num_blas_handles;
+
+				VkBuffer scratchBuffer = frame_data_get_buffer_from_le_resource_id( &frame, LE_RTX_SCRATCH_BUFFER_HANDLE );
+
+				for ( auto blas_handle = blas_handle_begin; blas_handle != blas_end; blas_handle++ ) {
+
+					auto const&                allocated_resource        = frame.availableResources.at( *blas_handle );
+					VkAccelerationStructureKHR vk_acceleration_structure = allocated_resource.as.blas;
+					auto                       blas_info                 = reinterpret_cast<le_rtx_blas_info_o*>( allocated_resource.info.blasInfo.handle );
+
+					// Translate geometry info from internal format toVkgeometryKHR format.
+					// We do this for each blas, which in turn may have an array of geometries.
+
+					std::vector<VkAccelerationStructureGeometryKHR> geometries;
+					geometries.reserve( blas_info->geometries.size() );
+
+					std::vector<VkAccelerationStructureBuildRangeInfoKHR> build_ranges;
+					build_ranges.reserve( blas_info->geometries.size() );
+
+					for ( auto const& g : blas_info->geometries ) {
+
+						// TODO: we may want to cache this - so that we don't have to lookup addresses more than once
+
+						VkBuffer vertex_buffer = frame_data_get_buffer_from_le_resource_id( &frame, g.vertex_buffer );
+						VkBuffer index_buffer  = frame_data_get_buffer_from_le_resource_id( &frame, g.index_buffer );
+
+						VkDeviceOrHostAddressConstKHR vertex_addr = { .deviceAddress = 0 };
+						VkDeviceOrHostAddressConstKHR index_addr  = { .deviceAddress = 0 };
+
+						{
+							VkBufferDeviceAddressInfo info = {
+							    .sType  = VK_STRUCTURE_TYPE_BUFFER_DEVICE_ADDRESS_INFO,
+							    .pNext  = nullptr, // optional
+							    .buffer = vertex_buffer,
+							};
+
+							vertex_addr.deviceAddress = g.vertex_offset + vkGetBufferDeviceAddress( device, &info );
+						}
+
 						{
-							// Copy data for first mip level from buffer to image.
-							//
-							// Then use the first mip level as a source for subsequent mip levels.
-							// When copying from a lower mip level to a higher mip level, we must make
-							// sure to add barriers, as these blit operations are transfers.
-							//
-
-							VkImageSubresourceLayers imageSubresourceLayers{
-							    .aspectMask     = VK_IMAGE_ASPECT_COLOR_BIT,
-							    .mipLevel       = 0,
-							    .baseArrayLayer = le_cmd->info.dst_array_layer,
-							    .layerCount     = 1,
+							VkBufferDeviceAddressInfo info = {
+							    .sType  = VK_STRUCTURE_TYPE_BUFFER_DEVICE_ADDRESS_INFO,
+							    .pNext  = nullptr, // optional
+							    .buffer = index_buffer,
 							};
+							index_addr.deviceAddress =
+							    g.index_count
+							        ? g.index_offset + vkGetBufferDeviceAddress( device, &info )
+							        : 0;
+						}
 
-							VkBufferImageCopy region{
-							    .bufferOffset      = 0,                                   // buffer offset is 0, since staging buffer is a fresh, specially allocated buffer
-							    .bufferRowLength   = 0,                                   // 0 means tightly packed
-							    .bufferImageHeight = 0,                                   // 0 means tightly packed
-							    .imageSubresource  = std::move( imageSubresourceLayers ), // stored inline
-							    .imageOffset =
-							        { .x = le_cmd->info.offset_x,
-							          .y = le_cmd->info.offset_y,
-							          .z = le_cmd->info.offset_z },
-							    .imageExtent =
-							        { .width  = le_cmd->info.image_w,
-							          .height = le_cmd->info.image_h,
-							          .depth  = le_cmd->info.image_d } };
-							;
-
-							vkCmdCopyBufferToImage( cmd, srcBuffer, dstImage, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 1, &region );
+						VkAccelerationStructureGeometryKHR geometry = {
+						    .sType        = VK_STRUCTURE_TYPE_ACCELERATION_STRUCTURE_GEOMETRY_KHR,
+						    .pNext        = nullptr, // optional
+						    .geometryType = VK_GEOMETRY_TYPE_TRIANGLES_KHR,
+						    .geometry     = {
+						            .triangles = {
+						                .sType         = VK_STRUCTURE_TYPE_ACCELERATION_STRUCTURE_GEOMETRY_TRIANGLES_DATA_KHR,
+						                .pNext         = nullptr, // optional
+						                .vertexFormat  = VkFormat( g.vertex_format ),
+						                .vertexData    = vertex_addr,
+						                .vertexStride  = g.vertex_stride,
+						                .maxVertex     = g.vertex_count - 1, // highest index of a vertex that will be accessed via build command
+						                .indexType     = VkIndexType( g.index_type ),
+						                .indexData     = index_addr,
+						                .transformData = {}, // no transform data
+                                        } },
+						    .flags = VK_GEOMETRY_OPAQUE_BIT_KHR, // optional
+						};
+
+						geometries.emplace_back( geometry );
+
+						VkAccelerationStructureBuildRangeInfoKHR build_range = {
+						    .primitiveCount  = 0,
+						    .primitiveOffset = 0,
+						    .firstVertex     = 0,
+						    .transformOffset = 0,
+						};
+
+						if ( g.index_count ) {
+							// indexed geometry
+							build_range.primitiveCount = g.index_count / 3;
+						} else {
+							// non-indexed geometry
+							build_range.primitiveCount = g.vertex_count / 3;
 						}
 
-						if ( le_cmd->info.num_miplevels > 1 ) {
-
-							// We generate additional miplevels by issueing scaled blits from one image subresource to the
-							// next higher mip level subresource.
-
-							// For this to work, we must first make sure that the image subresource we just wrote to
-							// is ready to be read back. We do this by issueing a read-after-write barrier, and with
-							// the same barrier we also transition the source subresource image to transfer_src_optimal
-							// layout (which is a requirement for blitting operations)
-							//
-							// The target image subresource is already in layout transfer_dst_optimal, as this is the
-							// layout we applied to the whole mip chain when
-
-							const uint32_t base_miplevel = le_cmd->info.dst_miplevel;
-							{
-								VkImageMemoryBarrier2 prepareBlit{
-								    .sType               = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER_2,
-								    .pNext               = nullptr,                              //
-								    .srcStageMask        = VK_PIPELINE_STAGE_2_TRANSFER_BIT,     //
-								    .srcAccessMask       = VK_ACCESS_2_TRANSFER_WRITE_BIT,       // make transfer write memory available (flush) to layout transition
-								    .dstStageMask        = VK_PIPELINE_STAGE_2_TRANSFER_BIT,     //
-								    .dstAccessMask       = VK_ACCESS_2_TRANSFER_READ_BIT,        // make cache (after layout transition) visible to transferRead op
-								    .oldLayout           = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, // layout transition from transfer dst optimal,
-								    .newLayout           = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, // to shader readonly optimal - note: implicitly makes memory available
-								    .srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
-								    .dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
-								    .image               = dstImage,
-								    .subresourceRange    = { VK_IMAGE_ASPECT_COLOR_BIT, base_miplevel, 1, 0, 1 },
-								};
-
-								VkDependencyInfo dependency_info{
-								    .sType                    = VK_STRUCTURE_TYPE_DEPENDENCY_INFO,
-								    .pNext                    = nullptr,
-								    .dependencyFlags          = 0,
-								    .memoryBarrierCount       = 0,
-								    .pMemoryBarriers          = 0,
-								    .bufferMemoryBarrierCount = 0,
-								    .pBufferMemoryBarriers    = 0,
-								    .imageMemoryBarrierCount  = 1,
-								    .pImageMemoryBarriers     = &prepareBlit,
-								};
-
-								vkCmdPipelineBarrier2( cmd, &dependency_info );
-							}
-							// Now blit from the srcMipLevel to dstMipLevel
-
-							int32_t srcImgWidth  = int32_t( le_cmd->info.image_w );
-							int32_t srcImgHeight = int32_t( le_cmd->info.image_h );
-
-							for ( uint32_t dstMipLevel = le_cmd->info.dst_miplevel + 1; dstMipLevel < le_cmd->info.num_miplevels; dstMipLevel++ ) {
-
-								// Blit from lower mip level into next higher mip level
-								auto srcMipLevel = dstMipLevel - 1;
-
-								// Calculate width and height for next image in mip chain as half the corresponding source
-								// image dimension, unless dimension is smaller or equal to 2, in which case clamp to 1.
-								auto dstImgWidth  = srcImgWidth > 2 ? srcImgWidth >> 1 : 1;
-								auto dstImgHeight = srcImgHeight > 2 ? srcImgHeight >> 1 : 1;
-
-								VkOffset3D  offsetZero = { .x = 0, .y = 0, .z = 0 };
-								VkOffset3D  offsetSrc  = { .x = srcImgWidth, .y = srcImgHeight, .z = 1 };
-								VkOffset3D  offsetDst  = { .x = dstImgWidth, .y = dstImgHeight, .z = 1 };
-								VkImageBlit region{
-								    .srcSubresource = { VK_IMAGE_ASPECT_COLOR_BIT, srcMipLevel, 0, 1 },
-								    .srcOffsets     = { offsetZero, offsetSrc },
-								    .dstSubresource = { VK_IMAGE_ASPECT_COLOR_BIT, dstMipLevel, 0, 1 },
-								    .dstOffsets     = { offsetZero, offsetDst },
-								};
-
-								vkCmdBlitImage(
-								    cmd,
-								    dstImage, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
-								    dstImage, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
-								    1, &region, VK_FILTER_LINEAR );
-
-								// Now we barrier Read after Write, and transition our freshly blitted subresource to transferSrc,
-								// so that the next iteration may read from it.
-
-								{
-									VkImageMemoryBarrier2 finishBlit{
-									    .sType               = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER_2,
-									    .pNext               = nullptr,                              // optional
-									    .srcStageMask        = VK_PIPELINE_STAGE_2_TRANSFER_BIT,     // wait on transfer op
-									    .srcAccessMask       = VK_ACCESS_2_TRANSFER_WRITE_BIT,       // flush transfer writes so that memory becomes available to layout transition
-									    .dstStageMask        = VK_PIPELINE_STAGE_2_TRANSFER_BIT,     // before next transfer op
-									    .dstAccessMask       = VK_ACCESS_2_TRANSFER_READ_BIT,        // make transitioned image visible to subsequent transfer read ops
-									    .oldLayout           = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, // transition from transfer dst optimal
-									    .newLayout           = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, // to shader readonly optimal
-									    .srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
-									    .dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
-									    .image               = dstImage,
-									    .subresourceRange    = {
-									           .aspectMask     = VK_IMAGE_ASPECT_COLOR_BIT,
-									           .baseMipLevel   = dstMipLevel,
-									           .levelCount     = 1,
-									           .baseArrayLayer = 0,
-									           .layerCount     = 1,
-                                        },
-									};
-
-									VkDependencyInfo dependency_info{
-									    .sType                    = VK_STRUCTURE_TYPE_DEPENDENCY_INFO,
-									    .pNext                    = nullptr,
-									    .dependencyFlags          = 0,
-									    .memoryBarrierCount       = 0,
-									    .pMemoryBarriers          = 0,
-									    .bufferMemoryBarrierCount = 0,
-									    .pBufferMemoryBarriers    = 0,
-									    .imageMemoryBarrierCount  = 1,
-									    .pImageMemoryBarriers     = &finishBlit,
-									};
-
-									vkCmdPipelineBarrier2( cmd, &dependency_info );
-								}
+						build_ranges.emplace_back( build_range );
+					}
+
+					VkAccelerationStructureBuildRangeInfoKHR const* pBuildRangeInfos = build_ranges.data();
+
+					VkDeviceOrHostAddressKHR scratchDataAddr = {};
+					//  We get the device address by querying from the buffer.
+					{
+						VkBufferDeviceAddressInfo info = {
+						    .sType  = VK_STRUCTURE_TYPE_BUFFER_DEVICE_ADDRESS_INFO,
+						    .pNext  = nullptr, // optional
+						    .buffer = scratchBuffer,
+						};
+
+						scratchDataAddr.deviceAddress = vkGetBufferDeviceAddress( device, &info );
+					}
+
+					VkAccelerationStructureBuildGeometryInfoKHR info = {
+					    .sType                    = VK_STRUCTURE_TYPE_ACCELERATION_STRUCTURE_BUILD_GEOMETRY_INFO_KHR,
+					    .pNext                    = nullptr, // optional
+					    .type                     = VK_ACCELERATION_STRUCTURE_TYPE_BOTTOM_LEVEL_KHR,
+					    .flags                    = blas_info->flags, // optional
+					    .mode                     = VK_BUILD_ACCELERATION_STRUCTURE_MODE_BUILD_KHR,
+					    .srcAccelerationStructure = nullptr,                       // optional
+					    .dstAccelerationStructure = vk_acceleration_structure,     // optional
+					    .geometryCount            = uint32_t( geometries.size() ), // optional
+					    .pGeometries              = geometries.data(),             // optional
+					    .ppGeometries             = 0,
+					    .scratchData              = scratchDataAddr,
+					};
+
+					vkCmdBuildAccelerationStructuresKHR( cmd, 1, &info, &pBuildRangeInfos );
+
+					// Since the scratch buffer is reused across builds, we need a barrier to ensure one build
+					// is finished before starting the next one - theoretically we could limit this to the scratch
+					// buffer by issueing a buffer memory barrier, but since no one else will probably use the
+					// acceleration structure memory caches, we should be fine with this more general barrier.
+
+					{
+						VkMemoryBarrier2 barrier = {
+						    .sType         = VK_STRUCTURE_TYPE_MEMORY_BARRIER_2,
+						    .pNext         = nullptr,                                                  // optional
+						    .srcStageMask  = VK_PIPELINE_STAGE_2_ACCELERATION_STRUCTURE_BUILD_BIT_KHR, //
+						    .srcAccessMask = VK_ACCESS_2_ACCELERATION_STRUCTURE_WRITE_BIT_KHR,         // make anything written in previous acceleration structure build stage available
+						    .dstStageMask  = VK_PIPELINE_STAGE_2_ACCELERATION_STRUCTURE_BUILD_BIT_KHR, // before the next acceleration build stage
+						    .dstAccessMask = VK_ACCESS_2_ACCELERATION_STRUCTURE_READ_BIT_KHR,          // memory which has been previously written (and made available) must be visible after the barrier
+						};
+						VkDependencyInfo dependency_info = {
+						    .sType                    = VK_STRUCTURE_TYPE_DEPENDENCY_INFO,
+						    .pNext                    = nullptr, // optional
+						    .dependencyFlags          = 0,       // optional
+						    .memoryBarrierCount       = 1,       // optional
+						    .pMemoryBarriers          = &barrier,
+						    .bufferMemoryBarrierCount = 0, // optional
+						    .pBufferMemoryBarriers    = 0,
+						    .imageMemoryBarrierCount  = 0,
+						    .pImageMemoryBarriers     = 0,
+						};
+
+						vkCmdPipelineBarrier2( cmd, &dependency_info );
+					}
+
+				} // end for each blas element in array
+
+				break;
+			}
+			case le::CommandType::eBuildRtxTlas: {
+				auto*                       le_cmd              = static_cast<le::CommandBuildRtxTlas*>( dataIt );
+				void*                       payload_addr        = le_cmd + 1;
+				le_resource_handle const*   resources           = static_cast<le_resource_handle*>( payload_addr );
+				void*                       scratch_memory_addr = le_cmd->info.staging_buffer_mapped_memory;
+				le_rtx_geometry_instance_t* instances           = static_cast<le_rtx_geometry_instance_t*>( scratch_memory_addr );
+
+				// Foreach resource, we must patch the corresponding instance
+
+				const size_t instances_count = le_cmd->info.geometry_instances_count;
+
+				// TODO: Error checking: we should skip this command and issue a
+				// warning if any blas resource could not be found.
+
+				for ( size_t i = 0; i != instances_count; i++ ) {
+					// Update blas handles in-place on GPU mapped, coherent memory.
+					//
+					// The 64bit integer handles for bottom level acceleration structures were queried from the GPU when
+					// building bottom level acceleration structures.
+					instances[ i ].blas_handle = frame.availableResources.at( resources[ i ] ).info.blasInfo.device_address;
+				}
+
+				// Invariant: all instances should be patched right now, we can use the buffer at offset as
+				// instance data to build tlas.
+				auto const&                allocated_resource        = frame.availableResources.at( le_cmd->info.tlas_handle );
+				VkAccelerationStructureKHR vk_acceleration_structure = allocated_resource.as.tlas;
+				auto                       tlas_info                 = reinterpret_cast<le_rtx_tlas_info_o*>( allocated_resource.info.tlasInfo.handle );
+
+				// Issue barrier to make sure that transfer to instances buffer is complete
+				// before building top-level acceleration structure
+
+				{
+					VkMemoryBarrier2 barrier = {
+					    .sType         = VK_STRUCTURE_TYPE_MEMORY_BARRIER_2,
+					    .pNext         = nullptr,                                                  //
+					    .srcStageMask  = VK_PIPELINE_STAGE_2_TRANSFER_BIT,                         // transfer must happen before barrier
+					    .srcAccessMask = VK_ACCESS_2_TRANSFER_WRITE_BIT,                           // anything written in transfer must have been made available
+					    .dstStageMask  = VK_PIPELINE_STAGE_2_ACCELERATION_STRUCTURE_BUILD_BIT_KHR, // acceleration structure build must happen-after barrier
+					    .dstAccessMask = VK_ACCESS_2_ACCELERATION_STRUCTURE_WRITE_BIT_KHR,         // and memory must have been made visible to acceleration structure write
+					};
+					VkDependencyInfo dependency_info = {
+					    .sType                    = VK_STRUCTURE_TYPE_DEPENDENCY_INFO,
+					    .pNext                    = nullptr, // optional
+					    .dependencyFlags          = 0,       // optional
+					    .memoryBarrierCount       = 1,       // optional
+					    .pMemoryBarriers          = &barrier,
+					    .bufferMemoryBarrierCount = 0, // optional
+					    .pBufferMemoryBarriers    = 0,
+					    .imageMemoryBarrierCount  = 0, // optional
+					    .pImageMemoryBarriers     = 0,
+					};
+					vkCmdPipelineBarrier2( cmd, &dependency_info );
+				}
+
+				// instances information is encoded via buffer, but that buffer is also available as host memory,
+				// because it is held in staging_buffer_mapped_memory...
+				VkBuffer instanceBuffer = frame_data_get_buffer_from_le_resource_id( &frame, le_cmd->info.staging_buffer_id );
+				VkBuffer scratchBuffer  = frame_data_get_buffer_from_le_resource_id( &frame, LE_RTX_SCRATCH_BUFFER_HANDLE );
+
+				VkDeviceOrHostAddressConstKHR instanceBufferDeviceAddress = {};
+
+				{
+					VkBufferDeviceAddressInfo info = {
+					    .sType  = VK_STRUCTURE_TYPE_BUFFER_DEVICE_ADDRESS_INFO,
+					    .pNext  = nullptr, // optional
+					    .buffer = instanceBuffer,
+					};
+
+					instanceBufferDeviceAddress.deviceAddress =
+					    le_cmd->info.staging_buffer_offset +
+					    vkGetBufferDeviceAddress( device, &info );
+				}
+
+				VkAccelerationStructureGeometryKHR khr_instances_data = {
+				    .sType        = VK_STRUCTURE_TYPE_ACCELERATION_STRUCTURE_GEOMETRY_KHR,
+				    .pNext        = nullptr, // optional
+				    .geometryType = VK_GEOMETRY_TYPE_INSTANCES_KHR,
+				    .geometry     = {
+				            .instances = {
+				                .sType           = VK_STRUCTURE_TYPE_ACCELERATION_STRUCTURE_GEOMETRY_INSTANCES_DATA_KHR,
+				                .pNext           = nullptr, // optional
+				                .arrayOfPointers = false,
+				                .data            = instanceBufferDeviceAddress,
+                                } },
+				    .flags = VK_GEOMETRY_OPAQUE_BIT_KHR, // optional
+				};
+				// Take pointer to array of khr_instances - we will need one further indirection because reasons.
+
+				//  we get the device address by querying from the buffer.
+				VkDeviceOrHostAddressKHR scratch_data_addr = {};
+				{
+					VkBufferDeviceAddressInfo info = {
+					    .sType  = VK_STRUCTURE_TYPE_BUFFER_DEVICE_ADDRESS_INFO,
+					    .pNext  = nullptr, // optional
+					    .buffer = scratchBuffer,
+					};
+					scratch_data_addr.deviceAddress = vkGetBufferDeviceAddress( device, &info );
+				}
+				VkAccelerationStructureBuildGeometryInfoKHR info = {
+				    .sType                    = VK_STRUCTURE_TYPE_ACCELERATION_STRUCTURE_BUILD_GEOMETRY_INFO_KHR,
+				    .pNext                    = nullptr, // optional
+				    .type                     = VK_ACCELERATION_STRUCTURE_TYPE_TOP_LEVEL_KHR,
+				    .flags                    = tlas_info->flags, // optional
+				    .mode                     = VK_BUILD_ACCELERATION_STRUCTURE_MODE_BUILD_KHR,
+				    .srcAccelerationStructure = 0,                         // optional
+				    .dstAccelerationStructure = vk_acceleration_structure, // optional
+				    .geometryCount            = 1,                         // optional
+				    .pGeometries              = &khr_instances_data,       // optional
+				    .ppGeometries             = 0,
+				    .scratchData              = scratch_data_addr,
+				};
+
+				VkAccelerationStructureBuildRangeInfoKHR build_ranges = {
+				    .primitiveCount  = tlas_info->instances_count, // This is where we set the number of instances.
+				    .primitiveOffset = 0,                          // spec states: must be a multiple of 16?!!
+				    .firstVertex     = 0,
+				    .transformOffset = 0,
+				};
+
+				VkAccelerationStructureBuildRangeInfoKHR* p_build_ranges = &build_ranges;
 
-								// Store this miplevel image's dimensions for next iteration
-								srcImgHeight = dstImgHeight;
-								srcImgWidth  = dstImgWidth;
-							}
+				vkCmdBuildAccelerationStructuresKHR( cmd, 1, &info, &p_build_ranges );
 
-						} // end if mipLevelCount > 1
-
-						// Transition image from transfer src optimal to shader read only optimal layout
-
-						if ( le_cmd->info.num_miplevels > 1 ) {
-
-							const uint32_t base_miplevel = le_cmd->info.dst_miplevel;
-							{
-								VkImageMemoryBarrier2 revert_prepare_blit{
-									.sType               = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER_2,
-									.pNext               = nullptr,                              //
-									.srcStageMask        = VK_PIPELINE_STAGE_2_TRANSFER_BIT,     //
-									.srcAccessMask       = VK_ACCESS_2_NONE,                     // make transfer write memory available (flush) to layout transition
-									.dstStageMask        = VK_PIPELINE_STAGE_2_TRANSFER_BIT,     //
-									.dstAccessMask       = VK_ACCESS_2_TRANSFER_WRITE_BIT,       // make cache (after layout transition) visible to transferRead op
-									.oldLayout           = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, // layout transition from transfer dst optimal,
-									.newLayout           = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, // to shader readonly optimal - note: implicitly makes memory available
-									.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
-									.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
-									.image               = dstImage,
-									.subresourceRange    = { VK_IMAGE_ASPECT_COLOR_BIT, base_miplevel, 1, 0, 1 },
-								};
-
-								VkDependencyInfo dependency_info{
-									.sType                    = VK_STRUCTURE_TYPE_DEPENDENCY_INFO,
-									.pNext                    = nullptr,
-									.dependencyFlags          = 0,
-									.memoryBarrierCount       = 0,
-									.pMemoryBarriers          = 0,
-									.bufferMemoryBarrierCount = 0,
-									.pBufferMemoryBarriers    = 0,
-									.imageMemoryBarrierCount  = 1,
-									.pImageMemoryBarriers     = &revert_prepare_blit,
-								};
-
-								vkCmdPipelineBarrier2( cmd, &dependency_info );
-							}
-							{
-								VkImageMemoryBarrier2 imageLayoutToShaderReadOptimal{
-									.sType               = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER_2,
-									.pNext               = nullptr,
-									.srcStageMask        = 0,
-									.srcAccessMask       = 0,
-									.dstStageMask        = 0,
-									.dstAccessMask       = 0,
-									.oldLayout           = VK_IMAGE_LAYOUT_UNDEFINED,
-									.newLayout           = VK_IMAGE_LAYOUT_UNDEFINED,
-									.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
-									.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
-									.image               = dstImage,
-									.subresourceRange    = rangeAllRemainingMiplevels,
-								};
-
-								// If there were additional miplevels, the miplevel generation logic ensures that all subresources
-								// are left in transfer_src layout.
-
-								imageLayoutToShaderReadOptimal.srcStageMask  = VK_PIPELINE_STAGE_2_TRANSFER_BIT;     // anything in transfer must happen-before
-								imageLayoutToShaderReadOptimal.dstStageMask  = VK_PIPELINE_STAGE_2_TRANSFER_BIT;     // anything that fragment shader does
-								imageLayoutToShaderReadOptimal.srcAccessMask = VK_ACCESS_2_NONE;                     // no memory needs to be made available - nothing to flush, as previous barriers ensure flush
-								imageLayoutToShaderReadOptimal.dstAccessMask = VK_ACCESS_2_TRANSFER_WRITE_BIT;       // make layout transitioned image visible to shader read in FragmentShader stage
-								imageLayoutToShaderReadOptimal.oldLayout     = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL; // transition from transfer src optimal
-								imageLayoutToShaderReadOptimal.newLayout     = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL; // ...to shader readonly optimal -and make transitioned image available;
-
-								VkDependencyInfo dependency_info{
-									.sType                    = VK_STRUCTURE_TYPE_DEPENDENCY_INFO,
-									.pNext                    = nullptr,
-									.dependencyFlags          = 0,
-									.memoryBarrierCount       = 0,
-									.pMemoryBarriers          = 0,
-									.bufferMemoryBarrierCount = 0,
-									.pBufferMemoryBarriers    = 0,
-									.imageMemoryBarrierCount  = 1,
-									.pImageMemoryBarriers     = &imageLayoutToShaderReadOptimal,
-								};
-
-								vkCmdPipelineBarrier2( cmd, &dependency_info ); // images: prepare for shader read
-							}
-						}
+				break;
+			}
 
-						break;
-					}
-					case le::CommandType::eBuildRtxBlas: {
-						auto* le_cmd = static_cast<le::CommandBuildRtxBlas*>( dataIt );
+			case le::CommandType::eVideoDecoderExecuteCallback: {
+				auto* le_cmd = static_cast<le::CommandVideoDecoderExecuteCallback*>( dataIt );
 
-						size_t     num_blas_handles  = le_cmd->info.blas_handles_count;
-						auto const blas_handle_begin = reinterpret_cast<le_resource_handle*>( le_cmd + 1 );
+				// Call the callback uncritically, passing along the currently mapped vulkan command buffer.
+				// You need to know what you are doing with this.
+				le_cmd->info.callback( cmd, le_cmd->info.user_data, &frame );
 
-						auto const blas_end = blas_handle_begin + num_blas_handles;
+				break;
+			}
+			default: {
+				assert( false && "command not handled" );
+			}
+			} // end switch header.info.type
 
-						VkBuffer scratchBuffer = frame_data_get_buffer_from_le_resource_id( &frame, LE_RTX_SCRATCH_BUFFER_HANDLE );
+			// Move iterator by size of current le_command so that it points
+			// to the next command in the list - this may be in the next block.
+			dataIt = commandStream->next( &dataBlock, dataIt, header->info.size );
 
-						for ( auto blas_handle = blas_handle_begin; blas_handle != blas_end; blas_handle++ ) {
+			++commandIndex;
+		}
+	}
 
-							auto const&                allocated_resource        = frame.availableResources.at( *blas_handle );
-							VkAccelerationStructureKHR vk_acceleration_structure = allocated_resource.as.blas;
-							auto                       blas_info                 = reinterpret_cast<le_rtx_blas_info_o*>( allocated_resource.info.blasInfo.handle );
+	// non-draw passes don't need renderpasses.
+	if ( pass.type == le::QueueFlagBits::eGraphics && pass.renderPass ) {
+		vkCmdEndRenderPass( cmd );
+	}
 
-							// Translate geometry info from internal format toVkgeometryKHR format.
-							// We do this for each blas, which in turn may have an array of geometries.
+	if ( SHOULD_INSERT_DEBUG_LABELS ) {
+		vkCmdEndDebugUtilsLabelEXT( cmd );
+	}
 
-							std::vector<VkAccelerationStructureGeometryKHR> geometries;
-							geometries.reserve( blas_info->geometries.size() );
+	vkEndCommandBuffer( cmd );
+}
 
-							std::vector<VkAccelerationStructureBuildRangeInfoKHR> build_ranges;
-							build_ranges.reserve( blas_info->geometries.size() );
+// ----------------------------------------------------------------------
+// Decode commandStream for each pass (may happen in parallel)
+// translate into vk specific commands.
+static void backend_process_frame( le_backend_o* self, size_t frameIndex ) {
 
-							for ( auto const& g : blas_info->geometries ) {
+	ZoneScoped;
+	static auto logger = LeLog( LOGGER_LABEL );
 
-								// TODO: we may want to cache this - so that we don't have to lookup addresses more than once
+	if ( LE_PRINT_DEBUG_MESSAGES ) {
+		logger.debug( "** Process Frame #%8d **", frameIndex );
+	}
 
-								VkBuffer vertex_buffer = frame_data_get_buffer_from_le_resource_id( &frame, g.vertex_buffer );
-								VkBuffer index_buffer  = frame_data_get_buffer_from_le_resource_id( &frame, g.index_buffer );
+	using namespace le_renderer;   // for encoder
+	using namespace le_backend_vk; // for device
 
-								VkDeviceOrHostAddressConstKHR vertex_addr = { .deviceAddress = 0 };
-								VkDeviceOrHostAddressConstKHR index_addr  = { .deviceAddress = 0 };
+	auto& frame = self->mFrames[ frameIndex ];
 
-								{
-									VkBufferDeviceAddressInfo info = {
-									    .sType  = VK_STRUCTURE_TYPE_BUFFER_DEVICE_ADDRESS_INFO,
-									    .pNext  = nullptr, // optional
-									    .buffer = vertex_buffer,
-									};
+	VkDevice device = self->device->getVkDevice();
 
-									vertex_addr.deviceAddress = g.vertex_offset + vkGetBufferDeviceAddress( device, &info );
-								}
+	static_assert( sizeof( VkViewport ) == sizeof( le::Viewport ), "Viewport data size must be same in vk and le" );
+	static_assert( sizeof( VkRect2D ) == sizeof( le::Rect2D ), "Rect2D data size must be same in vk and le" );
 
-								{
-									VkBufferDeviceAddressInfo info = {
-									    .sType  = VK_STRUCTURE_TYPE_BUFFER_DEVICE_ADDRESS_INFO,
-									    .pNext  = nullptr, // optional
-									    .buffer = index_buffer,
-									};
-									index_addr.deviceAddress =
-									    g.index_count
-									        ? g.index_offset + vkGetBufferDeviceAddress( device, &info )
-									        : 0;
-								}
+	LE_SETTING( bool, LE_SETTING_BACKEND_TRANSLATE_PASSES_IN_PARALLEL, true ); // translate passes on worker threads, if the renderer runs on the job system
 
-								VkAccelerationStructureGeometryKHR geometry = {
-								    .sType        = VK_STRUCTURE_TYPE_ACCELERATION_STRUCTURE_GEOMETRY_KHR,
-								    .pNext        = nullptr, // optional
-								    .geometryType = VK_GEOMETRY_TYPE_TRIANGLES_KHR,
-								    .geometry     = {
-								            .triangles = {
-								                .sType         = VK_STRUCTURE_TYPE_ACCELERATION_STRUCTURE_GEOMETRY_TRIANGLES_DATA_KHR,
-								                .pNext         = nullptr, // optional
-								                .vertexFormat  = VkFormat( g.vertex_format ),
-								                .vertexData    = vertex_addr,
-								                .vertexStride  = g.vertex_stride,
-								                .maxVertex     = g.vertex_count - 1, // highest index of a vertex that will be accessed via build command
-								                .indexType     = VkIndexType( g.index_type ),
-								                .indexData     = index_addr,
-								                .transformData = {}, // no transform data
-                                        } },
-								    .flags = VK_GEOMETRY_OPAQUE_BIT_KHR, // optional
-								};
-
-								geometries.emplace_back( geometry );
-
-								VkAccelerationStructureBuildRangeInfoKHR build_range = {
-								    .primitiveCount  = 0,
-								    .primitiveOffset = 0,
-								    .firstVertex     = 0,
-								    .transformOffset = 0,
-								};
-
-								if ( g.index_count ) {
-									// indexed geometry
-									build_range.primitiveCount = g.index_count / 3;
-								} else {
-									// non-indexed geometry
-									build_range.primitiveCount = g.vertex_count / 3;
-								}
+	// We may only wait for jobs if we are running inside the job system ourselves.
+	bool const should_translate_passes_in_parallel =
+	    *LE_SETTING_BACKEND_TRANSLATE_PASSES_IN_PARALLEL &&
+	    le_jobs::get_current_worker_id() >= 0 &&
+	    frame.passes.size() > 1;
 
-								build_ranges.emplace_back( build_range );
-							}
+	bool needs_to_collect_root_pass_names = frame.must_create_queues_dot_graph; // only collect root pass names when these are needed, for example in order to create dot graphs or debug printouts
 
-							VkAccelerationStructureBuildRangeInfoKHR const* pBuildRangeInfos = build_ranges.data();
+	{
 
-							VkDeviceOrHostAddressKHR scratchDataAddr = {};
-							//  We get the device address by querying from the buffer.
-							{
-								VkBufferDeviceAddressInfo info = {
-								    .sType  = VK_STRUCTURE_TYPE_BUFFER_DEVICE_ADDRESS_INFO,
-								    .pNext  = nullptr, // optional
-								    .buffer = scratchBuffer,
-								};
+		frame_build_queue_submission_data( frame, needs_to_collect_root_pass_names );
 
-								scratchDataAddr.deviceAddress = vkGetBufferDeviceAddress( device, &info );
-							}
+		// -- Control that resources may only be used by the same queue family per-frame.
+		// we adjust for this by making the queue requirements a superset of all resource queue usages,
+		// and accumulating all queue usages per-resource first.
 
-							VkAccelerationStructureBuildGeometryInfoKHR info = {
-							    .sType                    = VK_STRUCTURE_TYPE_ACCELERATION_STRUCTURE_BUILD_GEOMETRY_INFO_KHR,
-							    .pNext                    = nullptr, // optional
-							    .type                     = VK_ACCELERATION_STRUCTURE_TYPE_BOTTOM_LEVEL_KHR,
-							    .flags                    = blas_info->flags, // optional
-							    .mode                     = VK_BUILD_ACCELERATION_STRUCTURE_MODE_BUILD_KHR,
-							    .srcAccelerationStructure = nullptr,                       // optional
-							    .dstAccelerationStructure = vk_acceleration_structure,     // optional
-							    .geometryCount            = uint32_t( geometries.size() ), // optional
-							    .pGeometries              = geometries.data(),             // optional
-							    .ppGeometries             = 0,
-							    .scratchData              = scratchDataAddr,
-							};
+		if ( self->must_track_resources_queue_family_ownership ) {
+			// We only must do this if we have multiple queue families active
+			// as this can get pretty expensive if there are many resources flying around.
 
-							vkCmdBuildAccelerationStructuresKHR( cmd, 1, &info, &pBuildRangeInfos );
-
-							// Since the scratch buffer is reused across builds, we need a barrier to ensure one build
-							// is finished before starting the next one - theoretically we could limit this to the scratch
-							// buffer by issueing a buffer memory barrier, but since no one else will probably use the
-							// acceleration structure memory caches, we should be fine with this more general barrier.
-
-							{
-								VkMemoryBarrier2 barrier = {
-								    .sType         = VK_STRUCTURE_TYPE_MEMORY_BARRIER_2,
-								    .pNext         = nullptr,                                                  // optional
-								    .srcStageMask  = VK_PIPELINE_STAGE_2_ACCELERATION_STRUCTURE_BUILD_BIT_KHR, //
-								    .srcAccessMask = VK_ACCESS_2_ACCELERATION_STRUCTURE_WRITE_BIT_KHR,         // make anything written in previous acceleration structure build stage available
-								    .dstStageMask  = VK_PIPELINE_STAGE_2_ACCELERATION_STRUCTURE_BUILD_BIT_KHR, // before the next acceleration build stage
-								    .dstAccessMask = VK_ACCESS_2_ACCELERATION_STRUCTURE_READ_BIT_KHR,          // memory which has been previously written (and made available) must be visible after the barrier
-								};
-								VkDependencyInfo dependency_info = {
-								    .sType                    = VK_STRUCTURE_TYPE_DEPENDENCY_INFO,
-								    .pNext                    = nullptr, // optional
-								    .dependencyFlags          = 0,       // optional
-								    .memoryBarrierCount       = 1,       // optional
-								    .pMemoryBarriers          = &barrier,
-								    .bufferMemoryBarrierCount = 0, // optional
-								    .pBufferMemoryBarriers    = 0,
-								    .imageMemoryBarrierCount  = 0,
-								    .pImageMemoryBarriers     = 0,
-								};
-
-								vkCmdPipelineBarrier2( cmd, &dependency_info );
-							}
+			// We do this to prevent a situation where a resource is claimed by two or more queue families
+			// Ideally, this
 
-						} // end for each blas element in array
+			// for each resource, accumulate all queue type flags that it gets used with over all submissions
 
-						break;
+			std::unordered_map<le_resource_handle, VkQueueFlags> resource_queue_flags;
+
+			for ( auto const& qs : frame.queue_submission_data ) {
+				for ( auto const& pi : qs.pass_indices ) {
+					for ( auto const& r : frame.passes[ pi ].resources ) {
+						resource_queue_flags[ r ] |= qs.queue_flags;
 					}
-					case le::CommandType::eBuildRtxTlas: {
-						auto*                       le_cmd              = static_cast<le::CommandBuildRtxTlas*>( dataIt );
-						void*                       payload_addr        = le_cmd + 1;
-						le_resource_handle const*   resources           = static_cast<le_resource_handle*>( payload_addr );
-						void*                       scratch_memory_addr = le_cmd->info.staging_buffer_mapped_memory;
-						le_rtx_geometry_instance_t* instances           = static_cast<le_rtx_geometry_instance_t*>( scratch_memory_addr );
-
-						// Foreach resource, we must patch the corresponding instance
-
-						const size_t instances_count = le_cmd->info.geometry_instances_count;
-
-						// TODO: Error checking: we should skip this command and issue a
-						// warning if any blas resource could not be found.
-
-						for ( size_t i = 0; i != instances_count; i++ ) {
-							// Update blas handles in-place on GPU mapped, coherent memory.
-							//
-							// The 64bit integer handles for bottom level acceleration structures were queried from the GPU when
-							// building bottom level acceleration structures.
-							instances[ i ].blas_handle = frame.availableResources.at( resources[ i ] ).info.blasInfo.device_address;
-						}
+				}
+			}
 
-						// Invariant: all instances should be patched right now, we can use the buffer at offset as
-						// instance data to build tlas.
-						auto const&                allocated_resource        = frame.availableResources.at( le_cmd->info.tlas_handle );
-						VkAccelerationStructureKHR vk_acceleration_structure = allocated_resource.as.tlas;
-						auto                       tlas_info                 = reinterpret_cast<le_rtx_tlas_info_o*>( allocated_resource.info.tlasInfo.handle );
+			// now accumulate submission's queue flags based on the queue flags that all its resources have
 
-						// Issue barrier to make sure that transfer to instances buffer is complete
-						// before building top-level acceleration structure
+			for ( auto& qs : frame.queue_submission_data ) {
+				for ( auto const& pi : qs.pass_indices ) {
+					VkQueueFlags flags = qs.queue_flags;
+					for ( auto const& r : frame.passes[ pi ].resources ) {
+						flags |= resource_queue_flags.at( r );
+					}
+					qs.queue_flags = flags;
+				}
+			}
+		}
 
-						{
-							VkMemoryBarrier2 barrier = {
-							    .sType         = VK_STRUCTURE_TYPE_MEMORY_BARRIER_2,
-							    .pNext         = nullptr,                                                  //
-							    .srcStageMask  = VK_PIPELINE_STAGE_2_TRANSFER_BIT,                         // transfer must happen before barrier
-							    .srcAccessMask = VK_ACCESS_2_TRANSFER_WRITE_BIT,                           // anything written in transfer must have been made available
-							    .dstStageMask  = VK_PIPELINE_STAGE_2_ACCELERATION_STRUCTURE_BUILD_BIT_KHR, // acceleration structure build must happen-after barrier
-							    .dstAccessMask = VK_ACCESS_2_ACCELERATION_STRUCTURE_WRITE_BIT_KHR,         // and memory must have been made visible to acceleration structure write
-							};
-							VkDependencyInfo dependency_info = {
-							    .sType                    = VK_STRUCTURE_TYPE_DEPENDENCY_INFO,
-							    .pNext                    = nullptr, // optional
-							    .dependencyFlags          = 0,       // optional
-							    .memoryBarrierCount       = 1,       // optional
-							    .pMemoryBarriers          = &barrier,
-							    .bufferMemoryBarrierCount = 0, // optional
-							    .pBufferMemoryBarriers    = 0,
-							    .imageMemoryBarrierCount  = 0, // optional
-							    .pImageMemoryBarriers     = 0,
-							};
-							vkCmdPipelineBarrier2( cmd, &dependency_info );
-						}
+		{
+			/// Assign queues to each submission:
+			///
+			/// we must have a unique mapping from queue_flags to queue family.
+			///
+			/// from this, we can then go through all queues of the queue family
+			/// and pick the queue with the least submissions.
+			///
+			std::vector<uint32_t> num_submissions_per_queue( num_invocation_keys, 0 );
+			for ( size_t i = 0; i != num_invocation_keys; i++ ) {
 
-						// instances information is encoded via buffer, but that buffer is also available as host memory,
-						// because it is held in staging_buffer_mapped_memory...
-						VkBuffer instanceBuffer = frame_data_get_buffer_from_le_resource_id( &frame, le_cmd->info.staging_buffer_id );
-						VkBuffer scratchBuffer  = frame_data_get_buffer_from_le_resource_id( &frame, LE_RTX_SCRATCH_BUFFER_HANDLE );
+				auto const& queues = self->queues;
+				auto const& flags  = frame.queue_submission_data[ i ].queue_flags;
 
-						VkDeviceOrHostAddressConstKHR instanceBufferDeviceAddress = {};
+				int      matching_queue          = -1;
+				uint32_t lowest_submission_count = uint32_t( ~0 );
 
-						{
-							VkBufferDeviceAddressInfo info = {
-							    .sType  = VK_STRUCTURE_TYPE_BUFFER_DEVICE_ADDRESS_INFO,
-							    .pNext  = nullptr, // optional
-							    .buffer = instanceBuffer,
-							};
+				uint32_t matching_queue_family_index = backend_find_queue_family_index_from_requirements( self, flags );
 
-							instanceBufferDeviceAddress.deviceAddress =
-							    le_cmd->info.staging_buffer_offset +
-							    vkGetBufferDeviceAddress( device, &info );
+				// try to find an exact match with the lowest submissions to it
+				for ( uint32_t j = 0; j != queues.size(); j++ ) {
+					if ( queues[ j ]->queue_family_index == matching_queue_family_index ) {
+						// all flags are contained in q.queue_flags
+						if ( num_submissions_per_queue[ j ] < lowest_submission_count ) {
+							matching_queue          = j;
+							lowest_submission_count = num_submissions_per_queue[ j ];
 						}
+					}
+				}
 
-						VkAccelerationStructureGeometryKHR khr_instances_data = {
-						    .sType        = VK_STRUCTURE_TYPE_ACCELERATION_STRUCTURE_GEOMETRY_KHR,
-						    .pNext        = nullptr, // optional
-						    .geometryType = VK_GEOMETRY_TYPE_INSTANCES_KHR,
-						    .geometry     = {
-						            .instances = {
-						                .sType           = VK_STRUCTURE_TYPE_ACCELERATION_STRUCTURE_GEOMETRY_INSTANCES_DATA_KHR,
-						                .pNext           = nullptr, // optional
-						                .arrayOfPointers = false,
-						                .data            = instanceBufferDeviceAddress,
-                                } },
-						    .flags = VK_GEOMETRY_OPAQUE_BIT_KHR, // optional
-						};
-						// Take pointer to array of khr_instances - we will need one further indirection because reasons.
+				if ( matching_queue == -1 ) {
+					le::Log( LOGGER_LABEL ).error( "Could not find matching queue with capability: %s\n"
+					                               "This could be caused by one or more queue families claiming ownership of the same resource.",
+					                               to_string_vk_queue_flags( flags ).c_str() );
+				}
 
-						//  we get the device address by querying from the buffer.
-						VkDeviceOrHostAddressKHR scratch_data_addr = {};
-						{
-							VkBufferDeviceAddressInfo info = {
-							    .sType  = VK_STRUCTURE_TYPE_BUFFER_DEVICE_ADDRESS_INFO,
-							    .pNext  = nullptr, // optional
-							    .buffer = scratchBuffer,
-							};
-							scratch_data_addr.deviceAddress = vkGetBufferDeviceAddress( device, &info );
-						}
-						VkAccelerationStructureBuildGeometryInfoKHR info = {
-						    .sType                    = VK_STRUCTURE_TYPE_ACCELERATION_STRUCTURE_BUILD_GEOMETRY_INFO_KHR,
-						    .pNext                    = nullptr, // optional
-						    .type                     = VK_ACCELERATION_STRUCTURE_TYPE_TOP_LEVEL_KHR,
-						    .flags                    = tlas_info->flags, // optional
-						    .mode                     = VK_BUILD_ACCELERATION_STRUCTURE_MODE_BUILD_KHR,
-						    .srcAccelerationStructure = 0,                         // optional
-						    .dstAccelerationStructure = vk_acceleration_structure, // optional
-						    .geometryCount            = 1,                         // optional
-						    .pGeometries              = &khr_instances_data,       // optional
-						    .ppGeometries             = 0,
-						    .scratchData              = scratch_data_addr,
-						};
+				assert( matching_queue != -1 && "must have found matching queue" );
 
-						VkAccelerationStructureBuildRangeInfoKHR build_ranges = {
-						    .primitiveCount  = tlas_info->instances_count, // This is where we set the number of instances.
-						    .primitiveOffset = 0,                          // spec states: must be a multiple of 16?!!
-						    .firstVertex     = 0,
-						    .transformOffset = 0,
-						};
+				num_submissions_per_queue[ matching_queue ]++;
 
-						VkAccelerationStructureBuildRangeInfoKHR* p_build_ranges = &build_ranges;
+				frame.queue_submission_data[ i ].queue_idx = matching_queue;
+			}
+		}
 
-						vkCmdBuildAccelerationStructuresKHR( cmd, 1, &info, &p_build_ranges );
+		// for each submission data, allocate pool from the correct queue
+		//
+		// If we translate passes in parallel, each pass gets a pool of its own, so that
+		// no two threads ever record into command buffers allocated from the same pool.
+		// We must allocate all pools here, as producing a pool is not thread-safe.
 
-						break;
-					}
+		for ( auto& data : frame.queue_submission_data ) {
+			// this submission has passes
+			// find available command pool which has the correct queue family.
 
-					case le::CommandType::eVideoDecoderExecuteCallback: {
-						auto* le_cmd = static_cast<le::CommandVideoDecoderExecuteCallback*>( dataIt );
+			uint32_t const num_pools            = should_translate_passes_in_parallel ? uint32_t( data.pass_indices.size() ) : 1;
+			uint32_t const num_buffers_per_pool = should_translate_passes_in_parallel ? 1 : uint32_t( data.pass_indices.size() );
 
-						// Call the callback uncritically, passing along the currently mapped vulkan command buffer.
-						// You need to know what you are doing with this.
-						le_cmd->info.callback( cmd, le_cmd->info.user_data, &frame );
+			data.command_buffers.clear();
 
-						break;
-					}
-					default: {
-						assert( false && "command not handled" );
-					}
-					} // end switch header.info.type
+			for ( uint32_t i = 0; i != num_pools; i++ ) {
 
-					// Move iterator by size of current le_command so that it points
-					// to the next command in the list.
-					dataIt = static_cast<char*>( dataIt ) + header->info.size;
+				data.command_pool = backend_frame_data_produce_command_pool( frame, self->queues[ data.queue_idx ]->queue_family_index, self->device->getVkDevice() );
 
-					++commandIndex;
-				}
-			}
+				VkCommandBufferAllocateInfo info = {
+				    .sType              = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO,
+				    .pNext              = nullptr, // optional
+				    .commandPool        = data.command_pool->pool,
+				    .level              = VK_COMMAND_BUFFER_LEVEL_PRIMARY,
+				    .commandBufferCount = num_buffers_per_pool,
+				};
 
-			// non-draw passes don't need renderpasses.
-			if ( pass.type == le::QueueFlagBits::eGraphics && pass.renderPass ) {
-				vkCmdEndRenderPass( cmd );
+				data.command_pool->buffers.resize( info.commandBufferCount );
+				vkAllocateCommandBuffers( device, &info, data.command_pool->buffers.data() );
+
+				data.command_buffers.insert( data.command_buffers.end(), data.command_pool->buffers.begin(), data.command_pool->buffers.end() );
 			}
+		}
 
-			if ( SHOULD_INSERT_DEBUG_LABELS ) {
-				vkCmdEndDebugUtilsLabelEXT( cmd );
+		if ( LE_PRINT_DEBUG_MESSAGES ) {
+			logger.info( "Listing queue batches and their queue affinity:" );
+			int i = 0;
+			for ( auto const& qf : frame.queue_submission_data ) {
+				logger.info( "#%i, [%-50s]", i, to_string_vk_queue_flags( qf.queue_flags ).c_str() );
+				i++;
 			}
+			logger.info( "" );
+		}
+	}
+
+	// Translate passes into command buffers - one command buffer per pass.
+	//
+	// If we are running inside the job system, we translate passes concurrently:
+	// in this case, each pass has a command pool of its own, as command pools
+	// must not be accessed from more than one thread at a time.
+
+	struct translate_params_t {
+		le_backend_o*     self;
+		BackendFrameData* frame;
+		uint32_t          pass_index;
+		uint32_t          queue_idx;
+		VkCommandBuffer   cmd;
+	};
+
+	std::vector<translate_params_t> translate_params;
+
+	for ( auto const& submission : frame.queue_submission_data ) {
+		for ( size_t i = 0; i != submission.pass_indices.size(); i++ ) {
+			translate_params.push_back( { self, &frame, submission.pass_indices[ i ], submission.queue_idx, submission.command_buffers[ i ] } );
+		}
+	}
+
+	if ( should_translate_passes_in_parallel ) {
+
+		std::vector<le_jobs::job_t> jobs;
+		jobs.reserve( translate_params.size() );
+
+		for ( auto& p : translate_params ) {
+			jobs.push_back( { []( void* param_ ) {
+				                 auto p = static_cast<translate_params_t*>( param_ );
+				                 backend_translate_pass( p->self, *p->frame, p->pass_index, p->queue_idx, p->cmd );
+			                 },
+			                  &p } );
+		}
+
+		le_jobs::counter_t* counter;
+		le_jobs::run_jobs( jobs.data(), uint32_t( jobs.size() ), &counter );
+		le_jobs::wait_for_counter_and_free( counter, 0 );
 
-			vkEndCommandBuffer( cmd );
+	} else {
+		for ( auto const& p : translate_params ) {
+			backend_translate_pass( p.self, *p.frame, p.pass_index, p.queue_idx, p.cmd );
 		}
 	}
 }
@@ -7936,9 +9014,9 @@ static bool backend_dispatch_frame( le_backend_o* self, size_t frameIndex ) {
 		ZoneScopedN( "SubmitToQueue" );
 		// Prepare command buffers for submission
 		std::vector<VkCommandBufferSubmitInfo> command_buffer_submit_infos;
-		command_buffer_submit_infos.reserve( current_submission.command_pool->buffers.size() ); // one command buffer per pass
+		command_buffer_submit_infos.reserve( current_submission.command_buffers.size() ); // one command buffer per pass
 
-		for ( auto const& c : current_submission.command_pool->buffers ) {
+		for ( auto const& c : current_submission.command_buffers ) {
 			command_buffer_submit_infos.push_back(
 			    {
 			        .sType         = VK_STRUCTURE_TYPE_COMMAND_BUFFER_SUBMIT_INFO,
@@ -8090,6 +9168,184 @@ static void backend_set_frame_queue_submission_keys( le_backend_o* self, size_t
 	memcpy( frame.queue_submission_keys.data(), p_affinity_masks, sizeof( le::RootPassesField ) * num_affinity_masks );
 }
 
+// ----------------------------------------------------------------------
+// Dry run: Plans a frame for the given renderpasses without creating any
+// Vulkan objects, and without touching any of the backend's frames.
+//
+// This runs the same steps as acquire_physical_resources, and process_frame,
+// up until the point where these would start talking to the device:
+// resource infos are consolidated, sync chains are tracked, barriers are
+// placed, and passes are split into queue submissions.
+//
+// Since no resources exist yet, all resources start out in their initial
+// (undefined) state - just as they would on the first frame in which they
+// are used.
+//
+// Passes must have been built (and must have their affinity set) by the
+// rendergraph. Passes are left untouched: we plan using copies of the
+// passes, as planning patches pass extents.
+//
+// The backend does not need to have been set up for this - if it has not
+// been set up, image formats which can't be inferred fall back to generic
+// defaults.
+static bool backend_plan_frame( le_backend_o*             self,
+                                le_renderpass_o* const*   source_passes,
+                                size_t                    numRenderPasses,
+                                le_resource_handle const* declared_resources,
+                                le_resource_info_t const* declared_resources_infos,
+                                size_t                    declared_resources_count,
+                                void const*               p_affinity_masks,
+                                uint32_t                  num_affinity_masks,
+                                le_backend_frame_plan_t*  plan ) {
+
+	ZoneScoped;
+	using namespace le_renderer;
+
+	BackendFrameData frame{}; // scratch frame, only lives for the duration of this call
+
+	// Copies don't own an encoder - encoders stay with the source passes.
+	std::vector<le_renderpass_o*> pass_copies( numRenderPasses );
+	for ( size_t i = 0; i != numRenderPasses; i++ ) {
+		pass_copies[ i ] = renderpass_i.clone( source_passes[ i ] );
+		renderpass_i.steal_encoder( pass_copies[ i ] );
+	}
+	le_renderpass_o** passes = pass_copies.data();
+
+	frame_declare_resources( frame, declared_resources, declared_resources_infos, declared_resources_count );
+
+	patch_renderpass_extents( passes, numRenderPasses, DEFAULT_RENDERPASS_WIDTH, DEFAULT_RENDERPASS_HEIGHT );
+
+	std::unordered_map<le_resource_handle, le_resource_info_t> active_resources;
+
+	collect_resource_infos_per_resource( passes, numRenderPasses, frame.declared_resources, active_resources );
+	insert_msaa_versions( active_resources );
+
+	for ( auto const& [ resource, resourceInfo ] : active_resources ) {
+
+		AllocatedResourceVk allocatedResource{};
+		allocatedResource.info = ResourceCreateInfo::from_le_resource_info( resourceInfo );
+
+		if ( allocatedResource.info.isImage() ) {
+
+			patchImageUsageForMipLevels( &allocatedResource.info );
+
+			if ( allocatedResource.info.imageInfo.format == VK_FORMAT_UNDEFINED ) {
+				auto format = infer_image_format_from_le_image_usage_flags( self, resourceInfo.image.usage );
+				if ( format == le::Format::eUndefined ) {
+					format = ( resourceInfo.image.usage & le::ImageUsageFlags( le::ImageUsageFlagBits::eDepthStencilAttachment ) )
+					             ? le::Format::eD32Sfloat
+					             : le::Format::eR8G8B8A8Unorm;
+				}
+				allocatedResource.info.imageInfo.format = VkFormat( format );
+			}
+		}
+
+		frame.availableResources.emplace( resource, allocatedResource );
+	}
+
+	for ( auto const& res : frame.availableResources ) {
+		frame.syncChainTable.insert( { res.first, { res.second.state } } );
+	}
+
+	frame_track_resource_state( frame, passes, numRenderPasses, {} );
+
+	frame.queue_submission_keys.resize( num_affinity_masks );
+	memcpy( frame.queue_submission_keys.data(), p_affinity_masks, sizeof( le::RootPassesField ) * num_affinity_masks );
+
+	frame_build_queue_submission_data( frame, false );
+
+	// -- Translate into plan
+
+	auto to_sync_state = []( ResourceState const& state ) -> le_backend_frame_plan_t::SyncState {
+		return { uint64_t( state.stage ), uint64_t( state.visible_access ), uint32_t( state.layout ) };
+	};
+
+	plan->passes.clear();
+	plan->resources.clear();
+	plan->submissions.clear();
+
+	plan->passes.reserve( frame.passes.size() );
+
+	for ( size_t i = 0; i != frame.passes.size(); i++ ) {
+
+		auto const& pass = frame.passes[ i ];
+
+		le_backend_frame_plan_t::Pass plan_pass{};
+
+		plan_pass.debug_name = renderpass_i.get_debug_name( source_passes[ i ] );
+		plan_pass.type       = pass.type;
+		plan_pass.affinity   = pass.root_passes_affinity;
+		plan_pass.width      = pass.width;
+		plan_pass.height     = pass.height;
+
+		for ( auto const& op : pass.explicit_sync_ops ) {
+			ResourceState const* stateInitial = nullptr;
+			ResourceState const* stateFinal   = nullptr;
+			if ( frame_explicit_sync_op_needs_barrier( frame, op, &stateInitial, &stateFinal ) ) {
+				plan_pass.barriers.push_back( { op.resource, to_sync_state( *stateInitial ), to_sync_state( *stateFinal ) } );
+			}
+		}
+
+		const size_t numAttachments = pass.numColorAttachments +
+		                              pass.numDepthStencilAttachments +
+		                              pass.numResolveAttachments;
+
+		for ( size_t a = 0; a != numAttachments; a++ ) {
+			auto const& attachment = pass.attachments[ a ];
+			auto const& syncChain  = frame.syncChainTable.at( attachment.resource );
+			plan_pass.attachments.push_back( { attachment.resource,
+			                                   to_sync_state( syncChain[ attachment.initialStateOffset ] ),
+			                                   to_sync_state( syncChain[ attachment.finalStateOffset ] ) } );
+		}
+
+		plan->passes.emplace_back( std::move( plan_pass ) );
+	}
+
+	{
+		std::vector<le_resource_handle> resources;
+		resources.reserve( frame.syncChainTable.size() );
+
+		for ( auto const& tbl : frame.syncChainTable ) {
+			resources.push_back( tbl.first );
+		}
+
+		std::sort( resources.begin(), resources.end() );
+
+		std::vector<le_transient_resource_lifetime_t> lifetimes;
+		frame_calculate_transient_resource_lifetimes( passes, numRenderPasses, resources, lifetimes );
+
+		plan->resources.resize( resources.size() );
+
+		for ( size_t i = 0; i != resources.size(); i++ ) {
+
+			auto& r = plan->resources[ i ];
+
+			r.handle     = resources[ i ];
+			r.first_pass = lifetimes[ i ].first_use;
+			r.last_pass  = lifetimes[ i ].last_use;
+
+			auto it = active_resources.find( resources[ i ] );
+			if ( it != active_resources.end() ) {
+				r.info = it->second;
+			}
+
+			for ( auto const& state : frame.syncChainTable.at( resources[ i ] ) ) {
+				r.sync_chain.push_back( to_sync_state( state ) );
+			}
+		}
+	}
+
+	for ( auto const& submission : frame.queue_submission_data ) {
+		plan->submissions.push_back( { submission.key, uint32_t( submission.queue_flags ), submission.pass_indices } );
+	}
+
+	for ( auto& p : pass_copies ) {
+		renderpass_i.destroy( p );
+	}
+
+	return true;
+}
+
 // ----------------------------------------------------------------------
 
 static le_rtx_blas_info_handle backend_create_rtx_blas_info( le_backend_o* self, le_rtx_geometry_t const* geometries, uint32_t geometries_count, le::BuildAccelerationStructureFlagsKHR const* flags ) {
@@ -8150,12 +9406,15 @@ LE_MODULE_REGISTER_IMPL( le_backend_vk, api_ ) {
 	vk_backend_i.get_transient_allocators        = backend_get_transient_allocators;
 	vk_backend_i.get_staging_allocator           = backend_get_staging_allocator;
 	vk_backend_i.get_frame_command_streams       = backend_get_frame_command_streams;
+	vk_backend_i.get_frame_scratch_command_streams = backend_get_frame_scratch_command_streams;
+	vk_backend_i.get_frame_command_stream_stats  = backend_get_frame_command_stream_stats;
 	vk_backend_i.poll_frame_fence                = backend_poll_frame_fence;
 	vk_backend_i.clear_frame                     = backend_clear_frame;
 	vk_backend_i.acquire_physical_resources      = backend_acquire_physical_resources;
 	vk_backend_i.process_frame                   = backend_process_frame;
 	vk_backend_i.dispatch_frame                  = backend_dispatch_frame;
 	vk_backend_i.set_frame_queue_submission_keys = backend_set_frame_queue_submission_keys;
+	vk_backend_i.plan_frame                      = backend_plan_frame;
 
 	vk_backend_i.get_pipeline_cache    = backend_get_pipeline_cache;
 	vk_backend_i.update_shader_modules = backend_update_shader_modules;
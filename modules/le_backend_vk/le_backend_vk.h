@@ -19,6 +19,7 @@ struct le_staging_allocator_o;
 struct le_resource_handle_t; // defined in renderer_types
 struct le_command_stream_t;
 struct le_on_frame_clear_callback_data_t;
+struct le_backend_frame_plan_t; // defined in private/le_backend_vk/le_backend_frame_plan.h
 
 struct le_pipeline_manager_o;
 
@@ -117,6 +118,14 @@ struct le_pipeline_and_layout_info_t {
 	le_pipeline_layout_info layout_info;
 };
 
+// Per-frame command stream telemetry - summed over all command streams of a frame.
+struct le_command_stream_stats_t {
+	size_t num_streams;        // number of command streams in use by frame
+	size_t num_commands;       // number of commands recorded
+	size_t num_bytes;          // number of bytes recorded
+	size_t num_bytes_reserved; // number of bytes held by command streams
+};
+
 struct le_backend_vk_api {
 
 	struct backend_vk_settings_interface_t // global settings for backend - must be set before backend setup- after that, settings are read-only.
@@ -148,10 +157,13 @@ struct le_backend_vk_api {
 		void                   ( *process_frame              ) ( le_backend_o *self, size_t frameIndex );
 		bool                   ( *acquire_physical_resources ) ( le_backend_o *self, size_t frameIndex, le_renderpass_o **passes, size_t numRenderPasses, le_resource_handle const * declared_resources, le_resource_info_t const * declared_resources_infos, size_t const & declared_resources_count );
 		void                   ( *set_frame_queue_submission_keys ) ( le_backend_o *self, size_t frameIndex, void const * p_affinity_masks, uint32_t num_affinity_masks, char const** root_names, uint32_t root_names_count); // void* p_affinity_masks must be cast to le::RootPassesField, we can't forward-declare a using declaration
+		bool                   ( *plan_frame                 ) ( le_backend_o *self, le_renderpass_o * const *passes, size_t numRenderPasses, le_resource_handle const * declared_resources, le_resource_info_t const * declared_resources_infos, size_t declared_resources_count, void const * p_affinity_masks, uint32_t num_affinity_masks, le_backend_frame_plan_t* plan ); // dry run: plans a frame without touching the device
 
 		bool                   ( *dispatch_frame             ) ( le_backend_o *self, size_t frameIndex );
 		le_allocator_o**       ( *get_transient_allocators   ) ( le_backend_o* self, size_t frameIndex);
-		le_command_stream_t**  ( *get_frame_command_streams  ) ( le_backend_o* self, size_t frameIndex, size_t num_command_streams);
+		le_command_stream_t**  ( *get_frame_command_streams  ) ( le_backend_o* self, size_t frameIndex, size_t num_command_streams, uint64_t const* pass_ids); // pass_ids: one per command stream, may be nullptr
+		le_command_stream_t**  ( *get_frame_scratch_command_streams ) ( le_backend_o* self, size_t frameIndex, size_t num_command_streams); // one per pass: for encoders to record sorted draws into
+		void                   ( *get_frame_command_stream_stats ) ( le_backend_o* self, size_t frameIndex, le_command_stream_stats_t* stats); // valid once frame was recorded, until frame gets cleared
 		le_staging_allocator_o*( *get_staging_allocator      ) ( le_backend_o* self, size_t frameIndex);
 
 		le_shader_module_handle( *create_shader_module       ) ( le_backend_o* self, char const * path, const LeShaderSourceLanguageEnum& shader_source_language, const le::ShaderStageFlagBits& moduleType, char const * macro_definitions, le_shader_module_handle handle, VkSpecializationMapEntry const * specialization_map_entries, uint32_t specialization_map_entries_count, void * specialization_map_data, uint32_t specialization_map_data_num_bytes);
@@ -275,6 +287,12 @@ struct le_backend_vk_api {
 		le_pipeline_and_layout_info_t            ( *produce_rtx_pipeline              ) ( le_pipeline_manager_o *self, le_rtxpso_handle rtxpsoHandle, char ** shader_group_data);
 		le_pipeline_and_layout_info_t            ( *produce_compute_pipeline          ) ( le_pipeline_manager_o *self, le_cpso_handle cpsoHandle);
 
+		// Creates pipelines ahead of their first use - on background workers if called from within the job system.
+		void                                     ( *prewarm_pipelines                 ) ( le_pipeline_manager_o *self, le_gpso_handle const * gpsoHandles, size_t num_gpso_handles, le_cpso_handle const * cpsoHandles, size_t num_cpso_handles);
+
+		// Destroys render pass once no background pipeline compilation uses it anymore.
+		void                                     ( *destroy_render_pass               ) ( le_pipeline_manager_o *self, struct VkRenderPass_T* render_pass);
+
 		le_shader_module_handle                  ( *create_shader_module              ) ( le_pipeline_manager_o* self, char const * path, const LeShaderSourceLanguageEnum& shader_source_language, const le::ShaderStageFlagBits& moduleType, char const *macro_definitions, le_shader_module_handle handle, VkSpecializationMapEntry const * specialization_map_entries, uint32_t specialization_map_entries_count, void * specialization_map_data, uint32_t specialization_map_data_num_bytes);
 		le_shader_module_handle                  ( *create_shader_module_from_spirv   ) ( le_pipeline_manager_o* self, uint32_t const * spirv_code, uint32_t spirv_code_length, const le::ShaderStageFlagBits& moduleType, le_shader_module_handle handle, VkSpecializationMapEntry const * specialization_map_entries, uint32_t specialization_map_entries_count, void * specialization_map_data, uint32_t specialization_map_data_num_bytes);
 		void                                     ( *update_shader_modules             ) ( le_pipeline_manager_o* self );
@@ -5,14 +5,15 @@
 #include <string>
 #include <set>
 #include <unordered_map>
+#include <unordered_set>
 
 #include <filesystem> // for parsing shader source file paths
 #include <fstream>    // for reading shader source files
 #include <cstring>    // for memcpy
 #include <mutex>
-#include <shared_mutex>
 #include <atomic>
 #include <algorithm>
+#include <type_traits>
 
 #include "le_core.h"
 #include "le_shader_compiler.h"
@@ -21,6 +22,7 @@
 
 #include "le_file_watcher.h" // for watching shader source files
 #include "le_log.h"
+#include "le_jobs.h" // for compiling pipelines in the background
 #include "3rdparty/src/spooky/SpookyV2.h" // for hashing renderpass gestalt, so that we can test for *compatible* renderpasses
 
 static constexpr auto LOGGER_LABEL = "le_pipeline";
@@ -29,6 +31,14 @@ static constexpr auto LOGGER_LABEL = "le_pipeline";
 #include "private/le_backend_vk/le_backend_types_pipeline.inl"
 
 #include "le_tracy.h"
+#include "private/le_renderer/le_intern_table.h" // for lock-free lookups in pipeline and shader module caches
+
+#ifdef _MSC_VER
+#	define NOMINMAX     // we do this so that Windows.h does not define min and max macros
+#	include <Windows.h> // for getModule
+#else
+#	include <unistd.h> // for getexepath
+#endif
 
 typedef void ( *file_watcher_callback_fun_t )( char const*, void* );
 
@@ -63,148 +73,88 @@ struct le_shader_module_o {
 	};
 };
 
-// A table from `handle` -> `object*`, protected by mutex.
+// A map from `key` -> `object*`, with lock-free lookups.
 //
-// Access is internally synchronised.
+// Objects are copied on successful insert, and owned by the map. Once an
+// object has been inserted it never moves, and it is never removed until
+// the map gets cleared - which means that pointers returned by `try_find`
+// stay valid, and that readers never need to take a lock.
 //
-// lookup time will deteriorate linearly with number of elements,
-// but cache locality is very good for lookups, so this should work
-// fairly well for small number of resources such as pipelines.
-template <typename T, typename U>
-class HashTable : NoCopy, NoMove {
-
-	std::shared_mutex mtx;
-	std::vector<T>    handles;
-	std::vector<U*>   objects; // owning, object is copied on add_entry
-
-  public:
-	// Insert a new obj into table, object is copied.
-	// return true if successful, false if entry aready existed.
-	// in case return value is false, object was not copied.
-	bool try_insert( T const& handle, U* obj ) {
-		mtx.lock();
-		size_t i = 0;
-		for ( auto const& h : handles ) {
-			if ( h == handle ) {
-				break;
-			}
-			i++;
-		}
-		if ( i != handles.size() ) {
-			// entry already existed - this is strange.
-			mtx.unlock();
-			return false;
-		}
-		// -------| invariant: i == handles.size()
-		handles.push_back( handle );
-		objects.emplace_back( new U( *obj ) ); // make a copy
-		mtx.unlock();
-		return true;
-	}
-
-	// Looks up table entry under `needle`,
-	// returns nullptr if not found.
-	U* const try_find( T const& needle ) {
-		mtx.lock_shared();
-		U* const* obj = objects.data();
-		for ( auto const& h : handles ) {
-			if ( h == needle ) {
-				mtx.unlock();
-				return *obj;
-			}
-			obj++;
-		}
-		// --------| Invariant: no handle matching needle found
-		mtx.unlock();
-		return nullptr;
-	}
-
-	typedef void ( *iterator_fun )( U* e, void* user_data );
-
-	// do something on all objects
-	void iterator( iterator_fun fun, void* user_data ) {
-		mtx.lock();
-		for ( auto& e : objects ) {
-			fun( e, user_data );
-		}
-		mtx.unlock();
-	}
-
-	void clear() {
-		mtx.lock();
-		for ( auto& obj : objects ) {
-			delete obj;
-		}
-		handles.clear();
-		objects.clear();
-		mtx.unlock();
-	}
-
-	~HashTable() {
-		clear();
-	}
-};
-
+// We build on the renderer's intern table, which gives us lock-free
+// lookups via open addressing, and which serialises inserts via a mutex.
+// Inserts are rare: once pipelines have been created, almost all accesses
+// are lookups, and these must scale with the number of threads which
+// record passes in parallel.
 //
+// `clear()` must only be called once there can be no more concurrent
+// access - we only call it on teardown.
 template <typename S, typename T>
 class HashMap : NoCopy, NoMove {
 
-	std::shared_mutex         mtx;
-	std::unordered_map<S, T*> store; // owning, object is copied on successful try_insert
+	struct Entry {
+		S  key = {};
+		T* obj = nullptr; // owning, object is copied on successful try_insert
+	};
 
-  public:
-	T* try_find( S needle ) {
-		mtx.lock_shared();
-		auto e = store.find( needle );
-		if ( e == store.end() ) {
-			mtx.unlock();
-			return nullptr;
+	le_intern_table_t<Entry> table;
+
+	static uint64_t hash_key( S const& key ) {
+		uint64_t k;
+		if constexpr ( std::is_pointer_v<S> ) {
+			k = reinterpret_cast<uintptr_t>( key );
 		} else {
-			auto ret = e->second;
-			mtx.unlock();
-			return ret;
+			k = uint64_t( key );
 		}
+		// Handles are pointers, and their lower bits are always zero -
+		// we must mix bits so that keys distribute evenly across slots.
+		k ^= k >> 33;
+		k *= 0xff51afd7ed558ccdull;
+		k ^= k >> 33;
+		return k;
 	}
-	// returns true and stores copy of obj in internal hash - or
-	// returns false if element with key already existed.
-	bool try_insert( S handle, T* obj ) {
-
-		mtx.lock();
-
-		// we attempt an insertion - a nullptr will go in as a placeholder
-		// because we cannot tell at this point whether the insertion will
-		// be successful.
-		auto result = store.emplace( handle, nullptr );
-
-		if ( result.second ) {
-			// Insertion was successful - replace the placeholder with a copy of the actual object.
-			result.first->second = new T( *obj );
-		}
 
-		mtx.unlock();
+  public:
+	// Lock-free: returns nullptr if not found.
+	T* try_find( S const& needle ) {
+		Entry const* e = table.find( hash_key( needle ), [ & ]( Entry const& e ) { return e.key == needle; } );
+		return e ? e->obj : nullptr;
+	}
 
-		return result.second;
+	// returns true and stores copy of obj in internal hash - or
+	// returns false if element with key already existed.
+	bool try_insert( S const& handle, T* obj ) {
+		bool was_inserted = false;
+		table.find_or_insert(
+		    hash_key( handle ),
+		    [ & ]( Entry const& e ) { return e.key == handle; },
+		    [ & ]( Entry& e ) {
+			    e.key        = handle;
+			    e.obj        = new T( *obj ); // make a copy
+			    was_inserted = true;
+		    } );
+		return was_inserted;
 	}
 
 	typedef void ( *iterator_fun )( T* e, void* user_data );
 
 	// do something on all objects
 	void iterator( iterator_fun fun, void* user_data ) {
-		mtx.lock();
-		for ( auto& e : store ) {
-			fun( e.second, user_data );
+		std::scoped_lock lock( table.mtx );
+		for ( auto& e : table.entries ) {
+			if ( e->obj ) {
+				fun( e->obj, user_data );
+			}
 		}
-		mtx.unlock();
 	}
 
 	void clear() {
-		mtx.lock();
-		for ( auto& e : store ) {
-			delete ( e.second );
+		std::scoped_lock lock( table.mtx );
+		for ( auto& e : table.entries ) {
+			delete e->obj;
+			e->obj = nullptr;
 		}
-		store.clear();
-		mtx.unlock();
 	}
+
 	~HashMap() {
 		clear();
 	}
@@ -217,6 +167,8 @@ struct ProtectedModuleDependencies {
 	std::unordered_map<std::string, file_watcher_callback_fun_t>       moduleWatchCallbackAddrs; // we store this so that we can release the callback forwarder when resetting the watcher.
 };
 
+static constexpr size_t LE_SHADER_MANAGER_MAX_WORKER_COMPILERS = 16; // must be at least le_jobs' maximum number of worker threads
+
 struct le_shader_manager_o {
 	VkDevice device = nullptr;
 
@@ -225,9 +177,13 @@ struct le_shader_manager_o {
 	ProtectedModuleDependencies protected_module_dependencies; // must lock mutex before using.
 
 	std::set<le_shader_module_handle> modifiedShaderModules; // non-owning pointers to shader modules which need recompiling (used by file watcher)
+	std::set<le_shader_module_handle> deferredShaderModules; // modules which compiled, but were held back because they share source files with a failed module - these get recompiled with the next batch
+	std::set<le_shader_module_handle> failedShaderModules;   // modules whose most recent update failed - cleared once a module updates successfully
 
-	le_shader_compiler_o* shader_compiler   = nullptr; // owning
-	le_file_watcher_o*    shaderFileWatcher = nullptr; // owning
+	le_shader_compiler_o*    shader_compiler = nullptr;                                              // owning, used by threads outside of the job system
+	le_shader_compiler_o*    worker_shader_compilers[ LE_SHADER_MANAGER_MAX_WORKER_COMPILERS ] = {}; // owning, one per le_jobs worker, created on first use
+	std::vector<std::string> shader_include_directories;                                             // applied to all shader compilers, including compilers which get created later
+	le_file_watcher_o*       shaderFileWatcher = nullptr;                                            // owning
 };
 
 // NOTE: It might make sense to have one pipeline manager per worker thread, and
@@ -237,22 +193,36 @@ struct le_pipeline_manager_o {
 	le_device_o*  le_device = nullptr; // arc-owning, increases reference count, decreases on destruction
 	VkDevice      device    = nullptr;
 
-	std::mutex mtx;
+	std::mutex mtx; // serialises creation of pipelines, and pipeline layouts - lookups don't need to lock
 
-	VkPipelineCache vulkanCache = nullptr;
+	VkPipelineCache   vulkanCache                 = nullptr;
+	std::atomic<bool> vulkanCacheIsDirty          = false; // true if pipelines were created since vulkanCache was last saved to disk
+	uint32_t          vulkanCacheFramesSinceSaved = 0;     // number of calls to update since vulkanCache was last saved to disk
 
 	le_shader_manager_o* shaderManager = nullptr; // owning: does it make sense to have a shader manager additionally to the pipeline manager?
 
-	HashTable<le_gpso_handle, graphics_pipeline_state_o> graphicsPso;
-	HashTable<le_cpso_handle, compute_pipeline_state_o>  computePso;
-	HashTable<le_rtxpso_handle, rtx_pipeline_state_o>    rtxPso;
+	HashMap<le_gpso_handle, graphics_pipeline_state_o> graphicsPso;
+	HashMap<le_cpso_handle, compute_pipeline_state_o>  computePso;
+	HashMap<le_rtxpso_handle, rtx_pipeline_state_o>    rtxPso;
 
 	HashMap<uint64_t, VkPipeline>              pipelines;             // indexed by pipeline_hash
-	HashTable<uint64_t, char*>                 rtx_shader_group_data; // indexed by pipeline_hash
+	HashMap<uint64_t, char*>                   rtx_shader_group_data; // indexed by pipeline_hash
 	HashMap<uint64_t, le_pipeline_layout_info> pipelineLayoutInfos;
 
 	HashMap<uint64_t, le_descriptor_set_layout_t> descriptorSetLayouts;
 	HashMap<uint64_t, VkPipelineLayout>           pipelineLayouts; // indexed by hash of array of descriptorSetLayoutCache keys per pipeline layout
+
+	// -- Background pipeline compilation
+
+	std::unordered_set<uint64_t>     pipelinesPending;           // pipeline hashes for pipelines which are being compiled in the background, protected by mtx
+	std::vector<le_jobs::counter_t*> backgroundJobCounters;      // protected by mtx, freed once there are no more background jobs in flight
+	std::atomic<uint32_t>            backgroundJobsInFlight = 0; // number of background jobs which have not yet completed
+	bool                             shaderModulesUpdatePending = false; // protected by mtx: while true, no new background jobs may be submitted
+
+	std::mutex                                      renderPassMtx;       // protects render pass book-keeping below
+	std::unordered_map<VkRenderPass, uint32_t>      renderPassUsers;     // number of background jobs which use a render pass
+	std::unordered_set<VkRenderPass>                renderPassesRetired; // render passes which must be destroyed once their last user has completed
+	std::unordered_map<uint64_t, BackendRenderPass> renderPassesKnown;   // renderpass compatibility hash -> render pass, used to prewarm graphics pipelines
 };
 
 static VkFormat vk_format_from_spv_reflect_format( SpvReflectFormat const& format ) {
@@ -525,16 +495,19 @@ static bool check_is_data_spirv( const void* raw_data, size_t data_size ) {
 
 /// \brief translate a binary blob into spirv code if possible
 /// \details Blob may be raw spirv data, or glsl data
+/// \note compilation_result is owned by the caller - it may hold cached reflection
+///       data for spirvCode once this method returns, see `shader_module_update_reflection`.
 static bool translate_to_spirv_code(
-    le_shader_compiler_o*      shader_compiler,
-    void*                      raw_data,
-    size_t                     numBytes,
-    LeShaderSourceLanguageEnum shader_source_language,
-    le::ShaderStage            moduleType,
-    const char*                original_file_name,
-    std::string const&         shaderDefines,
-    std::vector<uint32_t>&     spirvCode,
-    std::vector<std::string>&  included_files ) {
+    le_shader_compiler_o*           shader_compiler,
+    void*                           raw_data,
+    size_t                          numBytes,
+    LeShaderSourceLanguageEnum      shader_source_language,
+    le::ShaderStage                 moduleType,
+    const char*                     original_file_name,
+    std::string const&              shaderDefines,
+    std::vector<uint32_t>&          spirvCode,
+    std::vector<std::string>&       included_files,
+    le_shader_compilation_result_o* compilation_result ) {
 
 	ZoneScoped;
 
@@ -550,8 +523,6 @@ static bool translate_to_spirv_code(
 
 		using namespace le_shader_compiler;
 
-		auto compilation_result = compiler_i.result_create();
-
 		compiler_i.compile_source(
 		    shader_compiler,
 		    static_cast<const char*>( raw_data ), numBytes,
@@ -579,9 +550,6 @@ static bool translate_to_spirv_code(
 		} else {
 			result = false;
 		}
-
-		// Release compile result object
-		compiler_i.result_destroy( compilation_result );
 	}
 	return result;
 }
@@ -779,7 +747,7 @@ inline static uint64_t le_shader_bindings_calculate_hash( le_shader_binding_info
 	return hash;
 }
 
-static void shader_module_update_reflection( le_shader_module_o* module ) {
+static void shader_module_reflect_spirv( le_shader_module_o* module ) {
 
 	static auto                         logger = LeLog( LOGGER_LABEL );
 	std::vector<le_shader_binding_info> bindings; // <- gets stored in module at end
@@ -943,6 +911,148 @@ static void shader_module_update_reflection( le_shader_module_o* module ) {
 	spvReflectDestroyShaderModule( &spv_module );
 }
 
+// ----------------------------------------------------------------------
+// Reflection data for a shader module, as we store it with cached spir-v in
+// the shader compiler's cache. Layout:
+//
+//     header | bindings | vertex attribute descriptions | vertex binding descriptions | vertex attribute names: { length, chars }
+//
+struct le_shader_reflection_blob_header_t {
+	uint32_t version;                   // must be LE_SHADER_REFLECTION_BLOB_VERSION
+	uint32_t binding_info_size;         // must be sizeof( le_shader_binding_info )
+	uint32_t num_bindings;              //
+	uint32_t num_vertex_attributes;     // number of vertex attribute descriptions, vertex binding descriptions, and vertex attribute names
+	uint64_t hash_pipelinelayout;       //
+	uint64_t push_constant_buffer_size; //
+};
+
+static constexpr uint32_t LE_SHADER_REFLECTION_BLOB_VERSION = 1; // bump this whenever reflection changes
+
+static void shader_module_reflection_serialize( le_shader_module_o const* module, std::vector<char>& blob ) {
+
+	assert( module->vertexAttributeDescriptions.size() == module->vertexBindingDescriptions.size() &&
+	        module->vertexAttributeDescriptions.size() == module->vertexAttributeNames.size() );
+
+	le_shader_reflection_blob_header_t const header = {
+	    .version                   = LE_SHADER_REFLECTION_BLOB_VERSION,
+	    .binding_info_size         = uint32_t( sizeof( le_shader_binding_info ) ),
+	    .num_bindings              = uint32_t( module->bindings.size() ),
+	    .num_vertex_attributes     = uint32_t( module->vertexAttributeDescriptions.size() ),
+	    .hash_pipelinelayout       = module->hash_pipelinelayout,
+	    .push_constant_buffer_size = module->push_constant_buffer_size,
+	};
+
+	auto write = [ &blob ]( void const* src, size_t num_bytes ) {
+		blob.insert( blob.end(), static_cast<char const*>( src ), static_cast<char const*>( src ) + num_bytes );
+	};
+
+	blob.clear();
+	write( &header, sizeof( header ) );
+	write( module->bindings.data(), sizeof( le_shader_binding_info ) * module->bindings.size() );
+	write( module->vertexAttributeDescriptions.data(), sizeof( VkVertexInputAttributeDescription ) * header.num_vertex_attributes );
+	write( module->vertexBindingDescriptions.data(), sizeof( VkVertexInputBindingDescription ) * header.num_vertex_attributes );
+
+	for ( auto const& name : module->vertexAttributeNames ) {
+		uint32_t const name_length = uint32_t( name.size() );
+		write( &name_length, sizeof( name_length ) );
+		write( name.data(), name_length );
+	}
+}
+
+// Returns false if blob is not valid - module is only updated if blob is valid.
+static bool shader_module_reflection_deserialize( le_shader_module_o* module, char const* blob, size_t blob_num_bytes ) {
+
+	char const*       c        = blob;
+	char const* const blob_end = blob + blob_num_bytes;
+
+	// Copies `num_bytes` from blob into `dst` - unless this would read past the end of blob.
+	auto read = [ & ]( void* dst, size_t num_bytes ) -> bool {
+		if ( size_t( blob_end - c ) < num_bytes ) {
+			return false;
+		}
+		if ( num_bytes ) {
+			memcpy( dst, c, num_bytes );
+		}
+		c += num_bytes;
+		return true;
+	};
+
+	le_shader_reflection_blob_header_t header{};
+
+	if ( !read( &header, sizeof( header ) ) ||
+	     header.version != LE_SHADER_REFLECTION_BLOB_VERSION ||
+	     header.binding_info_size != sizeof( le_shader_binding_info ) ) {
+		return false;
+	}
+
+	// Make sure that counts are plausible before we allocate any storage based on them.
+	size_t const num_bytes_expected =
+	    sizeof( le_shader_binding_info ) * size_t( header.num_bindings ) +
+	    ( sizeof( VkVertexInputAttributeDescription ) + sizeof( VkVertexInputBindingDescription ) + sizeof( uint32_t ) ) * size_t( header.num_vertex_attributes );
+
+	if ( size_t( blob_end - c ) < num_bytes_expected ) {
+		return false;
+	}
+
+	std::vector<le_shader_binding_info>            bindings( header.num_bindings );
+	std::vector<VkVertexInputAttributeDescription> vertexAttributeDescriptions( header.num_vertex_attributes );
+	std::vector<VkVertexInputBindingDescription>   vertexBindingDescriptions( header.num_vertex_attributes );
+	std::vector<std::string>                       vertexAttributeNames( header.num_vertex_attributes );
+
+	if ( !read( bindings.data(), sizeof( le_shader_binding_info ) * bindings.size() ) ||
+	     !read( vertexAttributeDescriptions.data(), sizeof( VkVertexInputAttributeDescription ) * vertexAttributeDescriptions.size() ) ||
+	     !read( vertexBindingDescriptions.data(), sizeof( VkVertexInputBindingDescription ) * vertexBindingDescriptions.size() ) ) {
+		return false;
+	}
+
+	for ( auto& name : vertexAttributeNames ) {
+		uint32_t name_length = 0;
+		if ( !read( &name_length, sizeof( name_length ) ) || size_t( blob_end - c ) < name_length ) {
+			return false;
+		}
+		name.assign( c, name_length );
+		c += name_length;
+	}
+
+	// ---------| invariant: blob was read successfully
+
+	module->bindings                    = std::move( bindings );
+	module->hash_pipelinelayout         = header.hash_pipelinelayout;
+	module->push_constant_buffer_size   = header.push_constant_buffer_size;
+	module->vertexAttributeDescriptions = std::move( vertexAttributeDescriptions );
+	module->vertexBindingDescriptions   = std::move( vertexBindingDescriptions );
+	module->vertexAttributeNames        = std::move( vertexAttributeNames );
+
+	return true;
+}
+
+// ----------------------------------------------------------------------
+// Updates bindings, pipeline layout hash, push constant buffer size, and vertex inputs for module.
+//
+// If the module's spirv code was loaded from the shader compiler's cache, reflection data may have
+// been cached with it - in that case we don't need to reflect. Otherwise we reflect spirv code, and
+// store the reflection data with the compilation result so that it may be found in cache next time.
+static void shader_module_update_reflection( le_shader_module_o* module, le_shader_compilation_result_o* compilation_result ) {
+
+	using namespace le_shader_compiler;
+
+	char const* cached_reflection           = nullptr;
+	size_t      cached_reflection_num_bytes = 0;
+
+	if ( compiler_i.result_get_cached_reflection( compilation_result, &cached_reflection, &cached_reflection_num_bytes ) &&
+	     shader_module_reflection_deserialize( module, cached_reflection, cached_reflection_num_bytes ) ) {
+		return;
+	}
+
+	// ---------| invariant: no reflection data was found in cache
+
+	shader_module_reflect_spirv( module );
+
+	std::vector<char> blob;
+	shader_module_reflection_serialize( module, blob );
+	compiler_i.result_set_cached_reflection( compilation_result, blob.data(), blob.size() );
+}
+
 // ----------------------------------------------------------------------
 
 /// \brief compare sorted bindings and raise the alarm if two successive bindings alias locations
@@ -1106,21 +1216,90 @@ static std::vector<le_shader_binding_info> shader_modules_merge_bindings( le_sha
 
 // ----------------------------------------------------------------------
 
-static void le_shader_manager_shader_module_update( le_shader_manager_o* self, le_shader_module_handle handle ) {
+// Returns shader compiler for the calling thread.
+//
+// Each le_jobs worker gets its own compiler, which is created on first use, so
+// that workers may compile shader modules in parallel. Threads outside of the
+// job system share the shader manager's main compiler.
+static le_shader_compiler_o* le_shader_manager_get_shader_compiler( le_shader_manager_o* self ) {
 
-	// Shader module needs updating if shader code has changed.
-	// if this happens, a new vulkan object for the module must be created.
+	int32_t const worker_id = le_jobs::get_current_worker_id();
 
-	// The module must be locked for this, as we need exclusive access just in case the module is
-	// in use by the frame recording thread, which may want to create pipelines.
-	//
-	// Vulkan lifetimes require us only to keep module alive for as long as a pipeline is being
-	// generated from it. This means we "only" need to protect against any threads which might be
-	// creating pipelines.
+	if ( worker_id < 0 ) {
+		return self->shader_compiler;
+	}
+
+	assert( size_t( worker_id ) < LE_SHADER_MANAGER_MAX_WORKER_COMPILERS && "worker id out of range" );
+
+	// Only the worker with this id ever accesses this slot, which is why we don't need to lock.
+	le_shader_compiler_o*& compiler = self->worker_shader_compilers[ worker_id ];
+
+	if ( nullptr == compiler ) {
+		using namespace le_shader_compiler;
+		compiler = compiler_i.create();
+		for ( auto const& dir : self->shader_include_directories ) {
+			compiler_i.add_shader_include_directory( compiler, dir.c_str() );
+		}
+	}
+
+	return compiler;
+}
+
+// ----------------------------------------------------------------------
 
-	auto module = self->shaderModules.try_find( handle );
+static void le_shader_manager_add_shader_include_directory( le_shader_manager_o* self, char const* path ) {
+
+	using namespace le_shader_compiler;
+
+	self->shader_include_directories.emplace_back( path );
+
+	if ( self->shader_compiler ) {
+		compiler_i.add_shader_include_directory( self->shader_compiler, path );
+	}
+
+	for ( auto& compiler : self->worker_shader_compilers ) {
+		if ( compiler ) {
+			compiler_i.add_shader_include_directory( compiler, path );
+		}
+	}
+}
+
+// ----------------------------------------------------------------------
+// An update for a shader module, which is needed because one of the module's
+// source files has changed.
+//
+// We compile updates into a copy of the module. The copy only replaces the
+// module once all updates in a batch have been compiled successfully.
+struct le_shader_module_update_t {
+	enum class Status {
+		eFailed = 0, // shader could not be compiled, or reports invalid bindings
+		eUnchanged,  // spirv code is identical with spirv code of current module - nothing to do
+		eCompiled,   // `module` holds new spirv code, reflection, and vulkan shader module object
+	};
+
+	le_shader_manager_o*     shader_manager = nullptr;
+	le_shader_module_handle  handle         = nullptr;
+	le_shader_module_o       module;         // updated copy of module - owns its vulkan shader module object, if any
+	std::vector<std::string> included_files; // source files which the updated module depends on
+	Status                   status = Status::eFailed;
+};
+
+// Compiles an update for a shader module - may run as a le_jobs job.
+//
+// This only reads from the current module, which means that we may compile
+// any number of updates in parallel, as long as no other thread writes to
+// shader modules in the meantime.
+static void le_shader_manager_shader_module_compile_update( void* param ) {
+
+	ZoneScoped;
+
+	auto update = static_cast<le_shader_module_update_t*>( param );
+	auto module = update->shader_manager->shaderModules.try_find( update->handle );
 	assert( module && "module not found" );
 
+	update->module        = *module;
+	update->module.module = nullptr; // the current vulkan shader module object stays with the current module
+
 	// -- get module spirv code
 	std::vector<char> source_text;
 
@@ -1129,76 +1308,97 @@ static void le_shader_manager_shader_module_update( le_shader_manager_o* self, l
 		return;
 	}
 
-	std::vector<uint32_t>    spirv_code;
-	std::vector<std::string> included_files = { module->filepath.string() }; // let first element be the original source file path
+	std::vector<uint32_t> spirv_code;
+	update->included_files = { module->filepath.string() }; // let first element be the original source file path
+
+	using namespace le_shader_compiler;
+	auto compilation_result = compiler_i.result_create();
 
-	translate_to_spirv_code( self->shader_compiler, source_text.data(), source_text.size(), { module->source_language }, module->stage, module->filepath.string().c_str(), module->macro_defines, spirv_code, included_files );
+	translate_to_spirv_code( le_shader_manager_get_shader_compiler( update->shader_manager ), source_text.data(), source_text.size(), { module->source_language }, module->stage, module->filepath.string().c_str(), module->macro_defines, spirv_code, update->included_files, compilation_result );
 
 	if ( spirv_code.empty() ) {
 		// no spirv code available, bail out.
+		compiler_i.result_destroy( compilation_result );
 		return;
 	}
 
-	module->hash_shader_defines = SpookyHash::Hash64( module->macro_defines.data(), module->macro_defines.size(), 0 );
-
 	// -- check spirv code hash against module spirv hash
 	uint64_t hash_of_module = SpookyHash::Hash64( spirv_code.data(), spirv_code.size() * sizeof( uint32_t ), module->hash_shader_defines );
 
 	if ( hash_of_module == module->hash ) {
-		// spirv code identical, no update needed, bail out.
+		// spirv code identical, no update needed.
+		compiler_i.result_destroy( compilation_result );
+		update->status = le_shader_module_update_t::Status::eUnchanged;
 		return;
 	}
 
-	le_shader_module_o previous_module = *module; // create backup copy
-
-	// -- update module hash
-	module->hash = hash_of_module;
+	// ---------| Invariant: new spir-v code detected.
 
-	le_pipeline_cache_remove_module_from_dependencies( self, handle );
+	update->module.hash  = hash_of_module;
+	update->module.spirv = std::move( spirv_code );
 
-	// -- update additional include paths, if necessary.
-	le_pipeline_cache_set_module_dependencies_for_watched_files( self, handle, included_files );
+	// -- update bindings via spirv-reflect (or shader cache), and update bindings hash
+	shader_module_update_reflection( &update->module, compilation_result );
+	compiler_i.result_destroy( compilation_result );
 
-	// ---------| Invariant: new spir-v code detected.
-
-	// -- if hash doesn't match, delete old vk module, create new vk module
+	if ( false == shader_module_check_bindings_valid( update->module.bindings.data(), update->module.bindings.size() ) ) {
+		return;
+	}
 
-	// -- store new spir-v code
-	module->spirv = std::move( spirv_code );
+	// -- create new vulkan shader module object
 
-	// -- update bindings via spirv-cross, and update bindings hash
-	shader_module_update_reflection( module );
+	VkShaderModuleCreateInfo createInfo = {
+	    .sType    = VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO,
+	    .pNext    = nullptr,
+	    .flags    = 0,
+	    .codeSize = update->module.spirv.size() * sizeof( uint32_t ),
+	    .pCode    = update->module.spirv.data(),
+	};
 
-	if ( false == shader_module_check_bindings_valid( module->bindings.data(), module->bindings.size() ) ) {
-		// we must clean up, and report an error
-		*module = previous_module;
+	if ( VK_SUCCESS != vkCreateShaderModule( update->shader_manager->device, &createInfo, nullptr, &update->module.module ) ) {
+		update->module.module = nullptr;
 		return;
 	}
 
+	update->status = le_shader_module_update_t::Status::eCompiled;
+}
+
+// ----------------------------------------------------------------------
+// Replaces a module with its updated copy.
+//
+// Shader modules must be exclusively ours for this, just in case a module is in use
+// by the frame recording thread, which may want to create pipelines.
+//
+// Vulkan lifetimes require us only to keep module alive for as long as a pipeline is being
+// generated from it. This means we "only" need to protect against any threads which might be
+// creating pipelines.
+static void le_shader_manager_shader_module_apply_update( le_shader_manager_o* self, le_shader_module_update_t& update ) {
+
+	assert( update.status == le_shader_module_update_t::Status::eCompiled );
+
+	auto module = self->shaderModules.try_find( update.handle );
+	assert( module && "module not found" );
+
+	le_pipeline_cache_remove_module_from_dependencies( self, update.handle );
+
+	// -- update additional include paths, if necessary.
+	le_pipeline_cache_set_module_dependencies_for_watched_files( self, update.handle, update.included_files );
+
 	// -- delete old vulkan shader module object
 	// Q: Should we rather defer deletion? In case that this module is in use?
 	// A: Not really - according to spec module must only be alife while pipeline is being compiled.
 	//    If we can guarantee that no other process is using this module at the moment to compile a
 	//    Pipeline, we can safely delete it.
 	vkDestroyShaderModule( self->device, module->module, nullptr );
-	module->module = nullptr;
-
-	// -- create new vulkan shader module object
-
-	VkShaderModuleCreateInfo createInfo = {
-	    .sType    = VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO,
-	    .pNext    = nullptr,
-	    .flags    = 0,
-	    .codeSize = module->spirv.size() * sizeof( uint32_t ),
-	    .pCode    = module->spirv.data(),
-	};
 
-	vkCreateShaderModule( self->device, &createInfo, nullptr, &module->module );
+	// -- store updated module, which brings its own vulkan shader module object
+	*module = std::move( update.module );
 }
 
 // ----------------------------------------------------------------------
 // this method is called via renderer::update - before frame processing.
-static void le_shader_manager_update_shader_modules( le_shader_manager_o* self ) {
+// Returns true if any shader modules have been tainted, and must be updated.
+static bool le_shader_manager_poll_shader_modules( le_shader_manager_o* self ) {
 
 	// -- find out which shader modules have been tainted
 
@@ -1206,13 +1406,127 @@ static void le_shader_manager_update_shader_modules( le_shader_manager_o* self )
 	// callbacks will modify le_backend->modifiedShaderModules
 	le_file_watcher::le_file_watcher_i.poll_notifications( self->shaderFileWatcher );
 
-	// -- update only modules which have been tainted
+	return !self->modifiedShaderModules.empty();
+}
+
+// ----------------------------------------------------------------------
+// Returns true if `module` depends on any source file which a failed module depends on, too.
+static bool le_shader_manager_shares_source_files_with_failed_module( le_shader_manager_o* self, le_shader_module_handle module ) {
+
+	if ( self->failedShaderModules.empty() ) {
+		return false;
+	}
+
+	auto lck = std::unique_lock( self->protected_module_dependencies.mtx );
 
-	for ( auto& s : self->modifiedShaderModules ) {
-		le_shader_manager_shader_module_update( self, s );
+	for ( auto const& [ path, modules ] : self->protected_module_dependencies.moduleDependencies ) {
+		if ( 0 == modules.count( module ) ) {
+			continue;
+		}
+		for ( auto const& m : modules ) {
+			if ( m != module && self->failedShaderModules.count( m ) ) {
+				return true;
+			}
+		}
+	}
+
+	return false;
+}
+
+// ----------------------------------------------------------------------
+// Updates shader modules which were tainted, see `le_shader_manager_poll_shader_modules`.
+//
+// We compile all modules in a batch - in parallel if we're running inside the job system.
+// A module which compiled only gets swapped in if it shares no source files with a module
+// whose update failed - in this batch, or in an earlier batch. Otherwise, it is held back
+// until the failed module compiles again, so that we never mix modules which were compiled
+// from different versions of a shared source file.
+//
+// Note that sharing any source file counts, even if it is not the file which broke the
+// failed module: we don't know which file did, and would rather hold back a module too
+// many than mix versions.
+static void le_shader_manager_update_shader_modules( le_shader_manager_o* self ) {
+
+	ZoneScoped;
+	static auto logger = LeLog( LOGGER_LABEL );
+
+	// -- update only modules which have been tainted - plus any modules which were held back
+	//    in a previous batch, as these have not been updated with the changes that tainted them.
+
+	self->modifiedShaderModules.merge( self->deferredShaderModules );
+	self->deferredShaderModules.clear();
+
+	std::vector<le_shader_module_update_t> updates( self->modifiedShaderModules.size() );
+	{
+		auto u = updates.begin();
+		for ( auto const& s : self->modifiedShaderModules ) {
+			u->shader_manager = self;
+			u->handle         = s;
+			u++;
+		}
 	}
 
 	self->modifiedShaderModules.clear();
+
+	// -- compile updates
+
+	if ( updates.size() > 1 && le_jobs::get_current_worker_id() >= 0 ) {
+
+		std::vector<le_jobs::job_t> jobs;
+		jobs.reserve( updates.size() );
+
+		for ( auto& u : updates ) {
+			jobs.push_back( { le_shader_manager_shader_module_compile_update, &u } );
+		}
+
+		le_jobs::counter_t* counter;
+		le_jobs::run_jobs( jobs.data(), uint32_t( jobs.size() ), &counter );
+		le_jobs::wait_for_counter_and_free( counter, 0 );
+
+	} else {
+		for ( auto& u : updates ) {
+			le_shader_manager_shader_module_compile_update( &u );
+		}
+	}
+
+	// -- update set of failed modules first, so that it accounts for this batch. Modules which
+	//    failed get compiled again once they are tainted again - if we retried them with every
+	//    batch, one module which keeps failing would be compiled over and over.
+
+	size_t num_failed = 0;
+
+	for ( auto const& u : updates ) {
+		if ( u.status == le_shader_module_update_t::Status::eFailed ) {
+			self->failedShaderModules.insert( u.handle );
+			num_failed++;
+		} else {
+			self->failedShaderModules.erase( u.handle );
+		}
+	}
+
+	size_t num_held_back = 0;
+
+	for ( auto& u : updates ) {
+
+		if ( u.status != le_shader_module_update_t::Status::eCompiled ) {
+			continue;
+		}
+
+		if ( le_shader_manager_shares_source_files_with_failed_module( self, u.handle ) ) {
+			// Hold back: keep previous version, and retry with the next batch.
+			vkDestroyShaderModule( self->device, u.module.module, nullptr );
+			self->deferredShaderModules.insert( u.handle );
+			num_held_back++;
+			continue;
+		}
+
+		le_shader_manager_shader_module_apply_update( self, u );
+	}
+
+	if ( num_failed != 0 || num_held_back != 0 ) {
+		logger.error( "%zu of %zu shader modules failed to update, %zu modules held back until modules which share their source files compile again.",
+		              num_failed, updates.size(), num_held_back );
+	}
 }
 
 // ----------------------------------------------------------------------
@@ -1251,6 +1565,13 @@ static void le_shader_manager_destroy( le_shader_manager_o* self ) {
 		self->shader_compiler = nullptr;
 	}
 
+	for ( auto& compiler : self->worker_shader_compilers ) {
+		if ( compiler ) {
+			compiler_i.destroy( compiler );
+			compiler = nullptr;
+		}
+	}
+
 	// -- destroy retained shader modules
 	self->shaderModules.iterator( []( le_shader_module_o* module, void* user_data ) {
 		VkDevice device = *static_cast<VkDevice*>( user_data );
@@ -1339,7 +1660,7 @@ static le_shader_module_handle le_shader_manager_create_shader_module_from_spirv
 
 	//----------| Invariant: there is either no old module, or the old module does not match our new module.
 
-	shader_module_update_reflection( &module );
+	shader_module_reflect_spirv( &module );
 
 	if ( false == shader_module_check_bindings_valid( module.bindings.data(), module.bindings.size() ) ) {
 		// we must clean up, and report an error
@@ -1390,6 +1711,10 @@ static le_shader_module_handle le_shader_manager_create_shader_module_from_spirv
 /// \details FIXME: this method can get called nearly anywhere - it should not be publicly accessible.
 /// ideally, this method is only allowed to be called in the setup phase.
 ///
+/// Initial creation is not parallelised: modules compile one by one on the calling thread, which
+/// is the main thread for all current callers. Only updates - see `le_shader_manager_update_shader_modules` -
+/// compile in parallel.
+///
 static le_shader_module_handle le_shader_manager_create_shader_module(
     le_shader_manager_o*              self,
     char const*                       path,
@@ -1453,7 +1778,10 @@ static le_shader_module_handle le_shader_manager_create_shader_module(
 	std::vector<uint32_t>    spirv_code;
 	std::vector<std::string> included_files = { canonical_path_as_string }; // this is where we collect any files that contribute to this compilation unit
 
-	translate_to_spirv_code( self->shader_compiler, raw_file_data.data(), raw_file_data.size(), shader_source_language, moduleType, path, macro_defines, spirv_code, included_files );
+	using namespace le_shader_compiler;
+	auto compilation_result = compiler_i.result_create();
+
+	translate_to_spirv_code( le_shader_manager_get_shader_compiler( self ), raw_file_data.data(), raw_file_data.size(), shader_source_language, moduleType, path, macro_defines, spirv_code, included_files, compilation_result );
 
 	le_shader_module_o module{};
 	module.stage               = moduleType;
@@ -1477,12 +1805,14 @@ static le_shader_module_handle le_shader_manager_create_shader_module(
 		// A module with the same handle already exists, and the cached
 		// version has the same hash as our new version: no more work to do.
 		logger.info( "Found cached shader module for '%s'.", path );
+		compiler_i.result_destroy( compilation_result );
 		return handle;
 	}
 
 	//----------| Invariant: there is either no old module, or the old module does not match our new module.
 
-	shader_module_update_reflection( &module );
+	shader_module_update_reflection( &module, compilation_result );
+	compiler_i.result_destroy( compilation_result );
 
 	if ( false == shader_module_check_bindings_valid( module.bindings.data(), module.bindings.size() ) ) {
 		// we must clean up, and report an error
@@ -1507,9 +1837,15 @@ static le_shader_module_handle le_shader_manager_create_shader_module(
 		// there is no prior module - let's create a module and try to retain it in shader manager
 		bool insert_successful = self->shaderModules.try_insert( handle, &module );
 		if ( !insert_successful ) {
-			logger.error( "Could not retain shader module" );
+			// Another thread might have created the same module since we last looked -
+			// this may happen if modules get created from more than one worker.
+			cached_module = self->shaderModules.try_find( handle );
 			vkDestroyShaderModule( self->device, module.module, nullptr );
 			logger.debug( "Vk shader module destroyed %p", module.module );
+			if ( cached_module && cached_module->hash == module.hash ) {
+				return handle;
+			}
+			logger.error( "Could not retain shader module" );
 			return nullptr;
 		}
 	} else {
@@ -1754,6 +2090,7 @@ static VkPipeline le_pipeline_cache_create_graphics_pipeline( le_pipeline_manage
 
 	VkPipeline pipeline = nullptr;
 	auto       result   = vkCreateGraphicsPipelines( self->device, self->vulkanCache, 1, &gpi, nullptr, &pipeline );
+	self->vulkanCacheIsDirty = true;
 
 	// cleanup temporary specialisation info objects
 	for ( auto& p_spec : p_specialization_infos ) {
@@ -1807,6 +2144,7 @@ static VkPipeline le_pipeline_cache_create_compute_pipeline( le_pipeline_manager
 
 	VkPipeline pipeline = nullptr;
 	auto       result   = vkCreateComputePipelines( self->device, self->vulkanCache, 1, &cpi, nullptr, &pipeline );
+	self->vulkanCacheIsDirty = true;
 
 	// cleanup temporary specialisation info objects
 	delete ( p_specialization_info );
@@ -1905,6 +2243,7 @@ static VkPipeline le_pipeline_cache_create_rtx_pipeline( le_pipeline_manager_o*
 
 	VkPipeline pipeline = nullptr;
 	auto       result   = vkCreateRayTracingPipelinesKHR( self->device, nullptr, self->vulkanCache, 1, &create_info, nullptr, &pipeline );
+	self->vulkanCacheIsDirty = true;
 
 	assert( VK_SUCCESS == result );
 	return pipeline;
@@ -2279,6 +2618,18 @@ static inline void le_pipeline_manager_produce_pipeline_layout_info(
 
 	auto pl = self->pipelineLayoutInfos.try_find( *pipeline_layout_hash );
 
+	if ( pl ) {
+		*pipeline_layout_info = *pl;
+		return;
+	}
+
+	// --------| invariant: layout info not found - we must create it
+
+	auto lock = std::unique_lock( self->mtx );
+
+	// Another thread might have created our layout info while we were waiting for the lock.
+	pl = self->pipelineLayoutInfos.try_find( *pipeline_layout_hash );
+
 	if ( pl ) {
 		*pipeline_layout_info = *pl;
 	} else {
@@ -2290,23 +2641,202 @@ static inline void le_pipeline_manager_produce_pipeline_layout_info(
 	}
 }
 
+// ----------------------------------------------------------------------
+// Background pipeline compilation
+//
+// If enabled, pipelines which are not found in the cache don't get created
+// on the thread which asked for them - instead, we hand them to a le_jobs
+// worker, and return a pipeline which is nullptr. The backend skips any
+// draws, or dispatches, for as long as the pipeline is nullptr, which means
+// that a new pipeline may be missing for a frame or two - but creating it
+// won't stall recording.
+//
+// Graphics pipelines are created against a render pass, which must stay
+// alive until the background job has completed. The backend therefore hands
+// render passes to `le_pipeline_manager_destroy_render_pass` for destruction,
+// which defers destroying a render pass for as long as any background job
+// still uses it.
+
+struct le_pipeline_compile_job_t {
+	le_pipeline_manager_o*           self;
+	uint64_t                         pipeline_hash;
+	graphics_pipeline_state_o const* gpso;    // either gpso or cpso must be set
+	compute_pipeline_state_o const*  cpso;    //
+	BackendRenderPass                pass;    // graphics only: render pass, but only fields which are used to create a pipeline
+	uint32_t                         subpass; // graphics only
+};
+
+// Returns a copy of `pass` which holds only the fields which we need to create
+// a graphics pipeline - so that a background job does not have to refer to frame data.
+static BackendRenderPass le_pipeline_render_pass_info_copy( BackendRenderPass const& pass ) {
+	BackendRenderPass info{};
+	info.numColorAttachments = pass.numColorAttachments;
+	info.sampleCount         = pass.sampleCount;
+	info.renderPass          = pass.renderPass;
+	info.renderpassHash      = pass.renderpassHash;
+	return info;
+}
+
+// Background compilation is a debug setting, and it only works if we are
+// running inside the job system: only then can we be sure that le_jobs has
+// been initialised.
+static bool le_pipeline_manager_should_compile_in_background() {
+	LE_SETTING( bool, LE_SETTING_PIPELINE_COMPILE_IN_BACKGROUND, false ); // skip draws until their pipelines have been compiled on a background worker, instead of compiling pipelines while recording
+	return *LE_SETTING_PIPELINE_COMPILE_IN_BACKGROUND && le_jobs::get_current_worker_id() >= 0;
+}
+
+// Remembers `pass` so that we may prewarm graphics pipelines against it.
+static void le_pipeline_manager_remember_render_pass( le_pipeline_manager_o* self, BackendRenderPass const& pass ) {
+	std::scoped_lock lock( self->renderPassMtx );
+	self->renderPassesKnown.try_emplace( pass.renderpassHash, le_pipeline_render_pass_info_copy( pass ) );
+}
+
+static void le_pipeline_manager_release_render_pass( le_pipeline_manager_o* self, VkRenderPass render_pass ) {
+	std::scoped_lock lock( self->renderPassMtx );
+
+	auto it = self->renderPassUsers.find( render_pass );
+	assert( it != self->renderPassUsers.end() );
+
+	if ( --it->second == 0 ) {
+		self->renderPassUsers.erase( it );
+		if ( self->renderPassesRetired.erase( render_pass ) ) {
+			// Render pass was retired while we were still using it - we were its last user.
+			vkDestroyRenderPass( self->device, render_pass, nullptr );
+		}
+	}
+}
+
+// Destroys `render_pass` - or, if a background job still uses it, defers destroying it
+// until the last background job using it has completed.
+static void le_pipeline_manager_destroy_render_pass( le_pipeline_manager_o* self, VkRenderPass render_pass ) {
+	std::scoped_lock lock( self->renderPassMtx );
+
+	for ( auto it = self->renderPassesKnown.begin(); it != self->renderPassesKnown.end(); ) {
+		if ( it->second.renderPass == render_pass ) {
+			it = self->renderPassesKnown.erase( it );
+		} else {
+			it++;
+		}
+	}
+
+	if ( self->renderPassUsers.count( render_pass ) ) {
+		self->renderPassesRetired.insert( render_pass );
+		return;
+	}
+
+	vkDestroyRenderPass( self->device, render_pass, nullptr );
+}
+
+static void le_pipeline_manager_compile_pipeline_job( void* param ) {
+	static auto logger = LeLog( LOGGER_LABEL );
+
+	auto job  = static_cast<le_pipeline_compile_job_t*>( param );
+	auto self = job->self;
+
+	VkPipeline pipeline =
+	    job->gpso
+	        ? le_pipeline_cache_create_graphics_pipeline( self, job->gpso, job->pass, job->subpass )
+	        : le_pipeline_cache_create_compute_pipeline( self, job->cpso );
+
+	if ( self->pipelines.try_insert( job->pipeline_hash, &pipeline ) ) {
+		logger.info( "New VK Pipeline created in background: %p", job->pipeline_hash );
+	} else {
+		// Someone else has created this pipeline while we were busy - ours is redundant.
+		vkDestroyPipeline( self->device, pipeline, nullptr );
+	}
+
+	{
+		auto lock = std::unique_lock( self->mtx );
+		self->pipelinesPending.erase( job->pipeline_hash );
+	}
+
+	if ( job->gpso ) {
+		le_pipeline_manager_release_render_pass( self, job->pass.renderPass );
+	}
+
+	delete job;
+
+	self->backgroundJobsInFlight--; // must come last: once this reaches zero, self may be destroyed.
+}
+
+// Must be called while holding self->mtx. Takes ownership of `job`.
+static void le_pipeline_manager_compile_in_background( le_pipeline_manager_o* self, le_pipeline_compile_job_t* job ) {
+
+	if ( self->shaderModulesUpdatePending ) {
+		// Shader modules are about to be updated, and background jobs read from them -
+		// this pipeline will be requested again once the update has completed.
+		delete job;
+		return;
+	}
+
+	if ( false == self->pipelinesPending.insert( job->pipeline_hash ).second ) {
+		// This pipeline is already being compiled.
+		delete job;
+		return;
+	}
+
+	if ( job->gpso ) {
+		std::scoped_lock lock( self->renderPassMtx );
+		self->renderPassUsers[ job->pass.renderPass ]++;
+	}
+
+	self->backgroundJobsInFlight++;
+
+	le_jobs::job_t      background_job{ le_pipeline_manager_compile_pipeline_job, job };
+	le_jobs::counter_t* counter;
+	le_jobs::run_jobs( &background_job, 1, &counter );
+
+	self->backgroundJobCounters.push_back( counter );
+}
+
+// Frees counters for background jobs which have completed. If `should_wait` is true,
+// waits for all background jobs to complete first - in this case, the caller must
+// make sure that no new background jobs get submitted while we wait.
+static void le_pipeline_manager_collect_background_jobs( le_pipeline_manager_o* self, bool should_wait ) {
+
+	if ( !should_wait && self->backgroundJobsInFlight > 0 ) {
+		return;
+	}
+
+	std::vector<le_jobs::counter_t*> counters;
+	{
+		auto lock = std::unique_lock( self->mtx );
+		std::swap( counters, self->backgroundJobCounters );
+	}
+
+	// Once a job has returned, its counter is decremented without delay -
+	// if no jobs are in flight, these waits return (almost) immediately.
+	//
+	// Each job decrements backgroundJobsInFlight before it returns, and
+	// therefore before its counter gets decremented. If called from within
+	// a job, waiting yields, so that the jobs we wait for may run, even if
+	// there is only one worker thread.
+	for ( auto c : counters ) {
+		le_jobs::wait_for_counter_and_free( c, 0 );
+	}
+
+	// If no new jobs could have been submitted, we have waited for all of them.
+	assert( !should_wait || self->backgroundJobsInFlight == 0 );
+}
+
 // ----------------------------------------------------------------------
 
 /// \brief Creates - or loads a pipeline from cache - based on current pipeline state
-/// \note This method may lock the gpso/cpso cache and is therefore costly.
+/// \note Lookups are lock-free; this method only locks if it must create a new pipeline.
 //
 // + Only the 'command buffer recording'-slice of a frame shall be able to modify the cache.
 //   The cache must be exclusively accessed through this method
 //
-// + NOTE: Access to this method must be sequential - no two frames may access this method
-//   at the same time - and no two renderpasses may access this method at the same time.
-static le_pipeline_and_layout_info_t le_pipeline_manager_produce_graphics_pipeline(
+// + Passes may be translated concurrently: any number of threads may call this method
+//   at the same time. Creating a pipeline is serialised via `self->mtx`.
+//
+// + If `compile_in_background` is true, and the pipeline was not found, returns
+//   a nullptr pipeline, and compiles the pipeline on a background worker.
+static le_pipeline_and_layout_info_t le_pipeline_manager_produce_graphics_pipeline_impl(
     le_pipeline_manager_o*   self,
     le_gpso_handle           gpso_handle,
-    const BackendRenderPass& pass, uint32_t subpass ) {
-
-	// TODO: Do we need this lock, or are the try_finds with their internal mutexes enough?
-	auto lock = std::unique_lock( self->mtx ); // Enforce sequentiality via scoped lock: no two renderpasses may access cache concurrently.
+    const BackendRenderPass& pass, uint32_t subpass,
+    bool                     compile_in_background ) {
 
 	// TODO: Check whether the current gpso is dirty - if not, we should be able to use a cached version
 	// via self.pipelines
@@ -2359,6 +2889,30 @@ static le_pipeline_and_layout_info_t le_pipeline_manager_produce_graphics_pipeli
 	if ( p ) {
 		// pipeline exists
 		pipeline_and_layout_info.pipeline = *p;
+		return pipeline_and_layout_info;
+	}
+
+	// --------| invariant: pipeline not found - we must create it
+
+	auto lock = std::unique_lock( self->mtx );
+
+	// Another thread might have created our pipeline while we were waiting for the lock.
+	p = self->pipelines.try_find( pipeline_hash );
+
+	le_pipeline_manager_remember_render_pass( self, pass );
+
+	if ( p ) {
+		pipeline_and_layout_info.pipeline = *p;
+	} else if ( compile_in_background ) {
+		le_pipeline_manager_compile_in_background(
+		    self, new le_pipeline_compile_job_t{
+		              .self          = self,
+		              .pipeline_hash = pipeline_hash,
+		              .gpso          = pso,
+		              .cpso          = nullptr,
+		              .pass          = le_pipeline_render_pass_info_copy( pass ),
+		              .subpass       = subpass,
+		          } );
 	} else {
 		// -- if not, create pipeline in pipeline cache and store / retain it
 		pipeline_and_layout_info.pipeline = le_pipeline_cache_create_graphics_pipeline( self, pso, pass, subpass );
@@ -2370,15 +2924,24 @@ static le_pipeline_and_layout_info_t le_pipeline_manager_produce_graphics_pipeli
 	return pipeline_and_layout_info;
 }
 
+static le_pipeline_and_layout_info_t le_pipeline_manager_produce_graphics_pipeline(
+    le_pipeline_manager_o*   self,
+    le_gpso_handle           gpso_handle,
+    const BackendRenderPass& pass, uint32_t subpass ) {
+	return le_pipeline_manager_produce_graphics_pipeline_impl( self, gpso_handle, pass, subpass, le_pipeline_manager_should_compile_in_background() );
+}
+
 /// \brief Creates - or loads a pipeline from cache - based on current pipeline state
-/// \note This method may lock the pso cache and is therefore costly.
+/// \note Lookups are lock-free; this method only locks if it must create a new pipeline,
+///       or query shader group data.
 //
 // + Only the 'command buffer recording'-slice of a frame shall be able to modify the cache.
 //   The cache must be exclusively accessed through this method
 //
-// + NOTE: Access to this method must be sequential - no two frames may access this method
-//   at the same time - and no two renderpasses may access this method at the same time.
+// + Passes may be translated concurrently: any number of threads may call this method
+//   at the same time. Creating a pipeline is serialised via `self->mtx`.
 static le_pipeline_and_layout_info_t le_pipeline_manager_produce_rtx_pipeline( le_pipeline_manager_o* self, le_rtxpso_handle pso_handle, char** maybe_shader_group_data ) {
+
 	le_pipeline_and_layout_info_t pipeline_and_layout_info = {};
 
 	static auto logger = LeLog( LOGGER_LABEL );
@@ -2422,6 +2985,29 @@ static le_pipeline_and_layout_info_t le_pipeline_manager_produce_rtx_pipeline( l
 	// -- look up if pipeline with this hash already exists in cache
 	auto p = self->pipelines.try_find( pipeline_hash );
 
+	if ( p && ( nullptr == maybe_shader_group_data ) ) {
+		// -- Pipeline was found, and no shader group data was requested: early out.
+		pipeline_and_layout_info.pipeline = *p;
+		return pipeline_and_layout_info;
+	}
+
+	if ( p ) {
+		auto g = self->rtx_shader_group_data.try_find( pipeline_hash );
+		if ( g ) {
+			// -- Pipeline and shader group data were both found: early out.
+			pipeline_and_layout_info.pipeline = *p;
+			*maybe_shader_group_data          = *g;
+			return pipeline_and_layout_info;
+		}
+	}
+
+	// --------| invariant: pipeline or shader group data not found - we must create them
+
+	auto lock = std::unique_lock( self->mtx );
+
+	// Another thread might have created our pipeline while we were waiting for the lock.
+	p = self->pipelines.try_find( pipeline_hash );
+
 	if ( p ) {
 		// -- Pipeline was found: return pipeline found in hash map
 		pipeline_and_layout_info.pipeline = *p;
@@ -2503,7 +3089,11 @@ static le_pipeline_and_layout_info_t le_pipeline_manager_produce_rtx_pipeline( l
 
 // ----------------------------------------------------------------------
 
-static le_pipeline_and_layout_info_t le_pipeline_manager_produce_compute_pipeline( le_pipeline_manager_o* self, le_cpso_handle cpso_handle ) {
+// Lookups are lock-free; this method only locks if it must create a new pipeline.
+//
+// If `compile_in_background` is true, and the pipeline was not found, returns
+// a nullptr pipeline, and compiles the pipeline on a background worker.
+static le_pipeline_and_layout_info_t le_pipeline_manager_produce_compute_pipeline_impl( le_pipeline_manager_o* self, le_cpso_handle cpso_handle, bool compile_in_background ) {
 
 	static auto                     logger = LeLog( LOGGER_LABEL );
 	compute_pipeline_state_o const* pso    = self->computePso.try_find( cpso_handle );
@@ -2540,6 +3130,28 @@ static le_pipeline_and_layout_info_t le_pipeline_manager_produce_compute_pipelin
 	if ( p ) {
 		// -- if yes, return pipeline found in hash map
 		pipeline_and_layout_info.pipeline = *p;
+		return pipeline_and_layout_info;
+	}
+
+	// --------| invariant: pipeline not found - we must create it
+
+	auto lock = std::unique_lock( self->mtx );
+
+	// Another thread might have created our pipeline while we were waiting for the lock.
+	p = self->pipelines.try_find( pipeline_hash );
+
+	if ( p ) {
+		pipeline_and_layout_info.pipeline = *p;
+	} else if ( compile_in_background ) {
+		le_pipeline_manager_compile_in_background(
+		    self, new le_pipeline_compile_job_t{
+		              .self          = self,
+		              .pipeline_hash = pipeline_hash,
+		              .gpso          = nullptr,
+		              .cpso          = pso,
+		              .pass          = {},
+		              .subpass       = 0,
+		          } );
 	} else {
 		// -- if not, create pipeline in pipeline cache and store / retain it
 		pipeline_and_layout_info.pipeline = le_pipeline_cache_create_compute_pipeline( self, pso );
@@ -2551,6 +3163,68 @@ static le_pipeline_and_layout_info_t le_pipeline_manager_produce_compute_pipelin
 	return pipeline_and_layout_info;
 }
 
+static le_pipeline_and_layout_info_t le_pipeline_manager_produce_compute_pipeline( le_pipeline_manager_o* self, le_cpso_handle cpso_handle ) {
+	return le_pipeline_manager_produce_compute_pipeline_impl( self, cpso_handle, le_pipeline_manager_should_compile_in_background() );
+}
+
+// ----------------------------------------------------------------------
+// Creates pipelines for the given pipeline state objects ahead of time, so that
+// they are ready by the time they are first used.
+//
+// Graphics pipelines depend on the render pass which they are used with:
+// we prewarm graphics pipelines for all render passes which are currently
+// known to the pipeline manager - and if no render passes are known yet, we
+// can only prepare their pipeline layouts.
+//
+// If called from within the job system, pipelines are compiled in the background.
+static void le_pipeline_manager_prewarm_pipelines(
+    le_pipeline_manager_o* self,
+    le_gpso_handle const* gpso_handles, size_t num_gpso_handles,
+    le_cpso_handle const* cpso_handles, size_t num_cpso_handles ) {
+
+	ZoneScoped;
+
+	bool const compile_in_background = le_jobs::get_current_worker_id() >= 0;
+
+	for ( size_t i = 0; i != num_cpso_handles; i++ ) {
+		le_pipeline_manager_produce_compute_pipeline_impl( self, cpso_handles[ i ], compile_in_background );
+	}
+
+	if ( 0 == num_gpso_handles ) {
+		return;
+	}
+
+	// Take a snapshot of known render passes - and register as a user of each render pass,
+	// so that none of them may get destroyed while we compile against them.
+	std::vector<BackendRenderPass> render_passes;
+	{
+		std::scoped_lock lock( self->renderPassMtx );
+		for ( auto const& [ hash, pass ] : self->renderPassesKnown ) {
+			render_passes.push_back( pass );
+			self->renderPassUsers[ pass.renderPass ]++;
+		}
+	}
+
+	for ( size_t i = 0; i != num_gpso_handles; i++ ) {
+		if ( render_passes.empty() ) {
+			// No render pass to compile against: at least prepare pipeline layout, and descriptor set layouts.
+			graphics_pipeline_state_o const* pso = self->graphicsPso.try_find( gpso_handles[ i ] );
+			assert( pso );
+			le_pipeline_layout_info layout_info{};
+			uint64_t                layout_hash{};
+			le_pipeline_manager_produce_pipeline_layout_info( self, pso->shaderModules.data(), pso->shaderModules.size(), &layout_info, &layout_hash );
+			continue;
+		}
+		for ( auto const& pass : render_passes ) {
+			le_pipeline_manager_produce_graphics_pipeline_impl( self, gpso_handles[ i ], pass, 0, compile_in_background );
+		}
+	}
+
+	for ( auto const& pass : render_passes ) {
+		le_pipeline_manager_release_render_pass( self, pass.renderPass );
+	}
+}
+
 // ----------------------------------------------------------------------
 // This method may get called through the pipeline builder -
 // via RECORD in command buffer recording state
@@ -2724,16 +3398,249 @@ static le_shader_module_handle le_pipeline_manager_create_shader_module_from_spi
 }
 
 // ----------------------------------------------------------------------
+// Persistent pipeline cache
+//
+// We store the contents of our VkPipelineCache to disk, so that pipelines
+// which were compiled in a previous session can be re-created from cache.
+//
+// Pipeline cache data is only valid for the exact device and driver which
+// produced it. Vulkan prefixes cache data with a header which holds vendor
+// id, device id, and cache uuid - but not the driver version, and drivers
+// are free to reject (or, worse, to crash on) data they don't understand.
+// We therefore add our own header, which additionally holds the driver
+// version, and a hash over the cache data so that we can detect truncated
+// or corrupted files. If anything in the header does not match, we ignore
+// the file and start with an empty cache.
+//
+// Files are written atomically: we first write to a temporary file, which
+// we then rename to its final name, so that a crash while writing can never
+// leave a partially written cache behind.
+
+struct le_pipeline_cache_file_header_t {
+	uint32_t magic;                               // must be LE_PIPELINE_CACHE_FILE_MAGIC
+	uint32_t header_version;                      // must be LE_PIPELINE_CACHE_FILE_VERSION
+	uint32_t vendor_id;                           // VkPhysicalDeviceProperties::vendorID
+	uint32_t device_id;                           // VkPhysicalDeviceProperties::deviceID
+	uint32_t driver_version;                      // VkPhysicalDeviceProperties::driverVersion
+	uint8_t  pipeline_cache_uuid[ VK_UUID_SIZE ]; // VkPhysicalDeviceProperties::pipelineCacheUUID
+	uint64_t data_size;                           // number of bytes of cache data following this header
+	uint64_t data_hash;                           // hash over cache data
+};
+
+static constexpr uint32_t LE_PIPELINE_CACHE_FILE_MAGIC   = 0x4350454c; // 'LEPC', little endian
+static constexpr uint32_t LE_PIPELINE_CACHE_FILE_VERSION = 1;
 
+static le_pipeline_cache_file_header_t le_pipeline_cache_file_header_for_device( le_device_o* le_device ) {
+	VkPhysicalDeviceProperties const* props = le_backend_vk::vk_device_i.get_vk_physical_device_properties( le_device );
+
+	le_pipeline_cache_file_header_t header{};
+	header.magic          = LE_PIPELINE_CACHE_FILE_MAGIC;
+	header.header_version = LE_PIPELINE_CACHE_FILE_VERSION;
+	header.vendor_id      = props->vendorID;
+	header.device_id      = props->deviceID;
+	header.driver_version = props->driverVersion;
+	memcpy( header.pipeline_cache_uuid, props->pipelineCacheUUID, VK_UUID_SIZE );
+	return header;
+}
+
+// Returns path to pipeline cache file - an empty path means that the persistent pipeline cache is disabled.
+//
+// Relative paths are resolved against the directory which holds the executable, not against
+// the current working directory, so that each app keeps its own cache, wherever it gets started from.
+static std::filesystem::path le_pipeline_cache_file_get_path() {
+	LE_SETTING( std::string, LE_SETTING_PIPELINE_CACHE_FILE_PATH, "le_pipeline_cache.bin" ); // set to empty string to disable persistent pipeline cache
+
+	if ( LE_SETTING_PIPELINE_CACHE_FILE_PATH->empty() ) {
+		return {};
+	}
+
+	static std::filesystem::path exe_path = []() {
+		char result[ 1024 ] = { 0 };
+
+#ifdef _MSC_VER
+
+		// When NULL is passed to GetModuleHandle, the handle of the exe itself is returned
+		HMODULE hModule = GetModuleHandle( NULL );
+		if ( hModule != NULL ) {
+			// Use GetModuleFileName() with module handle to get the path
+			GetModuleFileName( hModule, result, ( sizeof( result ) ) );
+		}
+		size_t count = strnlen_s( result, sizeof( result ) );
+#else
+		ssize_t count = readlink( "/proc/self/exe", result, 1024 );
+#endif
+
+		return std::string( result, ( count > 0 ) ? size_t( count ) : 0 );
+	}();
+
+	std::filesystem::path path = *LE_SETTING_PIPELINE_CACHE_FILE_PATH;
+
+	if ( path.is_relative() && !exe_path.empty() ) {
+		path = exe_path.parent_path() / path;
+	}
+
+	return path;
+}
+
+// Returns false if there was no valid pipeline cache file for the current device at `path`.
+// In case of success, `data` holds pipeline cache data which may be used as initial data for a VkPipelineCache.
+static bool le_pipeline_cache_file_load( le_device_o* le_device, std::filesystem::path const& path, std::vector<char>& data ) {
+	static auto logger = LeLog( LOGGER_LABEL );
+
+	std::ifstream file( path, std::ios::in | std::ios::binary | std::ios::ate );
+
+	if ( !file.is_open() ) {
+		logger.info( "No pipeline cache file found at '%s'", path.string().c_str() );
+		return false;
+	}
+
+	size_t const file_size = size_t( file.tellg() );
+	file.seekg( 0 );
+
+	le_pipeline_cache_file_header_t header{};
+
+	if ( file_size < sizeof( header ) || !file.read( reinterpret_cast<char*>( &header ), sizeof( header ) ) ) {
+		logger.warn( "Ignoring pipeline cache file '%s': file too small", path.string().c_str() );
+		return false;
+	}
+
+	le_pipeline_cache_file_header_t const expected = le_pipeline_cache_file_header_for_device( le_device );
+
+	if ( header.magic != expected.magic ||
+	     header.header_version != expected.header_version ||
+	     header.vendor_id != expected.vendor_id ||
+	     header.device_id != expected.device_id ||
+	     header.driver_version != expected.driver_version ||
+	     0 != memcmp( header.pipeline_cache_uuid, expected.pipeline_cache_uuid, VK_UUID_SIZE ) ) {
+		logger.info( "Ignoring pipeline cache file '%s': it was written for a different device, or driver", path.string().c_str() );
+		return false;
+	}
+
+	if ( header.data_size != file_size - sizeof( header ) ) {
+		logger.warn( "Ignoring pipeline cache file '%s': unexpected file size", path.string().c_str() );
+		return false;
+	}
+
+	data.resize( header.data_size );
+
+	if ( !file.read( data.data(), std::streamsize( data.size() ) ) ||
+	     SpookyHash::Hash64( data.data(), data.size(), 0 ) != header.data_hash ) {
+		logger.warn( "Ignoring pipeline cache file '%s': data is corrupted", path.string().c_str() );
+		data.clear();
+		return false;
+	}
+
+	logger.info( "Loaded pipeline cache file '%s' (%zu bytes)", path.string().c_str(), data.size() );
+	return true;
+}
+
+// Writes contents of `cache` to `path` - via a temporary file, which gets renamed once all data has been written.
+static bool le_pipeline_cache_file_save( le_device_o* le_device, VkDevice device, VkPipelineCache cache, std::filesystem::path const& path ) {
+	static auto logger = LeLog( LOGGER_LABEL );
+
+	size_t data_size = 0;
+	if ( VK_SUCCESS != vkGetPipelineCacheData( device, cache, &data_size, nullptr ) ) {
+		return false;
+	}
+
+	std::vector<char> data( data_size );
+	if ( VK_SUCCESS != vkGetPipelineCacheData( device, cache, &data_size, data.data() ) ) {
+		return false;
+	}
+	data.resize( data_size ); // cache may have returned fewer bytes than initially queried
+
+	le_pipeline_cache_file_header_t header = le_pipeline_cache_file_header_for_device( le_device );
+	header.data_size                       = data.size();
+	header.data_hash                       = SpookyHash::Hash64( data.data(), data.size(), 0 );
+
+	std::filesystem::path tmp_path = path;
+	tmp_path += ".tmp";
+
+	{
+		std::ofstream file( tmp_path, std::ios::out | std::ios::binary | std::ios::trunc );
+		file.write( reinterpret_cast<char const*>( &header ), sizeof( header ) );
+		file.write( data.data(), std::streamsize( data.size() ) );
+		file.close();
+
+		if ( file.fail() ) {
+			logger.warn( "Could not write pipeline cache file '%s'", tmp_path.string().c_str() );
+			std::error_code ec;
+			std::filesystem::remove( tmp_path, ec );
+			return false;
+		}
+	}
+
+	std::error_code ec;
+	std::filesystem::rename( tmp_path, path, ec ); // replaces any file at `path`
+
+	if ( ec ) {
+		logger.warn( "Could not move pipeline cache file '%s' into place: %s", path.string().c_str(), ec.message().c_str() );
+		std::filesystem::remove( tmp_path, ec );
+		return false;
+	}
+
+	logger.info( "Saved pipeline cache file '%s' (%zu bytes)", path.string().c_str(), data.size() );
+	return true;
+}
+
+// Saves vulkan pipeline cache to disk if any pipelines were created since it was last saved.
+// Returns immediately if the cache is not persistent.
+static void le_pipeline_manager_save_pipeline_cache( le_pipeline_manager_o* self ) {
+
+	std::filesystem::path const cache_file_path = le_pipeline_cache_file_get_path();
+
+	if ( cache_file_path.empty() || nullptr == self->vulkanCache ) {
+		return;
+	}
+
+	auto lock = std::unique_lock( self->mtx ); // serialise saves - vulkan pipeline caches are internally synchronised
+
+	if ( false == self->vulkanCacheIsDirty.exchange( false ) ) {
+		return;
+	}
+
+	le_pipeline_cache_file_save( self->le_device, self->device, self->vulkanCache, cache_file_path );
+}
+
+// ----------------------------------------------------------------------
+// Gets called once per frame.
 static void le_pipeline_manager_update_shader_modules( le_pipeline_manager_o* self ) {
-	le_shader_manager_update_shader_modules( self->shaderManager );
+
+	if ( le_shader_manager_poll_shader_modules( self->shaderManager ) ) {
+		// Background jobs read from shader modules - we must wait for
+		// them to complete before we may update any shader modules, and
+		// we must not allow any new background jobs until we're done.
+		{
+			auto lock                        = std::unique_lock( self->mtx );
+			self->shaderModulesUpdatePending = true;
+		}
+		le_pipeline_manager_collect_background_jobs( self, true );
+		le_shader_manager_update_shader_modules( self->shaderManager );
+		{
+			auto lock                        = std::unique_lock( self->mtx );
+			self->shaderModulesUpdatePending = false;
+		}
+	} else {
+		le_pipeline_manager_collect_background_jobs( self, false );
+	}
+
+	// Periodically save pipeline cache, so that we don't lose newly created
+	// pipelines if the application does not shut down cleanly.
+
+	LE_SETTING( uint32_t, LE_SETTING_PIPELINE_CACHE_SAVE_INTERVAL_FRAMES, 600 ); // 0 means: only save on shutdown
+
+	if ( *LE_SETTING_PIPELINE_CACHE_SAVE_INTERVAL_FRAMES &&
+	     ++self->vulkanCacheFramesSinceSaved >= *LE_SETTING_PIPELINE_CACHE_SAVE_INTERVAL_FRAMES ) {
+		self->vulkanCacheFramesSinceSaved = 0;
+		le_pipeline_manager_save_pipeline_cache( self );
+	}
 }
 
 // ----------------------------------------------------------------------
 
 static void le_pipeline_add_shader_include_directory( le_pipeline_manager_o* self, char const* path ) {
-	if ( self->shaderManager && self->shaderManager->shader_compiler ) {
-		le_shader_compiler::compiler_i.add_shader_include_directory( self->shaderManager->shader_compiler, path );
+	if ( self->shaderManager ) {
+		le_shader_manager_add_shader_include_directory( self->shaderManager, path );
 	}
 }
 
@@ -2749,15 +3656,29 @@ static le_pipeline_manager_o* le_pipeline_manager_create( le_backend_o* backend
 	vk_device_i.increase_reference_count( self->le_device );
 	self->device = vk_device_i.get_vk_device( self->le_device );
 
+	std::filesystem::path const cache_file_path = le_pipeline_cache_file_get_path();
+
+	// Seed pipeline cache with data from a previous session, if we have any for this device.
+	std::vector<char> initial_data;
+
+	if ( !cache_file_path.empty() ) {
+		le_pipeline_cache_file_load( self->le_device, cache_file_path, initial_data );
+	}
+
 	VkPipelineCacheCreateInfo info = {
 	    .sType           = VK_STRUCTURE_TYPE_PIPELINE_CACHE_CREATE_INFO,
 	    .pNext           = nullptr, // optional
 	    .flags           = 0,       // optional
-	    .initialDataSize = 0,       // optional
-	    .pInitialData    = nullptr,
+	    .initialDataSize = initial_data.size(),
+	    .pInitialData    = initial_data.empty() ? nullptr : initial_data.data(),
 	};
 
-	vkCreatePipelineCache( self->device, &info, nullptr, &self->vulkanCache );
+	if ( VK_SUCCESS != vkCreatePipelineCache( self->device, &info, nullptr, &self->vulkanCache ) && !initial_data.empty() ) {
+		// Driver did not accept our initial data - start with an empty cache instead.
+		info.initialDataSize = 0;
+		info.pInitialData    = nullptr;
+		vkCreatePipelineCache( self->device, &info, nullptr, &self->vulkanCache );
+	}
 	self->shaderManager = le_shader_manager_create( self->device );
 
 	// Add a default directory for where to look for additional shaders:
@@ -2775,6 +3696,12 @@ static void le_pipeline_manager_destroy( le_pipeline_manager_o* self ) {
 
 	static auto logger = LeLog( LOGGER_LABEL );
 
+	// Wait for background jobs, as these refer to our pipeline state objects, and shader modules.
+	le_pipeline_manager_collect_background_jobs( self, true );
+
+	// Any render passes which were waiting for background jobs have been destroyed by now.
+	assert( self->renderPassesRetired.empty() );
+
 	le_shader_manager_destroy( self->shaderManager );
 	self->shaderManager = nullptr;
 
@@ -2828,7 +3755,10 @@ static void le_pipeline_manager_destroy( le_pipeline_manager_o* self ) {
 	    },
 	    nullptr );
 
-	// Destroy Pipeline Cache
+	// Destroy Pipeline Cache - but save its contents first, so that
+	// the next session may re-create pipelines from cache.
+
+	le_pipeline_manager_save_pipeline_cache( self );
 
 	if ( self->vulkanCache ) {
 		vkDestroyPipelineCache( self->device, self->vulkanCache, nullptr );
@@ -2863,6 +3793,8 @@ void register_le_pipeline_vk_api( void* api_ ) {
 		i.produce_graphics_pipeline         = le_pipeline_manager_produce_graphics_pipeline;
 		i.produce_rtx_pipeline              = le_pipeline_manager_produce_rtx_pipeline;
 		i.produce_compute_pipeline          = le_pipeline_manager_produce_compute_pipeline;
+		i.prewarm_pipelines                 = le_pipeline_manager_prewarm_pipelines;
+		i.destroy_render_pass               = le_pipeline_manager_destroy_render_pass;
 	}
 	{
 		auto& i = le_backend_vk_api_i->le_shader_module_i;
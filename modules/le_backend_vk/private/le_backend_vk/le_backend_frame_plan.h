@@ -0,0 +1,74 @@
+#pragma once
+
+#include <stdint.h>
+#include <vector>
+
+#include "le_renderer.h" // for le_resource_handle, le_resource_info_t, le::RootPassesField
+
+/*
+ * A Frame Plan holds the result of planning a frame on the CPU, without
+ * a Vulkan device: this is everything the backend computes for a frame
+ * before it starts creating Vulkan objects.
+ *
+ * Use `vk_backend_i.plan_frame` to fill a frame plan from a list of
+ * (built) renderpasses - the backend does not need to be set up for this,
+ * which means that you can use this to benchmark, or to regression-test
+ * frame planning on machines without a GPU.
+ *
+ * Vulkan enums and flags are stored as plain integers, so that this header
+ * does not depend on vulkan.h:
+ *
+ * + stage  : VkPipelineStageFlags2
+ * + access : VkAccessFlags2
+ * + layout : VkImageLayout
+ *
+ */
+
+struct le_backend_frame_plan_t {
+
+	struct SyncState {
+		uint64_t stage;  // VkPipelineStageFlags2: stage which needs to happen-before
+		uint64_t access; // VkAccessFlags2: memory access which is visible in this stage
+		uint32_t layout; // VkImageLayout: current layout (for images)
+	};
+
+	struct Resource {
+		le_resource_handle     handle;
+		le_resource_info_t     info;       // consolidated over all passes, and declared resources
+		uint32_t               first_pass; // index of first pass which uses this resource
+		uint32_t               last_pass;  // index of last pass which uses this resource (inclusive)
+		std::vector<SyncState> sync_chain; // sync state for this resource, from beginning to end of frame
+	};
+
+	struct Barrier {
+		le_resource_handle resource;
+		SyncState          src; // state before barrier
+		SyncState          dst; // state after barrier
+	};
+
+	struct Attachment {
+		le_resource_handle resource;
+		SyncState          initial; // state before entering renderpass - synchronised implicitly via renderpass
+		SyncState          final;   // state after leaving renderpass
+	};
+
+	struct Pass {
+		char const*             debug_name; // non-owning, points into renderpass
+		le::QueueFlagBits       type;       //
+		le::RootPassesField     affinity;   // queue submissions this pass contributes to
+		uint32_t                width;      //
+		uint32_t                height;     //
+		std::vector<Barrier>    barriers;   // explicit barriers which execute before this pass begins
+		std::vector<Attachment> attachments;
+	};
+
+	struct Submission {
+		le::RootPassesField   key;          // submission key (affinity mask) - passes whose affinity overlaps this key belong to this submission
+		uint32_t              queue_flags;  // VkQueueFlags: capabilities a queue must have to process this submission
+		std::vector<uint32_t> pass_indices; // indices into passes, in order of submission
+	};
+
+	std::vector<Pass>       passes;      // in order of execution
+	std::vector<Resource>   resources;   // sorted by handle
+	std::vector<Submission> submissions; //
+};
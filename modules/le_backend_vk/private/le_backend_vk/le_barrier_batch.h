@@ -0,0 +1,158 @@
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+#include <vector>
+
+/*
+ * The Barrier Batch collects all resource transitions which must happen at
+ * a pass boundary, and turns them into the smallest set of barriers which
+ * will fit into a single dependency info.
+ *
+ * Input is a list of transitions: for each resource, its sync state before,
+ * and its sync state after the barrier.
+ *
+ * Output is at most one global memory barrier, plus one image barrier for
+ * each image which needs a layout transition:
+ *
+ * - Transitions where the state before equals the state after are dropped.
+ * - Transitions which don't change layout, which have no pending writes,
+ *   and where the state after only asks for stages and access which are
+ *   already covered by the state before are dropped, too: memory is already
+ *   visible where it is needed, and read-after-read does not need an
+ *   execution dependency.
+ * - Transitions which don't change layout are merged into the global memory
+ *   barrier, by combining their stage and access masks. Global memory
+ *   barriers apply to all resources, which means that this never weakens a
+ *   dependency.
+ * - Image transitions which do change layout each need an image barrier -
+ *   but transitions for the same image with identical layouts are merged.
+ *
+ * Transitions must be independent of each other: barriers within the same
+ * dependency info are not ordered, which means that a batch cannot express
+ * a chain of layout transitions on the same image.
+ *
+ * This is pure CPU code without any dependencies on Vulkan, so that it can
+ * be tested in isolation. Stage, access and layout values are the raw values
+ * of their Vulkan counterparts (VkPipelineStageFlags2, VkAccessFlags2, and
+ * VkImageLayout).
+ *
+ */
+
+struct le_barrier_state_t {
+	uint64_t stage;  // stage which must happen-before (src), or happen-after (dst)
+	uint64_t access; // memory access which must be made available (src), or visible (dst)
+	uint32_t layout; // image layout - ignored for buffers
+};
+
+struct le_barrier_transition_t {
+	uint64_t           resource; // opaque: identifies resource, e.g. a VkImage or VkBuffer handle
+	bool               is_image; // only images have layouts
+	le_barrier_state_t before;   // state of resource before barrier
+	le_barrier_state_t after;    // state of resource after barrier
+};
+
+struct le_barrier_batch_t {
+	struct MemoryBarrier {
+		uint64_t src_stage;
+		uint64_t src_access;
+		uint64_t dst_stage;
+		uint64_t dst_access;
+	};
+
+	struct ImageBarrier {
+		uint64_t      resource;
+		MemoryBarrier masks;
+		uint32_t      old_layout;
+		uint32_t      new_layout;
+	};
+
+	bool                      has_memory_barrier = false;
+	MemoryBarrier             memory_barrier     = {};
+	std::vector<ImageBarrier> image_barriers;
+
+	size_t num_dropped = 0; // number of transitions which did not need a barrier
+
+	bool empty() const {
+		return !has_memory_barrier && image_barriers.empty();
+	}
+};
+
+// ----------------------------------------------------------------------
+// Builds barriers for `num_transitions` transitions.
+//
+// `any_write_access` must hold all access flags which count as write access;
+// only write access must be made available, which is why we remove any other
+// bits from src access masks.
+inline void le_barrier_batch_build( le_barrier_batch_t* batch, le_barrier_transition_t const* transitions, size_t num_transitions, uint64_t any_write_access ) {
+
+	batch->has_memory_barrier = false;
+	batch->memory_barrier     = {};
+	batch->image_barriers.clear();
+	batch->num_dropped = 0;
+
+	for ( auto t = transitions; t != transitions + num_transitions; t++ ) {
+
+		bool const changes_layout = t->is_image && t->before.layout != t->after.layout;
+
+		if ( !changes_layout ) {
+
+			bool const is_identical = t->before.stage == t->after.stage &&
+			                          t->before.access == t->after.access;
+
+			bool const is_covered = 0 == ( t->before.access & any_write_access ) &&
+			                        0 == ( t->after.access & any_write_access ) &&
+			                        0 == ( t->after.stage & ~t->before.stage ) &&
+			                        0 == ( t->after.access & ~t->before.access );
+
+			if ( is_identical || is_covered ) {
+				batch->num_dropped++;
+				continue;
+			}
+		}
+
+		le_barrier_batch_t::MemoryBarrier const masks{
+		    .src_stage  = t->before.stage,
+		    .src_access = t->before.access & any_write_access,
+		    .dst_stage  = t->after.stage,
+		    .dst_access = t->after.access,
+		};
+
+		if ( !changes_layout ) {
+			// Merge into global memory barrier.
+			auto& m = batch->memory_barrier;
+			m.src_stage |= masks.src_stage;
+			m.src_access |= masks.src_access;
+			m.dst_stage |= masks.dst_stage;
+			m.dst_access |= masks.dst_access;
+			batch->has_memory_barrier = true;
+			continue;
+		}
+
+		// --------| invariant: transition needs an image barrier
+
+		bool was_merged = false;
+
+		for ( auto& b : batch->image_barriers ) {
+			if ( b.resource == t->resource &&
+			     b.old_layout == t->before.layout &&
+			     b.new_layout == t->after.layout ) {
+				b.masks.src_stage |= masks.src_stage;
+				b.masks.src_access |= masks.src_access;
+				b.masks.dst_stage |= masks.dst_stage;
+				b.masks.dst_access |= masks.dst_access;
+				was_merged = true;
+				break;
+			}
+		}
+
+		if ( !was_merged ) {
+			batch->image_barriers.push_back( {
+			    .resource   = t->resource,
+			    .masks      = masks,
+			    .old_layout = t->before.layout,
+			    .new_layout = t->after.layout,
+			} );
+		}
+	}
+}
@@ -2,6 +2,9 @@
 
 #include <cstdlib>
 #include <stddef.h>
+#include <stdint.h>
+#include <new>
+#include <unordered_map>
 
 /*
  * The Command Stream is where the renderer stores the bytecode for
@@ -28,31 +31,134 @@
  * and de-allocating command streams per-frame. At the same time, command
  * streams may grow, if there are a large number of commands to record.
  *
+ * Memory for a command stream is held in a linked list of large blocks.
+ * When a command does not fit into the current block, we continue in the
+ * next block, or add a new block - commands which were already recorded
+ * never move, and are never copied. Blocks are kept when a stream gets
+ * reset, so that a stream which has grown to fit a busy renderpass
+ * does not need to grow again the next time it is used.
+ *
+ * A command never straddles two blocks - readers must use `begin_read()`
+ * and `next()` to step through commands, as consecutive commands are not
+ * guaranteed to be contiguous in memory.
+ *
+ * Since command streams are assigned to renderpasses by index, and the
+ * renderpass at any index may change from frame to frame, each stream
+ * remembers the largest number of bytes recorded for each renderpass id
+ * it has seen, and reserves that much up-front via `begin()`.
+ *
  */
 
 struct le_command_stream_t {
-	char*  data      = nullptr;
-	size_t size      = 0;
-	size_t capacity  = 0;
-	size_t cmd_count = 0;
-
-	le_command_stream_t()
-	    : size( 0 )
-	    , capacity( 8 ) {
-		data = ( char* )malloc( capacity );
-	}
+
+	static constexpr size_t DEFAULT_BLOCK_SIZE = 64 * 1024; // minimum number of bytes for each block
+
+	struct alignas( 16 ) Block {
+		Block* next;     // next block in chain, nullptr if last block
+		size_t capacity; // number of bytes available for commands in this block
+		size_t size;     // number of bytes used by commands in this block
+
+		char* data() {
+			return reinterpret_cast<char*>( this + 1 ); // command data immediately follows block header
+		}
+	};
+
+	Block* first   = nullptr; // owning: first block in chain
+	Block* current = nullptr; // non-owning: block into which we currently record
+
+	size_t size      = 0; // number of bytes used by commands, summed over all blocks
+	size_t capacity  = 0; // number of bytes available for commands, summed over all blocks
+	size_t cmd_count = 0; // number of commands in stream
+
+	uint64_t                             pass_id = 0;      // id of renderpass which this stream currently records
+	std::unordered_map<uint64_t, size_t> high_water_marks; // pass id -> largest number of bytes recorded for this pass
+
+	le_command_stream_t() = default;
+
+	le_command_stream_t( le_command_stream_t const& )            = delete;
+	le_command_stream_t& operator=( le_command_stream_t const& ) = delete;
 
 	~le_command_stream_t() {
 
-		if ( data ) {
-			free( data );
-			size      = 0;
-			cmd_count = 0;
-			data      = nullptr;
+		for ( Block* b = first; b != nullptr; ) {
+			Block* next = b->next;
+			free( b );
+			b = next;
+		}
+
+		first     = nullptr;
+		current   = nullptr;
+		size      = 0;
+		capacity  = 0;
+		cmd_count = 0;
+	}
+
+	// Allocates a new block with at least `num_bytes` capacity, and links it in after `prev`
+	// (or at the front of the chain, if `prev` is nullptr).
+	Block* insert_block( Block* prev, size_t num_bytes ) {
+
+		size_t block_capacity = num_bytes > DEFAULT_BLOCK_SIZE ? num_bytes : DEFAULT_BLOCK_SIZE;
+
+		Block* block    = static_cast<Block*>( malloc( sizeof( Block ) + block_capacity ) );
+		block->capacity = block_capacity;
+		block->size     = 0;
+
+		if ( prev ) {
+			block->next = prev->next;
+			prev->next  = block;
+		} else {
+			block->next = first;
+			first       = block;
+		}
+
+		this->capacity += block_capacity;
+
+		return block;
+	}
+
+	// Makes sure that the stream can hold at least `num_bytes` of commands without allocating.
+	void reserve( size_t num_bytes ) {
+		if ( num_bytes <= this->capacity ) {
+			return;
+		}
+
+		// Add the missing capacity as a single block at the end of the chain.
+
+		Block* last = first;
+		while ( last && last->next ) {
+			last = last->next;
+		}
+
+		insert_block( last, num_bytes - this->capacity );
+	}
+
+	// Call this before recording commands for renderpass with id `pass_id_`:
+	// reserves as many bytes as were recorded for this renderpass previously.
+	void begin( uint64_t pass_id_ ) {
+		this->pass_id = pass_id_;
+
+		auto it = high_water_marks.find( pass_id_ );
+		if ( it != high_water_marks.end() ) {
+			reserve( it->second );
 		}
 	}
 
 	void reset() {
+
+		// Remember how many bytes we needed for the current pass.
+
+		if ( this->size ) {
+			auto& high_water_mark = high_water_marks[ this->pass_id ];
+			if ( this->size > high_water_mark ) {
+				high_water_mark = this->size;
+			}
+		}
+
+		for ( Block* b = first; b != nullptr; b = b->next ) {
+			b->size = 0;
+		}
+
+		this->current   = first;
 		this->cmd_count = 0;
 		this->size      = 0;
 	}
@@ -60,17 +166,71 @@ struct le_command_stream_t {
 	template <typename T>
 	inline T* emplace_cmd( size_t payload_sz = 0 ) {
 
-		size_t old_sz = this->size;
-		size_t new_sz = old_sz + sizeof( T ) + payload_sz;
+		size_t cmd_sz = sizeof( T ) + payload_sz;
 
-		while ( new_sz > this->capacity ) {
-			this->capacity *= 2;
-			this->data = ( char* )realloc( this->data, this->capacity );
+		if ( this->current == nullptr ) {
+			this->current = this->first ? this->first : insert_block( nullptr, cmd_sz );
 		}
 
-		this->size = new_sz;
+		if ( this->current->size + cmd_sz > this->current->capacity ) {
+
+			// Command does not fit into current block: continue with next block,
+			// if there is one, and it is large enough - otherwise add a new block.
+
+			Block* next = this->current->next;
+
+			if ( next && next->capacity >= cmd_sz ) {
+				this->current = next;
+			} else {
+				this->current = insert_block( this->current, cmd_sz );
+			}
+		}
+
+		// --------| invariant: command fits into current block
+
+		char* addr = this->current->data() + this->current->size;
+
+		this->current->size += cmd_sz;
+		this->size += cmd_sz;
 		this->cmd_count++;
-		return new ( this->data + old_sz )( T );
+
+		return new ( addr )( T );
+	}
+
+	// Returns address of the first command in this stream, and sets `block` to the
+	// block which holds it. Returns nullptr if stream holds no commands.
+	void* begin_read( Block** block ) const {
+		for ( Block* b = first; b != nullptr; b = b->next ) {
+			if ( b->size ) {
+				*block = b;
+				return b->data();
+			}
+		}
+		*block = nullptr;
+		return nullptr;
+	}
+
+	// Returns address of the command which follows the command at `cmd`, which must have
+	// a size of `cmd_size` bytes. Updates `block` if the next command lives in another block.
+	// Returns nullptr if there are no more commands.
+	void* next( Block** block, void* cmd, size_t cmd_size ) const {
+
+		char* next_cmd = static_cast<char*>( cmd ) + cmd_size;
+
+		if ( next_cmd != ( *block )->data() + ( *block )->size ) {
+			return next_cmd;
+		}
+
+		// --------| invariant: we have reached the end of the current block
+
+		for ( Block* b = ( *block )->next; b != nullptr; b = b->next ) {
+			if ( b->size ) {
+				*block = b;
+				return b->data();
+			}
+		}
+
+		return nullptr;
 	}
 };
 
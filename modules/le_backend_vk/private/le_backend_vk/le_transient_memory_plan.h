@@ -0,0 +1,218 @@
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+#include <vector>
+#include <algorithm>
+
+/*
+ * The Transient Memory Plan decides which transient resources may share
+ * (alias) memory with each other.
+ *
+ * Transient resources are resources which do not need to keep their
+ * contents from one frame to the next. If two transient resources are
+ * never used at the same time within a frame, they may occupy the same
+ * memory.
+ *
+ * Input is a list of resource lifetimes: for each resource the index of
+ * the first and the last pass which uses it, and its memory requirements.
+ *
+ * Output is a list of memory blocks, and, for each resource, a placement:
+ * the block it lives in, and its offset into that block.
+ *
+ * We pack resources using greedy interval colouring: we place resources
+ * largest-first, each into the first block (and at the lowest offset within
+ * that block) where it does not overlap, in memory, with any other resource
+ * whose lifetime overlaps its own. If no such place can be found, we add a
+ * new block.
+ *
+ * This is pure CPU code without any dependencies on Vulkan, so that it can
+ * be tested in isolation.
+ *
+ */
+
+struct le_transient_resource_lifetime_t {
+	uint32_t first_use;        // index of first pass which uses this resource
+	uint32_t last_use;         // index of last pass which uses this resource (inclusive)
+	uint64_t size;             // size of resource in bytes
+	uint64_t alignment;        // required alignment for offset of this resource, must be a power of two
+	uint32_t memory_type_bits; // memory types which are acceptable for this resource
+	uint64_t group;            // resources may only ever alias resources of the same group
+};
+
+struct le_transient_memory_plan_t {
+	struct Block {
+		uint64_t size;             // size of block in bytes
+		uint32_t memory_type_bits; // memory types acceptable to all resources placed within this block
+		uint64_t group;            // group of all resources placed within this block
+	};
+
+	struct Placement {
+		uint32_t block;  // index into blocks
+		uint64_t offset; // offset in bytes into block
+	};
+
+	std::vector<Block>     blocks;
+	std::vector<Placement> placements; // one per resource, in the same order as the lifetimes used to build this plan
+};
+
+// ----------------------------------------------------------------------
+
+inline bool le_transient_resource_lifetimes_overlap( le_transient_resource_lifetime_t const& lhs, le_transient_resource_lifetime_t const& rhs ) {
+	return lhs.group != rhs.group || // resources from different groups must be treated as if they were alive at the same time
+	       ( lhs.first_use <= rhs.last_use && rhs.first_use <= lhs.last_use );
+}
+
+// ----------------------------------------------------------------------
+
+inline void le_transient_memory_plan_build( le_transient_memory_plan_t* plan, le_transient_resource_lifetime_t const* resources, size_t num_resources ) {
+
+	plan->blocks.clear();
+	plan->placements.assign( num_resources, { uint32_t( ~0u ), 0 } );
+
+	// Place resources largest first - this keeps the number of blocks low,
+	// as each block is sized to the first (and therefore largest) resource
+	// placed within it.
+	std::vector<uint32_t> order( num_resources );
+	for ( uint32_t i = 0; i != num_resources; i++ ) {
+		order[ i ] = i;
+	}
+
+	std::stable_sort( order.begin(), order.end(), [ & ]( uint32_t lhs, uint32_t rhs ) {
+		if ( resources[ lhs ].size != resources[ rhs ].size ) {
+			return resources[ lhs ].size > resources[ rhs ].size;
+		}
+		return resources[ lhs ].first_use < resources[ rhs ].first_use;
+	} );
+
+	std::vector<std::vector<uint32_t>> block_residents; // per block: indices of resources placed within block
+
+	struct Range {
+		uint64_t begin;
+		uint64_t end;
+	};
+
+	std::vector<Range> occupied; // scratch: ranges within current block which are occupied during current resource's lifetime
+
+	for ( auto const& r : order ) {
+
+		auto const& resource = resources[ r ];
+
+		bool was_placed = false;
+
+		for ( uint32_t b = 0; b != plan->blocks.size() && !was_placed; b++ ) {
+
+			auto& block = plan->blocks[ b ];
+
+			if ( block.group != resource.group ||
+			     0 == ( block.memory_type_bits & resource.memory_type_bits ) ||
+			     block.size < resource.size ) {
+				continue;
+			}
+
+			// --------| invariant: resource could fit into this block
+
+			occupied.clear();
+
+			for ( auto const& other : block_residents[ b ] ) {
+				if ( le_transient_resource_lifetimes_overlap( resource, resources[ other ] ) ) {
+					occupied.push_back( { plan->placements[ other ].offset, plan->placements[ other ].offset + resources[ other ].size } );
+				}
+			}
+
+			std::sort( occupied.begin(), occupied.end(), []( Range const& lhs, Range const& rhs ) {
+				return lhs.begin < rhs.begin;
+			} );
+
+			// Find lowest offset at which resource does not overlap with any occupied range.
+
+			uint64_t const alignment = resource.alignment ? resource.alignment : 1;
+			uint64_t       offset    = 0;
+
+			for ( auto const& range : occupied ) {
+				if ( offset + resource.size <= range.begin ) {
+					break; // resource fits into gap before this range
+				}
+				if ( range.end > offset ) {
+					offset = ( range.end + alignment - 1 ) & ~( alignment - 1 );
+				}
+			}
+
+			if ( offset + resource.size > block.size ) {
+				continue;
+			}
+
+			// --------| invariant: resource fits into block at offset
+
+			block.memory_type_bits &= resource.memory_type_bits;
+			plan->placements[ r ] = { b, offset };
+			block_residents[ b ].push_back( r );
+			was_placed = true;
+		}
+
+		if ( !was_placed ) {
+			plan->placements[ r ] = { uint32_t( plan->blocks.size() ), 0 };
+			plan->blocks.push_back( { resource.size, resource.memory_type_bits, resource.group } );
+			block_residents.push_back( { r } );
+		}
+	}
+}
+
+// ----------------------------------------------------------------------
+// Returns true if `plan` may be used for the given resources: this is the case
+// if no two resources which overlap in memory are alive at the same time.
+//
+// We use this to test whether a plan which was built for a previous frame
+// can be re-used for the current frame.
+inline bool le_transient_memory_plan_is_valid( le_transient_memory_plan_t const& plan, le_transient_resource_lifetime_t const* resources, size_t num_resources ) {
+
+	if ( plan.placements.size() != num_resources ) {
+		return false;
+	}
+
+	for ( size_t i = 0; i != num_resources; i++ ) {
+
+		auto const& p_i = plan.placements[ i ];
+
+		if ( p_i.block >= plan.blocks.size() ) {
+			return false;
+		}
+
+		auto const& block = plan.blocks[ p_i.block ];
+
+		if ( block.group != resources[ i ].group ||
+		     0 == ( block.memory_type_bits & resources[ i ].memory_type_bits ) ||
+		     p_i.offset + resources[ i ].size > block.size ||
+		     ( resources[ i ].alignment && ( p_i.offset & ( resources[ i ].alignment - 1 ) ) ) ) {
+			return false;
+		}
+
+		for ( size_t j = i + 1; j != num_resources; j++ ) {
+
+			auto const& p_j = plan.placements[ j ];
+
+			if ( p_i.block != p_j.block ) {
+				continue;
+			}
+
+			bool overlap_in_memory = p_i.offset < p_j.offset + resources[ j ].size &&
+			                         p_j.offset < p_i.offset + resources[ i ].size;
+
+			if ( overlap_in_memory && le_transient_resource_lifetimes_overlap( resources[ i ], resources[ j ] ) ) {
+				return false;
+			}
+		}
+	}
+
+	return true;
+}
+
+// ----------------------------------------------------------------------
+// Returns the total number of bytes used by all blocks in this plan.
+inline uint64_t le_transient_memory_plan_get_total_size( le_transient_memory_plan_t const& plan ) {
+	uint64_t total = 0;
+	for ( auto const& b : plan.blocks ) {
+		total += b.size;
+	}
+	return total;
+}
@@ -49,6 +49,12 @@ struct le_module_loader_api {
 
 LE_MODULE( le_module_loader );
 
+// ----------------------------------------------------------------------
+// Internal to le_core: module loaders use these to contribute spans to
+// the module load timeline (see: le_core_get_module_load_timeline).
+uint64_t le_core_module_load_timeline_now();
+void     le_core_module_load_timeline_record( char const* module_name, char const* stage, uint64_t begin_ns, uint64_t end_ns );
+
 // ----------------------------------------------------------------------
 
 #ifdef __cplusplus
@@ -175,6 +175,9 @@ static bool load( le_module_loader_o* obj ) {
 static bool register_api( le_module_loader_o* obj, void* api_interface, const char* register_api_fun_name ) {
 	// define function pointer we will use to initialise api
 	register_api_fun_p_t fptr;
+	// module name is the suffix of the register function name
+	char const* module_name = register_api_fun_name + sizeof( "le_module_register_" ) - 1;
+	uint64_t    t_dlsym     = le_core_module_load_timeline_now();
 	// load function pointer to initialisation method
 	fptr = reinterpret_cast<register_api_fun_p_t>( dlsym( obj->mLibraryHandle, register_api_fun_name ) );
 	if ( !fptr ) {
@@ -182,11 +185,15 @@ static bool register_api( le_module_loader_o* obj, void* api_interface, const ch
 		assert( false );
 		return false;
 	}
+	uint64_t t_register = le_core_module_load_timeline_now();
+	le_core_module_load_timeline_record( module_name, "dlsym", t_dlsym, t_register );
+
 	// Initialize the API. This means telling the API to populate function
 	// pointers inside the struct which we are passing as parameter.
 	log_debug( "Register Module: '%s'", register_api_fun_name );
 
 	( *fptr )( api_interface );
+	le_core_module_load_timeline_record( module_name, "register_api", t_register, le_core_module_load_timeline_now() );
 	return true;
 }
 
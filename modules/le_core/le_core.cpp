@@ -15,6 +15,7 @@
 #include <string.h> // for memcpy
 #include <memory>
 #include <mutex>
+#include <chrono>
 
 #ifndef _WIN64
 #	include <sys/mman.h>
@@ -27,6 +28,17 @@
 
 #include "3rdparty/src/spooky/SpookyV2.h"
 
+// Set LE_CORE_PREFETCH_MODULES to the number of worker threads which should read
+// module files ahead of dynamic module loading - 0 to disable.
+#ifndef LE_CORE_PREFETCH_MODULES
+#	define LE_CORE_PREFETCH_MODULES 0
+#endif
+
+#if ( LE_CORE_PREFETCH_MODULES > 0 )
+#	include <thread>
+#	include <filesystem>
+#endif
+
 struct ApiStore {
 	std::vector<std::string> names{};      // Api names (used for debugging)
 	std::vector<uint64_t>    nameHashes{}; // Hashed api names (used for lookup)
@@ -56,13 +68,206 @@ ISL_API_ATTR void** le_core_produce_dictionary_entry( uint64_t key ) {
 }
 
 // ----------------------------------------------------------------------
-// Return heap-allocated char *, uniquely indexed by key
+/* Lock-free string interning
+ *
+ * Strings are copied into an append-only arena, and indexed by their 64 bit
+ * id (typically a hash of the string) via an open-addressing hash table.
+ *
+ * A slot gets claimed by compare-and-swapping its key from 0 to the id. The
+ * thread which claims the slot copies the string into the arena, and then
+ * publishes the string pointer. Slots, once claimed, never change, which
+ * means that lookups don't need to lock, and that pointers to interned
+ * strings stay valid until the program exits.
+ *
+ * Probing is bounded - if all slots in a probe sequence are taken by other
+ * ids, we continue probing in the next (twice as large) table, which gets
+ * chained to the current table on demand. Because a slot can only ever go
+ * from empty to full, any two threads which intern the same id will meet
+ * at the same slot.
+ *
+ */
+class StringArena : NoCopy, NoMove {
+	static constexpr size_t BLOCK_SIZE = 64 * 1024;
+
+	struct Block {
+		Block*              prev;
+		size_t              capacity;
+		std::atomic<size_t> used;
+		char*               data() {
+			return reinterpret_cast<char*>( this + 1 );
+		}
+	};
+
+	std::atomic<Block*> current = nullptr;
+
+  public:
+	// Returns pointer to `size` bytes of memory which will stay valid for the lifetime of the arena.
+	char* allocate( size_t size ) {
+		for ( ;; ) {
+			Block* block = current.load( std::memory_order_acquire );
+			if ( block ) {
+				size_t offset = block->used.fetch_add( size, std::memory_order_relaxed );
+				if ( offset + size <= block->capacity ) {
+					return block->data() + offset;
+				}
+			}
+			// ----------| invariant: current block is full (or there is no current block yet)
+			size_t capacity  = std::max( BLOCK_SIZE, size );
+			Block* new_block = static_cast<Block*>( malloc( sizeof( Block ) + capacity ) );
+			assert( new_block && "Could not allocate string arena block" );
+			new_block->prev     = block;
+			new_block->capacity = capacity;
+			new_block->used.store( size, std::memory_order_relaxed );
+			if ( current.compare_exchange_strong( block, new_block, std::memory_order_acq_rel ) ) {
+				return new_block->data();
+			}
+			// Another thread installed a new block before us - try again using their block.
+			free( new_block );
+		}
+	}
+
+	~StringArena() {
+		Block* block = current.load();
+		while ( block ) {
+			Block* prev = block->prev;
+			free( block );
+			block = prev;
+		}
+	}
+};
+
+class StringInternTable : NoCopy, NoMove {
+	static constexpr size_t MAX_PROBES = 64;
+
+	struct Slot {
+		std::atomic<uint64_t>    key = 0; // 0 means empty
+		std::atomic<char const*> str = nullptr;
+	};
+
+	struct Table {
+		size_t                  capacity; // must be power of two
+		std::unique_ptr<Slot[]> slots;
+		std::atomic<Table*>     next = nullptr;
+
+		explicit Table( size_t capacity_ )
+		    : capacity( capacity_ )
+		    , slots( new Slot[ capacity_ ] ) {
+		}
+	};
+
+	Table       first_table{ 4096 };
+	StringArena arena;
+
+	// Slot key 0 signals an empty slot - we therefore remap an id of 0.
+	static uint64_t key_from_id( uint64_t id ) {
+		return id ? id : ~uint64_t( 0 );
+	}
+
+	// Spin until the thread which claimed the slot has published the string.
+	static char const* wait_for_str( Slot const& slot ) {
+		char const* str;
+		while ( nullptr == ( str = slot.str.load( std::memory_order_acquire ) ) ) {
+		}
+		return str;
+	}
+
+	Table* produce_next_table( Table* table ) {
+		Table* next = table->next.load( std::memory_order_acquire );
+		if ( next ) {
+			return next;
+		}
+		Table* new_table = new Table( table->capacity * 2 );
+		if ( table->next.compare_exchange_strong( next, new_table, std::memory_order_acq_rel ) ) {
+			return new_table;
+		}
+		// Another thread chained a table before us; use theirs.
+		delete new_table;
+		return next;
+	}
+
+  public:
+	// If more than one string was interned with the same id, returns the string which was interned first.
+	char const* find( uint64_t id ) const {
+		uint64_t const key = key_from_id( id );
+		for ( Table const* t = &first_table; t != nullptr; t = t->next.load( std::memory_order_acquire ) ) {
+			size_t const mask = t->capacity - 1;
+			for ( size_t i = 0; i != MAX_PROBES; i++ ) {
+				Slot const& slot     = t->slots[ ( key + i ) & mask ];
+				uint64_t    slot_key = slot.key.load( std::memory_order_acquire );
+				if ( slot_key == key ) {
+					return wait_for_str( slot );
+				}
+				if ( slot_key == 0 ) {
+					// An empty slot ends the probe sequence - id cannot be in any table.
+					return nullptr;
+				}
+			}
+		}
+		return nullptr;
+	}
+
+	char const* produce( char const* str, uint64_t id ) {
+		uint64_t const key = key_from_id( id );
+		for ( Table* t = &first_table;; t = produce_next_table( t ) ) {
+			size_t const mask = t->capacity - 1;
+			for ( size_t i = 0; i != MAX_PROBES; i++ ) {
+				Slot&    slot     = t->slots[ ( key + i ) & mask ];
+				uint64_t slot_key = slot.key.load( std::memory_order_acquire );
+				if ( slot_key == 0 &&
+				     slot.key.compare_exchange_strong( slot_key, key, std::memory_order_acq_rel ) ) {
+					// We claimed this slot - copy string into arena, and publish it.
+					size_t num_bytes = strlen( str ) + 1;
+					char*  copy      = arena.allocate( num_bytes );
+					memcpy( copy, str, num_bytes );
+					slot.str.store( copy, std::memory_order_release );
+					return copy;
+				}
+				if ( slot_key == key ) {
+					char const* slot_str = wait_for_str( slot );
+					if ( 0 == strcmp( slot_str, str ) ) {
+						return slot_str;
+					}
+					// Hash collision: another string was interned with the same id - keep
+					// probing, so that `str` gets a slot of its own.
+				}
+			}
+		}
+	}
+
+	~StringInternTable() {
+		Table* t = first_table.next.load();
+		while ( t ) {
+			Table* next = t->next.load();
+			delete t;
+			t = next;
+		}
+	}
+};
+
+static StringInternTable& string_intern_table() {
+	static StringInternTable obj;
+	return obj;
+}
+
+// ----------------------------------------------------------------------
+
+ISL_API_ATTR char const* le_core_intern_string( char const* str, uint64_t hash ) {
+	if ( hash == 0 ) {
+		hash = hash_64_fnv1a( str );
+	}
+	return string_intern_table().produce( str, hash );
+}
+
+// ----------------------------------------------------------------------
+
+ISL_API_ATTR char const* le_core_get_interned_string( uint64_t hash ) {
+	return string_intern_table().find( hash );
+}
+
+// ----------------------------------------------------------------------
+// Return app-lifetime-persistent char *, uniquely indexed by key
 ISL_API_ATTR char const* le_core_produce_string_literal( char const* string_literal ) {
-	static std::mutex                                mtx;
-	auto                                             lock = std::scoped_lock( mtx );
-	static std::unordered_map<uint64_t, std::string> strings;
-	auto [ p, was_inserted ] = strings.insert( { hash_64_fnv1a( string_literal ), string_literal } );
-	return p->second.c_str();
+	return le_core_intern_string( string_literal, 0 );
 }
 
 // ----------------------------------------------------------------------
@@ -84,7 +289,7 @@ static le_settings_map_t& get_global_settings_store() {
 // Setting names must be unique - and their types must match.
 ISL_API_ATTR void** le_core_produce_setting_entry( char const* name, char const* type_name ) {
 	const uint64_t type_name_hash = type_name ? hash_64_fnv1a( type_name ) : 0;
-	const uint64_t key            = hash_64_fnv1a( name );
+	const uint64_t key            = hash_64_word( name );
 
 	// Fetch (or create and fetch) an entry from the store.
 	auto result = [ & ]() -> auto{
@@ -139,7 +344,7 @@ ISL_API_ATTR void le_core_copy_settings_entries( le_settings_map_t* settings_map
 ISL_API_ATTR LeSettingEntry* le_core_get_setting_entry( char const* setting_name ) {
 	std::scoped_lock lock( get_settings_store_mutex() );
 
-	auto result = get_global_settings_store().map.find( hash_64_fnv1a( setting_name ) );
+	auto result = get_global_settings_store().map.find( hash_64_word( setting_name ) );
 
 	if ( result != get_global_settings_store().map.end() ) {
 		return &result->second;
@@ -148,6 +353,129 @@ ISL_API_ATTR LeSettingEntry* le_core_get_setting_entry( char const* setting_name
 	}
 };
 
+// ----------------------------------------------------------------------
+// Module load timeline
+//
+// Module loads are rare (they happen at startup, and on hot-reload), which is
+// why we can afford to protect the timeline with a mutex.
+
+struct ModuleLoadTimeline {
+	std::mutex                               mtx;
+	std::vector<le_core_module_load_event_t> events;
+	std::chrono::steady_clock::time_point    t_zero = std::chrono::steady_clock::now();
+};
+
+static ModuleLoadTimeline& module_load_timeline() {
+	static ModuleLoadTimeline obj;
+	return obj;
+}
+
+// Returns a small, stable index for the calling thread - we use this instead
+// of std::thread::id, as chrome trace requires thread ids to be integers.
+static uint32_t get_thread_index() {
+	static std::atomic<uint32_t> thread_count = 0;
+	static thread_local uint32_t thread_index = thread_count++;
+	return thread_index;
+}
+
+ISL_API_ATTR uint64_t le_core_module_load_timeline_now() {
+	auto now = std::chrono::steady_clock::now();
+	return std::chrono::duration_cast<std::chrono::nanoseconds>( now - module_load_timeline().t_zero ).count();
+}
+
+ISL_API_ATTR void le_core_module_load_timeline_record( char const* module_name, char const* stage, uint64_t begin_ns, uint64_t end_ns ) {
+	le_core_module_load_event_t event{};
+	event.module_name  = le_core_intern_string( module_name, 0 );
+	event.stage        = stage;
+	event.thread_index = get_thread_index();
+	event.begin_ns     = begin_ns;
+	event.duration_ns  = end_ns - begin_ns;
+
+	auto& timeline = module_load_timeline();
+	auto  lock     = std::scoped_lock( timeline.mtx );
+	timeline.events.push_back( event );
+}
+
+// ----------------------------------------------------------------------
+
+ISL_API_ATTR void le_core_get_module_load_timeline( le_core_module_load_event_t* events, size_t* num_events ) {
+	auto& timeline = module_load_timeline();
+	auto  lock     = std::scoped_lock( timeline.mtx );
+
+	if ( events == nullptr ) {
+		*num_events = timeline.events.size();
+		return;
+	}
+
+	*num_events = std::min( *num_events, timeline.events.size() );
+	memcpy( events, timeline.events.data(), sizeof( le_core_module_load_event_t ) * ( *num_events ) );
+}
+
+// ----------------------------------------------------------------------
+
+// Returns `str` as a json string literal, including quotes - module names and
+// file paths may contain backslashes (on Windows) or quotes, which must be escaped.
+static std::string json_quote( char const* str ) {
+	std::string result = "\"";
+	for ( char const* c = str; c && *c; c++ ) {
+		switch ( *c ) {
+		case '"': result += "\\\""; break;
+		case '\\': result += "\\\\"; break;
+		case '\n': result += "\\n"; break;
+		case '\r': result += "\\r"; break;
+		case '\t': result += "\\t"; break;
+		default:
+			if ( uint8_t( *c ) < 0x20 ) {
+				char buf[ 8 ];
+				snprintf( buf, sizeof( buf ), "\\u%04x", uint32_t( *c ) );
+				result += buf;
+			} else {
+				result += *c;
+			}
+		}
+	}
+	result += "\"";
+	return result;
+}
+
+ISL_API_ATTR bool le_core_write_module_load_trace( char const* path ) {
+
+	std::vector<le_core_module_load_event_t> events;
+	{
+		auto& timeline = module_load_timeline();
+		auto  lock     = std::scoped_lock( timeline.mtx );
+		events         = timeline.events;
+	}
+
+	FILE* file = fopen( path, "wb" );
+
+	if ( file == nullptr ) {
+		return false;
+	}
+
+	fprintf( file, "{\"traceEvents\":[\n" );
+
+	for ( size_t i = 0; i != events.size(); i++ ) {
+		auto const& e     = events[ i ];
+		std::string name  = json_quote( e.module_name );
+		std::string stage = json_quote( e.stage );
+		// Chrome trace timestamps are given in microseconds.
+		if ( e.duration_ns == 0 ) {
+			fprintf( file, "{\"name\":%s,\"cat\":%s,\"ph\":\"i\",\"s\":\"t\",\"ts\":%.3f,\"pid\":0,\"tid\":%u}",
+			         name.c_str(), stage.c_str(), e.begin_ns / 1000.0, e.thread_index );
+		} else {
+			fprintf( file, "{\"name\":%s,\"cat\":%s,\"ph\":\"X\",\"ts\":%.3f,\"dur\":%.3f,\"pid\":0,\"tid\":%u,\"args\":{\"stage\":%s}}",
+			         name.c_str(), stage.c_str(), e.begin_ns / 1000.0, e.duration_ns / 1000.0, e.thread_index, stage.c_str() );
+		}
+		fprintf( file, i + 1 != events.size() ? ",\n" : "\n" );
+	}
+
+	fprintf( file, "]}\n" );
+	fclose( file );
+
+	return true;
+}
+
 // ----------------------------------------------------------------------
 
 struct loader_callback_params_o {
@@ -293,13 +621,81 @@ static void* le_core_create_api( uint64_t id, size_t apiStructSize, const char*
 // ----------------------------------------------------------------------
 
 ISL_API_ATTR void* le_core_load_module_static( char const* module_name, void ( *module_reg_fun )( void* ), uint64_t api_size_in_bytes ) {
-	void* api = le_core_create_api( hash_64_fnv1a_const( module_name ), api_size_in_bytes, module_name );
+	uint64_t t_begin = le_core_module_load_timeline_now();
+	void*    api     = le_core_create_api( hash_64_fnv1a_const( module_name ), api_size_in_bytes, module_name );
 	module_reg_fun( api );
+	le_core_module_load_timeline_record( module_name, "register_api", t_begin, le_core_module_load_timeline_now() );
 	return api;
 };
 
 // ----------------------------------------------------------------------
 
+#if ( LE_CORE_PREFETCH_MODULES > 0 )
+
+// We can't dlopen independent modules on parallel threads: the dynamic linker holds
+// a global lock while it loads a library and runs the library's static initialisers,
+// and these initialisers will recursively load any modules they depend on.
+//
+// What we can do in parallel is read module files from disk: On the first dynamic
+// module load, we read all module files on LE_CORE_PREFETCH_MODULES worker threads,
+// so that they are resident in the operating system's file cache by the time they
+// get dlopen'ed one after another on the main thread.
+class ModulePrefetcher : NoCopy, NoMove {
+	std::vector<std::string> paths;
+	std::atomic<size_t>      next_path = 0;
+	std::vector<std::thread> threads;
+
+	void prefetch_files() {
+		std::vector<char> buffer( 1 << 16 );
+		for ( size_t i = next_path++; i < paths.size(); i = next_path++ ) {
+			uint64_t t_begin = le_core_module_load_timeline_now();
+			FILE*    file    = fopen( paths[ i ].c_str(), "rb" );
+			if ( file == nullptr ) {
+				continue;
+			}
+			while ( fread( buffer.data(), 1, buffer.size(), file ) == buffer.size() ) {
+			}
+			fclose( file );
+			le_core_module_load_timeline_record( paths[ i ].c_str(), "prefetch", t_begin, le_core_module_load_timeline_now() );
+		}
+	}
+
+  public:
+	ModulePrefetcher() {
+#	ifdef WIN32
+		char const* modules_dir = ".";
+		char const* extension   = ".dll";
+#	else
+		char const* modules_dir = "./modules";
+		char const* extension   = ".so";
+#	endif
+		std::error_code ec;
+		for ( auto const& entry : std::filesystem::directory_iterator( modules_dir, ec ) ) {
+			if ( entry.is_regular_file( ec ) && entry.path().extension() == extension ) {
+				paths.emplace_back( entry.path().string() );
+			}
+		}
+		size_t num_threads = std::min<size_t>( LE_CORE_PREFETCH_MODULES, paths.size() );
+		for ( size_t i = 0; i != num_threads; i++ ) {
+			threads.emplace_back( &ModulePrefetcher::prefetch_files, this );
+		}
+	}
+
+	~ModulePrefetcher() {
+		for ( auto& t : threads ) {
+			t.join();
+		}
+	}
+};
+
+static void prefetch_module_files() {
+	static ModulePrefetcher prefetcher{};
+}
+
+#endif
+
+// ----------------------------------------------------------------------
+
 ISL_API_ATTR void* le_core_load_module_dynamic( char const* module_name, uint64_t api_size_in_bytes, bool should_watch ) {
 
 	uint64_t module_name_hash = hash_64_fnv1a_const( module_name );
@@ -315,6 +711,12 @@ ISL_API_ATTR void* le_core_load_module_dynamic( char const* module_name, uint64_
 
 	if ( api == nullptr ) {
 
+		uint64_t t_begin = le_core_module_load_timeline_now();
+
+#if ( LE_CORE_PREFETCH_MODULES > 0 )
+		prefetch_module_files();
+#endif
+
 		char api_register_fun_name[ 256 ];
 		snprintf( api_register_fun_name, 255, "le_module_register_%s", module_name );
 
@@ -346,7 +748,12 @@ ISL_API_ATTR void* le_core_load_module_dynamic( char const* module_name, uint64_
 		//
 		api = le_core_create_api( hash_64_fnv1a_const( module_name ), api_size_in_bytes, module_name );
 
+		// Note that dlopen will also run the module's static initialisers - which
+		// means that this span will contain any nested module loads.
+		uint64_t t_dlopen = le_core_module_load_timeline_now();
 		module_loader_i.load( loader );
+		le_core_module_load_timeline_record( module_name, "dlopen", t_dlopen, le_core_module_load_timeline_now() );
+
 		module_loader_i.register_api( loader, api, api_register_fun_name );
 
 		// ----
@@ -362,9 +769,13 @@ ISL_API_ATTR void* le_core_load_module_dynamic( char const* module_name, uint64_
 			le_file_watcher_watch_settings watchSettings = {};
 
 			watchSettings.callback_fun = []( const char*, void* user_data ) {
-				auto params = static_cast<loader_callback_params_o*>( user_data );
+				auto        params      = static_cast<loader_callback_params_o*>( user_data );
+				char const* module_name = params->lib_register_fun_name.c_str() + sizeof( "le_module_register_" ) - 1;
+				uint64_t    t_begin     = le_core_module_load_timeline_now();
 				module_loader_i.load( params->loader );
+				le_core_module_load_timeline_record( module_name, "dlopen", t_begin, le_core_module_load_timeline_now() );
 				module_loader_i.register_api( params->loader, params->api, params->lib_register_fun_name.c_str() );
+				le_core_module_load_timeline_record( module_name, "reload", t_begin, le_core_module_load_timeline_now() );
 			};
 
 			watchSettings.callback_user_data = reinterpret_cast<void*>( callbackParams );
@@ -374,8 +785,7 @@ ISL_API_ATTR void* le_core_load_module_dynamic( char const* module_name, uint64_
 			callbackParams->watch_id      = le_file_watcher_i.add_watch( get_file_watcher(), &watchSettings );
 		}
 
-	} else {
-		// TODO: we should warn that this api was already added.
+		le_core_module_load_timeline_record( module_name, "load_module", t_begin, le_core_module_load_timeline_now() );
 	}
 
 	return api;
@@ -390,54 +800,36 @@ ISL_API_ATTR void* le_core_load_library_persistently( char const* library_name )
 
 // ----------------------------------------------------------------------
 
-/* Provide storage for a lookup table for uniform arguments - any argument
- * set via the LE_ARGUMENT_NAME macro will be placed in this table should
- * we run in Debug mode.
+/* Any argument name set via the LE_ARGUMENT_NAME macro will be placed
+ * in the string interning table should we run in Debug mode.
  *
  * In Release mode the macro evaluates to a constexpr, and argument ids are
  * resolved at compile-time, therefore will not be
  * placed in table.
  *
  */
-struct ArgumentNameTable {
-	std::mutex                                mtx;
-	std::unordered_map<uint64_t, std::string> map;
-};
-
-static ArgumentNameTable argument_names_table{};
-
-// ----------------------------------------------------------------------
-
 ISL_API_ATTR void le_update_argument_name_table( const char* name, uint64_t value ) {
 
-	// find index of entry with current value in table
-
-	std::scoped_lock lock( argument_names_table.mtx );
+	char const* interned_name = le_core_intern_string( name, value );
 
-	auto result = argument_names_table.map.insert( { value, name } );
-
-	if ( !result.second ) {
-		// insertion did not take place
-		assert( result.first->second == std::string( name ) && "Possible hash collision, names for hashes don't match!" );
-	}
+	// Interning always gives us back our own name - but a lookup by id only does
+	// so if no other name was interned with the same id before.
+	assert( interned_name == le_core_get_interned_string( value ) &&
+	        "Possible hash collision, names for hashes don't match!" );
+	( void )interned_name;
 };
 
 // ----------------------------------------------------------------------
 
 ISL_API_ATTR char const* le_get_argument_name_from_hash( uint64_t value ) {
 
-	std::scoped_lock lock( argument_names_table.mtx );
-	if ( argument_names_table.map.empty() ) {
-		return "<< Argument name table empty. >>";
-	}
+	char const* name = le_core_get_interned_string( value );
 
-	auto const& e = argument_names_table.map.find( value );
-	if ( e == argument_names_table.map.end() ) {
+	if ( name == nullptr ) {
 		return "<< Argument name could not be resolved. >>";
-
-	} else {
-		return e->second.c_str();
 	}
+
+	return name;
 }
 
 // callback forwarding --------------------------------------------------
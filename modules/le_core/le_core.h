@@ -60,6 +60,20 @@ ISL_API_ATTR DLL_CORE_API void** le_core_produce_setting_entry( char const* name
 // Globally available, app-lifetime-persistent store for char literals
 ISL_API_ATTR DLL_CORE_API char const* le_core_produce_string_literal( char const* string_literal );
 
+// Globally available, app-lifetime-persistent, lock-free string interning table.
+//
+// Returns a stable pointer to the interned copy of `str`. The string's id is `hash` -
+// if you pass 0 for `hash`, id defaults to `hash_64_fnv1a( str )`. Interning the
+// same string more than once returns the same pointer each time.
+//
+// All strings share one id namespace - ids must therefore always be `hash_64_fnv1a`
+// hashes, which is also what LE_ARGUMENT_NAME uses. Should two strings collide,
+// both get interned, but a lookup by id returns the string which was interned first.
+ISL_API_ATTR DLL_CORE_API char const* le_core_intern_string( char const* str, uint64_t hash );
+// Look up an interned string by its id - returns nullptr if not found. Never locks,
+// and is safe to call from any thread.
+ISL_API_ATTR DLL_CORE_API char const* le_core_get_interned_string( uint64_t hash );
+
 // Persistent settings that can be shared among modules.
 
 namespace le {
@@ -134,6 +148,28 @@ ISL_API_ATTR DLL_CORE_API void le_core_copy_settings_entries( struct le_settings
 // lookup settings entry, and if found, return pointer to existing entry, nullptr otherwise.
 ISL_API_ATTR DLL_CORE_API struct LeSettingEntry* le_core_get_setting_entry( char const* setting_name );
 
+// Module load profiling --------------------------------------------------
+//
+// le_core records a timeline of module loads: for each module it records
+// spans for dlopen (which includes running the module's static initialisers),
+// symbol lookup, and `register_api`. Module reloads are recorded, too: each
+// reload gets a "reload" span, which contains its dlopen, dlsym, and
+// register_api spans.
+//
+struct le_core_module_load_event_t {
+	char const* module_name; // app-lifetime persistent
+	char const* stage;       // one of "load_module", "dlopen", "dlsym", "register_api", "reload", "prefetch"
+	uint32_t    thread_index;
+	uint64_t    begin_ns; // relative to the first event recorded
+	uint64_t    duration_ns;
+};
+
+// Copy the module load timeline into `events` - Call with `events` == nullptr to query the number of events.
+// If `events` is not nullptr, `num_events` must hold the capacity of `events`, and will be set to the number of events copied.
+ISL_API_ATTR DLL_CORE_API void le_core_get_module_load_timeline( struct le_core_module_load_event_t* events, size_t* num_events );
+// Write the module load timeline in Chrome trace json format (view via chrome://tracing, or ui.perfetto.dev)
+ISL_API_ATTR DLL_CORE_API bool le_core_write_module_load_trace( char const* path );
+
 // For debug purposes - shader arguments
 ISL_API_ATTR DLL_CORE_API void        le_update_argument_name_table( const char* source, uint64_t value );
 ISL_API_ATTR DLL_CORE_API char const* le_get_argument_name_from_hash( uint64_t value );
@@ -2,6 +2,9 @@
 #define GUARD_LE_HASH_UTIL_H
 
 #include "le_core.h"
+#include <string.h> // for memcpy, strlen
+#include <bit>      // for std::endian
+#include <type_traits>
 
 constexpr uint32_t FNV1A_VAL_32_CONST   = 0x811c9dc5;
 constexpr uint32_t FNV1A_PRIME_32_CONST = 0x1000193;
@@ -55,6 +58,92 @@ inline uint32_t hash_32_fnv1a( char const* const input ) noexcept {
 
 } // hash_32_fnv1a
 
+// ----------------------------------------------------------------------
+// Word-at-a-time 64 bit hash.
+//
+// Consumes input eight bytes at a time, and finishes with murmur3's 64 bit
+// finalizer for full avalanche - this is considerably faster than fnv1a for
+// runtime strings, and mixes better for short keys. Words are read as
+// little-endian, so that runtime and compile-time variants agree.
+//
+// Note that hash values differ from fnv1a: use this only for keys which are
+// never compared against hashes calculated via hash_64_fnv1a_const, such as
+// LE_ARGUMENT_NAME.
+
+constexpr uint64_t HASH_64_WORD_PRIME_1 = 0x9e3779b185ebca87;
+constexpr uint64_t HASH_64_WORD_PRIME_2 = 0xc2b2ae3d27d4eb4f;
+
+inline constexpr uint64_t hash_64_word_rotl( uint64_t x, int r ) noexcept {
+	return ( x << r ) | ( x >> ( 64 - r ) );
+}
+
+inline constexpr uint64_t hash_64_word_mix( uint64_t state, uint64_t word ) noexcept {
+	return hash_64_word_rotl( state ^ ( word * HASH_64_WORD_PRIME_2 ), 31 ) * HASH_64_WORD_PRIME_1;
+}
+
+inline constexpr uint64_t hash_64_word_finalize( uint64_t h ) noexcept {
+	h ^= h >> 33;
+	h *= 0xff51afd7ed558ccd;
+	h ^= h >> 33;
+	h *= 0xc4ceb9fe1a85ec53;
+	h ^= h >> 33;
+	return h;
+}
+
+// Reads up to 8 bytes as a little-endian word - bytes beyond `num_bytes` are zero.
+//
+// Words are assembled via shifts, so that hash values don't depend on host byte
+// order. At runtime, full words on little-endian hosts are read via a single load.
+template <typename T>
+inline constexpr uint64_t hash_64_word_read( T const* bytes, size_t num_bytes ) noexcept {
+	static_assert( sizeof( T ) == 1, "hash_64_word_read reads bytes" );
+	if constexpr ( std::endian::native == std::endian::little ) {
+		if ( !std::is_constant_evaluated() && num_bytes == 8 ) {
+			uint64_t word;
+			memcpy( &word, bytes, 8 );
+			return word;
+		}
+	}
+	uint64_t word = 0;
+	for ( size_t i = 0; i != num_bytes; i++ ) {
+		word |= uint64_t( uint8_t( bytes[ i ] ) ) << ( i * 8 );
+	}
+	return word;
+}
+
+// Generic implementation - used by both compile-time and runtime variants.
+template <typename T>
+inline constexpr uint64_t hash_64_word_impl( T const* data, size_t num_bytes ) noexcept {
+	uint64_t state = HASH_64_WORD_PRIME_1 ^ ( num_bytes * HASH_64_WORD_PRIME_2 );
+	size_t   i     = 0;
+	for ( ; i + 8 <= num_bytes; i += 8 ) {
+		state = hash_64_word_mix( state, hash_64_word_read( data + i, 8 ) );
+	}
+	if ( i != num_bytes ) {
+		state = hash_64_word_mix( state, hash_64_word_read( data + i, num_bytes - i ) );
+	}
+	return hash_64_word_finalize( state );
+}
+
+// Returns a compile-time calculated 64 bit word hash for a given constant string.
+consteval uint64_t hash_64_word_const( char const* const str ) noexcept {
+	size_t num_bytes = 0;
+	while ( str[ num_bytes ] ) {
+		num_bytes++;
+	}
+	return hash_64_word_impl( str, num_bytes );
+}
+
+// Returns a 64 bit word hash for `num_bytes` bytes starting at `data`.
+inline uint64_t hash_64_word( void const* data, size_t num_bytes ) noexcept {
+	return hash_64_word_impl( static_cast<uint8_t const*>( data ), num_bytes );
+}
+
+// Returns a 64 bit word hash for a given null-terminated string.
+inline uint64_t hash_64_word( char const* const str ) noexcept {
+	return hash_64_word( str, strlen( str ) );
+}
+
 #ifndef NDEBUG
 
 // Shader argument names are internally stored / looked up as their hashes.
@@ -15,5 +15,5 @@ struct LeSettingEntry {
 };
 
 struct le_settings_map_t {
-	std::unordered_map<uint64_t, LeSettingEntry> map; // fnv64_hash(name) -> entry
+	std::unordered_map<uint64_t, LeSettingEntry> map; // hash_64_word(name) -> entry
 };
@@ -1,4 +1,5 @@
 #include "le_core.h"
+#include "le_hash_util.h" // for state slot keys
 
 #include "le_renderer.h"
 
@@ -11,33 +12,33 @@
 #include <assert.h>
 #include <vector>
 #include <algorithm>
+#include <unordered_map>
+
+#include "3rdparty/src/spooky/SpookyV2.h" // for hashing argument data
 
 #ifdef _WIN32
 #	define __PRETTY_FUNCTION__ __FUNCSIG__
 #endif //
 
-#ifndef LE_MT
-#	define LE_MT 0
-#endif
-
-#if ( LE_MT > 0 )
-#	include "le_jobs.h"
-#endif
+#include "le_jobs.h"
 
 // ----------------------------------------------------------------------
 // return allocator offset based on current worker thread index.
-static inline int fetch_allocator_index() {
-#if ( LE_MT > 0 )
+//
+// If the renderer is multi-threaded, encoders only ever record from within
+// jobs, and each worker thread has an allocator of its own. If the renderer
+// is single-threaded, there is only one allocator.
+static inline int fetch_allocator_index( uint32_t num_worker_threads ) {
+	if ( num_worker_threads == 0 ) {
+		return 0;
+	}
 	int result = le_jobs::get_current_worker_id();
-	assert( result >= 0 );
+	assert( result >= 0 && uint32_t( result ) < num_worker_threads ); // must be called from within a job
 	return result;
-#else
-	return 0;
-#endif
 }
 
-static inline le_allocator_o* fetch_allocator( le_allocator_o** ppAlloc ) {
-	int             index  = fetch_allocator_index();
+static inline le_allocator_o* fetch_allocator( le_allocator_o** ppAlloc, uint32_t num_worker_threads ) {
+	int             index  = fetch_allocator_index( num_worker_threads );
 	le_allocator_o* result = ppAlloc[ index ];
 	assert( result );
 	return result;
@@ -82,26 +83,189 @@ struct le_shader_binding_table_o {
 // the main thing that we want to achieve is that the pool only gets destroyed once that the app gets torn down
 // this means we want to keep it alive - even through a reload...
 //
+// Shadow of the state which the backend will have set once it has decoded
+// all commands recorded so far. We use this to drop commands which would
+// not change this state.
+//
+// Note that the backend resets all argument bindings whenever a different
+// pipeline gets bound, which is why we must forget about any argument data
+// whenever the pipeline changes.
+struct le_command_buffer_encoder_shadow_state_t {
+
+	struct ArgumentData {
+		uint64_t             argument_name_id;
+		std::vector<uint8_t> data; // copy of data last set for this argument
+	};
+
+	le_gpso_handle gpso = nullptr; // currently bound graphics pipeline, or nullptr if unknown
+	le_cpso_handle cpso = nullptr; // currently bound compute pipeline, or nullptr if unknown
+
+	bool  has_line_width = false;
+	float line_width     = 0.f;
+
+	bool                      has_viewports  = false;
+	uint32_t                  first_viewport = 0;
+	std::vector<le::Viewport> viewports;
+
+	bool                    has_scissors  = false;
+	uint32_t                first_scissor = 0;
+	std::vector<le::Rect2D> scissors;
+
+	std::vector<ArgumentData> arguments; // argument data which is currently bound - only ever a handful of elements, so we search linearly
+
+	void forget_arguments() {
+		arguments.clear();
+	}
+
+	void forget_all() {
+		gpso           = nullptr;
+		cpso           = nullptr;
+		has_line_width = false;
+		has_viewports  = false;
+		has_scissors   = false;
+		forget_arguments();
+	}
+};
+
+// Argument data which was uploaded to the transient allocator by this encoder.
+//
+// Memory handed out by transient allocators stays valid until the frame gets
+// cleared, which means that we may bind the same allocation again if an
+// argument is set to data which we have already uploaded. We keep a copy of
+// uploaded data in regular (cached) memory, so that we never need to read back
+// from the transient allocator's mapped memory, which may be write-combined.
+struct le_command_buffer_encoder_argument_data_cache_t {
+
+	struct Upload {
+		le_buffer_resource_handle buffer;        // transient allocator buffer holding data
+		uint64_t                  buffer_offset; // offset into buffer
+		uint64_t                  num_bytes;     //
+		size_t                    copy_offset;   // offset into copies for a copy of data
+		uint32_t                  next;          // index of next upload with same hash, or NO_UPLOAD
+	};
+
+	static constexpr uint32_t NO_UPLOAD = ~0u;
+
+	std::unordered_map<uint64_t, uint32_t> first_upload; // hash of data -> index of first upload with this hash
+	std::vector<Upload>                    uploads;
+	std::vector<uint8_t>                   copies;
+
+	// Returns upload holding identical data, or nullptr if no such upload exists.
+	Upload const* find( uint64_t hash, void const* data, size_t num_bytes ) const {
+		auto it = first_upload.find( hash );
+		if ( it == first_upload.end() ) {
+			return nullptr;
+		}
+		for ( uint32_t i = it->second; i != NO_UPLOAD; i = uploads[ i ].next ) {
+			auto const& upload = uploads[ i ];
+			if ( upload.num_bytes == num_bytes &&
+			     0 == memcmp( copies.data() + upload.copy_offset, data, num_bytes ) ) {
+				return &upload;
+			}
+		}
+		return nullptr;
+	}
+
+	void insert( uint64_t hash, void const* data, size_t num_bytes, le_buffer_resource_handle buffer, uint64_t buffer_offset ) {
+		Upload upload{ buffer, buffer_offset, num_bytes, copies.size(), NO_UPLOAD };
+		copies.insert( copies.end(), static_cast<uint8_t const*>( data ), static_cast<uint8_t const*>( data ) + num_bytes );
+
+		auto [ it, was_inserted ] = first_upload.try_emplace( hash, uint32_t( uploads.size() ) );
+		if ( !was_inserted ) {
+			upload.next = it->second; // prepend to chain of uploads with this hash
+			it->second  = uint32_t( uploads.size() );
+		}
+		uploads.push_back( upload );
+	}
+};
+
+// Draws which were recorded between `begin_sorted_draws` and `end_sorted_draws`.
+//
+// Setting a sort key starts a new draw packet: a packet holds all commands
+// which were recorded after its sort key was set, up until the next sort key
+// gets set. At the end, we sort packets by their key, and emit their commands
+// into the encoder's command stream.
+//
+// Since packets may be re-ordered, each packet must set all state which its
+// draws depend upon - pipeline, arguments, vertex- and index buffers. Commands
+// recorded before the first sort key form a prefix, which is emitted first,
+// and in order - use this for state which is shared by all packets.
+struct le_command_buffer_encoder_draw_queue_t {
+
+	struct Packet {
+		uint64_t sort_key;
+		size_t   first_cmd; // index of first command of this packet in sorted stream
+		size_t   cmd_count; // number of commands in this packet
+	};
+
+	std::vector<Packet> packets;
+	std::vector<Packet> packets_scratch; // scratch space for radix sort
+	std::vector<void*>  cmds;            // addresses of all commands in sorted stream, in order of recording
+
+	// State slots for commands which we emitted: a state command which is identical to
+	// the last command emitted for the same slot would not change any state, and may
+	// be dropped. Only ever a handful of elements, so we search linearly.
+	struct Slot {
+		uint64_t                 key;
+		le::CommandHeader const* cmd; // last command emitted for this slot, points into encoder's command stream
+	};
+
+	std::vector<Slot> slots;
+};
+
 struct le_command_buffer_encoder_o {
 	le_command_stream_t*                    mCommandStream;
 	le_allocator_o**                        ppAllocator      = nullptr; // allocator list is owned by backend, externally
+	uint32_t                                num_worker_threads = 0;     // renderer's number of worker threads: if 0, we only ever use the first allocator
 	le_pipeline_manager_o*                  pipelineManager  = nullptr; // non-owning: owned by backend.
 	le_staging_allocator_o*                 stagingAllocator = nullptr; // Borrowed from backend - used for larger, permanent resources, shared amongst encoders
 	le::Extent2D                            extent           = {};      // Renderpass extent, otherwise swapchain extent inferred via renderer, this may be queried by users of encoder.
 	std::vector<le_shader_binding_table_o*> shader_binding_tables;      // owning
+
+	le_command_buffer_encoder_shadow_state_t shadow;                                  // state as seen by backend after decoding all commands recorded so far
+	bool                                     should_eliminate_redundant_state = true; // drop commands which don't change shadow state
+	bool                                     should_merge_draws               = true; // merge consecutive draws which only differ in instance range
+
+	le_command_buffer_encoder_argument_data_cache_t argument_data_cache;                     // argument data uploaded by this encoder
+	bool                                            should_deduplicate_argument_data = true; // re-use uploads of identical argument data
+
+	// Last draw command, and command count just after it was recorded: if no other command
+	// was recorded since, a following draw may be merged into this one. We may keep pointers
+	// into the command stream, since commands never move once recorded.
+	le::CommandDraw*        last_draw           = nullptr;
+	le::CommandDrawIndexed* last_draw_indexed   = nullptr;
+	size_t                  last_draw_cmd_count = 0;
+
+	le_command_buffer_encoder_draw_queue_t draw_queue;               //
+	le_command_stream_t*                   main_stream       = nullptr; // while recording sorted draws: stream into which we emit sorted draws, otherwise nullptr
+	le_command_stream_t*                   sorted_stream     = nullptr; // non-owning: holds commands while recording sorted draws, owned by backend frame
+	bool                                   should_sort_draws = true;    // sort draw packets by key - if false, packets are emitted in order of recording
 };
 
 // ----------------------------------------------------------------------
 
-static le_command_buffer_encoder_o* cbe_create( le_allocator_o** allocator, le_command_stream_t* command_stream, le_pipeline_manager_o* pipelineManager, le_staging_allocator_o* stagingAllocator, le::Extent2D const* extent ) {
-	auto self              = new le_command_buffer_encoder_o;
-	self->ppAllocator      = allocator;
+static le_command_buffer_encoder_o* cbe_create( le_allocator_o** allocator, le_command_stream_t* command_stream, le_command_stream_t* scratch_command_stream, le_pipeline_manager_o* pipelineManager, le_staging_allocator_o* stagingAllocator, le::Extent2D const* extent, uint32_t num_worker_threads ) {
+	auto self                = new le_command_buffer_encoder_o;
+	self->ppAllocator        = allocator;
+	self->num_worker_threads = num_worker_threads;
 	self->mCommandStream   = command_stream;
+	self->sorted_stream    = scratch_command_stream;
 	self->pipelineManager  = pipelineManager;
 	self->stagingAllocator = stagingAllocator;
 	if ( extent ) {
 		self->extent = *extent;
 	}
+
+	LE_SETTING( bool, LE_SETTING_ENCODER_ELIMINATE_REDUNDANT_STATE, true );
+	LE_SETTING( bool, LE_SETTING_ENCODER_MERGE_INSTANCED_DRAWS, true );
+	LE_SETTING( bool, LE_SETTING_ENCODER_DEDUPLICATE_ARGUMENT_DATA, true );
+	LE_SETTING( bool, LE_SETTING_ENCODER_SORT_DRAWS, true );
+
+	self->should_eliminate_redundant_state = *LE_SETTING_ENCODER_ELIMINATE_REDUNDANT_STATE;
+	self->should_merge_draws               = *LE_SETTING_ENCODER_MERGE_INSTANCED_DRAWS;
+	self->should_deduplicate_argument_data = *LE_SETTING_ENCODER_DEDUPLICATE_ARGUMENT_DATA;
+	self->should_sort_draws                = *LE_SETTING_ENCODER_SORT_DRAWS;
+
 	return self;
 };
 
@@ -127,6 +291,14 @@ static void cbe_get_extent( le_command_buffer_encoder_o* self, le::Extent2D* ext
 
 static void cbe_set_line_width( le_command_buffer_encoder_o* self, float lineWidth ) {
 
+	if ( self->should_eliminate_redundant_state ) {
+		if ( self->shadow.has_line_width && self->shadow.line_width == lineWidth ) {
+			return;
+		}
+		self->shadow.has_line_width = true;
+		self->shadow.line_width     = lineWidth;
+	}
+
 	auto cmd        = self->mCommandStream->emplace_cmd<le::CommandSetLineWidth>(); // placement new into data array
 	cmd->info.width = lineWidth;
 }
@@ -174,8 +346,29 @@ static void cbe_draw( le_command_buffer_encoder_o* self,
                       uint32_t                     firstVertex,
                       uint32_t                     firstInstance ) {
 
+	if ( self->should_merge_draws &&
+	     self->last_draw &&
+	     self->last_draw_cmd_count == self->mCommandStream->cmd_count ) {
+
+		// No commands were recorded since the last draw - if this draw only continues
+		// the instance range of the last draw, we can extend the last draw instead.
+
+		auto& last = self->last_draw->info;
+
+		if ( last.vertexCount == vertexCount &&
+		     last.firstVertex == firstVertex &&
+		     last.firstInstance + last.instanceCount == firstInstance ) {
+			last.instanceCount += instanceCount;
+			return;
+		}
+	}
+
 	auto cmd  = self->mCommandStream->emplace_cmd<le::CommandDraw>(); // placement new!
 	cmd->info = { vertexCount, instanceCount, firstVertex, firstInstance };
+
+	self->last_draw           = cmd;
+	self->last_draw_indexed   = nullptr;
+	self->last_draw_cmd_count = self->mCommandStream->cmd_count;
 }
 
 // ----------------------------------------------------------------------
@@ -187,6 +380,24 @@ static void cbe_draw_indexed( le_command_buffer_encoder_o* self,
                               int32_t                      vertexOffset,
                               uint32_t                     firstInstance ) {
 
+	if ( self->should_merge_draws &&
+	     self->last_draw_indexed &&
+	     self->last_draw_cmd_count == self->mCommandStream->cmd_count ) {
+
+		// No commands were recorded since the last draw - if this draw only continues
+		// the instance range of the last draw, we can extend the last draw instead.
+
+		auto& last = self->last_draw_indexed->info;
+
+		if ( last.indexCount == indexCount &&
+		     last.firstIndex == firstIndex &&
+		     last.vertexOffset == vertexOffset &&
+		     last.firstInstance + last.instanceCount == firstInstance ) {
+			last.instanceCount += instanceCount;
+			return;
+		}
+	}
+
 	auto cmd  = self->mCommandStream->emplace_cmd<le::CommandDrawIndexed>();
 	cmd->info = {
 	    indexCount,
@@ -196,6 +407,10 @@ static void cbe_draw_indexed( le_command_buffer_encoder_o* self,
 	    firstInstance,
 	    0 // padding must be set to zero
 	};
+
+	self->last_draw           = nullptr;
+	self->last_draw_indexed   = cmd;
+	self->last_draw_cmd_count = self->mCommandStream->cmd_count;
 }
 
 // ----------------------------------------------------------------------
@@ -226,6 +441,19 @@ static void cbe_set_viewport( le_command_buffer_encoder_o* self,
                               const uint32_t               viewportCount,
                               const le::Viewport*          pViewports ) {
 
+	if ( self->should_eliminate_redundant_state ) {
+		auto& shadow = self->shadow;
+		if ( shadow.has_viewports &&
+		     shadow.first_viewport == firstViewport &&
+		     shadow.viewports.size() == viewportCount &&
+		     0 == memcmp( shadow.viewports.data(), pViewports, sizeof( le::Viewport ) * viewportCount ) ) {
+			return;
+		}
+		shadow.has_viewports  = true;
+		shadow.first_viewport = firstViewport;
+		shadow.viewports.assign( pViewports, pViewports + viewportCount );
+	}
+
 	size_t data_size = sizeof( le::Viewport ) * viewportCount;
 
 	auto cmd = self->mCommandStream->emplace_cmd<le::CommandSetViewport>( data_size ); // placement new!
@@ -262,6 +490,8 @@ static void cbe_set_viewport( le_command_buffer_encoder_o* self,
 // ----------------------------------------------------------------------
 // copy user data into command stream
 static void cbe_video_decoder_execute_callback( le_command_buffer_encoder_o* self, le::CommandVideoDecoderExecuteCallback::callback_fun_t* fun, void* user_data ) {
+	// Callback may record arbitrary commands - we can't make any assumptions about state after it returns.
+	self->shadow.forget_all();
 	auto cmd  = self->mCommandStream->emplace_cmd<le::CommandVideoDecoderExecuteCallback>(); // placement new!
 	cmd->info = { fun, user_data };
 }
@@ -273,6 +503,19 @@ static void cbe_set_scissor( le_command_buffer_encoder_o* self,
                              const uint32_t               scissorCount,
                              le::Rect2D const*            pScissors ) {
 
+	if ( self->should_eliminate_redundant_state ) {
+		auto& shadow = self->shadow;
+		if ( shadow.has_scissors &&
+		     shadow.first_scissor == firstScissor &&
+		     shadow.scissors.size() == scissorCount &&
+		     0 == memcmp( shadow.scissors.data(), pScissors, sizeof( le::Rect2D ) * scissorCount ) ) {
+			return;
+		}
+		shadow.has_scissors  = true;
+		shadow.first_scissor = firstScissor;
+		shadow.scissors.assign( pScissors, pScissors + scissorCount );
+	}
+
 	size_t data_size = sizeof( le::Rect2D ) * scissorCount;
 	auto   cmd       = self->mCommandStream->emplace_cmd<le::CommandSetScissor>( data_size ); // placement new!
 
@@ -348,7 +591,7 @@ static void cbe_set_vertex_data( le_command_buffer_encoder_o*
 	void*    memAddr      = nullptr;
 	uint64_t bufferOffset = 0;
 
-	le_allocator_o* allocator = fetch_allocator( self->ppAllocator );
+	le_allocator_o* allocator = fetch_allocator( self->ppAllocator, self->num_worker_threads );
 
 	le_buffer_resource_handle allocatorBufferId;
 	if ( le_allocator_linear_i.allocate( allocator, numBytes, &memAddr, &bufferOffset, &allocatorBufferId ) ) {
@@ -386,7 +629,7 @@ static void cbe_set_index_data( le_command_buffer_encoder_o*
 	void*    memAddr;
 	uint64_t bufferOffset = 0;
 
-	le_allocator_o*           allocator = fetch_allocator( self->ppAllocator );
+	le_allocator_o*           allocator = fetch_allocator( self->ppAllocator, self->num_worker_threads );
 	le_buffer_resource_handle allocatorBufferId;
 	// -- Allocate data on scratch buffer
 	if ( le_allocator_linear_i.allocate( allocator, numBytes, &memAddr, &bufferOffset, &allocatorBufferId ) ) {
@@ -410,7 +653,7 @@ static void cbe_set_index_data( le_command_buffer_encoder_o*
 
 // ----------------------------------------------------------------------
 
-static void cbe_bind_argument_buffer( le_command_buffer_encoder_o* self, le_buffer_resource_handle const bufferId, uint64_t argumentName, uint64_t offset, uint64_t range ) {
+static void encode_bind_argument_buffer( le_command_buffer_encoder_o* self, le_buffer_resource_handle const bufferId, uint64_t argumentName, uint64_t offset, uint64_t range ) {
 
 	auto cmd = self->mCommandStream->emplace_cmd<le::CommandBindArgumentBuffer>();
 
@@ -420,6 +663,25 @@ static void cbe_bind_argument_buffer( le_command_buffer_encoder_o* self, le_buff
 	cmd->info.range            = range;
 }
 
+// ----------------------------------------------------------------------
+
+static void cbe_bind_argument_buffer( le_command_buffer_encoder_o* self, le_buffer_resource_handle const bufferId, uint64_t argumentName, uint64_t offset, uint64_t range ) {
+
+	// Argument now points to a user-provided buffer - any data we shadowed
+	// for this argument is therefore no longer bound.
+
+	auto& arguments = self->shadow.arguments;
+
+	for ( auto it = arguments.begin(); it != arguments.end(); it++ ) {
+		if ( it->argument_name_id == argumentName ) {
+			arguments.erase( it );
+			break;
+		}
+	}
+
+	encode_bind_argument_buffer( self, bufferId, argumentName, offset, range );
+}
+
 // ----------------------------------------------------------------------
 static void cbe_set_argument_data( le_command_buffer_encoder_o* self,
                                    uint64_t                     argumentNameId, // hash id of argument name
@@ -433,10 +695,51 @@ static void cbe_set_argument_data( le_command_buffer_encoder_o* self,
 
 	// --------| invariant: there are some bytes to set
 
+	if ( self->should_eliminate_redundant_state ) {
+
+		// If this argument is already bound to identical data, there is nothing to do.
+
+		le_command_buffer_encoder_shadow_state_t::ArgumentData* argument = nullptr;
+
+		for ( auto& a : self->shadow.arguments ) {
+			if ( a.argument_name_id == argumentNameId ) {
+				argument = &a;
+				break;
+			}
+		}
+
+		if ( argument == nullptr ) {
+			argument = &self->shadow.arguments.emplace_back();
+
+			argument->argument_name_id = argumentNameId;
+		} else if ( argument->data.size() == numBytes &&
+		            0 == memcmp( argument->data.data(), data, numBytes ) ) {
+			return;
+		}
+
+		argument->data.assign( static_cast<uint8_t const*>( data ), static_cast<uint8_t const*>( data ) + numBytes );
+	}
+
+	uint64_t data_hash = 0;
+
+	if ( self->should_deduplicate_argument_data ) {
+
+		// If we have uploaded identical data before, we bind the earlier upload.
+
+		data_hash = SpookyHash::Hash64( data, numBytes, 0 );
+
+		auto upload = self->argument_data_cache.find( data_hash, data, numBytes );
+
+		if ( upload ) {
+			encode_bind_argument_buffer( self, upload->buffer, argumentNameId, upload->buffer_offset, upload->num_bytes );
+			return;
+		}
+	}
+
 	void*    memAddr;
 	uint64_t bufferOffset = 0;
 
-	le_allocator_o*           allocator = fetch_allocator( self->ppAllocator );
+	le_allocator_o*           allocator = fetch_allocator( self->ppAllocator, self->num_worker_threads );
 	le_buffer_resource_handle allocatorBuffer;
 	// -- Allocate memory on scratch buffer for ubo
 	//
@@ -447,11 +750,16 @@ static void cbe_set_argument_data( le_command_buffer_encoder_o* self,
 		// -- Store ubo data to scratch allocator
 		memcpy( memAddr, data, numBytes );
 
-		cbe_bind_argument_buffer( self, allocatorBuffer, argumentNameId, uint32_t( bufferOffset ), uint32_t( numBytes ) );
+		if ( self->should_deduplicate_argument_data ) {
+			self->argument_data_cache.insert( data_hash, data, numBytes, allocatorBuffer, bufferOffset );
+		}
+
+		encode_bind_argument_buffer( self, allocatorBuffer, argumentNameId, uint32_t( bufferOffset ), uint32_t( numBytes ) );
 
 	} else {
 		std::cerr << "ERROR " << __PRETTY_FUNCTION__ << " could not allocate " << numBytes << " Bytes." << std::endl
 		          << std::flush;
+		self->shadow.forget_arguments(); // nothing was bound, we must not assume that data is bound.
 		return;
 	}
 }
@@ -493,6 +801,17 @@ static void cbe_set_argument_tlas( le_command_buffer_encoder_o* self, le_tlas_re
 
 static void cbe_bind_graphics_pipeline( le_command_buffer_encoder_o* self, le_gpso_handle gpsoHandle ) {
 
+	if ( self->should_eliminate_redundant_state ) {
+		if ( self->shadow.gpso == gpsoHandle ) {
+			return;
+		}
+		self->shadow.gpso = gpsoHandle;
+		self->shadow.cpso = nullptr;
+	}
+
+	// Backend resets argument bindings when pipeline changes.
+	self->shadow.forget_arguments();
+
 	// -- insert graphics PSO pointer into command stream
 	auto cmd = self->mCommandStream->emplace_cmd<le::CommandBindGraphicsPipeline>();
 
@@ -503,6 +822,11 @@ static void cbe_bind_graphics_pipeline( le_command_buffer_encoder_o* self, le_gp
 
 static void cbe_bind_rtx_pipeline( le_command_buffer_encoder_o* self, le_shader_binding_table_o* sbt ) {
 
+	// Backend resets argument bindings when pipeline changes.
+	self->shadow.gpso = nullptr;
+	self->shadow.cpso = nullptr;
+	self->shadow.forget_arguments();
+
 	// -- insert rtx PSO pointer into command stream
 	auto cmd = self->mCommandStream->emplace_cmd<le::CommandBindRtxPipeline>();
 
@@ -620,7 +944,7 @@ static void cbe_bind_rtx_pipeline( le_command_buffer_encoder_o* self, le_shader_
 
 	// -- allocate buffer from scratch memory
 
-	le_allocator_o* allocator = fetch_allocator( self->ppAllocator );
+	le_allocator_o* allocator = fetch_allocator( self->ppAllocator, self->num_worker_threads );
 
 	void*    memAddr          = nullptr;
 	uint64_t bufferBaseOffset = 0;
@@ -698,6 +1022,17 @@ static void cbe_bind_rtx_pipeline( le_command_buffer_encoder_o* self, le_shader_
 
 static void cbe_bind_compute_pipeline( le_command_buffer_encoder_o* self, le_cpso_handle cpsoHandle ) {
 
+	if ( self->should_eliminate_redundant_state ) {
+		if ( self->shadow.cpso == cpsoHandle ) {
+			return;
+		}
+		self->shadow.cpso = cpsoHandle;
+		self->shadow.gpso = nullptr;
+	}
+
+	// Backend resets argument bindings when pipeline changes.
+	self->shadow.forget_arguments();
+
 	// -- insert compute PSO pointer into command stream
 	auto cmd = self->mCommandStream->emplace_cmd<le::CommandBindComputePipeline>();
 
@@ -931,7 +1266,7 @@ void cbe_build_rtx_tlas( le_command_buffer_encoder_o*      self,
 
 	size_t gpu_memory_bytes_required = sizeof( le_rtx_geometry_instance_t ) * instances_count;
 
-	le_allocator_o* allocator = fetch_allocator( self->ppAllocator );
+	le_allocator_o* allocator = fetch_allocator( self->ppAllocator, self->num_worker_threads );
 	uint64_t        offset    = 0;
 
 	using namespace le_backend_vk; // for le_allocator_linear_i
@@ -960,16 +1295,288 @@ void cbe_build_rtx_tlas( le_command_buffer_encoder_o*      self,
 	memcpy( memAddr, blas_handles, data_size );
 }
 
+// ----------------------------------------------------------------------
+// Start recording sorted draws: until `end_sorted_draws`, commands are held
+// back, and grouped into draw packets - see le_command_buffer_encoder_draw_queue_t.
+static void cbe_begin_sorted_draws( le_command_buffer_encoder_o* self ) {
+
+	if ( self->main_stream ) {
+		std::cerr << "ERROR " << __PRETTY_FUNCTION__ << " already recording sorted draws." << std::endl
+		          << std::flush;
+		return;
+	}
+
+	if ( self->sorted_stream == nullptr ) {
+		std::cerr << "ERROR " << __PRETTY_FUNCTION__ << " encoder has no scratch command stream to record sorted draws into." << std::endl
+		          << std::flush;
+		return;
+	}
+
+	self->sorted_stream->reset();
+	self->draw_queue.packets.clear();
+
+	self->main_stream    = self->mCommandStream;
+	self->mCommandStream = self->sorted_stream;
+
+	self->shadow.forget_all(); // we can't know which state the first packet will be emitted after
+	self->last_draw         = nullptr;
+	self->last_draw_indexed = nullptr;
+}
+
+// ----------------------------------------------------------------------
+// Starts a new draw packet - commands recorded from now on will be sorted by `sort_key`.
+static void cbe_set_draw_sort_key( le_command_buffer_encoder_o* self, uint64_t sort_key ) {
+
+	if ( self->main_stream == nullptr ) {
+		std::cerr << "ERROR " << __PRETTY_FUNCTION__ << " not recording sorted draws - call begin_sorted_draws first." << std::endl
+		          << std::flush;
+		return;
+	}
+
+	self->draw_queue.packets.push_back( { sort_key, self->sorted_stream->cmd_count, 0 } );
+
+	// Each packet must set its own state, as it may end up anywhere in the
+	// sorted sequence - and draws must not be merged across packets.
+
+	self->shadow.forget_all();
+	self->last_draw         = nullptr;
+	self->last_draw_indexed = nullptr;
+}
+
+// ----------------------------------------------------------------------
+// Stable LSD radix sort, 8 bits per pass - we skip any pass for which all keys
+// have the same digit, which is common, as most keys share their upper bits.
+static void radix_sort_packets( std::vector<le_command_buffer_encoder_draw_queue_t::Packet>& packets,
+                                std::vector<le_command_buffer_encoder_draw_queue_t::Packet>& scratch ) {
+
+	size_t const num_packets = packets.size();
+
+	if ( num_packets < 2 ) {
+		return;
+	}
+
+	scratch.resize( num_packets );
+
+	for ( uint32_t shift = 0; shift != 64; shift += 8 ) {
+
+		size_t counts[ 256 ] = {};
+
+		for ( auto const& p : packets ) {
+			counts[ ( p.sort_key >> shift ) & 0xff ]++;
+		}
+
+		if ( counts[ ( packets[ 0 ].sort_key >> shift ) & 0xff ] == num_packets ) {
+			continue; // all keys have the same digit
+		}
+
+		size_t offset = 0;
+		for ( auto& c : counts ) {
+			size_t count = c;
+			c            = offset;
+			offset += count;
+		}
+
+		for ( auto const& p : packets ) {
+			scratch[ counts[ ( p.sort_key >> shift ) & 0xff ]++ ] = p;
+		}
+
+		std::swap( packets, scratch );
+	}
+}
+
+// ----------------------------------------------------------------------
+
+static constexpr uint64_t ARGUMENT_SLOT_TAG = 1ull << 63; // marks state slots which hold argument bindings
+
+// Returns state slot for argument `argument_name_id` at `array_index`. Arguments
+// share slots by name regardless of how they were bound, so that binding a buffer
+// invalidates an image which was bound to the same argument.
+static uint64_t draw_queue_get_argument_slot( uint64_t argument_name_id, uint32_t array_index ) {
+	return ARGUMENT_SLOT_TAG | hash_64_word_finalize( hash_64_word_mix( argument_name_id, array_index ) );
+}
+
+// Returns true if the vertex buffer bindings which `a` and `b` bind overlap -
+// both must be eBindVertexBuffers commands.
+static bool draw_queue_vertex_bindings_overlap( le::CommandHeader const* a, le::CommandHeader const* b ) {
+	auto const& info_a = reinterpret_cast<le::CommandBindVertexBuffers const*>( a )->info;
+	auto const& info_b = reinterpret_cast<le::CommandBindVertexBuffers const*>( b )->info;
+	return info_a.firstBinding < info_b.firstBinding + info_b.bindingCount &&
+	       info_b.firstBinding < info_a.firstBinding + info_a.bindingCount;
+}
+
+// ----------------------------------------------------------------------
+// Returns the state slot which `cmd` writes to, or 0 if `cmd` is not a state command
+// which we may drop. Commands which are identical to the last command emitted for
+// the same slot don't change any state.
+static uint64_t draw_queue_get_state_slot( le::CommandHeader const* cmd ) {
+
+	using namespace le;
+
+	switch ( cmd->info.type ) {
+	case CommandType::eBindGraphicsPipeline: // fall-through
+	case CommandType::eBindIndexBuffer:      // fall-through
+	case CommandType::eSetLineWidth:         // fall-through
+	case CommandType::eSetViewport:          // fall-through
+	case CommandType::eSetScissor:
+		return uint64_t( cmd->info.type ) + 1;
+	case CommandType::eBindVertexBuffers:
+		return ( uint64_t( reinterpret_cast<CommandBindVertexBuffers const*>( cmd )->info.firstBinding ) << 32 ) | ( uint64_t( cmd->info.type ) + 1 );
+	case CommandType::eBindArgumentBuffer:
+		return draw_queue_get_argument_slot( reinterpret_cast<CommandBindArgumentBuffer const*>( cmd )->info.argument_name_id, 0 );
+	case CommandType::eSetArgumentTexture: {
+		auto const& info = reinterpret_cast<CommandSetArgumentTexture const*>( cmd )->info;
+		return draw_queue_get_argument_slot( info.argument_name_id, info.array_index );
+	}
+	case CommandType::eSetArgumentImage: {
+		auto const& info = reinterpret_cast<CommandSetArgumentImage const*>( cmd )->info;
+		return draw_queue_get_argument_slot( info.argument_name_id, info.array_index );
+	}
+	default:
+		return 0;
+	}
+}
+
+// ----------------------------------------------------------------------
+// Copies `count` commands, starting at command index `first`, from the sorted
+// stream into the main stream - dropping any commands which would not change state.
+static void draw_queue_emit( le_command_buffer_encoder_o* self, size_t first, size_t count ) {
+
+	auto& queue = self->draw_queue;
+
+	for ( size_t i = first; i != first + count; i++ ) {
+
+		auto cmd = static_cast<le::CommandHeader const*>( queue.cmds[ i ] );
+
+		uint64_t slot_key = self->should_eliminate_redundant_state ? draw_queue_get_state_slot( cmd ) : 0;
+
+		le_command_buffer_encoder_draw_queue_t::Slot* slot = nullptr;
+
+		if ( slot_key ) {
+			for ( auto& s : queue.slots ) {
+				if ( s.key == slot_key ) {
+					slot = &s;
+					break;
+				}
+			}
+			if ( slot &&
+			     slot->cmd->info.size == cmd->info.size &&
+			     0 == memcmp( slot->cmd, cmd, cmd->info.size ) ) {
+				continue; // identical to what is already set
+			}
+		}
+
+		// --------| invariant: command must be emitted
+
+		auto dst = self->main_stream->emplace_cmd<le::CommandHeader>( cmd->info.size - sizeof( le::CommandHeader ) );
+		memcpy( dst, cmd, cmd->info.size );
+
+		auto forget_slots = [ & ]( auto const& predicate ) {
+			queue.slots.erase( std::remove_if( queue.slots.begin(), queue.slots.end(), predicate ), queue.slots.end() );
+		};
+
+		if ( cmd->info.type == le::CommandType::eBindGraphicsPipeline ) {
+			// Backend resets argument bindings when pipeline changes: forget all argument slots.
+			forget_slots( []( le_command_buffer_encoder_draw_queue_t::Slot const& s ) {
+				return s.key & ARGUMENT_SLOT_TAG;
+			} );
+		} else if ( cmd->info.type == le::CommandType::eBindVertexBuffers ) {
+			// Vertex buffer slots are keyed by first binding: forget any other slots
+			// which bind to any of the bindings which this command overwrites.
+			forget_slots( [ & ]( le_command_buffer_encoder_draw_queue_t::Slot const& s ) {
+				return s.key != slot_key &&
+				       s.cmd->info.type == le::CommandType::eBindVertexBuffers &&
+				       draw_queue_vertex_bindings_overlap( s.cmd, cmd );
+			} );
+		}
+
+		if ( slot_key ) {
+			slot = nullptr; // slot may have moved
+			for ( auto& s : queue.slots ) {
+				if ( s.key == slot_key ) {
+					slot = &s;
+					break;
+				}
+			}
+			if ( slot == nullptr ) {
+				slot      = &queue.slots.emplace_back();
+				slot->key = slot_key;
+			}
+			slot->cmd = dst;
+		}
+	}
+}
+
+// ----------------------------------------------------------------------
+// Sorts draw packets by key, and emits them into the encoder's command stream.
+static void cbe_end_sorted_draws( le_command_buffer_encoder_o* self ) {
+
+	if ( self->main_stream == nullptr ) {
+		return;
+	}
+
+	auto& queue = self->draw_queue;
+
+	// Gather command addresses, so that we can find packets by command index:
+	// commands in the sorted stream are not guaranteed to be contiguous.
+
+	queue.cmds.clear();
+	queue.cmds.reserve( self->sorted_stream->cmd_count );
+
+	le_command_stream_t::Block* block = nullptr;
+
+	for ( void* cmd = self->sorted_stream->begin_read( &block ); cmd != nullptr;
+	      cmd       = self->sorted_stream->next( &block, cmd, static_cast<le::CommandHeader*>( cmd )->info.size ) ) {
+		queue.cmds.push_back( cmd );
+	}
+
+	// Each packet ends where the next packet begins.
+
+	for ( size_t i = 0; i != queue.packets.size(); i++ ) {
+		size_t end                 = ( i + 1 != queue.packets.size() ) ? queue.packets[ i + 1 ].first_cmd : queue.cmds.size();
+		queue.packets[ i ].cmd_count = end - queue.packets[ i ].first_cmd;
+	}
+
+	size_t const prefix_cmd_count = queue.packets.empty() ? queue.cmds.size() : queue.packets[ 0 ].first_cmd;
+
+	if ( self->should_sort_draws ) {
+		radix_sort_packets( queue.packets, queue.packets_scratch );
+	}
+
+	queue.slots.clear(); // we don't know which state the main stream is in
+
+	draw_queue_emit( self, 0, prefix_cmd_count );
+
+	for ( auto const& p : queue.packets ) {
+		draw_queue_emit( self, p.first_cmd, p.cmd_count );
+	}
+
+	queue.packets.clear();
+	queue.cmds.clear();
+	queue.slots.clear();
+
+	self->mCommandStream = self->main_stream;
+	self->main_stream    = nullptr;
+
+	self->shadow.forget_all();
+	self->last_draw         = nullptr;
+	self->last_draw_indexed = nullptr;
+}
+
 // ----------------------------------------------------------------------
 
 static void cbe_get_encoded_data( le_command_buffer_encoder_o* self,
-                                  void**                       data,
+                                  le_command_stream_t**        commandStream,
                                   size_t*                      numBytes,
                                   size_t*                      numCommands ) {
 
-	*data        = self->mCommandStream->data;
-	*numBytes    = self->mCommandStream->size;
-	*numCommands = self->mCommandStream->cmd_count;
+	if ( self->main_stream ) {
+		// Sorted draws were never ended - emit them now, so that they don't get lost.
+		cbe_end_sorted_draws( self );
+	}
+
+	*commandStream = self->mCommandStream;
+	*numBytes      = self->mCommandStream->size;
+	*numCommands   = self->mCommandStream->cmd_count;
 }
 
 // ----------------------------------------------------------------------
@@ -1062,6 +1669,9 @@ void register_le_command_buffer_encoder_api( void* api_ ) {
 	    .set_index_data         = cbe_set_index_data,
 	    .set_vertex_data        = cbe_set_vertex_data,
 	    .get_extent             = cbe_get_extent,
+	    .begin_sorted_draws     = cbe_begin_sorted_draws,
+	    .set_draw_sort_key      = cbe_set_draw_sort_key,
+	    .end_sorted_draws       = cbe_end_sorted_draws,
 	};
 
 	cbe_compute_i = {
@@ -0,0 +1,640 @@
+#include "le_core.h"
+#include "le_renderer.h"
+#include "le_backend_vk.h"
+#include "le_log.h"
+#include "le_tracy.h"
+
+#include <cstring>
+#include <cstdio>
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include <chrono>
+
+#include "private/le_renderer/le_resource_handle_t.inl"
+#include "private/le_renderer/le_rendergraph.h"
+#include "private/le_backend_vk/le_command_stream_t.h"
+#include "private/le_backend_vk/le_backend_frame_plan.h"
+
+static constexpr auto LOGGER_LABEL = "le_frame_capture";
+
+/*
+
+Frame capture
+
+	+ Serialises everything that the backend receives for a frame once the
+	renderer has recorded it: renderpasses (after the rendergraph was built),
+	declared resources, queue submission affinity masks, and encoded command
+	streams.
+
+	+ Replay reads a capture back, and runs backend frame planning on it for
+	a given number of iterations, so that frame planning may be measured
+	against a fixed frame, without running any app logic.
+
+Replay does not touch the GPU, and it does not translate commands: command
+payloads refer to pipelines, buffers, and textures via process-local handles,
+which are meaningless once the process which recorded them has exited.
+Replay times:
+
+	+ frame planning, via `vk_backend_i.plan_frame` (dry-run), and
+	+ a walk over the headers of all commands in all command streams - this
+	validates the streams, and counts commands, but it measures iteration
+	only, not the cost of translating commands into Vulkan calls.
+
+Replay is therefore no benchmark for command translation. Transient allocator
+contents (argument data, vertex, and index data) are not captured, as nothing
+would read them without a device.
+
+Resource handles which are referenced by renderpasses, and declared resources
+are re-interned by name on load. Texture sampler infos are not captured, as
+frame planning does not need them.
+
+*/
+
+static constexpr uint32_t LE_FRAME_CAPTURE_MAGIC   = 0x5043454c; // "LECP", little endian
+static constexpr uint32_t LE_FRAME_CAPTURE_VERSION = 2; // version 2: no longer stores transient allocator contents
+
+struct le_frame_capture_header_t {
+	uint32_t magic;
+	uint32_t version;
+	uint32_t sizeof_resource_info;   // must match sizeof( le_resource_info_t ), otherwise capture was made with an incompatible build
+	uint32_t sizeof_attachment_info; // must match sizeof( le_image_attachment_info_t )
+	uint64_t frame_number;
+};
+
+struct le_frame_capture_resource_t {
+	LeResourceType type;
+	uint8_t        num_samples;
+	uint8_t        flags;
+	uint16_t       index;
+	uint32_t       reference_index; // index into resource table for reference handle, or ~0u if none
+	char           debug_name[ 48 ];
+};
+
+struct le_frame_capture_pass_t {
+	char                debug_name[ 256 ];
+	le::QueueFlagBits   type;
+	uint32_t            is_root;
+	le::RootPassesField root_passes_affinity;
+	uint32_t            width;
+	uint32_t            height;
+	uint32_t            sample_count;
+	uint32_t            num_resources;
+	uint32_t            num_attachments;
+	uint32_t            num_commands;
+	uint64_t            num_command_bytes;
+};
+
+static constexpr uint32_t NO_RESOURCE_INDEX = ~0u;
+
+// ----------------------------------------------------------------------
+// Writing
+
+struct le_frame_capture_writer_t {
+	FILE* file;
+	bool  ok = true;
+
+	void write( void const* data, size_t num_bytes ) {
+		if ( ok && num_bytes ) {
+			ok = ( 1 == fwrite( data, num_bytes, 1, file ) );
+		}
+	}
+
+	template <typename T>
+	void write( T const& value ) {
+		write( &value, sizeof( T ) );
+	}
+};
+
+// ----------------------------------------------------------------------
+// Adds resource to resource table, if it is not yet in there, and returns
+// its index into the table. Reference handles are added before the handle
+// which refers to them, so that we can resolve them in order on load.
+static uint32_t capture_intern_resource( std::vector<le_frame_capture_resource_t>&            table,
+                                         std::unordered_map<le_resource_handle, uint32_t>& index_of,
+                                         le_resource_handle                                  resource ) {
+
+	if ( resource == nullptr ) {
+		return NO_RESOURCE_INDEX;
+	}
+
+	auto it = index_of.find( resource );
+
+	if ( it != index_of.end() ) {
+		return it->second;
+	}
+
+	// --------| invariant: resource is not yet in table
+
+	le_resource_handle_data_t const* data = resource->data;
+
+	uint32_t reference_index = capture_intern_resource( table, index_of, data->reference_handle );
+
+	le_frame_capture_resource_t entry{};
+	entry.type            = data->type;
+	entry.num_samples     = data->num_samples;
+	entry.flags           = data->flags;
+	entry.index           = data->index;
+	entry.reference_index = reference_index;
+	memcpy( entry.debug_name, data->debug_name, sizeof( entry.debug_name ) );
+
+	uint32_t index = uint32_t( table.size() );
+	table.push_back( entry );
+	index_of[ resource ] = index;
+
+	return index;
+}
+
+// ----------------------------------------------------------------------
+// Writes the current state of a recorded frame to a file at `path`.
+//
+// Must be called once the frame has been recorded, but before the backend
+// acquires physical resources for it - at this point renderpasses still own
+// their encoders (and, through them, their command streams).
+static bool frame_capture_write( le_rendergraph_o* rendergraph, size_t frameNumber, char const* path ) {
+
+	ZoneScoped;
+	using namespace le_renderer;
+
+	static auto logger = LeLog( LOGGER_LABEL );
+
+	// -- Build resource table from all resources which are referenced by
+	// renderpasses, or declared resources.
+
+	std::vector<le_frame_capture_resource_t>         resources;
+	std::unordered_map<le_resource_handle, uint32_t> resource_index;
+
+	for ( auto const& r : rendergraph->declared_resources_id ) {
+		capture_intern_resource( resources, resource_index, r );
+	}
+
+	for ( auto const& p : rendergraph->passes ) {
+		for ( auto const& r : p->resources ) {
+			capture_intern_resource( resources, resource_index, r );
+		}
+		for ( auto const& r : p->attachmentResources ) {
+			capture_intern_resource( resources, resource_index, r );
+		}
+	}
+
+	FILE* file = fopen( path, "wb" );
+
+	if ( file == nullptr ) {
+		logger.error( "Could not open file for frame capture: '%s'", path );
+		return false;
+	}
+
+	le_frame_capture_writer_t w{ file };
+
+	le_frame_capture_header_t header{};
+	header.magic                  = LE_FRAME_CAPTURE_MAGIC;
+	header.version                = LE_FRAME_CAPTURE_VERSION;
+	header.sizeof_resource_info   = sizeof( le_resource_info_t );
+	header.sizeof_attachment_info = sizeof( le_image_attachment_info_t );
+	header.frame_number           = frameNumber;
+
+	w.write( header );
+
+	// -- Resource table
+
+	w.write( uint32_t( resources.size() ) );
+	w.write( resources.data(), sizeof( le_frame_capture_resource_t ) * resources.size() );
+
+	// -- Declared resources
+
+	w.write( uint32_t( rendergraph->declared_resources_id.size() ) );
+
+	for ( size_t i = 0; i != rendergraph->declared_resources_id.size(); i++ ) {
+		w.write( resource_index.at( rendergraph->declared_resources_id[ i ] ) );
+		w.write( rendergraph->declared_resources_info[ i ] );
+	}
+
+	// -- Queue submission affinity masks
+
+	w.write( uint32_t( rendergraph->root_passes_affinity_masks.size() ) );
+	w.write( rendergraph->root_passes_affinity_masks.data(), sizeof( le::RootPassesField ) * rendergraph->root_passes_affinity_masks.size() );
+
+	// -- Renderpasses, each followed by its resources, attachments, and command stream
+
+	w.write( uint32_t( rendergraph->passes.size() ) );
+
+	for ( auto const& p : rendergraph->passes ) {
+
+		le_command_stream_t* stream      = nullptr;
+		size_t               num_bytes   = 0;
+		size_t               num_command = 0;
+
+		if ( p->encoder ) {
+			encoder_i.get_encoded_data( p->encoder, &stream, &num_bytes, &num_command );
+		}
+
+		le_frame_capture_pass_t pass{};
+		memcpy( pass.debug_name, p->debugName, sizeof( pass.debug_name ) );
+		pass.type                 = p->type;
+		pass.is_root              = p->is_root;
+		pass.root_passes_affinity = p->root_passes_affinity;
+		pass.width                = p->width;
+		pass.height               = p->height;
+		pass.sample_count         = uint32_t( p->sample_count );
+		pass.num_resources        = uint32_t( p->resources.size() );
+		pass.num_attachments      = uint32_t( p->imageAttachments.size() );
+		pass.num_commands         = uint32_t( stream ? num_command : 0 );
+		pass.num_command_bytes    = stream ? num_bytes : 0;
+
+		w.write( pass );
+
+		for ( size_t i = 0; i != p->resources.size(); i++ ) {
+			w.write( resource_index.at( p->resources[ i ] ) );
+			w.write( p->resources_access_flags[ i ] );
+		}
+
+		for ( size_t i = 0; i != p->imageAttachments.size(); i++ ) {
+			w.write( resource_index.at( p->attachmentResources[ i ] ) );
+			w.write( p->imageAttachments[ i ] );
+		}
+
+		if ( stream == nullptr ) {
+			continue;
+		}
+
+		// Commands are written tightly packed, in order - block boundaries
+		// are not preserved, as they are an artifact of the recording process.
+
+		le_command_stream_t::Block* block = nullptr;
+
+		void* cmd = stream->begin_read( &block );
+
+		while ( cmd ) {
+			auto cmd_size = static_cast<le::CommandHeader const*>( cmd )->info.size;
+			w.write( cmd, cmd_size );
+			cmd = stream->next( &block, cmd, cmd_size );
+		}
+	}
+
+	fclose( file );
+
+	if ( !w.ok ) {
+		logger.error( "Could not write frame capture: '%s'", path );
+		return false;
+	}
+
+	logger.info( "Captured frame %zu to file: '%s'", frameNumber, path );
+
+	return true;
+}
+
+// ----------------------------------------------------------------------
+// Reading
+
+struct le_frame_capture_reader_t {
+	char const* pos;
+	char const* end;
+	bool        ok = true;
+
+	void read( void* data, size_t num_bytes ) {
+		if ( !ok || size_t( end - pos ) < num_bytes ) {
+			ok = false;
+			return;
+		}
+		memcpy( data, pos, num_bytes );
+		pos += num_bytes;
+	}
+
+	template <typename T>
+	T read() {
+		T value{};
+		read( &value, sizeof( T ) );
+		return value;
+	}
+};
+
+// A capture, as loaded from file - renderpasses are owned by the capture.
+struct le_frame_capture_o {
+	size_t                                frame_number = 0;
+	std::vector<le_resource_handle>       declared_resources_id;
+	std::vector<le_resource_info_t>       declared_resources_info;
+	std::vector<le::RootPassesField>      root_passes_affinity_masks;
+	std::vector<le_renderpass_o*>         passes;
+	std::vector<le_command_stream_t*>     command_streams; // one per pass
+
+	~le_frame_capture_o() {
+		using namespace le_renderer;
+		for ( auto& p : passes ) {
+			renderpass_i.destroy( p );
+		}
+		for ( auto& s : command_streams ) {
+			delete s;
+		}
+	}
+};
+
+// ----------------------------------------------------------------------
+
+static le_resource_handle capture_produce_resource_handle( le_frame_capture_resource_t const& r, le_resource_handle reference_handle ) {
+	using namespace le_renderer;
+	switch ( r.type ) {
+	case LeResourceType::eBuffer:
+		return renderer_i.produce_buf_resource_handle( r.debug_name, r.flags, r.index );
+	case LeResourceType::eImage:
+		return renderer_i.produce_img_resource_handle( r.debug_name, r.num_samples, static_cast<le_image_resource_handle>( reference_handle ), r.flags );
+	case LeResourceType::eRtxTlas:
+		return renderer_i.produce_tlas_resource_handle( r.debug_name );
+	case LeResourceType::eRtxBlas:
+		return renderer_i.produce_blas_resource_handle( r.debug_name );
+	default:
+		return nullptr;
+	}
+}
+
+// ----------------------------------------------------------------------
+
+static bool frame_capture_load( le_frame_capture_o* self, char const* path ) {
+
+	ZoneScoped;
+	using namespace le_renderer;
+
+	static auto logger = LeLog( LOGGER_LABEL );
+
+	std::vector<char> bytes;
+
+	{
+		FILE* file = fopen( path, "rb" );
+
+		if ( file == nullptr ) {
+			logger.error( "Could not open frame capture: '%s'", path );
+			return false;
+		}
+
+		fseek( file, 0, SEEK_END );
+		long num_bytes = ftell( file );
+		fseek( file, 0, SEEK_SET );
+
+		bytes.resize( num_bytes > 0 ? size_t( num_bytes ) : 0 );
+
+		bool read_ok = bytes.empty() || 1 == fread( bytes.data(), bytes.size(), 1, file );
+		fclose( file );
+
+		if ( !read_ok ) {
+			logger.error( "Could not read frame capture: '%s'", path );
+			return false;
+		}
+	}
+
+	le_frame_capture_reader_t r{ bytes.data(), bytes.data() + bytes.size() };
+
+	auto header = r.read<le_frame_capture_header_t>();
+
+	if ( !r.ok ||
+	     header.magic != LE_FRAME_CAPTURE_MAGIC ||
+	     header.version != LE_FRAME_CAPTURE_VERSION ||
+	     header.sizeof_resource_info != sizeof( le_resource_info_t ) ||
+	     header.sizeof_attachment_info != sizeof( le_image_attachment_info_t ) ) {
+		logger.error( "File is not a frame capture, or was captured with an incompatible version: '%s'", path );
+		return false;
+	}
+
+	self->frame_number = header.frame_number;
+
+	// -- Resource table: re-intern resource handles
+
+	uint32_t num_resources = r.read<uint32_t>();
+
+	if ( size_t( r.end - r.pos ) < sizeof( le_frame_capture_resource_t ) * num_resources ) {
+		logger.error( "Frame capture is truncated, or corrupt: '%s'", path );
+		return false;
+	}
+
+	std::vector<le_resource_handle> resources( num_resources );
+
+	for ( auto& handle : resources ) {
+		auto entry = r.read<le_frame_capture_resource_t>();
+		entry.debug_name[ sizeof( entry.debug_name ) - 1 ] = '\0';
+
+		le_resource_handle reference_handle = nullptr;
+
+		if ( entry.reference_index != NO_RESOURCE_INDEX ) {
+			if ( entry.reference_index >= size_t( &handle - resources.data() ) ) {
+				r.ok = false; // reference must point to an earlier entry
+				break;
+			}
+			reference_handle = resources[ entry.reference_index ];
+		}
+
+		handle = capture_produce_resource_handle( entry, reference_handle );
+	}
+
+	auto resource_at = [ & ]( uint32_t index ) -> le_resource_handle {
+		if ( index >= resources.size() ) {
+			r.ok = false;
+			return nullptr;
+		}
+		return resources[ index ];
+	};
+
+	// -- Declared resources
+
+	uint32_t num_declared_resources = r.read<uint32_t>();
+
+	for ( uint32_t i = 0; i != num_declared_resources && r.ok; i++ ) {
+		self->declared_resources_id.push_back( resource_at( r.read<uint32_t>() ) );
+		self->declared_resources_info.push_back( r.read<le_resource_info_t>() );
+	}
+
+	// -- Queue submission affinity masks
+
+	self->root_passes_affinity_masks.resize( r.read<uint32_t>() );
+	r.read( self->root_passes_affinity_masks.data(), sizeof( le::RootPassesField ) * self->root_passes_affinity_masks.size() );
+
+	// -- Renderpasses
+
+	uint32_t num_passes = r.read<uint32_t>();
+
+	for ( uint32_t i = 0; i != num_passes && r.ok; i++ ) {
+
+		auto pass_info = r.read<le_frame_capture_pass_t>();
+		pass_info.debug_name[ sizeof( pass_info.debug_name ) - 1 ] = '\0';
+
+		le_renderpass_o* pass = renderpass_i.create( pass_info.debug_name, pass_info.type );
+
+		pass->is_root              = pass_info.is_root;
+		pass->root_passes_affinity = pass_info.root_passes_affinity;
+		pass->width                = pass_info.width;
+		pass->height               = pass_info.height;
+		pass->sample_count         = le::SampleCountFlagBits( pass_info.sample_count );
+
+		self->passes.push_back( pass );
+
+		for ( uint32_t j = 0; j != pass_info.num_resources && r.ok; j++ ) {
+			pass->resources.push_back( resource_at( r.read<uint32_t>() ) );
+			pass->resources_access_flags.push_back( r.read<le::AccessFlags2>() );
+		}
+
+		for ( uint32_t j = 0; j != pass_info.num_attachments && r.ok; j++ ) {
+			pass->attachmentResources.push_back( static_cast<le_image_resource_handle>( resource_at( r.read<uint32_t>() ) ) );
+			pass->imageAttachments.push_back( r.read<le_image_attachment_info_t>() );
+		}
+
+		// Re-record commands into a command stream of their own, so that
+		// we walk through the same data structure as the backend does.
+
+		auto stream = new le_command_stream_t();
+		self->command_streams.push_back( stream );
+
+		stream->reserve( pass_info.num_command_bytes );
+
+		char const* cmd_end = r.pos + pass_info.num_command_bytes;
+
+		if ( size_t( r.end - r.pos ) < pass_info.num_command_bytes ) {
+			r.ok = false;
+			break;
+		}
+
+		for ( uint32_t c = 0; c != pass_info.num_commands; c++ ) {
+
+			if ( size_t( cmd_end - r.pos ) < sizeof( le::CommandHeader ) ) {
+				r.ok = false;
+				break;
+			}
+
+			le::CommandHeader cmd_header{};
+			memcpy( &cmd_header, r.pos, sizeof( cmd_header ) );
+
+			if ( cmd_header.info.size < sizeof( cmd_header ) ||
+			     size_t( cmd_end - r.pos ) < cmd_header.info.size ) {
+				r.ok = false;
+				break;
+			}
+
+			auto cmd = stream->emplace_cmd<le::CommandHeader>( cmd_header.info.size - sizeof( le::CommandHeader ) );
+			memcpy( cmd, r.pos, cmd_header.info.size );
+
+			r.pos += cmd_header.info.size;
+		}
+
+		if ( r.pos != cmd_end ) {
+			r.ok = false;
+		}
+	}
+
+	if ( !r.ok ) {
+		logger.error( "Frame capture is truncated, or corrupt: '%s'", path );
+		return false;
+	}
+
+	return true;
+}
+
+// ----------------------------------------------------------------------
+// Walks over the headers of all commands in a command stream - command payloads
+// are not looked at. Returns false if the stream contains an invalid header.
+static bool frame_capture_walk_command_stream( le_command_stream_t const* stream, size_t* num_commands, size_t* num_bytes, size_t* checksum ) {
+
+	le_command_stream_t::Block* block = nullptr;
+
+	void* cmd = stream->begin_read( &block );
+
+	while ( cmd ) {
+
+		auto header = static_cast<le::CommandHeader const*>( cmd );
+
+		if ( header->info.size < sizeof( le::CommandHeader ) ||
+		     uint32_t( header->info.type ) > uint32_t( le::CommandType::eVideoDecoderExecuteCallback ) ) {
+			return false;
+		}
+
+		// Fold command type into a checksum, so that the compiler can't
+		// optimise away the walk.
+		*checksum = ( *checksum ^ uint32_t( header->info.type ) ) * 0x100000001b3ull;
+
+		( *num_commands )++;
+		( *num_bytes ) += header->info.size;
+
+		cmd = stream->next( &block, cmd, header->info.size );
+	}
+
+	return true;
+}
+
+// ----------------------------------------------------------------------
+// Loads a frame capture from `path`, and replays it `num_iterations` times.
+//
+// Backend does not need to have been set up for this.
+static bool frame_capture_replay( le_backend_o* backend, char const* path, uint32_t num_iterations, le_frame_replay_stats_t* stats ) {
+
+	ZoneScoped;
+	using namespace le_backend_vk;
+
+	static auto logger = LeLog( LOGGER_LABEL );
+
+	le_frame_capture_o capture;
+
+	if ( !frame_capture_load( &capture, path ) ) {
+		return false;
+	}
+
+	*stats                = {};
+	stats->num_iterations = num_iterations;
+	stats->num_passes     = capture.passes.size();
+
+	using clock = std::chrono::high_resolution_clock;
+
+	le_backend_frame_plan_t plan;
+
+	size_t checksum = 0;
+
+	for ( uint32_t i = 0; i != num_iterations; i++ ) {
+
+		// -- Plan frame (dry-run)
+
+		auto t_plan_start = clock::now();
+
+		bool plan_ok = vk_backend_i.plan_frame(
+		    backend,
+		    capture.passes.data(), capture.passes.size(),
+		    capture.declared_resources_id.data(), capture.declared_resources_info.data(), capture.declared_resources_id.size(),
+		    capture.root_passes_affinity_masks.data(), uint32_t( capture.root_passes_affinity_masks.size() ),
+		    &plan );
+
+		auto t_plan_end = clock::now();
+
+		if ( !plan_ok ) {
+			logger.error( "Could not plan frame from capture: '%s'", path );
+			return false;
+		}
+
+		// -- Walk command streams
+
+		size_t num_commands = 0;
+		size_t num_bytes    = 0;
+
+		for ( auto const& stream : capture.command_streams ) {
+			if ( !frame_capture_walk_command_stream( stream, &num_commands, &num_bytes, &checksum ) ) {
+				logger.error( "Invalid command stream in capture: '%s'", path );
+				return false;
+			}
+		}
+
+		auto t_walk_end = clock::now();
+
+		stats->plan_frame_ms += std::chrono::duration<double, std::milli>( t_plan_end - t_plan_start ).count();
+		stats->walk_commands_ms += std::chrono::duration<double, std::milli>( t_walk_end - t_plan_end ).count();
+
+		stats->num_commands      = num_commands;
+		stats->num_command_bytes = num_bytes;
+	}
+
+	logger.info( "Replayed frame %zu from '%s' %u times: %zu passes, %zu commands (%zu bytes), checksum: %zx",
+	             capture.frame_number, path, num_iterations, stats->num_passes, stats->num_commands, stats->num_command_bytes, checksum );
+
+	return true;
+}
+
+// ----------------------------------------------------------------------
+
+void register_le_frame_capture_api( void* api_ ) {
+	auto  le_renderer_api_i = static_cast<le_renderer_api*>( api_ );
+	auto& frame_capture_i   = le_renderer_api_i->le_frame_capture_i;
+
+	frame_capture_i.write  = frame_capture_write;
+	frame_capture_i.replay = frame_capture_replay;
+}
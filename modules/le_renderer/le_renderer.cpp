@@ -20,6 +20,7 @@
 
 #include "private/le_renderer/le_resource_handle_t.inl"
 #include "private/le_renderer/le_rendergraph.h"
+#include "private/le_renderer/le_intern_table.h"
 
 #include "le_tracy.h"
 
@@ -29,10 +30,6 @@ using NanoTime = std::chrono::time_point<std::chrono::high_resolution_clock>;
 
 #include "le_jobs.h"
 
-#ifndef LE_MT
-#	define LE_MT 0
-#endif
-
 // ----------------------------------------------------------------------
 // ffdecl.
 static le_swapchain_handle renderer_add_swapchain( le_renderer_o* self, le_swapchain_settings_t const* settings );
@@ -60,18 +57,21 @@ struct FrameData {
 };
 
 struct le_texture_handle_t {
-	std::string debug_name;
+	char const* debug_name; // interned via le_core, nullptr if unnamed
 };
 
-struct le_texture_handle_store_t {
-	std::unordered_multimap<std::string, le_texture_handle_t> texture_handles;
-	std::mutex                                                mtx;
+// A resource handle points to the `handle` field of an entry - handle and
+// handle data are allocated together.
+struct le_resource_handle_entry_t {
+	le_resource_handle_t      handle;
+	le_resource_handle_data_t data;
 };
 
-struct le_resource_handle_store_t {
-	std::unordered_multimap<le_resource_handle_data_t, le_resource_handle_t, le_resource_handle_data_hash> resource_handles;
-	std::mutex                                                                                             mtx;
-};
+// Textures are looked up via hash_64_word(name).
+struct le_texture_handle_store_t : le_intern_table_t<le_texture_handle_t> {};
+
+// Resources are looked up via le_resource_handle_data_hash(data).
+struct le_resource_handle_store_t : le_intern_table_t<le_resource_handle_entry_t> {};
 
 static le_texture_handle_store_t* get_texture_handle_library( bool erase = false ) {
 
@@ -140,6 +140,8 @@ struct le_renderer_o {
 	// uint64_t      swapchainDirty = false;
 	le_backend_o* backend        = nullptr; // Owned, created in setup
 
+	le_retained_buffer_pool_o* retained_buffer_pool = nullptr; // Owned, created in create
+
 	std::vector<FrameData> frames;
 	size_t                 backendDataFramesCount = 0;
 	size_t                 currentFrameNumber = size_t( ~0 ); // ever increasing number of current frame
@@ -153,57 +155,52 @@ static void renderer_clear_frame( le_renderer_o* self, size_t frameIndex ); // f
 static le_renderer_o* renderer_create() {
 	auto obj = new le_renderer_o();
 
-	if ( LE_MT > 0 ) {
-		le_jobs::initialize( LE_MT );
-	}
-
 	using namespace le_backend_vk;
 	obj->backend = vk_backend_i.create();
 
+	obj->retained_buffer_pool = le_renderer::retained_buffer_pool_i.create();
+
 	return obj;
 }
 
 // ----------------------------------------------------------------------
 
 // creates a new handle if no name was given, or given name was not found in list of current handles.
+//
+// Lock-free if a handle with this name already exists.
 static le_texture_handle renderer_produce_texture_handle( char const* maybe_name ) {
 
-	// lock handle library for reading/writing
 	static le_texture_handle_store_t* texture_handle_library = get_texture_handle_library();
-	std::scoped_lock                  lock( texture_handle_library->mtx );
-
-	le_texture_handle handle;
-
-	if ( maybe_name ) {
-		// if a string was given, search for multimap and see if we can find something.
-		auto it = texture_handle_library->texture_handles.find( maybe_name );
-		if ( it == texture_handle_library->texture_handles.end() ) {
-			// not found, insert a new element
-			handle = &texture_handle_library->texture_handles.emplace( maybe_name, le_texture_handle_t( { maybe_name } ) )->second;
-		} else {
-			// found, return a pointer to the found element
-			handle = &it->second;
-		}
-	} else {
+
+	if ( maybe_name == nullptr ) {
 		// no name given: handle is set to address of newly inserted element
-		// As this is a multimap, there can be any number of textures with the same
-		// key "unnamed" in the map.
-		handle = &texture_handle_library->texture_handles.emplace( "unnamed", le_texture_handle_t{} )->second;
+		return texture_handle_library->insert_anonymous( []( le_texture_handle_t& ) {} );
 	}
 
-	// handle is a pointer to the element in the container, and as such it is
-	// guaranteed to stay valid, even through rehashes of the texture_handles
-	// container, because that's a guarantee that maps give us in c++, until
-	// the element gets erased.
+	// ----------| invariant: name was given
+
+	uint64_t name_hash = hash_64_word( maybe_name );
+
+	// Textures are identified by their name - we compare names so that two
+	// names which share a hash don't end up sharing a handle.
+	return texture_handle_library->find_or_insert(
+	    name_hash,
+	    [ & ]( le_texture_handle_t const& entry ) { return entry.debug_name && 0 == strcmp( entry.debug_name, maybe_name ); },
+	    [ & ]( le_texture_handle_t& entry ) {
+		    // We only intern the name once we know that we need a new handle.
+		    entry.debug_name = le_core_intern_string( maybe_name, 0 ); // interned strings are keyed by hash_64_fnv1a, not by our lookup hash
+	    } );
 
-	return handle;
+	// handle is a pointer to an entry in the library, and as such it is
+	// guaranteed to stay valid, as entries never move, and never get
+	// removed until the library gets destroyed.
 }
 
 // ----------------------------------------------------------------------
 
 static char const* texture_handle_get_name( le_texture_handle texture ) {
-	if ( texture && !texture->debug_name.empty() ) {
-		return texture->debug_name.c_str();
+	if ( texture && texture->debug_name ) {
+		return texture->debug_name;
 	} else {
 		return nullptr;
 	}
@@ -219,46 +216,49 @@ le_resource_handle renderer_produce_resource_handle(
     le_resource_handle    reference_handle = nullptr ) {
 
 	static le_resource_handle_store_t* resource_handle_library = get_resource_handle_library();
-	// lock handle library for reading/writing
-	std::scoped_lock lock( resource_handle_library->mtx );
-
-	le_resource_handle handle;
-
-	le_resource_handle_data_t* p_data = new le_resource_handle_data_t{};
-	p_data->flags                     = flags;
-	p_data->num_samples               = num_samples;
-	p_data->reference_handle          = reference_handle;
-	p_data->type                      = resource_type;
-	p_data->index                     = index;
-
-	if ( maybe_name && maybe_name[ 0 ] != '\0' ) {
-		memcpy( p_data->debug_name, maybe_name, sizeof( p_data->debug_name ) );
-		// if a string was given, search for multimap and see if we can find something.
-		auto it = resource_handle_library->resource_handles.find( *p_data );
-		if ( it == resource_handle_library->resource_handles.end() ) {
-			// not found, insert a new element
-			handle = &resource_handle_library->resource_handles.emplace( *p_data, le_resource_handle_t{ p_data } )->second;
-		} else {
-			// found, return a pointer to the found element
-			handle = &it->second;
-			delete ( p_data );
-		}
-	} else {
-		// no name given: handle is set to address of newly inserted element
-		// As this is a multimap, there can be any number of textures with the same
-		// key "unnamed" in the map.
-		handle = &resource_handle_library->resource_handles.emplace( *p_data, le_resource_handle_t{ p_data } )->second;
+
+	auto init_entry = [ & ]( le_resource_handle_entry_t& entry ) {
+		entry.data.flags            = flags;
+		entry.data.num_samples      = num_samples;
+		entry.data.reference_handle = reference_handle;
+		entry.data.type             = resource_type;
+		entry.data.index            = index;
+		entry.handle.data           = &entry.data;
+	};
+
+	if ( maybe_name == nullptr || maybe_name[ 0 ] == '\0' ) {
+		// no name given: handle is set to address of newly inserted element, and
 		// we tag the element with a debug name that contains the handle so that
 		// the debug name is unique.
-		sprintf( handle->data->debug_name, "[%p]", handle );
+		le_resource_handle_entry_t* entry = resource_handle_library->insert_anonymous( [ & ]( le_resource_handle_entry_t& entry ) {
+			init_entry( entry );
+			snprintf( entry.data.debug_name, sizeof( entry.data.debug_name ), "[%p]", &entry.handle );
+		} );
+		return &entry->handle;
 	}
 
-	// handle is a pointer to the element in the container, and as such it is
-	// guaranteed to stay valid, even through rehashes of the resource_handle_library
-	// container, because that's a guarantee that maps give us in c++, until
-	// the element gets erased.
+	// ----------| invariant: name was given
+
+	// Build lookup key on the stack - we only allocate if we need a new handle.
+	le_resource_handle_entry_t key;
+	init_entry( key );
+	strncpy( key.data.debug_name, maybe_name, sizeof( key.data.debug_name ) - 1 );
 
-	return handle;
+	uint64_t hash = le_resource_handle_data_hash()( key.data );
+
+	le_resource_handle_entry_t* entry = resource_handle_library->find_or_insert(
+	    hash,
+	    [ & ]( le_resource_handle_entry_t const& entry ) { return entry.data == key.data; },
+	    [ & ]( le_resource_handle_entry_t& entry ) {
+		    init_entry( entry );
+		    memcpy( entry.data.debug_name, key.data.debug_name, sizeof( entry.data.debug_name ) );
+	    } );
+
+	// handle is a pointer to an entry in the library, and as such it is
+	// guaranteed to stay valid, as entries never move, and never get
+	// removed until the library gets destroyed.
+
+	return &entry->handle;
 }
 
 // ----------------------------------------------------------------------
@@ -305,19 +305,19 @@ static void renderer_destroy( le_renderer_o* self ) {
 
 	self->frames.clear();
 
+	if ( self->retained_buffer_pool ) {
+		// All frames have been cleared by now, which means that any deferred
+		// frees have been reclaimed.
+		retained_buffer_pool_i.destroy( self->retained_buffer_pool );
+		self->retained_buffer_pool = nullptr;
+	}
+
 	// Delete texture handle library
 	get_texture_handle_library( false );
 
 	{
-		le_resource_handle_store_t* resource_handle_library = get_resource_handle_library();
-		if ( resource_handle_library ) {
-			// we must deallocate manually allocated data for resource handles
-			for ( auto& e : resource_handle_library->resource_handles ) {
-				delete ( e.second.data );
-			}
-			// Delete static pointer to resource handle library
-			get_resource_handle_library( true );
-		}
+		// Delete resource handle library - this also deletes all resource handles
+		get_resource_handle_library( true );
 	}
 
 	if ( self->backend ) {
@@ -327,15 +327,21 @@ static void renderer_destroy( le_renderer_o* self ) {
 		self->backend = nullptr;
 	}
 
-#if ( LE_MT > 0 )
-	le_jobs::terminate();
-#endif
+	if ( self->settings.num_worker_threads > 0 ) {
+		le_jobs::terminate();
+	}
 
 	delete self;
 }
 
 // ----------------------------------------------------------------------
 
+static le_retained_buffer_pool_o* renderer_get_retained_buffer_pool( le_renderer_o* self ) {
+	return self->retained_buffer_pool;
+}
+
+// ----------------------------------------------------------------------
+
 static le_rtx_blas_info_handle renderer_create_rtx_blas_info_handle( le_renderer_o* self, le_rtx_geometry_t* geometries, uint32_t geometries_count, le::BuildAccelerationStructureFlagsKHR const* flags ) {
 	using namespace le_backend_vk;
 	return vk_backend_i.create_rtx_blas_info( self->backend, geometries, geometries_count, flags );
@@ -382,6 +388,8 @@ static bool renderer_request_swapchain_capabilities( le_renderer_o* self, le_swa
 
 static void renderer_setup( le_renderer_o* self, le_renderer_settings_t const* settings ) {
 
+	static auto logger = LeLog( "le_renderer" );
+
 	// We store swapchain settings with the renderer so that we can pass
 	// backend a permanent pointer to it.
 
@@ -392,9 +400,27 @@ static void renderer_setup( le_renderer_o* self, le_renderer_settings_t const* s
 
 		renderer_request_swapchain_capabilities( self, self->settings.swapchain_settings, self->settings.num_swapchain_settings );
 
-#if ( LE_MT > 0 )
-		le_backend_vk::settings_i.set_concurrency_count( LE_MT );
-#endif
+		if ( self->settings.num_worker_threads > 0 ) {
+			// Backend must provide one transient allocator per worker thread
+			le_backend_vk::settings_i.set_concurrency_count( self->settings.num_worker_threads );
+		}
+
+		if ( self->settings.num_worker_threads > 0 && self->settings.pipeline_depth < 3 ) {
+			// With worker threads, we record, process and clear frames concurrently,
+			// and each of these steps must work on a frame of its own.
+			if ( self->settings.pipeline_depth > 0 ) {
+				logger.warn( "Pipeline depth must be at least 3 when using worker threads, was: %d. Using pipeline depth of 3.", self->settings.pipeline_depth );
+			}
+			self->settings.pipeline_depth = 3;
+		}
+
+		if ( self->settings.pipeline_depth > 0 ) {
+			if ( self->settings.pipeline_depth < 2 ) {
+				logger.warn( "Pipeline depth must be at least 2, was: %d. Using pipeline depth of 2.", self->settings.pipeline_depth );
+				self->settings.pipeline_depth = 2;
+			}
+			le_backend_vk::settings_i.set_data_frames_count( self->settings.pipeline_depth );
+		}
 
 		// We can now initialize the backend so that it hopefully conforms to
 		// any requirements and capabilities that have been requested so far...
@@ -437,7 +463,16 @@ static void renderer_setup( le_renderer_o* self, le_renderer_settings_t const* s
 
 	self->currentFrameNumber = 0;
 
+	if ( self->settings.num_worker_threads > 0 && self->backendDataFramesCount < 3 ) {
+		// A swapchain may have limited the number of data frames - we can't
+		// record, process and clear frames concurrently with fewer than three.
+		logger.warn( "Only %zu data frames available, but worker threads need at least 3. Rendering on the main thread.", self->backendDataFramesCount );
+		self->settings.num_worker_threads = 0;
+	}
 
+	if ( self->settings.num_worker_threads > 0 ) {
+		le_jobs::initialize( self->settings.num_worker_threads );
+	}
 }
 // ----------------------------------------------------------------------
 
@@ -467,9 +502,10 @@ static void renderer_clear_frame( le_renderer_o* self, size_t frameIndex ) {
 
 		while ( false == vk_backend_i.poll_frame_fence( self->backend, frameIndex ) ) {
 			// Note: this call may block until the fence has been reached.
-#if ( LE_MT > 0 )
-			le_jobs::yield();
-#endif
+			if ( le_jobs::get_current_worker_id() >= 0 ) {
+				// We're running inside a job: give other jobs a chance to run while we wait.
+				le_jobs::yield();
+			}
 		}
 
 		bool result = vk_backend_i.clear_frame( self->backend, frameIndex );
@@ -514,6 +550,12 @@ static void renderer_record_frame( le_renderer_o* self, size_t frameIndex, le_re
 	// and stores their descriptors (information needed to allocate physical resources)
 	//
 	using namespace le_renderer; // for rendergraph_i, rendergraph_i
+
+	// Hand any queued retained buffer uploads and frees to this frame - this must
+	// happen before setup, as it may add passes, declared resources, and frame
+	// clear callbacks to the rendergraph.
+	retained_buffer_pool_i.update( self->retained_buffer_pool, graph_ );
+
 	le_renderer::api->le_rendergraph_private_i.setup_passes( graph_, frame.rendergraph );
 
 	// Find out which renderpasses contribute, only add contributing render passes to
@@ -535,7 +577,7 @@ static void renderer_record_frame( le_renderer_o* self, size_t frameIndex, le_re
 	// Execute callbacks into main application for each render pass,
 	// build command lists per render pass in intermediate, api-agnostic representation
 	//
-	le_renderer::api->le_rendergraph_private_i.execute( frame.rendergraph, frameIndex, self->backend );
+	le_renderer::api->le_rendergraph_private_i.execute( frame.rendergraph, frameIndex, self->backend, self->settings.num_worker_threads );
 
 	frame.state = FrameData::State::eRecorded;
 }
@@ -559,6 +601,17 @@ static const FrameData::State& renderer_acquire_backend_resources( le_renderer_o
 
 	// ----------| invariant: frame is either initial, or cleared.
 
+	LE_SETTING( uint32_t, LE_SETTING_RENDERER_CAPTURE_FRAMES, 0 ); // number of frames to capture to file, counts down
+
+	if ( *LE_SETTING_RENDERER_CAPTURE_FRAMES > 0 ) [[unlikely]] {
+		// We must capture before the backend acquires physical resources,
+		// as this is where renderpasses hand over their encoders.
+		char filename[ 32 ] = "";
+		snprintf( filename, sizeof( filename ), "frame_%08zu.le_capture", frame.frameNumber );
+		frame_capture_i.write( frame.rendergraph, frame.frameNumber, filename );
+		( *LE_SETTING_RENDERER_CAPTURE_FRAMES )--;
+	}
+
 	le_renderpass_o** passes          = frame.rendergraph->passes.data();
 	size_t            numRenderPasses = frame.rendergraph->passes.size();
 
@@ -691,40 +744,40 @@ static void renderer_update( le_renderer_o* self, le_rendergraph_o* graph_ ) {
 	const auto& index     = self->currentFrameNumber;
 	const auto& numFrames = self->frames.size();
 
+	// Each update, we record one frame, process (and dispatch) the frame which
+	// was recorded in the previous update, and clear the frame which we will
+	// record next. Any further frames are in flight on the GPU - the more frames
+	// we have, the more time the GPU gets before we must wait for a frame to
+	// be cleared.
+	//
+	// With two frames, we must be running on the main thread, where record
+	// and process happen one after another: we process the frame which we
+	// recorded in this update.
+	assert( self->settings.num_worker_threads == 0 || numFrames >= 3 ); // record, process and clear must not share a frame
+	const size_t process_offset = numFrames > 2 ? numFrames - 1 : 0;
+
 	// If necessary, recompile and reload shader modules
-	// - this must be complete before the record_frame step
+	// - this must be complete before the record_frame and the process_frame
+	// steps, as both may create pipelines from shader modules.
 
-	if ( LE_MT > 0 ) {
+	if ( self->settings.num_worker_threads > 0 ) {
 		// use task system (experimental)
 
-		le_jobs::counter_t* shader_counter;
-
-		le_jobs::job_t j{
-		    []( void* backend ) {
-			    vk_backend_i.update_shader_modules( static_cast<le_backend_o*>( backend ) );
-		    },
-		    self->backend };
-
-		le_jobs::run_jobs( &j, 1, &shader_counter );
-
 		struct frame_params_t {
 			le_renderer_o* renderer;
 			size_t         frame_index;
 		};
 
 		struct record_params_t {
-			le_renderer_o*      renderer;
-			size_t              frame_index;
-			le_rendergraph_o*   rendergraph;
-			size_t              current_frame_number;
-			le_jobs::counter_t* shader_counter;
+			le_renderer_o*    renderer;
+			size_t            frame_index;
+			le_rendergraph_o* rendergraph;
+			size_t            current_frame_number;
 		};
 
 		auto record_frame_fun = []( void* param_ ) {
 			auto p = static_cast<record_params_t*>( param_ );
 			// generate an intermediary, api-agnostic, representation of the frame
-
-			le_jobs::wait_for_counter_and_free( p->shader_counter, 0 );
 			renderer_record_frame( p->renderer, p->frame_index, p->rendergraph, p->current_frame_number );
 		};
 
@@ -739,41 +792,57 @@ static void renderer_update( le_renderer_o* self, le_rendergraph_o* graph_ ) {
 			renderer_dispatch_frame( p->renderer, p->frame_index );
 		};
 
+		auto update_shader_modules_fun = []( void* backend ) {
+			vk_backend_i.update_shader_modules( static_cast<le_backend_o*>( backend ) );
+		};
+
 		auto clear_frame_fun = []( void* param_ ) {
 			auto p = static_cast<frame_params_t*>( param_ );
 			renderer_clear_frame( p->renderer, p->frame_index );
 		};
 
-		le_jobs::job_t jobs[ 3 ];
+		le_jobs::job_t jobs[ 4 ];
 
 		record_params_t record_frame_params;
 		record_frame_params.renderer             = self;
 		record_frame_params.frame_index          = ( index + 0 ) % numFrames;
 		record_frame_params.rendergraph          = graph_;
 		record_frame_params.current_frame_number = self->currentFrameNumber;
-		record_frame_params.shader_counter       = shader_counter;
 
 		frame_params_t process_frame_params;
 		process_frame_params.renderer    = self;
-		process_frame_params.frame_index = ( index + 2 ) % numFrames;
+		process_frame_params.frame_index = ( index + process_offset ) % numFrames;
 
 		frame_params_t clear_frame_params;
 		clear_frame_params.renderer    = self;
 		clear_frame_params.frame_index = ( index + 1 ) % numFrames;
 
-		jobs[ 0 ] = { process_frame_fun, &process_frame_params };
-		jobs[ 1 ] = { clear_frame_fun, &clear_frame_params };
-		jobs[ 2 ] = { record_frame_fun, &record_frame_params };
+		jobs[ 0 ] = { clear_frame_fun, &clear_frame_params };
+		jobs[ 1 ] = { update_shader_modules_fun, self->backend };
+		jobs[ 2 ] = { process_frame_fun, &process_frame_params };
+		jobs[ 3 ] = { record_frame_fun, &record_frame_params };
 
+		le_jobs::counter_t* clear_counter;
+		le_jobs::counter_t* shader_counter;
 		le_jobs::counter_t* counter;
 
 		assert( self->backend );
 
-		le_jobs::run_jobs( jobs, 3, &counter );
+		// Clearing a frame does not touch shader modules - it may run
+		// while we update shader modules.
+		le_jobs::run_jobs( jobs + 0, 1, &clear_counter );
+		le_jobs::run_jobs( jobs + 1, 1, &shader_counter );
+
+		// Processing may submit background jobs which read shader modules,
+		// and recording may create pipelines: both must wait for the update.
+		le_jobs::wait_for_counter_and_free( shader_counter, 0 );
+
+		le_jobs::run_jobs( jobs + 2, 2, &counter );
 
 		// we could theoretically do some more work on the main thread here...
 
 		le_jobs::wait_for_counter_and_free( counter, 0 );
+		le_jobs::wait_for_counter_and_free( clear_counter, 0 );
 
 	} else {
 
@@ -791,7 +860,7 @@ static void renderer_update( le_renderer_o* self, le_rendergraph_o* graph_ ) {
 			// DISPATCH FRAME
 			// acquire external backend resources such as swapchain
 			// and create any temporary resources
-			auto frameIndex = ( index + 2 ) % numFrames;
+			auto frameIndex = ( index + process_offset ) % numFrames;
 			// logger.info( "+++ [%5d] DISP", frameIndex );
 			renderer_acquire_backend_resources( self, frameIndex ); //
 			renderer_process_frame( self, frameIndex );             // generate api commands for the frame
@@ -853,6 +922,8 @@ static le_resource_info_t get_default_resource_info_for_buffer() {
 
 extern void register_le_rendergraph_api( void* api );            // in le_rendergraph.cpp
 extern void register_le_command_buffer_encoder_api( void* api ); // in le_command_buffer_encoder.cpp
+extern void register_le_frame_capture_api( void* api );          // in le_frame_capture.cpp
+extern void register_le_retained_buffer_pool_api( void* api );   // in le_retained_buffer.cpp
 
 // ----------------------------------------------------------------------
 
@@ -867,6 +938,7 @@ LE_MODULE_REGISTER_IMPL( le_renderer, api ) {
 	le_renderer_i.get_settings                   = renderer_get_settings;
 	le_renderer_i.get_swapchain_extent           = renderer_get_swapchain_extent;
 	le_renderer_i.get_pipeline_manager           = renderer_get_pipeline_manager;
+	le_renderer_i.get_retained_buffer_pool       = renderer_get_retained_buffer_pool;
 	le_renderer_i.get_backend                    = renderer_get_backend;
 	le_renderer_i.get_swapchain_resource         = renderer_get_swapchain_resource;
 	le_renderer_i.get_swapchain_resource_default = renderer_get_swapchain_resource_default;
@@ -891,5 +963,7 @@ LE_MODULE_REGISTER_IMPL( le_renderer, api ) {
 	register_le_rendergraph_api( api );
 
 	register_le_command_buffer_encoder_api( api );
+	register_le_frame_capture_api( api );
+	register_le_retained_buffer_pool_api( api );
 	LE_LOAD_TRACING_LIBRARY;
 }
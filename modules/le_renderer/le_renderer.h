@@ -13,6 +13,7 @@ struct le_command_buffer_encoder_o;
 struct le_backend_o;
 struct le_shader_module_o; ///< shader module, 1:1 relationship with a shader source file
 struct le_pipeline_manager_o;
+struct le_retained_buffer_pool_o;
 struct le_command_stream_t; // ffdecl
 
 struct le_allocator_o;         // from backend
@@ -27,11 +28,38 @@ LE_OPAQUE_HANDLE( le_swapchain_handle );
 #define LE_IMG_RESOURCE( x ) \
 	le_renderer::renderer_i.produce_img_resource_handle( ( x ), 0, 0, 0 )
 
+// Transient resources don't keep their contents from one frame to the next:
+// the backend may let them share memory with other transient resources which
+// are not in use at the same time.
+#define LE_BUF_RESOURCE_TRANSIENT( x ) \
+	le_renderer::renderer_i.produce_buf_resource_handle( ( x ), le_buf_resource_usage_flags_t::eIsTransient, 0 )
+
+#define LE_IMG_RESOURCE_TRANSIENT( x ) \
+	le_renderer::renderer_i.produce_img_resource_handle( ( x ), 0, 0, le_img_resource_usage_flags_t::eIsTransient )
+
 #define LE_TEXTURE( x ) \
 	le_renderer::renderer_i.produce_texture_handle( ( x ) )
 
 struct le_shader_binding_table_o;
 
+// A block of memory in a persistent GPU buffer, handed out by a retained buffer pool.
+// Bind `buffer` at `offset` to use the data in this allocation.
+struct le_retained_buffer_allocation_t {
+	le_buffer_resource_handle buffer;    // buffer which holds this allocation
+	uint64_t                  offset;    // offset into buffer, in bytes
+	uint64_t                  num_bytes; // number of bytes which were requested
+};
+
+// Timings and counts gathered while replaying a frame capture - times are summed over all iterations.
+struct le_frame_replay_stats_t {
+	size_t num_iterations;      // number of times the captured frame was replayed
+	size_t num_passes;          // number of renderpasses in captured frame
+	size_t num_commands;        // number of commands in captured frame, summed over all command streams
+	size_t num_command_bytes;   // number of bytes in captured frame, summed over all command streams
+	double plan_frame_ms;       // time spent in backend frame planning (dry-run)
+	double walk_commands_ms;    // time spent walking command headers in all command streams - commands are not translated
+};
+
 // clang-format off
 struct le_renderer_api {
 
@@ -57,6 +85,7 @@ struct le_renderer_api {
 		bool 						   ( * remove_swapchain 	 )(le_renderer_o* self, le_swapchain_handle swapchain);
 
 		le_pipeline_manager_o*         ( *get_pipeline_manager    )( le_renderer_o* self );
+		le_retained_buffer_pool_o*     ( *get_retained_buffer_pool)( le_renderer_o* self );
 
         le_texture_handle              ( *produce_texture_handle  )(char const * maybe_name );
         char const *                   ( *texture_handle_get_name )(le_texture_handle handle);
@@ -128,7 +157,7 @@ struct le_renderer_api {
 
 	struct rendergraph_private_interface_t {
 		void                 ( *build                  ) ( le_rendergraph_o *self, size_t frameNumber );
-		void                 ( *execute                ) ( le_rendergraph_o *self, size_t frameIndex, le_backend_o *backend );
+		void                 ( *execute                ) ( le_rendergraph_o *self, size_t frameIndex, le_backend_o *backend, uint32_t num_worker_threads );
 		void                 ( *setup_passes           ) ( le_rendergraph_o *self, le_rendergraph_o *dst );
     };
 
@@ -140,11 +169,11 @@ struct le_renderer_api {
    	         uint64_t             offset;
         };
 
-		le_command_buffer_encoder_o *( *create                 )( le_allocator_o **allocator, le_command_stream_t* command_stream, le_pipeline_manager_o* pipeline_cache, le_staging_allocator_o* stagingAllocator, le::Extent2D const* extent );
+		le_command_buffer_encoder_o *( *create                 )( le_allocator_o **allocator, le_command_stream_t* command_stream, le_command_stream_t* scratch_command_stream, le_pipeline_manager_o* pipeline_cache, le_staging_allocator_o* stagingAllocator, le::Extent2D const* extent, uint32_t num_worker_threads );
 		void                         ( *destroy                )( le_command_buffer_encoder_o *obj );
 
 		le_pipeline_manager_o*		 ( *get_pipeline_manager   )( le_command_buffer_encoder_o *self);
-		void                         ( *get_encoded_data       )( le_command_buffer_encoder_o *self, void **data, size_t *numBytes, size_t *numCommands );
+		void                         ( *get_encoded_data       )( le_command_buffer_encoder_o *self, le_command_stream_t **command_stream, size_t *numBytes, size_t *numCommands );
 	};
 
 	struct command_buffer_graphics_encoder_interface_t{
@@ -174,6 +203,12 @@ struct le_renderer_api {
 		void                         ( *set_index_data         )( le_command_buffer_encoder_o *self, void const *data, uint64_t numBytes, le::IndexType const & indexType, command_buffer_encoder_interface_t::buffer_binding_info_o* optional_binding_info_readback );
 		void                         ( *set_vertex_data        )( le_command_buffer_encoder_o *self, void const *data, uint64_t numBytes, uint32_t bindingIndex, command_buffer_encoder_interface_t::buffer_binding_info_o* optional_transient_binding_info_readback );
 		void         				 ( *get_extent             )( le_command_buffer_encoder_o *self, le::Extent2D* extent);
+
+		// Sorted draws: commands recorded after a sort key was set form a draw packet, which must set
+		// all state its draws depend on. Packets are sorted by key, and emitted on end_sorted_draws.
+		void                         ( *begin_sorted_draws     )( le_command_buffer_encoder_o *self );
+		void                         ( *set_draw_sort_key      )( le_command_buffer_encoder_o *self, uint64_t sort_key );
+		void                         ( *end_sorted_draws       )( le_command_buffer_encoder_o *self );
 	};
 
 	struct command_buffer_compute_encoder_interface_t{
@@ -240,6 +275,30 @@ struct le_renderer_api {
 
 	command_buffer_video_decoder_encoder_interface_t le_cbe_video_decoder_i;
 
+	// Capture a recorded frame to file, and replay captured frames offline - see le_frame_capture.cpp
+	struct frame_capture_interface_t {
+		bool ( *write  )( le_rendergraph_o* rendergraph, size_t frameNumber, char const* path );
+		bool ( *replay )( le_backend_o* backend, char const* path, uint32_t num_iterations, le_frame_replay_stats_t* stats );
+	};
+
+	frame_capture_interface_t                   le_frame_capture_i;
+
+	// Sub-allocate persistent GPU buffers for data which does not change every frame - see le_retained_buffer.cpp
+	struct retained_buffer_pool_interface_t {
+		le_retained_buffer_pool_o* ( *create   )( );
+		void                       ( *destroy  )( le_retained_buffer_pool_o* self );
+
+		bool ( *allocate )( le_retained_buffer_pool_o* self, uint64_t num_bytes, le_retained_buffer_allocation_t* allocation );
+		// fails once the allocation has been uploaded with a recorded frame - allocate a new block to change retained data
+		bool ( *write    )( le_retained_buffer_pool_o* self, le_retained_buffer_allocation_t const* allocation, uint64_t offset, void const* data, uint64_t num_bytes );
+		void ( *free     )( le_retained_buffer_pool_o* self, le_retained_buffer_allocation_t const* allocation );
+
+		// called by the renderer for each frame, before the frame gets recorded
+		void ( *update   )( le_retained_buffer_pool_o* self, le_rendergraph_o* rendergraph );
+	};
+
+	retained_buffer_pool_interface_t            le_retained_buffer_pool_i;
+
 	helpers_interface_t                			helpers_i;
 };
 
@@ -261,6 +320,8 @@ static const auto& encoder_compute_i       = api->le_cbe_compute_i;
 static const auto& encoder_transfer_i      = api->le_cbe_transfer_i;
 static const auto& encoder_rtx_i           = api->le_cbe_rtx_i;
 static const auto& encoder_video_decoder_i = api->le_cbe_video_decoder_i;
+static const auto& frame_capture_i         = api->le_frame_capture_i;
+static const auto& retained_buffer_pool_i  = api->le_retained_buffer_pool_i;
 
 static const auto& helpers_i = api->helpers_i;
 
@@ -237,6 +237,22 @@ class RendererInfoBuilder {
 		}
 	}
 
+	/// Set to a value greater than 0 to record, process and clear frames in parallel,
+	/// using this number of worker threads. 0 means to render on the main thread.
+	RendererInfoBuilder& setNumWorkerThreads( uint32_t num_worker_threads = 0 ) {
+		renderer_settings.num_worker_threads = num_worker_threads;
+		return *this;
+	}
+
+	/// Number of frames in flight. More frames in flight give the GPU more time
+	/// to complete a frame before the renderer needs to wait for it, at the cost
+	/// of memory. 0 means to use the backend default. With worker threads, the
+	/// pipeline depth is at least 3.
+	RendererInfoBuilder& setPipelineDepth( uint32_t pipeline_depth = 0 ) {
+		renderer_settings.pipeline_depth = pipeline_depth;
+		return *this;
+	}
+
 	operator le_renderer_settings_t const&() {
 		return self;
 	}
@@ -443,6 +459,10 @@ class Renderer {
 		return le_renderer::renderer_i.get_pipeline_manager( self );
 	}
 
+	le_retained_buffer_pool_o* getRetainedBufferPool() const {
+		return le_renderer::renderer_i.get_retained_buffer_pool( self );
+	}
+
 	static le_texture_handle produceTextureHandle( char const* maybe_name ) {
 		return le_renderer::renderer_i.produce_texture_handle( maybe_name );
 	}
@@ -836,6 +856,37 @@ class GraphicsEncoder {
 		return *this;
 	}
 
+	/// Hold back draws until endSortedDraws(), and emit them sorted by key, so that draws
+	/// which share pipeline and arguments end up next to each other.
+	///
+	/// Commands recorded after setDrawSortKey() form a draw packet - a packet must set
+	/// all state which its draws depend on, as it may be re-ordered.
+	GraphicsEncoder& beginSortedDraws() {
+		le_renderer::encoder_graphics_i.begin_sorted_draws( self );
+		return *this;
+	}
+
+	GraphicsEncoder& setDrawSortKey( uint64_t sortKey ) {
+		le_renderer::encoder_graphics_i.set_draw_sort_key( self, sortKey );
+		return *this;
+	}
+
+	GraphicsEncoder& endSortedDraws() {
+		le_renderer::encoder_graphics_i.end_sorted_draws( self );
+		return *this;
+	}
+
+	/// Builds a sort key which groups draws by pipeline first, then by material, then by
+	/// depth (front-to-back, for depth in [0..1]). Pipelines are identified by a 16 bit hash,
+	/// materials by their lower 24 bits - collisions only affect the order of draws.
+	static uint64_t makeDrawSortKey( le_gpso_handle pipeline, uint32_t material, float depth ) {
+		uint64_t pipeline_bits = ( reinterpret_cast<uintptr_t>( pipeline ) * 0x9e3779b97f4a7c15ull ) >> 48;
+		uint64_t material_bits = material & 0xffffff;
+		float    depth_clamped = depth < 0.f ? 0.f : depth > 1.f ? 1.f : depth;
+		uint64_t depth_bits    = uint64_t( depth_clamped * float( 0xffffff ) );
+		return ( pipeline_bits << 48 ) | ( material_bits << 24 ) | depth_bits;
+	}
+
 	GraphicsEncoder& bindIndexBuffer( le_buffer_resource_handle const& bufferId, uint64_t const& offset, IndexType const& indexType = IndexType::eUint16 ) {
 		le_renderer::encoder_graphics_i.bind_index_buffer( self, bufferId, offset, indexType );
 		return *this;
@@ -10,7 +10,6 @@
 #include <filesystem>
 #include <sstream>
 #include <array>
-#include <bitset>
 
 #include "le_renderer.h"
 #include "le_backend_vk.h"
@@ -32,18 +31,86 @@ static constexpr auto LOGGER_LABEL = "le_rendergraph";
 
 #include "le_log.h"
 
-using ResourceField = std::bitset<LE_MAX_NUM_GRAPH_RESOURCES>; // Each bit represents a distinct resource
+#include "le_jobs.h"
 
+// Dynamically sized bitfield - each bit represents a distinct resource.
+// Size this to the number of unique resources in the graph before use.
+struct ResourceField {
+	std::vector<uint64_t> words;
+
+	explicit ResourceField( size_t num_bits = 0 )
+	    : words( ( num_bits + 63 ) / 64, 0 ) {
+	}
+
+	bool test( uint32_t idx ) const {
+		return words[ idx / 64 ] & ( uint64_t( 1 ) << ( idx % 64 ) );
+	}
+	void set( uint32_t idx ) {
+		words[ idx / 64 ] |= ( uint64_t( 1 ) << ( idx % 64 ) );
+	}
+	void reset( uint32_t idx ) {
+		words[ idx / 64 ] &= ~( uint64_t( 1 ) << ( idx % 64 ) );
+	}
+	// Returns true if any of the bits with given indices is set
+	bool test_any( std::vector<uint32_t> const& indices ) const {
+		for ( auto const& idx : indices ) {
+			if ( test( idx ) ) {
+				return true;
+			}
+		}
+		return false;
+	}
+	void set_all( std::vector<uint32_t> const& indices ) {
+		for ( auto const& idx : indices ) {
+			set( idx );
+		}
+	}
+	// Returns true if any bit is set in both this, and rhs
+	bool intersects( ResourceField const& rhs ) const {
+		assert( words.size() == rhs.words.size() );
+		for ( size_t i = 0; i != words.size(); i++ ) {
+			if ( words[ i ] & rhs.words[ i ] ) {
+				return true;
+			}
+		}
+		return false;
+	}
+	// Returns bits as a string of '0', and '1', most significant bit first, for debug purposes
+	std::string to_string() const {
+		std::string result( words.size() * 64, '0' );
+		for ( size_t i = 0; i != result.size(); i++ ) {
+			if ( test( uint32_t( i ) ) ) {
+				result[ result.size() - 1 - i ] = '1';
+			}
+		}
+		return result;
+	}
+};
+
+// Nodes hold their reads and writes in a sparse representation: as a list of indices of the
+// unique resources which they access. Most passes only touch a handful of resources, even if
+// the graph contains thousands - which means that a dense bitfield per node would be wasteful.
 struct Node {
-	ResourceField       reads               = 0;
-	ResourceField       writes              = 0;
-	le::RootPassesField root_nodes_affinity = 0;       // association of node with root node(s) - each bit represents a root node, if set, this pass contributes to that particular root node
-	bool                is_root             = false;   // whether this node is a root node
-	bool                is_contributing     = false;   // whether this node contributes to a root node
-	char const*         debug_name          = nullptr; // non-owning pointer to char[256]
-	uint64_t            unique_id           = 0;       // unique id for each node, assigned upon node creation
+	std::vector<uint32_t> reads;                         // indices of unique resources read by this node
+	std::vector<uint32_t> writes;                        // indices of unique resources written by this node
+	le::RootPassesField   root_nodes_affinity = 0;       // association of node with root node(s) - each bit represents a root node, if set, this pass contributes to that particular root node
+	bool                  is_root             = false;   // whether this node is a root node
+	bool                  is_contributing     = false;   // whether this node contributes to a root node
+	char const*           debug_name          = nullptr; // non-owning pointer to char[256]
+	uint64_t              unique_id           = 0;       // unique id for each node, assigned upon node creation
+
+	bool does_read( uint32_t res_idx ) const {
+		return std::find( reads.begin(), reads.end(), res_idx ) != reads.end();
+	}
+	bool does_write( uint32_t res_idx ) const {
+		return std::find( writes.begin(), writes.end(), res_idx ) != writes.end();
+	}
 };
 
+// Maps a resource handle to its index in the list of unique resources for a graph.
+// Resource handles are interned, and therefore we may use their addresses as keys.
+using ResourceIndexMap = std::unordered_map<le_resource_handle, uint32_t>;
+
 // ----------------------------------------------------------------------
 
 static le_renderpass_o* renderpass_create( const char* renderpass_name, const le::QueueFlagBits& type_ ) {
@@ -407,6 +474,69 @@ static void rendergraph_add_renderpass( le_rendergraph_o* self, le_renderpass_o*
 	self->passes.push_back( renderpass_clone( renderpass ) ); // Note: We receive ownership of the pass here. We must destroy it.
 }
 
+// ----------------------------------------------------------------------
+// Calculates a hash over everything that rendergraph_build depends upon:
+// for each pass, whether it is a root pass, which resources it uses, and how
+// it accesses them. Resource handles are interned, and therefore stable, which
+// means that we can hash their addresses.
+static uint64_t rendergraph_calculate_structural_hash( le_rendergraph_o const* self ) {
+	ZoneScoped;
+
+	uint64_t hash = self->passes.size();
+
+	for ( auto const& p : self->passes ) {
+		uint64_t const pass_header[ 2 ] = { uint64_t( p->is_root ), p->resources.size() };
+		hash                            = SpookyHash::Hash64( pass_header, sizeof( pass_header ), hash );
+		hash                            = SpookyHash::Hash64( p->resources.data(), p->resources.size() * sizeof( p->resources[ 0 ] ), hash );
+		hash                            = SpookyHash::Hash64( p->resources_access_flags.data(), p->resources_access_flags.size() * sizeof( p->resources_access_flags[ 0 ] ), hash );
+	}
+
+	return hash;
+}
+
+// ----------------------------------------------------------------------
+// Applies the result of a build, as held in build_cache, to our list of
+// passes: removes (and deletes) any passes which do not contribute, and
+// tags the remaining passes with their root affinity.
+static void rendergraph_consolidate_passes( le_rendergraph_o* self ) {
+	ZoneScoped;
+
+	le_rendergraph_build_cache_t const& cache = self->build_cache;
+
+	size_t num_passes = self->passes.size();
+
+	assert( cache.pass_is_contributing.size() == num_passes && "build cache must have been built for this number of passes" );
+
+	self->root_passes_affinity_masks = cache.root_passes_affinity_masks;
+
+	// Update debug root names - we must do this before we remove any passes.
+	self->root_debug_names.resize( cache.root_pass_indices.size() );
+	for ( size_t i = 0; i != cache.root_pass_indices.size(); i++ ) {
+		self->root_debug_names[ i ] = self->passes[ cache.root_pass_indices[ i ] ]->debugName; // owned by pass, will stay alive and in-place until frame gets cleared
+	}
+
+	std::vector<le_renderpass_o*> consolidated_passes;
+	consolidated_passes.reserve( num_passes );
+
+	for ( size_t i = 0; i != num_passes; i++ ) {
+		if ( cache.pass_is_contributing[ i ] ) {
+			// Pass contributes, add it to consolidated passes
+			self->passes[ i ]->is_root              = cache.pass_is_root[ i ];
+			self->passes[ i ]->root_passes_affinity = cache.pass_root_affinity[ i ];
+			consolidated_passes.push_back( self->passes[ i ] );
+		} else {
+			// Pass is not contributing, we will not keep it.
+			// Since the rendergraph owns this pass at this point,
+			// we must explicitly delete it.
+			delete self->passes[ i ];
+			self->passes[ i ] = nullptr;
+		}
+	}
+
+	// Update self->passes
+	std::swap( self->passes, consolidated_passes );
+}
+
 // ----------------------------------------------------------------------
 // Generates a .dot file for graphviz which visualises renderpasses
 // and their resource dependencies. It will also show the sequencing
@@ -415,11 +545,10 @@ static void rendergraph_add_renderpass( le_rendergraph_o* self, le_renderpass_o*
 // The graphviz file is stored as graph.dot in the executable's directory.
 //
 static bool generate_dot_file_for_rendergraph(
-    le_rendergraph_o*   self,
-    le_resource_handle* uniqueResources,
-    size_t const&       numUniqueResources,
-    Node const*         nodes,
-    size_t              frame_number ) {
+    le_rendergraph_o*       self,
+    ResourceIndexMap const& resource_index,
+    Node const*             nodes,
+    size_t                  frame_number ) {
 	ZoneScoped;
 
 	static auto                  logger   = LeLog( LOGGER_LABEL );
@@ -486,25 +615,17 @@ static bool generate_dot_file_for_rendergraph(
 			os << r->data->debug_name << "\">";
 
 			{
-				auto const needle = r;
-
-				size_t res_idx = 0; // unique resource id (monotonic, non-sparse, index into bitfield)
-				for ( auto ur = uniqueResources; res_idx != numUniqueResources; res_idx++, ur++ ) {
-					if ( *ur == needle ) {
-						// found matching resource, res_idx is index into uniqueHandles for resource
-						break;
-					}
-				}
+				uint32_t const res_idx = resource_index.at( r ); // unique resource id (monotonic, non-sparse, index into bitfield)
 
 				// if resource is being written to, then underline resource name
-				if ( nodes[ i ].reads[ res_idx ] ) {
+				if ( nodes[ i ].does_read( res_idx ) ) {
 					os << "△";
 				}
-				if ( nodes[ i ].writes[ res_idx ] ) {
+				if ( nodes[ i ].does_write( res_idx ) ) {
 					os << "▼";
 				}
 
-				if ( nodes[ i ].writes[ res_idx ] ) {
+				if ( nodes[ i ].does_write( res_idx ) ) {
 					os << "<u>" << r->data->debug_name << "</u>";
 				} else {
 					os << " " << r->data->debug_name << "";
@@ -531,27 +652,20 @@ static bool generate_dot_file_for_rendergraph(
 
 			auto const needle = p->resources[ j ];
 
-			size_t res_idx = 0; // unique resource id (monotonic, non-sparse, index into bitfield)
-			for ( auto r = uniqueResources; res_idx != numUniqueResources; res_idx++, r++ ) {
-				if ( *r == needle ) {
-					// found matching resource, res_idx is index into uniqueHandles for resource
-					break;
-				}
-			}
+			auto it = resource_index.find( needle );
 
-			assert( res_idx != numUniqueResources && "something went wrong, handle could not be found in list of unique handles." );
+			assert( it != resource_index.end() && "something went wrong, handle could not be found in list of unique handles." );
 
-			if ( !nodes[ i ].writes[ res_idx ] ) {
+			uint32_t const res_idx = it->second; // unique resource id (monotonic, non-sparse, index into bitfield)
+
+			if ( !nodes[ i ].does_write( res_idx ) ) {
 				continue;
 			}
 
 			// now we must find any subsequent nodes which read from this resource.
 
-			ResourceField res_filter = uint64_t( 1 ) << res_idx;
-
 			for ( size_t k = i + 1; k != self->passes.size(); k++ ) {
-				if ( ( nodes[ k ].reads & res_filter ).any() ||
-				     ( nodes[ k ].writes & nodes[ k ].reads & res_filter ).any() ) {
+				if ( nodes[ k ].does_read( res_idx ) ) {
 
 					os << "\"" << nodes[ i ].debug_name << "_" << nodes[ i ].unique_id << "\":"
 					   << "\"" << needle->data->debug_name << "\""
@@ -562,7 +676,7 @@ static bool generate_dot_file_for_rendergraph(
 					   << ( nodes[ k ].is_contributing == false ? "[style=dashed]" : "" )
 					   << ";" << std::endl;
 				}
-				if ( ( nodes[ k ].writes & res_filter ).any() ) {
+				if ( nodes[ k ].does_write( res_idx ) ) {
 					break;
 				}
 			}
@@ -612,14 +726,14 @@ static bool generate_dot_file_for_rendergraph(
 /// \brief Tag any nodes which contribute to any root nodes
 /// \details We do this so that we can weed out any nodes which are provably
 ///          not contributing - these don't need to be executed at all.
-static void node_tag_contributing( Node* const nodes, const size_t num_nodes, uint32_t* count_roots = nullptr ) {
+static void node_tag_contributing( Node* const nodes, const size_t num_nodes, const size_t num_unique_resources, uint32_t* count_roots = nullptr ) {
 	ZoneScoped;
 
 	// We iterate bottom to top - from last layer to first layer
 	Node*             node      = nodes + num_nodes;
 	Node const* const node_rend = nodes;
 
-	ResourceField read_accum;
+	ResourceField read_accum( num_unique_resources );
 
 	if ( count_roots ) {
 		*count_roots = 0;
@@ -638,7 +752,7 @@ static void node_tag_contributing( Node* const nodes, const size_t num_nodes, ui
 		// If it's not a root node, first see if there are any writes to currently monitored reads
 		//      if yes, add all reads to monitored reads
 
-		bool writes_to_any_monitored_read = ( node->writes & read_accum ).any();
+		bool writes_to_any_monitored_read = read_accum.test_any( node->writes );
 
 		if ( node->is_root || writes_to_any_monitored_read ) {
 
@@ -651,8 +765,10 @@ static void node_tag_contributing( Node* const nodes, const size_t num_nodes, ui
 			// be implicitly discarded by a write-only operation onto this place. (Any previous writes
 			// are never read, and we will need a new read to make this resource active again)
 
-			read_accum = ( read_accum & ( ~node->writes ) ) // Anything written in this node will be extinguished (consumed)
-			             | node->reads;                     // Anything read in this node will be lit up.
+			for ( auto const& w : node->writes ) {
+				read_accum.reset( w ); // Anything written in this node will be extinguished (consumed)
+			}
+			read_accum.set_all( node->reads ); // Anything read in this node will be lit up.
 
 			node->is_contributing = true;
 
@@ -674,21 +790,51 @@ static void node_tag_contributing( Node* const nodes, const size_t num_nodes, ui
 // As a side-effect, this method removes (and deletes) any
 // passes which do not contribute to the rendergraph
 //
+// If the structure of the graph is identical to the structure of the graph
+// which was last built using this rendergraph object, we skip compilation,
+// and re-use the previous result.
+//
 static void rendergraph_build( le_rendergraph_o* self, size_t frame_number ) {
 	ZoneScoped;
 
 	static auto logger = LeLog( LOGGER_LABEL );
 
 	LE_SETTING( bool, LE_SETTING_RENDERGRAPH_PRINT_EXTENDED_DEBUG_MESSAGES, false );
+	LE_SETTING( uint32_t, LE_SETTING_RENDERGRAPH_GENERATE_DOT_FILES, 0 );
+	LE_SETTING( bool, LE_SETTING_RENDERGRAPH_USE_BUILD_CACHE, true );
+
+	uint64_t graph_hash = rendergraph_calculate_structural_hash( self );
+
+	if ( *LE_SETTING_RENDERGRAPH_USE_BUILD_CACHE &&
+	     graph_hash != 0 &&
+	     graph_hash == self->build_cache.hash &&
+	     self->build_cache.pass_is_contributing.size() == self->passes.size() &&
+	     0 == *LE_SETTING_RENDERGRAPH_GENERATE_DOT_FILES ) {
+		// Graph has the same structure as last time we built it - we can re-use the result.
+		ZoneScopedN( "Rendergraph build cache hit" );
+		rendergraph_consolidate_passes( self );
+		return;
+	}
+
+	// --------| invariant: graph structure has changed, we must compile the graph
 	// We must express our list of passes as a list of nodes.
 	// A node holds two bitfields, the bitfield names are: `read` and `write`.
 	// Each bit in the bitfield represents a possible resource.
 	// This means we must create a list of unique resources, so that we can use the resource index as the
 	// offset value for a bit representing this particular resource in the bitfields.
 
-	std::vector<Node>                                          nodes;         // There is exactly one Node per `pass` - their indices correspond
-	std::array<le_resource_handle, LE_MAX_NUM_GRAPH_RESOURCES> uniqueHandles; // lookup for resource handles.
-	size_t                                                     numUniqueResources = 0;
+	std::vector<Node>               nodes;          // There is exactly one Node per `pass` - their indices correspond
+	std::vector<le_resource_handle> uniqueHandles;  // unique resource handles, index into this is index into ResourceField
+	ResourceIndexMap                resource_index; // lookup for resource handles: handle -> index into uniqueHandles
+
+	{
+		size_t num_resource_uses = 0;
+		for ( auto const& p : self->passes ) {
+			num_resource_uses += p->resources.size();
+		}
+		nodes.reserve( self->passes.size() );
+		resource_index.reserve( num_resource_uses );
+	}
 
 	// Translate all passes into a node
 	//   Get list of resources per pass and build node from this
@@ -702,6 +848,9 @@ static void rendergraph_build( le_rendergraph_o* self, size_t frame_number ) {
 
 		const size_t numResources = p->resources.size();
 
+		node.reads.reserve( numResources );
+		node.writes.reserve( numResources );
+
 		for ( size_t i = 0; i != numResources; i++ ) {
 			auto const& resource_handle = p->resources[ i ];
 			auto        access_flags    = p->resources_access_flags[ i ];
@@ -717,25 +866,24 @@ static void rendergraph_build( le_rendergraph_o* self, size_t frame_number ) {
 				detect_write |= ( access_flags & LE_ALL_IMAGE_IMPLIED_WRITE_ACCESS_FLAGS );
 			}
 
-			size_t res_idx = 0; // unique resource id (monotonic, non-sparse, index into bitfield)
-			for ( auto r = uniqueHandles.data(); res_idx != numUniqueResources; res_idx++, r++ ) {
-				if ( *r == resource_handle ) {
-					// found matching resource, res_idx is index into uniqueHandles for resource
-					break;
-				}
-			}
+			// unique resource id (monotonic, non-sparse, index into bitfield) - if resource was not
+			// found, we add a new resource
+			auto [ it, was_inserted ] = resource_index.try_emplace( resource_handle, uint32_t( uniqueHandles.size() ) );
 
-			if ( res_idx == numUniqueResources ) {
-				// resource was not found, we must add a new resource
-				uniqueHandles[ res_idx ] = resource_handle;
-				numUniqueResources++;
-				assert( numUniqueResources < LE_MAX_NUM_GRAPH_RESOURCES && "bitfield must be large enough to provide one field for each unique resource" );
+			if ( was_inserted ) {
+				uniqueHandles.push_back( resource_handle );
 			}
 
+			uint32_t const res_idx = it->second;
+
 			// --------| invariant: uniqueHandles[res_idx] is valid
 
-			node.reads.set( res_idx, detect_read );
-			node.writes.set( res_idx, detect_write );
+			if ( detect_read ) {
+				node.reads.push_back( res_idx );
+			}
+			if ( detect_write ) {
+				node.writes.push_back( res_idx );
+			}
 		}
 
 		if ( p->is_root ) {
@@ -751,16 +899,21 @@ static void rendergraph_build( le_rendergraph_o* self, size_t frame_number ) {
 	// Tasks which don't contribute to any root node
 	// can be disposed, as their products will never be used.
 	uint32_t root_count = 0; // gets set to number of found root nodes as a side-effect of node_tag_contributing
-	node_tag_contributing( nodes.data(), nodes.size(), &root_count );
+	node_tag_contributing( nodes.data(), nodes.size(), uniqueHandles.size(), &root_count );
+
+	le_rendergraph_build_cache_t& cache = self->build_cache;
 
-	// non-owning pointers to debug names within passes which are root, in the same order as RootPassesField is constructed
-	std::vector<char const*> root_debug_names( root_count );
+	cache.hash = 0; // invalidate cache until we have finished building
+	cache.root_passes_affinity_masks.clear();
+
+	// indices of passes which are root, in the same order as RootPassesField is constructed
+	cache.root_pass_indices.resize( root_count );
 
 	assert( root_count <= LE_MAX_NUM_GRAPH_ROOTS && "number of nodes must fit LE_MAX_NUM_TREES, otherwise we can't express tree affinity as a bitfield" );
 
 	{
-		std::vector<ResourceField> root_reads_accum( root_count );
-		std::vector<ResourceField> root_writes_accum( root_count );
+		std::vector<ResourceField> root_reads_accum( root_count, ResourceField( uniqueHandles.size() ) );
+		std::vector<ResourceField> root_writes_accum( root_count, ResourceField( uniqueHandles.size() ) );
 
 		// for each root node, accumulate all reads, and writes from contributing nodes.
 		// we do this so that we can test whether each tree is isolated.
@@ -783,8 +936,8 @@ static void rendergraph_build( le_rendergraph_o* self, size_t frame_number ) {
 				ResourceField& read_accum  = root_reads_accum[ root_index ];
 				ResourceField& write_accum = root_writes_accum[ root_index ];
 				// r is a root node.
-				read_accum  = r->reads;
-				write_accum = r->writes;
+				read_accum.set_all( r->reads );
+				write_accum.set_all( r->writes );
 				r->root_nodes_affinity |= ( 1ULL << root_index );
 
 				for ( auto n = r + 1; n != nodes.rend(); n++ ) {
@@ -793,14 +946,14 @@ static void rendergraph_build( le_rendergraph_o* self, size_t frame_number ) {
 					}
 					// if this earlier node writes to any of our subsequent reads, we add it to our
 					// current tree of nodes.
-					if ( ( n->writes & read_accum ).any() ) {
-						read_accum |= n->reads;
-						write_accum |= n->writes;
+					if ( read_accum.test_any( n->writes ) ) {
+						read_accum.set_all( n->reads );
+						write_accum.set_all( n->writes );
 						// tag resource as belonging to this particular root node.
 						n->root_nodes_affinity |= ( 1ULL << root_index );
 					}
 				}
-				root_debug_names[ root_index ] = r->debug_name; // owned by pass, will stay alive and in-place until frame gets cleared
+				cache.root_pass_indices[ root_index ] = uint32_t( std::distance( r, nodes.rend() ) - 1 );
 				root_index++;
 			}
 		}
@@ -808,7 +961,7 @@ static void rendergraph_build( le_rendergraph_o* self, size_t frame_number ) {
 		if ( *LE_SETTING_RENDERGRAPH_PRINT_EXTENDED_DEBUG_MESSAGES ) [[unlikely]] {
 			{
 				logger.info( "Unique resources:" );
-				for ( size_t i = 0; i != numUniqueResources; i++ ) {
+				for ( size_t i = 0; i != uniqueHandles.size(); i++ ) {
 					logger.info( "%3d : %s", i, uniqueHandles[ i ]->data->debug_name );
 				}
 			}
@@ -860,8 +1013,8 @@ static void rendergraph_build( le_rendergraph_o* self, size_t frame_number ) {
 				// compare i <-> j
 				// compare j <-> i
 				// If any reads appear in writes, tag both as being part of the same batch.
-				if ( ( root_reads_accum[ i ] & root_writes_accum[ j ] ).any() || // writes from j touch reads from i
-				     ( root_reads_accum[ j ] & root_writes_accum[ i ] ).any() )  // or writes from i touch reads from j
+				if ( root_reads_accum[ i ].intersects( root_writes_accum[ j ] ) || // writes from j touch reads from i
+				     root_reads_accum[ j ].intersects( root_writes_accum[ i ] ) )  // or writes from i touch reads from j
 				{
 
 					// Overlap detectd:
@@ -901,7 +1054,7 @@ static void rendergraph_build( le_rendergraph_o* self, size_t frame_number ) {
 				logger.info( "subgraph key [ %-12d], affinity: %x", i, subgraph_id[ subgraph_id_idx[ i ] ] );
 			}
 
-			self->root_passes_affinity_masks.push_back( subgraph_id[ subgraph_id_idx[ i ] ] );
+			cache.root_passes_affinity_masks.push_back( subgraph_id[ subgraph_id_idx[ i ] ] );
 
 			{
 				// Do some error checking: each bit in the RootPassesField bitfield is only allowed
@@ -913,42 +1066,32 @@ static void rendergraph_build( le_rendergraph_o* self, size_t frame_number ) {
 		}
 	}
 
-	LE_SETTING( uint32_t, LE_SETTING_RENDERGRAPH_GENERATE_DOT_FILES, 0 );
-
 	if ( *LE_SETTING_RENDERGRAPH_GENERATE_DOT_FILES > 0 ) [[unlikely]] {
-		generate_dot_file_for_rendergraph( self, uniqueHandles.data(), numUniqueResources, nodes.data(), frame_number );
+		generate_dot_file_for_rendergraph( self, resource_index, nodes.data(), frame_number );
 		( *LE_SETTING_RENDERGRAPH_GENERATE_DOT_FILES )--;
 	}
 
 	{
-		// Remove any passes from rendergraph which do not contribute.
-		//
-		//
+		// Store result of build so that we may re-use it if the next graph
+		// built with this rendergraph has the same structure.
 		size_t num_passes = self->passes.size();
 
-		std::vector<le_renderpass_o*> consolidated_passes;
-		consolidated_passes.reserve( num_passes );
+		cache.pass_is_contributing.resize( num_passes );
+		cache.pass_is_root.resize( num_passes );
+		cache.pass_root_affinity.resize( num_passes );
 
 		for ( size_t i = 0; i != num_passes; i++ ) {
-			if ( nodes[ i ].is_contributing ) {
-				// Pass contributes, add it to consolidated passes
-				self->passes[ i ]->is_root              = nodes[ i ].is_root;
-				self->passes[ i ]->root_passes_affinity = nodes[ i ].root_nodes_affinity;
-				consolidated_passes.push_back( self->passes[ i ] );
-			} else {
-				// Pass is not contributing, we will not keep it.
-				// Since the rendergraph owns this pass at this point,
-				// we must explicitly delete it.
-				delete self->passes[ i ];
-				self->passes[ i ] = nullptr;
-			}
+			cache.pass_is_contributing[ i ] = nodes[ i ].is_contributing;
+			cache.pass_is_root[ i ]         = nodes[ i ].is_root;
+			cache.pass_root_affinity[ i ]   = nodes[ i ].root_nodes_affinity;
 		}
 
-		// Update self->passes
-		std::swap( self->passes, consolidated_passes );
+		cache.hash = graph_hash;
+	}
 
-		// Update debug root names
-		std::swap( self->root_debug_names, root_debug_names );
+	{
+		// Remove any passes from rendergraph which do not contribute.
+		rendergraph_consolidate_passes( self );
 
 		if ( *LE_SETTING_RENDERGRAPH_PRINT_EXTENDED_DEBUG_MESSAGES ) [[unlikely]] {
 			logger.info( "* Consolidated Pass List *" );
@@ -971,12 +1114,16 @@ static void rendergraph_build( le_rendergraph_o* self, size_t frame_number ) {
 ///
 /// The command stream is stored inside of the Encoder that is used to record it (that's not elegant).
 ///
-/// We could possibly go wide when recording renderpasses, with one context per renderpass.
-static void rendergraph_execute( le_rendergraph_o* self, size_t frameIndex, le_backend_o* backend ) {
+/// If we run multi-threaded, we go wide when recording renderpasses: each pass records into its own
+/// encoder, and therefore into its own command stream, and each encoder picks the transient allocator
+/// which belongs to the worker thread it currently runs on.
+static void rendergraph_execute( le_rendergraph_o* self, size_t frameIndex, le_backend_o* backend, uint32_t num_worker_threads ) {
 	ZoneScoped;
 
 	static auto logger = LeLog( LOGGER_LABEL );
 	LE_SETTING( bool, LE_SETTING_RENDERGRAPH_PRINT_EXTENDED_DEBUG_MESSAGES, false );
+	// Opt-in: set this to true only if your execute callbacks are safe to call concurrently.
+	LE_SETTING( bool, LE_SETTING_RENDERGRAPH_RECORD_PASSES_IN_PARALLEL, false );
 
 	if ( *LE_SETTING_RENDERGRAPH_PRINT_EXTENDED_DEBUG_MESSAGES ) [[unlikely]] {
 		std::ostringstream msg;
@@ -1057,7 +1204,15 @@ static void rendergraph_execute( le_rendergraph_o* self, size_t frameIndex, le_b
 
 	const size_t numPasses = self->passes.size();
 
-	le_command_stream_t** const ppCommandStreams = vk_backend_i.get_frame_command_streams( backend, frameIndex, numPasses );
+	// Command streams remember how much memory each pass needed - we pass ids so that they can reserve up-front
+	std::vector<uint64_t> pass_ids;
+	pass_ids.reserve( numPasses );
+	for ( auto const& pass : self->passes ) {
+		pass_ids.push_back( pass->id );
+	}
+
+	le_command_stream_t** const ppCommandStreams        = vk_backend_i.get_frame_command_streams( backend, frameIndex, numPasses, pass_ids.data() );
+	le_command_stream_t** const ppScratchCommandStreams = vk_backend_i.get_frame_scratch_command_streams( backend, frameIndex, numPasses );
 
 	for ( size_t i = 0; i != numPasses; ++i ) {
 		ZoneScopedN( "Prepare Pass" );
@@ -1084,7 +1239,7 @@ static void rendergraph_execute( le_rendergraph_o* self, size_t frameIndex, le_b
 			}
 
 			// NOTE: we must manually track the lifetime of encoder!
-			pass->encoder = encoder_i.create( ppAllocators, ppCommandStreams[ i ], pipelineCache, stagingAllocator, &pass_extents );
+			pass->encoder = encoder_i.create( ppAllocators, ppCommandStreams[ i ], ppScratchCommandStreams[ i ], pipelineCache, stagingAllocator, &pass_extents, num_worker_threads );
 
 			if ( pass->type == le::QueueFlagBits::eGraphics ) {
 
@@ -1102,8 +1257,42 @@ static void rendergraph_execute( le_rendergraph_o* self, size_t frameIndex, le_b
 				encoder_graphics_i.set_scissor( pass->encoder, 0, 1, default_scissor );
 				encoder_graphics_i.set_viewport( pass->encoder, 0, 1, default_viewport );
 			}
+		}
+	}
+
+	// --------| invariant: each pass which has execute callbacks has an encoder
 
-			renderpass_run_execute_callbacks( pass ); // record draw commands into encoder
+	// Record draw commands into encoders by running each pass's execute callbacks.
+
+	// We may only record passes in parallel if the renderer is multi-threaded -
+	// if it is, we're running inside a job.
+	if ( *LE_SETTING_RENDERGRAPH_RECORD_PASSES_IN_PARALLEL && num_worker_threads > 0 ) {
+
+		std::vector<le_jobs::job_t> jobs;
+		jobs.reserve( numPasses );
+
+		for ( auto& pass : self->passes ) {
+			if ( !pass->executeCallbacks.empty() ) {
+				jobs.push_back( { []( void* pass ) {
+					                 ZoneScopedN( "Record Pass" );
+					                 renderpass_run_execute_callbacks( static_cast<le_renderpass_o*>( pass ) );
+				                 },
+				                  pass } );
+			}
+		}
+
+		if ( !jobs.empty() ) {
+			le_jobs::counter_t* counter;
+			le_jobs::run_jobs( jobs.data(), uint32_t( jobs.size() ), &counter );
+			le_jobs::wait_for_counter_and_free( counter, 0 );
+		}
+
+		return;
+	}
+
+	for ( auto& pass : self->passes ) {
+		if ( !pass->executeCallbacks.empty() ) {
+			renderpass_run_execute_callbacks( pass );
 		}
 	}
 
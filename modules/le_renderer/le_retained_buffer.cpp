@@ -0,0 +1,411 @@
+#include "le_core.h"
+#include "le_renderer.h"
+#include "le_log.h"
+#include "le_tracy.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cstring>
+#include <cstdio>
+#include <string>
+#include <vector>
+#include <mutex>
+#include <unordered_set>
+
+#include "private/le_renderer/le_rendergraph.h"
+#include "private/le_renderer/le_buddy_allocator.h"
+
+static constexpr auto LOGGER_LABEL = "le_retained_buffer";
+
+/*
+
+Retained buffer pool
+
+	+ Hands out blocks of memory in persistent GPU buffers, for data which
+	does not change from frame to frame - static meshes, cached geometry,
+	glyph quads. Once such data has been written, it stays on the GPU
+	until it is freed, and does not need to be uploaded again.
+
+	+ Buffers are allocated in pages of a fixed size (see setting
+	`LE_SETTING_RETAINED_BUFFER_PAGE_SIZE`). Each page is sub-allocated via a
+	buddy allocator: blocks are power-of-two sized, and aligned to their
+	size, which means every allocation is at least 256 byte aligned, and may
+	be bound as a vertex, index, uniform, or storage buffer. Allocations
+	which are larger than a page get a page of their own.
+
+	+ Writes are queued, and uploaded via a transfer pass which the pool
+	inserts at the front of the next frame that gets recorded. Passes which
+	read from a retained buffer must declare that they use it - the
+	rendergraph then synchronises them with the upload.
+
+	+ Once a frame which uploads into a block has been recorded, that block
+	is sealed, and further writes to it are rejected: frames in flight may
+	still read from the block, and the rendergraph only synchronises passes
+	within a frame, not with earlier frames - an upload would race with
+	these reads. To change retained data, allocate a new block, write to
+	it, and free the old block.
+
+	+ Frees are deferred: a freed block may still be read by frames which
+	are in flight on the GPU. We attach freed blocks to the next frame that
+	gets recorded, and only return them to the allocator once that frame has
+	been cleared, which is after its fence has signalled - by then, no frame
+	which could have read from these blocks can be in flight anymore.
+
+Pages are declared with the rendergraph every frame with a fixed size and
+usage, so that the backend never needs to re-allocate (and thereby discard)
+a page.
+
+*/
+
+struct le_retained_buffer_page_t {
+	le_buffer_resource_handle    buffer;
+	le_buddy_allocator_t         allocator;
+	std::unordered_set<uint64_t> sealed_blocks; // offsets of blocks which have been uploaded with a recorded frame - must not be written to again
+};
+
+struct le_retained_buffer_upload_t {
+	le_buffer_resource_handle buffer;
+	uint64_t                  dst_offset; // offset into buffer
+	uint64_t                  src_offset; // offset into upload data
+	uint64_t                  num_bytes;
+};
+
+struct le_retained_buffer_uploads_t {
+	std::vector<le_retained_buffer_upload_t> uploads;
+	std::vector<uint8_t>                     data; // data for all uploads, back-to-back
+};
+
+struct le_retained_buffer_block_t {
+	uint32_t page_index;
+	uint64_t offset;
+};
+
+struct le_retained_buffer_pool_o;
+
+// Blocks which were freed before a frame was recorded - reclaimed once this frame gets cleared.
+struct le_retained_buffer_free_batch_t {
+	le_retained_buffer_pool_o*             pool;
+	std::vector<le_retained_buffer_block_t> frees;
+};
+
+struct le_retained_buffer_pool_o {
+	std::mutex                              mtx;                // protects all members below - frame clear callbacks may be called from any thread
+	uint64_t                                page_size = 0;      // default size for pages, power of two
+	std::vector<le_retained_buffer_page_t>  pages;              //
+	le_retained_buffer_uploads_t            pending_uploads;    // writes which have not been uploaded yet
+	le_retained_buffer_uploads_t            recorded_uploads;   // writes which were handed to the most recently recorded frame
+	std::vector<le_retained_buffer_block_t> pending_writes;     // blocks written by pending uploads - sealed once these uploads are handed to a frame
+	std::vector<le_retained_buffer_block_t> pending_frees;      // frees which have not been attached to a frame yet
+	uint32_t                                num_batches_in_flight = 0; // number of free batches which wait for their frame to be cleared
+};
+
+static constexpr uint32_t MIN_BLOCK_SIZE_LOG2 = 8; // 256 bytes
+static constexpr uint32_t MAX_PAGE_SIZE_LOG2  = 31; // buffer sizes are 32 bit
+
+static constexpr le::BufferUsageFlags PAGE_USAGE_FLAGS{
+    le::BufferUsageFlagBits::eVertexBuffer |
+    le::BufferUsageFlagBits::eIndexBuffer |
+    le::BufferUsageFlagBits::eUniformBuffer |
+    le::BufferUsageFlagBits::eStorageBuffer |
+    le::BufferUsageFlagBits::eIndirectBuffer |
+    le::BufferUsageFlagBits::eTransferDst |
+    le::BufferUsageFlagBits::eTransferSrc };
+
+// ----------------------------------------------------------------------
+
+static uint32_t ceil_log2( uint64_t value ) {
+	uint32_t result = 0;
+	while ( ( 1ull << result ) < value ) {
+		result++;
+	}
+	return result;
+}
+
+// ----------------------------------------------------------------------
+
+static le_retained_buffer_pool_o* retained_buffer_pool_create() {
+	auto self = new le_retained_buffer_pool_o();
+
+	LE_SETTING( uint32_t, LE_SETTING_RETAINED_BUFFER_PAGE_SIZE, 32 << 20 ); // default size of a retained buffer page, in bytes - rounded up to a power of two
+
+	uint32_t page_size_log2 = ceil_log2( *LE_SETTING_RETAINED_BUFFER_PAGE_SIZE );
+
+	page_size_log2 = std::max( page_size_log2, MIN_BLOCK_SIZE_LOG2 );
+	page_size_log2 = std::min( page_size_log2, MAX_PAGE_SIZE_LOG2 );
+
+	self->page_size = 1ull << page_size_log2;
+
+	return self;
+}
+
+// ----------------------------------------------------------------------
+
+static void retained_buffer_pool_destroy( le_retained_buffer_pool_o* self ) {
+
+	static auto logger = LeLog( LOGGER_LABEL );
+
+	if ( self->num_batches_in_flight ) {
+		// This would mean that frame clear callbacks will access a pool which has
+		// been destroyed - the renderer must clear all frames before it destroys the pool.
+		logger.error( "Destroying retained buffer pool while %u batches of frees are in flight.", self->num_batches_in_flight );
+		assert( false );
+	}
+
+	// Page buffers are owned by the backend, and will be destroyed with it.
+
+	delete self;
+}
+
+// ----------------------------------------------------------------------
+// Must be called while holding self->mtx
+static le_retained_buffer_page_t& retained_buffer_pool_add_page( le_retained_buffer_pool_o* self, uint32_t size_log2 ) {
+
+	char name[ 48 ] = "";
+	snprintf( name, sizeof( name ), "le_retained_buffer[%p:%zu]", ( void* )self, self->pages.size() );
+
+	self->pages.push_back( { LE_BUF_RESOURCE( name ), le_buddy_allocator_t( size_log2, MIN_BLOCK_SIZE_LOG2 ) } );
+
+	return self->pages.back();
+}
+
+// ----------------------------------------------------------------------
+// Returns false if allocation failed.
+static bool retained_buffer_pool_allocate( le_retained_buffer_pool_o* self, uint64_t num_bytes, le_retained_buffer_allocation_t* allocation ) {
+	ZoneScoped;
+	static auto logger = LeLog( LOGGER_LABEL );
+
+	if ( num_bytes == 0 || num_bytes > ( 1ull << MAX_PAGE_SIZE_LOG2 ) ) {
+		logger.error( "Could not allocate retained buffer: invalid size: %zu bytes", num_bytes );
+		return false;
+	}
+
+	std::scoped_lock lock( self->mtx );
+
+	uint64_t offset = 0;
+
+	for ( auto& page : self->pages ) {
+		if ( page.allocator.allocate( num_bytes, &offset ) ) {
+			*allocation = { page.buffer, offset, num_bytes };
+			return true;
+		}
+	}
+
+	// --------| invariant: no page has a free block which is large enough - we must add a page
+
+	uint32_t size_log2 = std::max( ceil_log2( self->page_size ), ceil_log2( num_bytes ) );
+
+	auto& page = retained_buffer_pool_add_page( self, size_log2 );
+
+	if ( !page.allocator.allocate( num_bytes, &offset ) ) {
+		// This should never happen, as the new page is large enough.
+		assert( false );
+		return false;
+	}
+
+	*allocation = { page.buffer, offset, num_bytes };
+	return true;
+}
+
+// ----------------------------------------------------------------------
+// Must be called while holding self->mtx - returns nullptr if allocation is not valid.
+static le_retained_buffer_page_t* retained_buffer_pool_find_page( le_retained_buffer_pool_o* self, le_retained_buffer_allocation_t const* allocation, uint32_t* page_index ) {
+	for ( uint32_t i = 0; i != self->pages.size(); i++ ) {
+		if ( self->pages[ i ].buffer == allocation->buffer ) {
+			if ( self->pages[ i ].allocator.get_allocation_size( allocation->offset ) < allocation->num_bytes ) {
+				return nullptr;
+			}
+			if ( page_index ) {
+				*page_index = i;
+			}
+			return &self->pages[ i ];
+		}
+	}
+	return nullptr;
+}
+
+// ----------------------------------------------------------------------
+// Queues `num_bytes` from `data` for upload into `allocation`, starting at `offset` bytes
+// into the allocation. Data is copied, and uploaded with the next frame which gets recorded.
+//
+// Fails if an earlier write to this allocation has already been uploaded with a recorded
+// frame, as frames in flight may still read from it - see "sealed" in the comment at the top.
+static bool retained_buffer_pool_write( le_retained_buffer_pool_o* self, le_retained_buffer_allocation_t const* allocation, uint64_t offset, void const* data, uint64_t num_bytes ) {
+	ZoneScoped;
+	static auto logger = LeLog( LOGGER_LABEL );
+
+	if ( offset + num_bytes > allocation->num_bytes ) {
+		logger.error( "Could not write to retained buffer: write [%zu..%zu) exceeds allocation size of %zu bytes", offset, offset + num_bytes, allocation->num_bytes );
+		return false;
+	}
+
+	if ( num_bytes == 0 ) {
+		return true;
+	}
+
+	std::scoped_lock lock( self->mtx );
+
+	uint32_t page_index = 0;
+	auto     page       = retained_buffer_pool_find_page( self, allocation, &page_index );
+
+	if ( nullptr == page ) {
+		logger.error( "Could not write to retained buffer: allocation is not valid." );
+		return false;
+	}
+
+	if ( page->sealed_blocks.count( allocation->offset ) ) {
+		// Writing would race with frames in flight which read from this allocation.
+		logger.error( "Could not write to retained buffer: allocation has already been uploaded, and may be in use by frames in flight. Allocate a new block instead." );
+		assert( false );
+		return false;
+	}
+
+	self->pending_writes.push_back( { page_index, allocation->offset } );
+
+	auto& pending = self->pending_uploads;
+
+	pending.uploads.push_back( { allocation->buffer, allocation->offset + offset, pending.data.size(), num_bytes } );
+	pending.data.insert( pending.data.end(), static_cast<uint8_t const*>( data ), static_cast<uint8_t const*>( data ) + num_bytes );
+
+	return true;
+}
+
+// ----------------------------------------------------------------------
+// Frees an allocation - the allocation must not be used in any frame which gets
+// recorded after this call. Memory is reclaimed once all frames which might still
+// read from it have been cleared.
+static void retained_buffer_pool_free( le_retained_buffer_pool_o* self, le_retained_buffer_allocation_t const* allocation ) {
+	static auto logger = LeLog( LOGGER_LABEL );
+
+	std::scoped_lock lock( self->mtx );
+
+	uint32_t page_index = 0;
+
+	if ( nullptr == retained_buffer_pool_find_page( self, allocation, &page_index ) ) {
+		logger.error( "Could not free retained buffer allocation: allocation is not valid." );
+		return;
+	}
+
+	self->pending_frees.push_back( { page_index, allocation->offset } );
+}
+
+// ----------------------------------------------------------------------
+
+static void retained_buffer_pool_on_frame_clear( void* user_data ) {
+	auto batch = static_cast<le_retained_buffer_free_batch_t*>( user_data );
+	auto self  = batch->pool;
+
+	{
+		std::scoped_lock lock( self->mtx );
+
+		for ( auto const& f : batch->frees ) {
+			self->pages[ f.page_index ].allocator.free( f.offset );
+			self->pages[ f.page_index ].sealed_blocks.erase( f.offset );
+		}
+
+		self->num_batches_in_flight--;
+	}
+
+	delete batch;
+}
+
+// ----------------------------------------------------------------------
+
+static void retained_buffer_pool_execute_upload( le_command_buffer_encoder_o* encoder, void* user_data ) {
+	using namespace le_renderer;
+	auto uploads = static_cast<le_retained_buffer_uploads_t const*>( user_data );
+
+	for ( auto const& u : uploads->uploads ) {
+		encoder_transfer_i.write_to_buffer( encoder, u.buffer, u.dst_offset, uploads->data.data() + u.src_offset, u.num_bytes );
+	}
+}
+
+// ----------------------------------------------------------------------
+// Called by the renderer before each frame gets recorded - `rendergraph` is the
+// rendergraph which the application passed to the renderer for this frame.
+static void retained_buffer_pool_update( le_retained_buffer_pool_o* self, le_rendergraph_o* rendergraph ) {
+	ZoneScoped;
+	using namespace le_renderer;
+
+	std::scoped_lock lock( self->mtx );
+
+	if ( self->pages.empty() ) {
+		return;
+	}
+
+	// Declare all pages with their full size and usage, so that the backend
+	// never has to re-allocate a page because a pass uses it in a new way.
+
+	for ( auto const& page : self->pages ) {
+		le_resource_info_t info = helpers_i.get_default_resource_info_for_buffer();
+		info.buffer.size        = uint32_t( page.allocator.size );
+		info.buffer.usage       = PAGE_USAGE_FLAGS;
+		rendergraph_i.declare_resource( rendergraph, page.buffer, info );
+	}
+
+	// The previously recorded frame has been fully recorded by now, which means
+	// that its upload pass has executed, and we may recycle its upload data.
+
+	self->recorded_uploads.uploads.clear();
+	self->recorded_uploads.data.clear();
+
+	if ( !self->pending_uploads.uploads.empty() ) {
+
+		std::swap( self->recorded_uploads, self->pending_uploads );
+
+		// From now on, frames may read from these blocks - seal them.
+
+		for ( auto const& w : self->pending_writes ) {
+			self->pages[ w.page_index ].sealed_blocks.insert( w.offset );
+		}
+
+		self->pending_writes.clear();
+
+		le_renderpass_o* pass = renderpass_i.create( "le_retained_buffer_upload", le::QueueFlagBits::eTransfer );
+
+		// Only declare pages which we actually write to, so that passes which
+		// read from other pages do not need to wait for this pass.
+
+		std::vector<le_buffer_resource_handle> dst_buffers;
+
+		for ( auto const& u : self->recorded_uploads.uploads ) {
+			if ( std::find( dst_buffers.begin(), dst_buffers.end(), u.buffer ) == dst_buffers.end() ) {
+				dst_buffers.push_back( u.buffer );
+				renderpass_i.use_resource( pass, u.buffer, le::AccessFlagBits2::eTransferWrite );
+			}
+		}
+
+		renderpass_i.set_execute_callback( pass, &self->recorded_uploads, retained_buffer_pool_execute_upload );
+		renderpass_i.set_is_root( pass, true ); // uploads must never be culled
+
+		// Insert upload pass at the front, so that it executes before any pass of this
+		// frame which reads from a retained buffer. Rendergraph takes ownership of pass.
+		rendergraph->passes.insert( rendergraph->passes.begin(), pass );
+	}
+
+	if ( !self->pending_frees.empty() ) {
+
+		auto batch   = new le_retained_buffer_free_batch_t{};
+		batch->pool  = self;
+		batch->frees = std::move( self->pending_frees );
+		self->pending_frees.clear();
+
+		self->num_batches_in_flight++;
+
+		le_on_frame_clear_callback_data_t callback{ retained_buffer_pool_on_frame_clear, batch };
+		rendergraph_i.add_on_frame_clear_callbacks( rendergraph, &callback, 1 );
+	}
+}
+
+// ----------------------------------------------------------------------
+
+void register_le_retained_buffer_pool_api( void* api_ ) {
+	auto  le_renderer_api_i      = static_cast<le_renderer_api*>( api_ );
+	auto& retained_buffer_pool_i = le_renderer_api_i->le_retained_buffer_pool_i;
+
+	retained_buffer_pool_i.create   = retained_buffer_pool_create;
+	retained_buffer_pool_i.destroy  = retained_buffer_pool_destroy;
+	retained_buffer_pool_i.allocate = retained_buffer_pool_allocate;
+	retained_buffer_pool_i.write    = retained_buffer_pool_write;
+	retained_buffer_pool_i.free     = retained_buffer_pool_free;
+	retained_buffer_pool_i.update   = retained_buffer_pool_update;
+}
@@ -0,0 +1,127 @@
+#pragma once
+
+#include <stdint.h>
+#include <set>
+#include <unordered_map>
+#include <vector>
+
+/*
+ * The Buddy Allocator hands out power-of-two sized blocks from a
+ * power-of-two sized range of bytes. It only does book-keeping - it never
+ * touches the memory which it manages - which means we can use it to
+ * sub-allocate GPU buffers on the CPU.
+ *
+ * A block of order `o` has a size of `min_block_size << o` bytes, and its
+ * offset is a multiple of its size. On allocation, we split the smallest
+ * free block which fits until it has the requested order; on free, we
+ * merge a block with its buddy for as long as its buddy is free, too.
+ *
+ * Every block is aligned to its own size, and therefore at least to
+ * `min_block_size`.
+ *
+ * The allocator is not thread-safe.
+ *
+ */
+
+struct le_buddy_allocator_t {
+
+	uint64_t                               size           = 0; // number of bytes in range, must be a power of two
+	uint32_t                               min_block_log2 = 0; // log2 of smallest block size
+	std::vector<std::set<uint64_t>>        free_blocks;        // per order: offsets of free blocks
+	std::unordered_map<uint64_t, uint32_t> used_blocks;        // offset -> order, for each allocated block
+	uint64_t                               used_bytes = 0;     // sum over sizes of allocated blocks
+
+	le_buddy_allocator_t( uint32_t size_log2, uint32_t min_block_log2_ )
+	    : size( 1ull << size_log2 )
+	    , min_block_log2( min_block_log2_ ) {
+		free_blocks.resize( size_log2 - min_block_log2 + 1 );
+		free_blocks.back().insert( 0 ); // initially, the whole range is a single free block
+	}
+
+	uint64_t get_block_size( uint32_t order ) const {
+		return 1ull << ( order + min_block_log2 );
+	}
+
+	// Returns order of smallest block which can hold `num_bytes`.
+	uint32_t get_order( uint64_t num_bytes ) const {
+		uint32_t order = 0;
+		while ( get_block_size( order ) < num_bytes ) {
+			order++;
+		}
+		return order;
+	}
+
+	// Returns false if there is no free block which could hold `num_bytes`.
+	bool allocate( uint64_t num_bytes, uint64_t* offset ) {
+
+		uint32_t const order = get_order( num_bytes );
+
+		if ( order >= free_blocks.size() ) {
+			return false;
+		}
+
+		// Find smallest free block which is large enough.
+
+		uint32_t o = order;
+		while ( o < free_blocks.size() && free_blocks[ o ].empty() ) {
+			o++;
+		}
+
+		if ( o == free_blocks.size() ) {
+			return false;
+		}
+
+		// --------| invariant: free_blocks[o] holds a block which is large enough
+
+		uint64_t block_offset = *free_blocks[ o ].begin();
+		free_blocks[ o ].erase( free_blocks[ o ].begin() );
+
+		// Split block until it has the requested order - each split
+		// returns the upper half to the free list one order below.
+
+		while ( o > order ) {
+			o--;
+			free_blocks[ o ].insert( block_offset + get_block_size( o ) );
+		}
+
+		used_blocks[ block_offset ] = order;
+		used_bytes += get_block_size( order );
+
+		*offset = block_offset;
+		return true;
+	}
+
+	// Returns size of allocated block at `offset`, or 0 if there is no allocated block at `offset`.
+	uint64_t get_allocation_size( uint64_t offset ) const {
+		auto it = used_blocks.find( offset );
+		return it != used_blocks.end() ? get_block_size( it->second ) : 0;
+	}
+
+	// Returns false if there is no allocated block at `offset`.
+	bool free( uint64_t offset ) {
+
+		auto it = used_blocks.find( offset );
+
+		if ( it == used_blocks.end() ) {
+			return false;
+		}
+
+		uint32_t order = it->second;
+		used_blocks.erase( it );
+		used_bytes -= get_block_size( order );
+
+		// Merge with buddy for as long as buddy is free.
+
+		while ( order + 1 < free_blocks.size() ) {
+			uint64_t buddy_offset = offset ^ get_block_size( order );
+			if ( 0 == free_blocks[ order ].erase( buddy_offset ) ) {
+				break;
+			}
+			offset = offset < buddy_offset ? offset : buddy_offset;
+			order++;
+		}
+
+		free_blocks[ order ].insert( offset );
+		return true;
+	}
+};
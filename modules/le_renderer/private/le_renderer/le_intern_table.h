@@ -0,0 +1,214 @@
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+#include <atomic>
+#include <mutex>
+#include <vector>
+
+/*
+ * The Intern Table is an insert-only hash table which maps a 64 bit hash to
+ * a pointer to an entry. We use it to intern resource- and texture handles:
+ * once an entry has been inserted, it never moves, and it is never removed
+ * until the table gets destroyed - which means that a pointer to an entry
+ * may be used as a handle.
+ *
+ * Lookups are lock-free: they only ever load from the table. Inserts are
+ * serialised via a mutex - they are rare, as most lookups are for handles
+ * which already exist.
+ *
+ * The table uses open addressing with linear probing. When the table needs
+ * to grow, we build a new, larger, slot array, and publish it atomically.
+ * Retired slot arrays are kept alive until the table gets destroyed, so
+ * that any concurrent readers may finish probing them. A reader which
+ * misses an entry because it probed a retired slot array will find that
+ * entry on the (locked) insert path.
+ *
+ * Each thread additionally keeps a small, direct-mapped cache of recent
+ * lookups. A cache hit costs a few loads, and does not need to probe the
+ * table at all.
+ *
+ * `Entry` must be default-constructible. Entries are owned by the table.
+ *
+ */
+
+template <typename Entry>
+struct le_intern_table_t {
+
+	struct Slot {
+		std::atomic<uint64_t> hash;
+		std::atomic<Entry*>   entry; // nullptr means slot is empty
+	};
+
+	struct Slots {
+		size_t capacity; // number of slots, must be a power of two
+		Slot*  slots;
+	};
+
+	static constexpr size_t INITIAL_CAPACITY = 1024;
+	static constexpr size_t CACHE_SIZE       = 64; // number of entries in per-thread lookup cache, must be a power of two
+
+	struct CacheLine {
+		uint64_t table_id; // id of table which produced this entry
+		uint64_t hash;
+		Entry*   entry;
+	};
+
+	std::atomic<Slots*> slots;        // current slot array
+	std::vector<Slots*> slots_retired; // slot arrays which were replaced when the table grew
+	std::vector<Entry*> entries;      // owning: all entries, including entries which were inserted without a hash
+	size_t              num_hashed = 0; // number of entries which are stored in slots
+	std::mutex          mtx;          // protects inserts
+	uint64_t            id;           // unique id for this table, so that per-thread caches can tell tables apart
+
+	le_intern_table_t() {
+		static std::atomic<uint64_t> table_count = 0;
+		id = ++table_count;
+		slots.store( create_slots( INITIAL_CAPACITY ), std::memory_order_relaxed );
+	}
+
+	le_intern_table_t( le_intern_table_t const& )            = delete;
+	le_intern_table_t& operator=( le_intern_table_t const& ) = delete;
+
+	~le_intern_table_t() {
+		for ( auto& e : entries ) {
+			delete e;
+		}
+		destroy_slots( slots.load( std::memory_order_relaxed ) );
+		for ( auto& s : slots_retired ) {
+			destroy_slots( s );
+		}
+	}
+
+	static Slots* create_slots( size_t capacity ) {
+		Slots* s    = new Slots;
+		s->capacity = capacity;
+		s->slots    = new Slot[ capacity ];
+		for ( size_t i = 0; i != capacity; i++ ) {
+			s->slots[ i ].hash.store( 0, std::memory_order_relaxed );
+			s->slots[ i ].entry.store( nullptr, std::memory_order_relaxed );
+		}
+		return s;
+	}
+
+	static void destroy_slots( Slots* s ) {
+		delete[] s->slots;
+		delete s;
+	}
+
+	static CacheLine* get_thread_cache() {
+		static thread_local CacheLine cache[ CACHE_SIZE ] = {};
+		return cache;
+	}
+
+	// Lock-free: returns entry for which `is_equal( entry )` is true, or nullptr if not found.
+	template <typename IsEqual>
+	Entry* find( uint64_t hash, IsEqual const& is_equal ) {
+
+		CacheLine& cached = get_thread_cache()[ hash & ( CACHE_SIZE - 1 ) ];
+
+		if ( cached.table_id == id && cached.hash == hash && is_equal( *cached.entry ) ) {
+			return cached.entry;
+		}
+
+		// --------| invariant: not found in per-thread cache
+
+		Slots const* s    = slots.load( std::memory_order_acquire );
+		size_t const mask = s->capacity - 1;
+
+		for ( size_t i = hash & mask;; i = ( i + 1 ) & mask ) {
+
+			Entry* entry = s->slots[ i ].entry.load( std::memory_order_acquire );
+
+			if ( entry == nullptr ) {
+				return nullptr;
+			}
+
+			if ( s->slots[ i ].hash.load( std::memory_order_relaxed ) == hash && is_equal( *entry ) ) {
+				cached = { id, hash, entry };
+				return entry;
+			}
+		}
+	}
+
+	// Returns entry for which `is_equal( entry )` is true - if no such entry exists,
+	// creates a new entry, and calls `init( entry )` before the entry gets published.
+	template <typename IsEqual, typename Init>
+	Entry* find_or_insert( uint64_t hash, IsEqual const& is_equal, Init const& init ) {
+
+		Entry* entry = find( hash, is_equal );
+
+		if ( entry ) {
+			return entry;
+		}
+
+		// --------| invariant: entry was not found - we must insert
+
+		std::scoped_lock lock( mtx );
+
+		// Another thread might have inserted our entry since we last looked,
+		// or our lookup might have probed a retired slot array - look again
+		// while holding the lock, which guarantees that we see the latest slots.
+
+		entry = find( hash, is_equal );
+
+		if ( entry ) {
+			return entry;
+		}
+
+		entry = new Entry{};
+		init( *entry );
+		entries.push_back( entry );
+
+		Slots* s = slots.load( std::memory_order_relaxed );
+
+		if ( ( num_hashed + 1 ) * 2 > s->capacity ) {
+			s = grow( s );
+		}
+
+		insert_into_slots( s, hash, entry );
+		num_hashed++;
+
+		return entry;
+	}
+
+	// Creates a new entry which can't be found via lookup - use this for anonymous entries.
+	template <typename Init>
+	Entry* insert_anonymous( Init const& init ) {
+		std::scoped_lock lock( mtx );
+		Entry*           entry = new Entry{};
+		init( *entry );
+		entries.push_back( entry );
+		return entry;
+	}
+
+  private:
+	static void insert_into_slots( Slots* s, uint64_t hash, Entry* entry ) {
+		size_t const mask = s->capacity - 1;
+		for ( size_t i = hash & mask;; i = ( i + 1 ) & mask ) {
+			if ( s->slots[ i ].entry.load( std::memory_order_relaxed ) == nullptr ) {
+				// Publish hash before entry: readers test entry first.
+				s->slots[ i ].hash.store( hash, std::memory_order_relaxed );
+				s->slots[ i ].entry.store( entry, std::memory_order_release );
+				return;
+			}
+		}
+	}
+
+	// Must be called while holding mtx.
+	Slots* grow( Slots* s ) {
+		Slots* grown = create_slots( s->capacity * 2 );
+
+		for ( size_t i = 0; i != s->capacity; i++ ) {
+			Entry* entry = s->slots[ i ].entry.load( std::memory_order_relaxed );
+			if ( entry ) {
+				insert_into_slots( grown, s->slots[ i ].hash.load( std::memory_order_relaxed ), entry );
+			}
+		}
+
+		slots_retired.push_back( s );
+		slots.store( grown, std::memory_order_release );
+
+		return grown;
+	}
+};
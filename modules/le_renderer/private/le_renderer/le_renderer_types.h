@@ -5,8 +5,7 @@
 
 #include "le_hash_util.h"
 
-constexpr size_t LE_MAX_NUM_GRAPH_RESOURCES = 2048; // Maximum number of unique resources in a Rendergraph. Set this to larger value if you want to deal with a larger number of distinct resources.
-constexpr size_t LE_MAX_NUM_GRAPH_ROOTS     = 64;   // Maximum number of root nodes in a given RenderGraph. We assume this is much smaller than LE_MAX_NUM_GRAPH_RESOURCES, but worst case it would need to be the same size.
+constexpr size_t LE_MAX_NUM_GRAPH_ROOTS = 64; // Maximum number of root nodes in a given RenderGraph. Note that the number of unique resources in a RenderGraph is not limited.
 
 namespace le {
 using RootPassesField = uint64_t; // used to express affinity to a root pass - each bit may represent a root pass
@@ -36,6 +35,23 @@ enum class LeResourceType : uint32_t {
 	eRtxTlas, // top level acceleration structure
 };
 
+struct le_buf_resource_usage_flags_t {
+	enum FlagBits : uint8_t {
+		eIsUnset   = 0,
+		eIsVirtual   = 1u << 0,
+		eIsStaging   = 1u << 1,
+		eIsTransient = 1u << 2, // buffer contents need not survive from one frame to the next - backend may alias its memory
+	};
+};
+
+struct le_img_resource_usage_flags_t {
+	enum FlagBits : uint8_t {
+		eIsUnset     = 0,
+		eIsRoot      = 1u << 0, // whether image, when used as a render target, is flagged as a root resource to the rendergraph
+		eIsTransient = 1u << 1, // image contents need not survive from one frame to the next - backend may alias its memory
+	};
+};
+
 LE_OPAQUE_HANDLE( le_resource_handle );
 LE_OPAQUE_HANDLE( le_image_resource_handle );
 LE_OPAQUE_HANDLE( le_buffer_resource_handle );
@@ -294,7 +310,8 @@ struct le_swapchain_settings_t {
 struct le_renderer_settings_t {
 	le_swapchain_settings_t swapchain_settings[ 16 ] = {}; // todo: rename this to initial_swapchain_settings; make sure that this is only accessed during renderer::setup, and not any later. convert this into a linked list!
 	size_t                  num_swapchain_settings   = 0;
-	// TODO: add a hint for number of swapchain frames
+	uint32_t                num_worker_threads       = 0; // number of worker threads for rendering, 0 means to render on the main thread
+	uint32_t                pipeline_depth           = 0; // number of frames in flight, 0 means to use backend default; must be at least 2, or at least 3 with worker threads
 };
 
 // specifies parameters for an image write operation.
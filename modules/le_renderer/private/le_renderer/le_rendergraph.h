@@ -113,6 +113,18 @@ struct le_renderpass_o {
 	char                         debugName[ 256 ];
 };
 
+// ----------------------------------------------------------------------
+// Result of rendergraph_build, kept so that we may skip compiling the graph
+// if the next graph we build has an identical structure.
+struct le_rendergraph_build_cache_t {
+	uint64_t                         hash = 0;                   // structural hash of passes this was built from, 0 means invalid
+	std::vector<uint8_t>             pass_is_contributing;       // one entry per pass, in order of passes before consolidation
+	std::vector<uint8_t>             pass_is_root;               // one entry per pass, in order of passes before consolidation
+	std::vector<le::RootPassesField> pass_root_affinity;         // one entry per pass, in order of passes before consolidation
+	std::vector<le::RootPassesField> root_passes_affinity_masks; // copy of rendergraph's root_passes_affinity_masks
+	std::vector<uint32_t>            root_pass_indices;          // index of each root pass, in order of passes before consolidation, in same order as RootPassesField indices
+};
+
 // ----------------------------------------------------------------------
 
 struct le_rendergraph_o : NoCopy, NoMove {
@@ -127,5 +139,6 @@ struct le_rendergraph_o : NoCopy, NoMove {
 	                                                                         //
 	std::vector<char const*>                       root_debug_names;         // not owning: pointers to debug_names for root passes held within passes, in same order as RootPassesField indices
 	std::vector<le_on_frame_clear_callback_data_t> on_frame_clear_callbacks; // passed on to the backend: callbacks which get called once the backend frame into which this renderpass was placed gets cleared
+	le_rendergraph_build_cache_t                   build_cache;              // persists through reset: result of the last build with this rendergraph
 };
 #endif
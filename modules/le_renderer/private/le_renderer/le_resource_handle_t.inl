@@ -4,21 +4,6 @@
 #include <stdint.h>
 #include "le_renderer.h"
 
-struct le_buf_resource_usage_flags_t {
-	enum FlagBits : uint8_t {
-		eIsUnset   = 0,
-		eIsVirtual = 1u << 0,
-		eIsStaging = 1u << 1,
-	};
-};
-
-struct le_img_resource_usage_flags_t {
-	enum FlagBits : uint8_t {
-		eIsUnset = 0,
-		eIsRoot  = 1u << 0, // whether image, when used as a render target, is flagged as a root resource to the rendergraph
-	};
-};
-
 struct le_resource_handle_data_t {
 	LeResourceType        type;                        // type controls which of the following fields are used.
 	uint8_t               num_samples      = 0;        // number of samples log 2 if image
@@ -30,10 +15,13 @@ struct le_resource_handle_data_t {
 	bool
 	operator==( le_resource_handle_data_t const &rhs ) const noexcept {
 
-		for ( char const *c = debug_name, *d = rhs.debug_name; *c != 0; c++, d++ ) {
+		for ( char const *c = debug_name, *d = rhs.debug_name;; c++, d++ ) {
 			if ( *c != *d ) {
 				return false;
 			}
+			if ( *c == 0 ) {
+				break; // both names end here
+			}
 		}
 
 		return type == rhs.type &&
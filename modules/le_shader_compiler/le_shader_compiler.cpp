@@ -4,6 +4,7 @@
 #include "shaderc/shaderc.hpp"
 #include "le_log.h"
 #include "private/le_renderer/le_renderer_types.h" // for shader type
+#include "3rdparty/src/spooky/SpookyV2.h" // for shader cache keys
 
 #include <iomanip>
 #include <iostream>
@@ -16,9 +17,29 @@
 #include <vector>
 #include <set>
 #include <regex>
+#include <thread> // for naming temporary shader cache files
+
+#ifdef _MSC_VER
+#	define NOMINMAX     // we do this so that Windows.h does not define min and max macros
+#	include <Windows.h> // for getModule
+#else
+#	include <unistd.h> // for getexepath
+#endif
 
 static constexpr auto LOGGER_LABEL = "le_shader_compiler";
 
+// Compiler options which affect spir-v output. These also go into shader cache
+// keys, so that cached spir-v becomes stale as soon as any of these change.
+static constexpr shaderc_optimization_level SHADER_OPTIMIZATION_LEVEL   = shaderc_optimization_level_performance;
+static constexpr bool                       SHADER_GENERATE_DEBUG_INFO  = true;
+static constexpr shaderc_env_version        SHADER_TARGET_ENV_VERSION   = shaderc_env_version_vulkan_1_3;
+static constexpr shaderc_spirv_version      SHADER_TARGET_SPIRV_VERSION = shaderc_spirv_version_1_5;
+
+// Bump this whenever the shader cache file format changes, or whenever shaderc gets
+// updated - this invalidates all existing shader cache entries.
+static constexpr uint32_t SHADER_CACHE_VERSION = 1;
+static constexpr uint32_t SHADER_CACHE_MAGIC   = 0x4353454c; // 'LESC'
+
 struct le_shader_compiler_o {
 	shaderc_compiler_t                 compiler;
 	shaderc_compile_options_t          options;
@@ -36,7 +57,8 @@ struct FileData {
 // simplifies passing it to the includer callback
 //
 struct included_files_container_t {
-	std::vector<std::string> paths; // paths to files that this translation unit depends on
+	std::vector<std::string> paths;          // paths to files that this translation unit depends on
+	std::vector<uint64_t>    content_hashes; // hash over contents for each file in paths, so that we can tell whether a cached result is stale
 };
 
 // ---------------------------------------------------------------
@@ -44,6 +66,12 @@ struct included_files_container_t {
 struct le_shader_compilation_result_o {
 	shaderc_compilation_result* result = nullptr;
 	included_files_container_t  includes;
+	std::filesystem::path       cache_entry_path;      // path to shader cache entry for this result - empty if result is not cached
+	uint64_t                    cache_key     = 0;     // key for shader cache entry, see `le_shader_cache_calculate_key`
+	bool                        is_from_cache = false; // if true, `result` is nullptr, and spir-v is held in `cached_spirv`
+	bool                        must_store    = false; // if true, cache entry has not been written yet - see `le_shader_compilation_result_set_cached_reflection`
+	std::vector<char>           cached_spirv;          // spir-v code, if result was loaded from shader cache
+	std::vector<char>           cached_reflection;     // reflection data which is stored with shader cache entry, may be empty
 };
 
 struct includes_callback_data_t {
@@ -149,7 +177,13 @@ static le_shader_compilation_result_o* le_shader_compilation_result_create() {
 
 // ---------------------------------------------------------------
 
+static bool le_shader_cache_entry_store( le_shader_compilation_result_o* result ); // forward declaration
+
 static void le_shader_compilation_result_destroy( le_shader_compilation_result_o* self ) {
+	if ( self->must_store ) {
+		// Nobody attached reflection data - store cache entry without it.
+		le_shader_cache_entry_store( self );
+	}
 	if ( self->result != nullptr ) {
 		shaderc_result_release( self->result );
 	}
@@ -159,6 +193,13 @@ static void le_shader_compilation_result_destroy( le_shader_compilation_result_o
 // ---------------------------------------------------------------
 
 static void le_shader_compilation_result_get_result_bytes( le_shader_compilation_result_o* res, const char** p_spir_v_bytes, size_t* pNumBytes ) {
+
+	if ( res->is_from_cache ) {
+		*p_spir_v_bytes = res->cached_spirv.data();
+		*pNumBytes      = res->cached_spirv.size();
+		return;
+	}
+
 	assert( res->result );
 
 	*p_spir_v_bytes = shaderc_result_get_bytes( res->result );
@@ -168,6 +209,9 @@ static void le_shader_compilation_result_get_result_bytes( le_shader_compilation
 // ---------------------------------------------------------------
 /// \brief returns true if compilation was a success, false otherwise
 static bool le_shader_compilation_result_get_result_success( le_shader_compilation_result_o* res ) {
+	if ( res->is_from_cache ) {
+		return true; // we only ever store successful results in the cache
+	}
 	assert( res->result );
 	return shaderc_result_get_compilation_status( res->result ) == shaderc_compilation_status_success;
 }
@@ -180,9 +224,11 @@ static le_shader_compiler_o* le_shader_compiler_create() {
 
 	{
 		obj->options = shaderc_compile_options_initialize();
-		shaderc_compile_options_set_generate_debug_info( obj->options );
+		if ( SHADER_GENERATE_DEBUG_INFO ) {
+			shaderc_compile_options_set_generate_debug_info( obj->options );
+		}
 		shaderc_compile_options_set_source_language( obj->options, shaderc_source_language::shaderc_source_language_glsl );
-		shaderc_compile_options_set_optimization_level( obj->options, shaderc_optimization_level_performance );
+		shaderc_compile_options_set_optimization_level( obj->options, SHADER_OPTIMIZATION_LEVEL );
 	}
 
 	obj->include_search_directories = {
@@ -317,6 +363,9 @@ static shaderc_include_result* le_shaderc_include_result_create( void*       use
 		// -- load file contents into fileData
 		fileData->contents = load_file( requested_source_path, &loadSuccess );
 
+		// -- store hash over contents, so that we can tell later whether a cached result is stale
+		included_files->content_hashes.push_back( loadSuccess ? SpookyHash::Hash64( fileData->contents.data(), fileData->contents.size(), 0 ) : 0 );
+
 	} else {
 		// Empty path is understood as a signal in shaderc: failed inclusion
 		fileData->path_str = "";
@@ -570,6 +619,319 @@ static shaderc_source_language to_shader_c( LeShaderSourceLanguageEnum const& sh
 	// clang-format on
 }
 
+// ---------------------------------------------------------------
+// Shader cache
+//
+// We cache compiled spir-v on disk, so that we don't have to compile shaders
+// on startup unless their sources or compiler options have changed. Each cache
+// entry is a file in the shader cache directory, named after the entry's key.
+//
+// The key is a hash over everything which goes into a compilation apart from
+// the contents of included files: source text, source file path, macro
+// definitions, shader stage, source language, compiler options, and include
+// search directories. We can't know which files a shader includes without
+// running the preprocessor - each entry therefore records path and content
+// hash for all files which were included, and a lookup only counts as a hit
+// if all these files still hash to the same values.
+//
+// Entry file layout:
+//
+//     header | includes: { content hash, path length, path } | spir-v | reflection data
+//
+// Reflection data is opaque to us - callers may store it with an entry so that
+// they don't have to reflect spir-v which was loaded from the cache.
+
+struct le_shader_cache_entry_header_t {
+	uint32_t magic;                // must be SHADER_CACHE_MAGIC
+	uint32_t version;              // must be SHADER_CACHE_VERSION
+	uint64_t key;                  // must match key for entry
+	uint32_t num_includes;         //
+	uint32_t reserved;             //
+	uint64_t spirv_num_bytes;      //
+	uint64_t reflection_num_bytes; // may be 0 if no reflection data was stored
+};
+
+// Returns shader cache directory - an empty path means that the shader cache is disabled.
+//
+// Relative paths are resolved against the directory which holds the executable, not against
+// the current working directory, so that each app keeps its own cache, wherever it gets started from.
+static std::filesystem::path le_shader_cache_get_directory() {
+	LE_SETTING( std::string, LE_SETTING_SHADER_CACHE_DIRECTORY, ".le_shader_cache" ); // set to empty string to disable shader cache
+
+	if ( LE_SETTING_SHADER_CACHE_DIRECTORY->empty() ) {
+		return {};
+	}
+
+	static std::filesystem::path exe_path = []() {
+		char result[ 1024 ] = { 0 };
+
+#ifdef _MSC_VER
+
+		// When NULL is passed to GetModuleHandle, the handle of the exe itself is returned
+		HMODULE hModule = GetModuleHandle( NULL );
+		if ( hModule != NULL ) {
+			// Use GetModuleFileName() with module handle to get the path
+			GetModuleFileName( hModule, result, ( sizeof( result ) ) );
+		}
+		size_t count = strnlen_s( result, sizeof( result ) );
+#else
+		ssize_t count = readlink( "/proc/self/exe", result, 1024 );
+#endif
+
+		return std::string( result, ( count > 0 ) ? size_t( count ) : 0 );
+	}();
+
+	std::filesystem::path directory = *LE_SETTING_SHADER_CACHE_DIRECTORY;
+
+	if ( directory.is_relative() && !exe_path.empty() ) {
+		directory = exe_path.parent_path() / directory;
+	}
+
+	return directory;
+}
+
+// ---------------------------------------------------------------
+
+static uint64_t le_shader_cache_calculate_key(
+    le_shader_compiler_o const*       self,
+    const char*                       sourceFileText,
+    size_t                            sourceFileNumBytes,
+    const LeShaderSourceLanguageEnum& shader_source_language,
+    const le::ShaderStage&            shaderType,
+    const char*                       original_file_path,
+    char const*                       macroDefinitionsStr,
+    size_t                            macroDefinitionsStrSz ) {
+
+	struct {
+		uint32_t cache_version;
+		uint32_t stage;
+		uint32_t source_language;
+		uint32_t optimization_level;
+		uint32_t generate_debug_info;
+		uint32_t target_env_version;
+		uint32_t target_spirv_version;
+	} const options = {
+	    .cache_version        = SHADER_CACHE_VERSION,
+	    .stage                = uint32_t( shaderType ),
+	    .source_language      = uint32_t( shader_source_language.data ),
+	    .optimization_level   = uint32_t( SHADER_OPTIMIZATION_LEVEL ),
+	    .generate_debug_info  = uint32_t( SHADER_GENERATE_DEBUG_INFO ),
+	    .target_env_version   = uint32_t( SHADER_TARGET_ENV_VERSION ),
+	    .target_spirv_version = uint32_t( SHADER_TARGET_SPIRV_VERSION ),
+	};
+
+	uint64_t key = SpookyHash::Hash64( &options, sizeof( options ), 0 );
+
+	key = SpookyHash::Hash64( sourceFileText, sourceFileNumBytes, key );
+	key = SpookyHash::Hash64( original_file_path, strlen( original_file_path ), key ); // relative includes are resolved against source file path
+	key = SpookyHash::Hash64( macroDefinitionsStr, macroDefinitionsStrSz, key );
+
+	for ( auto const& dir : self->include_search_directories ) {
+		std::string const dir_str = dir.string();
+		key                       = SpookyHash::Hash64( dir_str.data(), dir_str.size(), key );
+	}
+
+	return key;
+}
+
+// ---------------------------------------------------------------
+// Unlike `load_file`, this does not complain if the file can't be read,
+// as this is what we expect on a cache miss.
+static bool le_shader_cache_read_file( std::filesystem::path const& path, std::vector<char>& contents ) {
+
+	std::ifstream file( path, std::ios::in | std::ios::binary | std::ios::ate );
+
+	if ( !file.is_open() ) {
+		return false;
+	}
+
+	auto endOfFilePos = file.tellg();
+
+	if ( endOfFilePos < 0 ) {
+		return false;
+	}
+
+	contents.resize( size_t( endOfFilePos ) );
+
+	file.seekg( 0, std::ios::beg );
+	file.read( contents.data(), endOfFilePos );
+
+	return !file.fail();
+}
+
+// ---------------------------------------------------------------
+// Fills in result from cache entry at `path`.
+// Returns false if there is no valid entry at `path`, or if the entry is stale.
+static bool le_shader_cache_entry_load( std::filesystem::path const& path, uint64_t key, le_shader_compilation_result_o* result ) {
+
+	std::vector<char> data;
+
+	if ( !le_shader_cache_read_file( path, data ) ) {
+		return false;
+	}
+
+	char const*       c        = data.data();
+	char const* const data_end = data.data() + data.size();
+
+	// Copies `num_bytes` from entry data into `dst` - unless this would read past the end of entry data.
+	auto read = [ & ]( void* dst, size_t num_bytes ) -> bool {
+		if ( size_t( data_end - c ) < num_bytes ) {
+			return false;
+		}
+		memcpy( dst, c, num_bytes );
+		c += num_bytes;
+		return true;
+	};
+
+	le_shader_cache_entry_header_t header{};
+
+	if ( !read( &header, sizeof( header ) ) ||
+	     header.magic != SHADER_CACHE_MAGIC ||
+	     header.version != SHADER_CACHE_VERSION ||
+	     header.key != key ) {
+		return false;
+	}
+
+	included_files_container_t includes;
+
+	for ( uint32_t i = 0; i != header.num_includes; i++ ) {
+		uint64_t content_hash = 0;
+		uint32_t path_length  = 0;
+
+		if ( !read( &content_hash, sizeof( content_hash ) ) ||
+		     !read( &path_length, sizeof( path_length ) ) ||
+		     size_t( data_end - c ) < path_length ) {
+			return false;
+		}
+
+		includes.paths.emplace_back( c, path_length );
+		includes.content_hashes.push_back( content_hash );
+		c += path_length;
+	}
+
+	if ( size_t( data_end - c ) < header.spirv_num_bytes ||
+	     size_t( data_end - c ) - header.spirv_num_bytes != header.reflection_num_bytes ) {
+		return false;
+	}
+
+	// ---------| invariant: entry is well-formed
+
+	// Entry is only valid if none of the files which it includes have changed since it was written.
+
+	std::vector<char> include_contents;
+
+	for ( size_t i = 0; i != includes.paths.size(); i++ ) {
+		if ( !le_shader_cache_read_file( includes.paths[ i ], include_contents ) ||
+		     SpookyHash::Hash64( include_contents.data(), include_contents.size(), 0 ) != includes.content_hashes[ i ] ) {
+			return false;
+		}
+	}
+
+	// ---------| invariant: entry is valid
+
+	result->cached_spirv.assign( c, c + header.spirv_num_bytes );
+	result->cached_reflection.assign( c + header.spirv_num_bytes, data_end );
+	result->includes      = std::move( includes );
+	result->is_from_cache = true;
+
+	return true;
+}
+
+// ---------------------------------------------------------------
+// Writes cache entry for a successful result. We write into a temporary file
+// first, and then move it into place, so that readers never see a partially
+// written entry. Temporary files are named per-thread, as more than one thread
+// may compile the same shader at the same time.
+static bool le_shader_cache_entry_store( le_shader_compilation_result_o* result ) {
+	static auto logger = LeLog( LOGGER_LABEL );
+
+	assert( !result->cache_entry_path.empty() );
+	assert( result->includes.paths.size() == result->includes.content_hashes.size() );
+
+	const char* spirv_bytes     = nullptr;
+	size_t      spirv_num_bytes = 0;
+	le_shader_compilation_result_get_result_bytes( result, &spirv_bytes, &spirv_num_bytes );
+
+	le_shader_cache_entry_header_t const header = {
+	    .magic                = SHADER_CACHE_MAGIC,
+	    .version              = SHADER_CACHE_VERSION,
+	    .key                  = result->cache_key,
+	    .num_includes         = uint32_t( result->includes.paths.size() ),
+	    .reserved             = 0,
+	    .spirv_num_bytes      = spirv_num_bytes,
+	    .reflection_num_bytes = result->cached_reflection.size(),
+	};
+
+	std::error_code ec;
+	std::filesystem::create_directories( result->cache_entry_path.parent_path(), ec );
+
+	std::filesystem::path tmp_path = result->cache_entry_path;
+	tmp_path += ".tmp" + std::to_string( std::hash<std::thread::id>()( std::this_thread::get_id() ) );
+
+	{
+		std::ofstream file( tmp_path, std::ios::out | std::ios::binary | std::ios::trunc );
+		file.write( reinterpret_cast<char const*>( &header ), sizeof( header ) );
+
+		for ( size_t i = 0; i != result->includes.paths.size(); i++ ) {
+			uint64_t const content_hash = result->includes.content_hashes[ i ];
+			uint32_t const path_length  = uint32_t( result->includes.paths[ i ].size() );
+			file.write( reinterpret_cast<char const*>( &content_hash ), sizeof( content_hash ) );
+			file.write( reinterpret_cast<char const*>( &path_length ), sizeof( path_length ) );
+			file.write( result->includes.paths[ i ].data(), path_length );
+		}
+
+		file.write( spirv_bytes, std::streamsize( spirv_num_bytes ) );
+		file.write( result->cached_reflection.data(), std::streamsize( result->cached_reflection.size() ) );
+		file.close();
+
+		if ( file.fail() ) {
+			logger.warn( "Could not write shader cache entry '%s'", tmp_path.string().c_str() );
+			std::filesystem::remove( tmp_path, ec );
+			return false;
+		}
+	}
+
+	std::filesystem::rename( tmp_path, result->cache_entry_path, ec ); // replaces any previous entry
+
+	if ( ec ) {
+		logger.warn( "Could not move shader cache entry '%s' into place: %s", result->cache_entry_path.string().c_str(), ec.message().c_str() );
+		std::filesystem::remove( tmp_path, ec );
+		return false;
+	}
+
+	return true;
+}
+
+// ---------------------------------------------------------------
+
+static bool le_shader_compilation_result_get_cached_reflection( le_shader_compilation_result_o* res, const char** p_data, size_t* pNumBytes ) {
+	if ( !res->is_from_cache || res->cached_reflection.empty() ) {
+		return false;
+	}
+	*p_data    = res->cached_reflection.data();
+	*pNumBytes = res->cached_reflection.size();
+	return true;
+}
+
+// ---------------------------------------------------------------
+// Writes cache entry for this result, so that it includes reflection data.
+//
+// A freshly compiled result does not write its cache entry straight away, but
+// waits for reflection data to be attached here, so that each entry gets written
+// only once. If no reflection data gets attached, the entry is written when the
+// result is destroyed.
+static void le_shader_compilation_result_set_cached_reflection( le_shader_compilation_result_o* res, const char* data, size_t numBytes ) {
+
+	if ( res->cache_entry_path.empty() ) {
+		// result is not cached - nothing to do.
+		return;
+	}
+
+	res->cached_reflection.assign( data, data + numBytes );
+	res->must_store = false;
+	le_shader_cache_entry_store( res );
+}
+
 // ---------------------------------------------------------------
 
 static bool le_shader_compiler_compile_source(
@@ -584,6 +946,29 @@ static bool le_shader_compiler_compile_source(
     le_shader_compilation_result_o*   result ) {
 	static auto logger = LeLog( LOGGER_LABEL );
 
+	// -- Look up shader cache first - if there is a valid entry, we don't need to compile.
+
+	std::filesystem::path const cache_directory = le_shader_cache_get_directory();
+	std::filesystem::path       cache_entry_path; // stays empty if shader cache is disabled
+	uint64_t                    cache_key = 0;
+
+	if ( !cache_directory.empty() ) {
+		cache_key = le_shader_cache_calculate_key( self, sourceFileText, sourceFileNumBytes, shader_source_language, shaderType, original_file_path, macroDefinitionsStr, macroDefinitionsStrSz );
+
+		char cache_entry_name[ 32 ];
+		snprintf( cache_entry_name, sizeof( cache_entry_name ), "%016llx.spv", ( unsigned long long )cache_key );
+		cache_entry_path = cache_directory / cache_entry_name;
+
+		if ( le_shader_cache_entry_load( cache_entry_path, cache_key, result ) ) {
+			logger.info( "Loaded shader file from cache: '%s'", original_file_path );
+			result->cache_entry_path = cache_entry_path;
+			result->cache_key        = cache_key;
+			return true;
+		}
+	}
+
+	// ---------| invariant: shader was not found in cache, we must compile
+
 	logger.info( "Compiling shader file: '%s'", original_file_path );
 
 	auto shaderKind = convert_to_shaderc_shader_kind( shaderType );
@@ -609,8 +994,8 @@ static bool le_shader_compiler_compile_source(
 	    le_shaderc_include_result_destroy,
 	    &includes_callback_data );
 
-	shaderc_compile_options_set_target_env( local_options, shaderc_target_env_vulkan, shaderc_env_version_vulkan_1_3 );
-	shaderc_compile_options_set_target_spirv( local_options, shaderc_spirv_version_1_5 );
+	shaderc_compile_options_set_target_env( local_options, shaderc_target_env_vulkan, SHADER_TARGET_ENV_VERSION );
+	shaderc_compile_options_set_target_spirv( local_options, SHADER_TARGET_SPIRV_VERSION );
 
 	// -- Preprocess GLSL source - this will expand macros and includes
 	auto preprocessorResult =
@@ -668,6 +1053,12 @@ static bool le_shader_compiler_compile_source(
 	if ( shaderc_result_get_compilation_status( result->result ) != shaderc_compilation_status_success ) {
 		const char* err_msg = shaderc_result_get_error_message( result->result );
 		le_shader_compiler_print_error_context( err_msg, preprocessorText, original_file_path );
+	} else if ( !cache_entry_path.empty() ) {
+		// -- Mark successful result for the shader cache - the entry gets written once
+		// reflection data has been attached, see `le_shader_compilation_result_set_cached_reflection`.
+		result->cache_entry_path = cache_entry_path;
+		result->cache_key        = cache_key;
+		result->must_store       = true;
 	}
 
 	shaderc_compile_options_release( local_options );
@@ -693,6 +1084,9 @@ LE_MODULE_REGISTER_IMPL( le_shader_compiler, api_ ) {
 	compiler_i.result_get_included_files = le_shader_compilation_result_get_next_included_file_path;
 	compiler_i.result_destroy            = le_shader_compilation_result_destroy;
 
+	compiler_i.result_get_cached_reflection = le_shader_compilation_result_get_cached_reflection;
+	compiler_i.result_set_cached_reflection = le_shader_compilation_result_set_cached_reflection;
+
 #ifdef PLUGINS_DYNAMIC
 	le_core_load_library_persistently( "libshaderc_shared.so" );
 #endif
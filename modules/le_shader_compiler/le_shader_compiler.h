@@ -37,6 +37,14 @@ struct le_shader_compiler_api {
         // pAddr receives a pointer to spir-v binary code - this is guaranteed to be castable to uint32_t. 
         void                    (* result_get_bytes          ) ( le_shader_compilation_result_o* res, const char** p_spir_v_bytes, size_t* pNumBytes);
 
+        /// \brief  reflection data is opaque to the compiler - it gets stored in the shader cache, next to cached spir-v,
+        ///         so that callers don't have to reflect spir-v which was loaded from the cache.
+        /// \return false if result was not loaded from cache, or if there was no reflection data stored with it
+        bool                    (* result_get_cached_reflection ) ( le_shader_compilation_result_o* res, const char** p_data, size_t* pNumBytes);
+        /// \brief  store reflection data with cached spir-v for this result - does nothing if result is not cached
+        /// \note   cache entries for freshly compiled results are written here, or on result_destroy if this is never called
+        void                    (* result_set_cached_reflection ) ( le_shader_compilation_result_o* res, const char* data, size_t numBytes);
+
     };
 
 	compiler_interface_t       compiler_i;
@@ -85,6 +85,7 @@ process_app(){
     local build_type="$2"
     local app_dir=$(echo ${app_names[0]} | xargs)
     local app_name=$(echo ${app_names[1]} | xargs)
+    local app_action=$(echo ${app_names[2]} | xargs)
 	local app_base_dir="$FILE_DIR/../../apps/$app_dir"
 
     # printf "'%s' '%s' '%s'\n" "${app_dir}" "${app_name}" "${app_base_dir}"
@@ -93,7 +94,7 @@ process_app(){
 	then
 		local build_dir="${app_base_dir}/build/Desktop-Test_${build_type}"
 
-		build_app "${build_dir} ${app_name} ${build_type}" &>build.log
+		build_app "${build_dir}" "${app_name}" "${build_type}" &>build.log
 		local build_result=$?
 
 		# echo "BUILD result: ${build_result}" 
@@ -115,6 +116,24 @@ process_app(){
 
 		printf "[  OK  ] %- 10s: %s\n" "${build_type}" "${app_name}"
 
+		# apps marked with `:run` in tests.txt are tests which don't need a
+		# device - we run these, and fail if they return a non-zero exit code.
+		if [[ "${app_action}" == "run" ]]
+		then
+			if ( cd "${build_dir}/bin" && "./${app_name}" ) &>run.log
+			then
+				printf "[  OK  ] %- 10s: %s (run)\n" "${build_type}" "${app_name}"
+			else
+				printf "[ FAIL ] %- 10s: %s (run)\n" "${build_type}" "${app_name}"
+				echo "--------------" >> run.err
+				echo "${build_type} ${app_name} RUN FAILED: " >> run.err
+				echo "--------------" >> run.err
+				cat run.log >> run.err
+				cat run.err
+				return 1
+			fi
+		fi
+
 	else 
 		echo "directory not found: '${app_base_dir}'"
 		exit 1